@@ -56,6 +56,11 @@ GST_DEBUG_CATEGORY_STATIC (gst_mobilenetv2ssd_debug_category);
 #define TOTAL_CLASSES 90
 #define LOCATION_PARAMS 4
 
+#define LOCATIONS_TENSOR "locations"
+#define CLASSES_TENSOR "classes"
+#define SCORES_TENSOR "scores"
+#define NUM_DETECTIONS_TENSOR "num_detections"
+
 /* prototypes */
 static void gst_mobilenetv2ssd_set_property (GObject * object,
     guint property_id, const GValue * value, GParamSpec * pspec);
@@ -65,13 +70,14 @@ static gboolean gst_mobilenetv2ssd_preprocess (GstVideoInference * vi,
     GstVideoFrame * inframe, GstVideoFrame * outframe);
 static gboolean
 gst_mobilenetv2ssd_postprocess (GstVideoInference * vi,
-    const gpointer prediction, gsize predsize, GstMeta * meta_model,
-    GstVideoInfo * info_model, gboolean * valid_prediction,
-    gchar ** labels_list, gint num_labels);
+    const GstVideoInferenceTensor * tensors, guint num_tensors,
+    GstMeta * meta_model, GstVideoInfo * info_model,
+    gboolean * valid_prediction, gchar ** labels_list, gint num_labels);
 static gint
 gst_mobilenetv2ssd_get_boxes_from_prediction (GstMobilenetv2ssd *
-    mobilenetv2ssd, const gfloat * prediction, gint num_boxes, gint img_width,
-    gint img_height, BBox * boxes, gdouble ** probabilities);
+    mobilenetv2ssd, const gfloat * locations, const gfloat * classes,
+    const gfloat * scores, gint num_boxes, gint img_width, gint img_height,
+    BBox * boxes, gdouble ** probabilities);
 
 enum
 {
@@ -80,12 +86,23 @@ enum
   PROP_IOU_THRESH
 };
 
+/* The 4 output tensors of the model. The locations hold the top-left
+ * and bottom-right corners of every box, and the classes and scores its
+ * label and probability. Only the first num_detections boxes are valid */
+static const GstVideoInferenceTensorDesc output_tensors[] = {
+  {LOCATIONS_TENSOR, GST_INFERENCE_TENSOR_TYPE_FLOAT, 2,
+      {0, LOCATION_PARAMS}},
+  {CLASSES_TENSOR, GST_INFERENCE_TENSOR_TYPE_FLOAT, 1, {0}},
+  {SCORES_TENSOR, GST_INFERENCE_TENSOR_TYPE_FLOAT, 1, {0}},
+  {NUM_DETECTIONS_TENSOR, GST_INFERENCE_TENSOR_TYPE_FLOAT, 1, {1}},
+};
+
 /* pad templates */
 #define CAPS								\
   "video/x-raw, "							\
   "width=300, "								\
   "height=300, "							\
-  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}"
+  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR, I420, NV12}"
 
 static GstStaticPadTemplate sink_model_factory =
 GST_STATIC_PAD_TEMPLATE ("sink_model",
@@ -151,7 +168,10 @@ gst_mobilenetv2ssd_class_init (GstMobilenetv2ssdClass * klass)
           G_PARAM_READWRITE));
 
   vi_class->preprocess = GST_DEBUG_FUNCPTR (gst_mobilenetv2ssd_preprocess);
-  vi_class->postprocess = GST_DEBUG_FUNCPTR (gst_mobilenetv2ssd_postprocess);
+  vi_class->postprocess_tensors =
+      GST_DEBUG_FUNCPTR (gst_mobilenetv2ssd_postprocess);
+  gst_video_inference_class_set_output_tensors (vi_class, output_tensors,
+      G_N_ELEMENTS (output_tensors));
 }
 
 static void
@@ -176,18 +196,21 @@ gst_mobilenetv2ssd_preprocess (GstVideoInference * vi,
 
 static gint
 gst_mobilenetv2ssd_get_boxes_from_prediction (GstMobilenetv2ssd *
-    mobilenetv2ssd, const gfloat * prediction, gint num_boxes, gint img_width,
-    gint img_height, BBox * boxes, gdouble ** probabilities)
+    mobilenetv2ssd, const gfloat * locations, const gfloat * classes,
+    const gfloat * scores, gint num_boxes, gint img_width, gint img_height,
+    BBox * boxes, gdouble ** probabilities)
 {
   gint cur_box = 0;
   gdouble left = 0, top = 0, right = 0, bottom = 0;
-  gint i_box = 0, i_prob = 0, i_location = 0, i_label = 0;
+  gint i_box = 0, i_location = 0;
   gdouble prob = 0;
   gdouble prob_thresh = 0;
   gdouble iou_thresh = 0;
 
   g_return_val_if_fail (mobilenetv2ssd, cur_box);
-  g_return_val_if_fail (prediction, cur_box);
+  g_return_val_if_fail (locations, cur_box);
+  g_return_val_if_fail (classes, cur_box);
+  g_return_val_if_fail (scores, cur_box);
   g_return_val_if_fail (boxes, cur_box);
   g_return_val_if_fail (probabilities, cur_box);
 
@@ -197,27 +220,22 @@ gst_mobilenetv2ssd_get_boxes_from_prediction (GstMobilenetv2ssd *
   GST_OBJECT_UNLOCK (mobilenetv2ssd);
 
   for (i_box = 0; i_box < num_boxes; i_box++) {
-    /* Here prediction has the 4 concatenated tensors in the order
-       [locations, labels, probabilities, num_boxes], so we compute the indices 
-       to access each one of them */
     i_location = i_box * LOCATION_PARAMS;
-    i_label = i_box + (num_boxes * LOCATION_PARAMS);
-    i_prob = i_label + num_boxes;
-    prob = prediction[i_prob];
+    prob = scores[i_box];
 
     if (prob > prob_thresh) {
       BBox result = { 0 };
 
-      top = prediction[i_location] * img_height;
-      left = prediction[i_location + 1] * img_width;
-      bottom = prediction[i_location + 2] * img_height;
-      right = prediction[i_location + 3] * img_width;
+      top = locations[i_location] * img_height;
+      left = locations[i_location + 1] * img_width;
+      bottom = locations[i_location + 2] * img_height;
+      right = locations[i_location + 3] * img_width;
 
       result.x = left;
       result.y = top;
       result.width = right - left;
       result.height = bottom - top;
-      result.label = prediction[i_label];
+      result.label = CLAMP (classes[i_box], 0, TOTAL_CLASSES - 1);
       result.prob = prob;
       probabilities[cur_box][result.label] = result.prob;
       boxes[cur_box] = result;
@@ -232,40 +250,50 @@ gst_mobilenetv2ssd_get_boxes_from_prediction (GstMobilenetv2ssd *
 
 static gboolean
 gst_mobilenetv2ssd_postprocess (GstVideoInference * vi,
-    const gpointer prediction, gsize predsize, GstMeta * meta_model,
-    GstVideoInfo * info_model, gboolean * valid_prediction,
-    gchar ** labels_list, gint num_labels)
+    const GstVideoInferenceTensor * tensors, guint num_tensors,
+    GstMeta * meta_model, GstVideoInfo * info_model,
+    gboolean * valid_prediction, gchar ** labels_list, gint num_labels)
 {
   GstMobilenetv2ssd *mobilenetv2ssd = NULL;
   GstInferenceMeta *imeta = NULL;
+  const GstVideoInferenceTensor *locations, *classes, *scores, *detections;
   BBox *boxes = NULL;
   gdouble **probabilities = NULL;
   gint total_boxes = 0;
   gint valid_boxes = 0;
   gint i = 0;
   gboolean ret = TRUE;
-  const gfloat *pred = NULL;
 
   g_return_val_if_fail (vi, FALSE);
-  g_return_val_if_fail (prediction, FALSE);
+  g_return_val_if_fail (tensors, FALSE);
   g_return_val_if_fail (meta_model, FALSE);
   g_return_val_if_fail (info_model, FALSE);
   g_return_val_if_fail (valid_prediction, FALSE);
 
   GST_LOG_OBJECT (vi, "Postprocess");
 
-  pred = (const gfloat *) prediction;
   mobilenetv2ssd = GST_MOBILENETV2SSD (vi);
-  /* The ssd mobilenetv2 model has 4 output tensors:
-     0: [N * 4] tensor with the location of the N bounding boxes (top-left and
-     right-bottom corners). This tensor is flattened so the output we get here
-     is of shape [N * 4]
-     1: [N] tensor with the number of labels for the N bounding boxes
-     2: [N] tensor with the probabilities of those N labels
-     3: [1] tensor with the number of detected boxes 
-     They are all concatenated here in a 1D array in row-major order.
-   */
-  total_boxes = pred[predsize / sizeof (gfloat) - 1];
+
+  locations = gst_video_inference_tensor_find (tensors, num_tensors,
+      LOCATIONS_TENSOR);
+  classes = gst_video_inference_tensor_find (tensors, num_tensors,
+      CLASSES_TENSOR);
+  scores = gst_video_inference_tensor_find (tensors, num_tensors,
+      SCORES_TENSOR);
+  detections = gst_video_inference_tensor_find (tensors, num_tensors,
+      NUM_DETECTIONS_TENSOR);
+  g_return_val_if_fail (locations && classes && scores && detections, FALSE);
+
+  if (classes->shape[0] != locations->shape[0]
+      || scores->shape[0] != locations->shape[0]) {
+    GST_ERROR_OBJECT (mobilenetv2ssd, "Got %" G_GSIZE_FORMAT " locations, %"
+        G_GSIZE_FORMAT " classes and %" G_GSIZE_FORMAT " scores",
+        locations->shape[0], classes->shape[0], scores->shape[0]);
+    return FALSE;
+  }
+
+  total_boxes = *(const gfloat *) detections->data;
+  total_boxes = CLAMP (total_boxes, 0, (gint) locations->shape[0]);
 
   GST_LOG_OBJECT (mobilenetv2ssd, "Number of total predictions: %d",
       total_boxes);
@@ -287,8 +315,9 @@ gst_mobilenetv2ssd_postprocess (GstVideoInference * vi,
   }
 
   valid_boxes =
-      gst_mobilenetv2ssd_get_boxes_from_prediction (mobilenetv2ssd, pred,
-      total_boxes, info_model->width, info_model->height, boxes, probabilities);
+      gst_mobilenetv2ssd_get_boxes_from_prediction (mobilenetv2ssd,
+      locations->data, classes->data, scores->data, total_boxes,
+      info_model->width, info_model->height, boxes, probabilities);
 
   GST_LOG_OBJECT (mobilenetv2ssd, "Number of valid predictions: %d",
       valid_boxes);
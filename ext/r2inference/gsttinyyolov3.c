@@ -67,7 +67,9 @@ GST_DEBUG_CATEGORY_STATIC (gst_tinyyolov3_debug_category);
 #define MIN_NUM_CLASSES 1
 #define DEFAULT_NUM_CLASSES 80
 
-#define TOTAL_BOXES 2535
+/* Every box holds its corners, the objectness and the class
+ * probabilities */
+#define BOX_PARAMS 5
 
 /* prototypes */
 static void gst_tinyyolov3_set_property (GObject * object,
@@ -78,8 +80,9 @@ static void gst_tinyyolov3_get_property (GObject * object,
 static gboolean gst_tinyyolov3_preprocess (GstVideoInference * vi,
     GstVideoFrame * inframe, GstVideoFrame * outframe);
 static gboolean
-gst_tinyyolov3_postprocess (GstVideoInference * vi, const gpointer prediction,
-    gsize predsize, GstMeta * meta_model, GstVideoInfo * info_model,
+gst_tinyyolov3_postprocess (GstVideoInference * vi,
+    const GstVideoInferenceTensor * tensors, guint num_tensors,
+    GstMeta * meta_model, GstVideoInfo * info_model,
     gboolean * valid_prediction, gchar ** labels_list, gint num_labels);
 static gboolean gst_tinyyolov3_start (GstVideoInference * vi);
 static gboolean gst_tinyyolov3_stop (GstVideoInference * vi);
@@ -93,12 +96,18 @@ enum
   PROP_NUM_CLASSES,
 };
 
+/* The boxes of both detection scales, the number of boxes depends on
+ * the input size and the number of classes */
+static const GstVideoInferenceTensorDesc output_tensors[] = {
+  {"boxes", GST_INFERENCE_TENSOR_TYPE_FLOAT, 1, {0}},
+};
+
 /* pad templates */
 #define CAPS								\
   "video/x-raw, "							\
   "width=416, "								\
   "height=416, "							\
-  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}"
+  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR, I420, NV12}"
 
 static GstStaticPadTemplate sink_model_factory =
 GST_STATIC_PAD_TEMPLATE ("sink_model",
@@ -184,7 +193,10 @@ gst_tinyyolov3_class_init (GstTinyyolov3Class * klass)
   vi_class->start = GST_DEBUG_FUNCPTR (gst_tinyyolov3_start);
   vi_class->stop = GST_DEBUG_FUNCPTR (gst_tinyyolov3_stop);
   vi_class->preprocess = GST_DEBUG_FUNCPTR (gst_tinyyolov3_preprocess);
-  vi_class->postprocess = GST_DEBUG_FUNCPTR (gst_tinyyolov3_postprocess);
+  vi_class->postprocess_tensors =
+      GST_DEBUG_FUNCPTR (gst_tinyyolov3_postprocess);
+  gst_video_inference_class_set_output_tensors (vi_class, output_tensors,
+      G_N_ELEMENTS (output_tensors));
 }
 
 static void
@@ -273,32 +285,43 @@ gst_tinyyolov3_preprocess (GstVideoInference * vi,
 }
 
 static gboolean
-gst_tinyyolov3_postprocess (GstVideoInference * vi, const gpointer prediction,
-    gsize predsize, GstMeta * meta_model, GstVideoInfo * info_model,
+gst_tinyyolov3_postprocess (GstVideoInference * vi,
+    const GstVideoInferenceTensor * tensors, guint num_tensors,
+    GstMeta * meta_model, GstVideoInfo * info_model,
     gboolean * valid_prediction, gchar ** labels_list, gint num_labels)
 {
   GstTinyyolov3 *tinyyolov3 = NULL;
   GstInferenceMeta *imeta = NULL;
   BBox *boxes = NULL;
   gint num_boxes = 0, i = 0;
+  gint total_boxes, box_size;
   gdouble **probabilities = NULL;
 
   g_return_val_if_fail (vi, FALSE);
-  g_return_val_if_fail (prediction, FALSE);
+  g_return_val_if_fail (tensors, FALSE);
   g_return_val_if_fail (meta_model, FALSE);
   g_return_val_if_fail (info_model, FALSE);
   g_return_val_if_fail (valid_prediction, FALSE);
 
-  probabilities = g_malloc (sizeof (gdouble *) * TOTAL_BOXES);
-
   imeta = (GstInferenceMeta *) meta_model;
   tinyyolov3 = GST_TINYYOLOV3 (vi);
 
   GST_LOG_OBJECT (tinyyolov3, "Postprocess Meta");
 
+  box_size = BOX_PARAMS + tinyyolov3->num_classes;
+  if (0 != tensors[0].shape[0] % box_size) {
+    GST_ERROR_OBJECT (tinyyolov3, "Output of %" G_GSIZE_FORMAT
+        " values can't hold boxes of %u classes", tensors[0].shape[0],
+        tinyyolov3->num_classes);
+    return FALSE;
+  }
+  total_boxes = tensors[0].shape[0] / box_size;
+
+  probabilities = g_malloc (sizeof (gdouble *) * total_boxes);
+
   /* Create boxes from prediction data */
-  gst_create_boxes_float (vi, prediction, valid_prediction,
-      &boxes, &num_boxes, tinyyolov3->obj_thresh,
+  gst_create_boxes_float_full (vi, tensors[0].data, total_boxes,
+      valid_prediction, &boxes, &num_boxes, tinyyolov3->obj_thresh,
       tinyyolov3->prob_thresh, tinyyolov3->iou_thresh, probabilities,
       tinyyolov3->num_classes);
 
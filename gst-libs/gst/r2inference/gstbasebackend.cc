@@ -19,14 +19,22 @@
  *
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include "gstbasebackend.h"
 #include "gstbasebackendsubclass.h"
 
+#include <glib/gstdio.h>
 #include <r2i/r2i.h>
 
 #include <cstring>
 #include <memory>
 #include <list>
+#include <map>
+#include <string>
+#include <vector>
 
 GST_DEBUG_CATEGORY_STATIC (gst_base_backend_debug_category);
 #define GST_CAT_DEFAULT gst_base_backend_debug_category
@@ -85,8 +93,158 @@ class InferenceProperty {
   const gchar *get_name() {
     return apspec->name;
   }
+
+  std::string to_string() {
+    gchar *contents = g_strdup_value_contents (avalue);
+    std::string str = std::string (apspec->name) + "=" + contents;
+
+    g_free (contents);
+    return str;
+  }
+};
+
+/* Engines started on the same loaded model. Each prediction takes the
+ * next free engine after the last one taken, so as many predictions as
+ * engines run at once. The first engine is the backend engine */
+class EnginePool {
+ public:
+
+  std::vector<std::shared_ptr<r2i::IEngine>> engines;
+  std::vector<std::shared_ptr<r2i::IParameters>> params;
+
+  EnginePool () {
+    next = 0;
+    g_mutex_init (&mutex);
+    g_cond_init (&cond);
+  }
+
+  ~EnginePool () {
+    g_mutex_clear (&mutex);
+    g_cond_clear (&cond);
+  }
+
+  void add (std::shared_ptr<r2i::IEngine> engine,
+            std::shared_ptr<r2i::IParameters> engine_params) {
+    engines.push_back (engine);
+    params.push_back (engine_params);
+    busy.push_back (FALSE);
+  }
+
+  guint acquire () {
+    guint index, i;
+
+    g_mutex_lock (&mutex);
+    while (TRUE) {
+      for (i = 0; i < engines.size (); i++) {
+        index = (next + i) % engines.size ();
+        if (!busy[index]) {
+          busy[index] = TRUE;
+          next = index + 1;
+          g_mutex_unlock (&mutex);
+          return index;
+        }
+      }
+      g_cond_wait (&cond, &mutex);
+    }
+  }
+
+  void release (guint index) {
+    g_mutex_lock (&mutex);
+    busy[index] = FALSE;
+    g_cond_signal (&cond);
+    g_mutex_unlock (&mutex);
+  }
+
+  /* The first engine is stopped by the backend */
+  void stop (r2i::RuntimeError &error) {
+    r2i::RuntimeError stop_error;
+
+    for (guint i = 1; i < engines.size (); i++) {
+      stop_error = engines[i]->Stop ();
+      if (stop_error.IsError ()) {
+        error = stop_error;
+      }
+    }
+  }
+
+ private:
+
+  std::vector<gboolean> busy;
+  guint next;
+  GMutex mutex;
+  GCond cond;
+};
+
+/* Predictions allowed to run at once on a cached engine, 0 for no
+ * limit. Shared with the results still holding a slot, which may
+ * outlive the engine cache entry */
+class EngineSlots {
+ public:
+
+  EngineSlots (guint limit) {
+    concurrency = limit;
+    running = 0;
+    g_mutex_init (&mutex);
+    g_cond_init (&cond);
+  }
+
+  ~EngineSlots () {
+    g_mutex_clear (&mutex);
+    g_cond_clear (&cond);
+  }
+
+  void enter () {
+    if (0 == concurrency) {
+      return;
+    }
+
+    g_mutex_lock (&mutex);
+    while (running >= concurrency) {
+      g_cond_wait (&cond, &mutex);
+    }
+    running++;
+    g_mutex_unlock (&mutex);
+  }
+
+  void leave () {
+    if (0 == concurrency) {
+      return;
+    }
+
+    g_mutex_lock (&mutex);
+    running--;
+    g_cond_signal (&cond);
+    g_mutex_unlock (&mutex);
+  }
+
+ private:
+
+  guint concurrency;
+  guint running;
+  GMutex mutex;
+  GCond cond;
 };
 
+/* A started engine, shared by every backend that loads the same model
+ * file with the same framework and parameters */
+struct EngineCacheEntry {
+  guint refcount;
+  /* FALSE while the first user is still loading the model */
+  gboolean loaded;
+  std::shared_ptr < r2i::IFrameworkFactory > factory;
+  std::shared_ptr < r2i::IEngine > engine;
+  std::shared_ptr < r2i::ILoader > loader;
+  std::shared_ptr < r2i::IModel > model;
+  std::shared_ptr < r2i::IParameters > params;
+  /* The extra engine instances, NULL for a single one */
+  std::shared_ptr < EnginePool > pool;
+  std::shared_ptr < EngineSlots > slots;
+};
+
+static GMutex engine_cache_mutex;
+static GCond engine_cache_cond;
+static std::map < std::string, EngineCacheEntry * > engine_cache;
+
 typedef struct _GstBaseBackendPrivate GstBaseBackendPrivate;
 struct _GstBaseBackendPrivate {
   r2i::FrameworkCode code;
@@ -94,12 +252,20 @@ struct _GstBaseBackendPrivate {
   std::shared_ptr < r2i::ILoader > loader;
   std::shared_ptr < r2i::IModel > model;
   std::shared_ptr < r2i::IParameters > params;
-  std::unique_ptr < r2i::IFrameworkFactory > factory;
+  std::shared_ptr < r2i::IFrameworkFactory > factory;
   GMutex backend_mutex;
   gboolean backend_started;
   std::shared_ptr < std::list<InferenceProperty *> > property_list;
   gboolean backend_created;
-
+  GstInferenceTensorType tensor_type;
+  GstInferenceTensorInfo tensor_info;
+  /* Reused between batches, only touched by the predicting thread */
+  std::vector<guint8> batch_tensor;
+  gboolean engine_cache;
+  guint engine_concurrency;
+  EngineCacheEntry *cache_entry;
+  guint engine_instances;
+  std::shared_ptr < EnginePool > pool;
 };
 
 G_DEFINE_TYPE_WITH_CODE (GstBaseBackend, gst_base_backend, G_TYPE_OBJECT,
@@ -112,6 +278,84 @@ G_DEFINE_TYPE_WITH_CODE (GstBaseBackend, gst_base_backend, G_TYPE_OBJECT,
 static GParamSpec *gst_base_backend_param_to_spec (r2i::ParameterMeta *param);
 static int gst_base_backend_param_flags (int flags);
 static void gst_base_backend_finalize (GObject *obj);
+static gboolean gst_base_backend_check_frame (GstVideoFrame *input_frame,
+    const GstInferenceTensorInfo *tensor_info, GstInferenceTensorType tensor_type,
+    gboolean raw, r2i::RuntimeError &error);
+static gboolean gst_base_backend_predict (GstBaseBackend *self,
+    GstVideoFrame *input_frame, gboolean raw, GstBuffer **prediction,
+    GError **err);
+static gboolean gst_base_backend_run (GstBaseBackend *self,
+    std::shared_ptr<r2i::IEngine> engine, gpointer data, gint width,
+    gint height, GstVideoFormat format, r2i::DataType::Id data_type,
+    std::vector<std::shared_ptr<r2i::IPrediction>> &predictions,
+    r2i::RuntimeError &error);
+static gboolean gst_base_backend_load (GstBaseBackend *self,
+    const gchar *model_location,
+    std::shared_ptr<r2i::IFrameworkFactory> &factory,
+    std::shared_ptr<r2i::IEngine> &engine, std::shared_ptr<r2i::ILoader> &loader,
+    std::shared_ptr<r2i::IModel> &model,
+    std::shared_ptr<r2i::IParameters> &params,
+    std::vector<r2i::ParameterMeta> &metas, r2i::RuntimeError &error);
+static void gst_base_backend_apply_properties (GstBaseBackend *self,
+    std::shared_ptr<r2i::IParameters> params,
+    std::vector<r2i::ParameterMeta> &metas, gboolean before_start,
+    r2i::RuntimeError &error);
+static std::string gst_base_backend_cache_key (GstBaseBackend *self,
+    const gchar *model_location);
+static gboolean gst_base_backend_cache_acquire (GstBaseBackend *self,
+    const gchar *model_location, r2i::RuntimeError &error);
+static void gst_base_backend_cache_release (GstBaseBackend *self,
+    r2i::RuntimeError &error);
+static gboolean gst_base_backend_cache_detach (GstBaseBackend *self);
+static std::shared_ptr<r2i::IEngine> gst_base_backend_engine_enter (
+  GstBaseBackend *self, std::shared_ptr<EngineSlots> &slots,
+  std::shared_ptr<EnginePool> &pool, guint &instance);
+static void gst_base_backend_engine_leave (std::shared_ptr<EngineSlots>
+    slots, std::shared_ptr<EnginePool> pool, guint instance);
+static gboolean gst_base_backend_holds_engine (GstBaseBackend *self);
+static std::shared_ptr<EnginePool> gst_base_backend_start_instances (
+  GstBaseBackend *self, std::shared_ptr<r2i::IFrameworkFactory> factory,
+  std::shared_ptr<r2i::IModel> model, std::shared_ptr<r2i::IEngine> engine,
+  std::shared_ptr<r2i::IParameters> params,
+  std::vector<r2i::ParameterMeta> &metas, r2i::RuntimeError &error);
+
+/* The outputs of one Predict call, wrapped by the memories of the
+ * prediction buffers. Outputs living in the engine hold its slot until
+ * the last of them is freed, the others left it after Predict */
+class PredictionResults {
+ public:
+
+  std::shared_ptr<r2i::IEngine> engine;
+  std::shared_ptr<EngineSlots> slots;
+  std::shared_ptr<EnginePool> pool;
+  guint instance;
+  gboolean held;
+  std::vector<std::shared_ptr<r2i::IPrediction>> predictions;
+
+  PredictionResults (std::shared_ptr<r2i::IEngine> predict_engine,
+                     std::shared_ptr<EngineSlots> engine_slots,
+                     std::shared_ptr<EnginePool> engines, guint engine_instance,
+                     gboolean hold,
+                     std::vector<std::shared_ptr<r2i::IPrediction>> &outputs) {
+    engine = predict_engine;
+    slots = engine_slots;
+    pool = engines;
+    instance = engine_instance;
+    held = hold;
+    predictions.swap (outputs);
+  }
+
+  ~PredictionResults () {
+    predictions.clear ();
+    if (held) {
+      gst_base_backend_engine_leave (slots, pool, instance);
+    }
+  }
+};
+
+static GstMemory *gst_base_backend_wrap_result (
+    std::shared_ptr<PredictionResults> &results, guint index);
+static void gst_base_backend_results_free (gpointer data);
 
 #define GST_BASE_BACKEND_ERROR gst_base_backend_error_quark()
 
@@ -131,21 +375,37 @@ gst_base_backend_init (GstBaseBackend *self) {
   g_mutex_init(&priv->backend_mutex);
   priv->backend_started = false;
   priv->backend_created = false;
+  priv->tensor_type = GST_INFERENCE_TENSOR_TYPE_FLOAT;
+  memset (&priv->tensor_info, 0, sizeof (priv->tensor_info));
   priv->property_list = std::make_shared<std::list<InferenceProperty *>>();
+  priv->engine_cache = FALSE;
+  priv->engine_concurrency = 1;
+  priv->cache_entry = NULL;
+  priv->engine_instances = 1;
 }
 
 static void
 gst_base_backend_finalize (GObject *obj) {
   GstBaseBackend *self = GST_BASE_BACKEND (obj);
   GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  r2i::RuntimeError error;
+
+  if (priv->cache_entry) {
+    gst_base_backend_cache_release (self, error);
+  }
   g_mutex_clear (&priv->backend_mutex);
 
+  priv->pool = nullptr;
   priv->engine = nullptr;
   priv->loader = nullptr;
   priv->model = nullptr;
   priv->params = nullptr;
   priv->factory = nullptr;
+  for (auto property : *priv->property_list) {
+    delete property;
+  }
   priv-> property_list = nullptr;
+  std::vector<guint8>().swap (priv->batch_tensor);
 
   G_OBJECT_CLASS (gst_base_backend_parent_class)->finalize (obj);
 }
@@ -243,26 +503,57 @@ gst_base_backend_set_property (GObject *object, guint property_id,
   GST_DEBUG_OBJECT (self, "set_property");
 
   g_mutex_lock (&priv->backend_mutex);
+  /* The change would reach every element using the cached engine */
+  if (priv->backend_started && priv->cache_entry
+      && !gst_base_backend_cache_detach (self)) {
+    GST_WARNING_OBJECT (self, "Property %s can not change while other "
+                        "elements share the cached engine", pspec->name);
+    g_mutex_unlock (&priv->backend_mutex);
+    return;
+  }
+
   if (priv->backend_started) {
-    switch (pspec->value_type) {
-      case G_TYPE_STRING:
-        priv->params->Set(pspec->name, g_value_get_string(value));
-        break;
-      case G_TYPE_INT:
-        priv->params->Set(pspec->name, g_value_get_int(value));
-        break;
-      case G_TYPE_DOUBLE:
-        priv->params->Set(pspec->name, g_value_get_double(value));
-        break;
-      default:
-        GST_WARNING_OBJECT (self, "Invalid property type");
-        break;
+    std::vector<std::shared_ptr<r2i::IParameters>> params;
+
+    /* Every engine instance runs with the same parameters */
+    if (priv->pool) {
+      params = priv->pool->params;
+    } else {
+      params.push_back (priv->params);
+    }
+
+    for (auto &instance_params : params) {
+      switch (pspec->value_type) {
+        case G_TYPE_STRING:
+          instance_params->Set(pspec->name, g_value_get_string(value));
+          break;
+        case G_TYPE_INT:
+          instance_params->Set(pspec->name, g_value_get_int(value));
+          break;
+        case G_TYPE_DOUBLE:
+          instance_params->Set(pspec->name, g_value_get_double(value));
+          break;
+        default:
+          GST_WARNING_OBJECT (self, "Invalid property type");
+          break;
+      }
     }
-  } else {
-    property = new InferenceProperty(value, pspec);
-    priv->property_list->push_back(property);
-    GST_INFO_OBJECT (self, "Queueing property: %s\n", pspec->name);
   }
+
+  /* Every property is kept, it is part of the cache key and applied
+   * again to every engine instance each time the backend starts. A
+   * property set again replaces its queued value */
+  for (auto it = priv->property_list->begin ();
+       it != priv->property_list->end (); ++it) {
+    if (!g_strcmp0 ((*it)->get_name (), pspec->name)) {
+      delete *it;
+      priv->property_list->erase (it);
+      break;
+    }
+  }
+  property = new InferenceProperty(value, pspec);
+  priv->property_list->push_back(property);
+  GST_INFO_OBJECT (self, "Queueing property: %s\n", pspec->name);
   g_mutex_unlock (&priv->backend_mutex);
 
 }
@@ -299,102 +590,71 @@ gboolean
 gst_base_backend_start (GstBaseBackend *self, const gchar *model_location,
                    GError **err) {
   GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  GstBaseBackendClass *klass = GST_BASE_BACKEND_GET_CLASS (self);
   r2i::RuntimeError error;
-  InferenceProperty *property;
-  std::list<InferenceProperty *>::iterator property_it;
-  static std::vector<r2i::ParameterMeta> params;
-  static std::vector<r2i::ParameterMeta>::iterator param_it;
+  /* Per call, several elements may start their backends at once */
+  std::vector<r2i::ParameterMeta> params;
 
   g_return_val_if_fail (priv, FALSE);
   g_return_val_if_fail (model_location, FALSE);
   g_return_val_if_fail (err, FALSE);
 
+  if (klass->start) {
+    return klass->start (self, model_location, err);
+  }
 
-  if (!priv->backend_created) {
-    priv->factory = r2i::IFrameworkFactory::MakeFactory (priv->code,
-                    error);
-    if (error.IsError ()) {
-      GST_ERROR_OBJECT (self, "Failed to start the backend library");
-      goto error;
-    }
-
-    priv->engine = priv->factory->MakeEngine (error);
-    if (error.IsError ()) {
-      GST_ERROR_OBJECT (self, "Failed to start the backend engine");
-      goto error;
-    }
-
-    priv->loader = priv->factory->MakeLoader (error);
-    if (error.IsError ()) {
-      GST_ERROR_OBJECT (self, "Failed to start the model loader");
-      goto error;
-    }
-
-    priv->model = priv->loader->Load (model_location, error);
-    if (error.IsError ()) {
-      GST_ERROR_OBJECT (self, "Failed to load model");
-      goto error;
-    }
-
-    error = priv->engine->SetModel (priv->model);
-    if (error.IsError ()) {
-      GST_ERROR_OBJECT (self, "Failed to set model to engine");
+  if (priv->engine_cache) {
+    if (!gst_base_backend_cache_acquire (self, model_location, error)) {
       goto error;
     }
+    g_mutex_lock (&priv->backend_mutex);
+    priv->backend_started = true;
+    g_mutex_unlock (&priv->backend_mutex);
+    return TRUE;
+  }
 
-    priv->params = priv->factory->MakeParameters (error);
-    if (error.IsError ()) {
-      GST_ERROR_OBJECT (self, "Failed to set get parameters for backend");
-      goto error;
-    }
-    error = priv->params->Configure(priv->engine, priv->model);
-    if (error.IsError ()) {
-      GST_ERROR_OBJECT (self, "Failed to configure mode to backend");
+  if (!priv->backend_created) {
+    if (!gst_base_backend_load (self, model_location, priv->factory,
+                                priv->engine, priv->loader, priv->model, priv->params, params,
+                                error)) {
       goto error;
     }
+    priv->backend_created = true;
+  } else {
+    /* Loaded by an earlier start that failed */
     error = priv->params->List (params);
     if (error.IsError ()) {
       GST_ERROR_OBJECT (self, "Failed to list the backend parameters");
       goto error;
     }
-    priv->backend_created = true;
   }
 
   g_mutex_lock (&priv->backend_mutex);
-  for (property_it = priv->property_list->begin();
-       property_it != priv->property_list->end(); ++property_it) {
-    property = *property_it;
-    for (param_it = params.begin(); param_it != params.end(); ++param_it) {
-      if (!g_strcmp0(property->get_name(), param_it->name.c_str())) {
-        if (r2i::ParameterMeta::Flags::WRITE_BEFORE_START & param_it->flags) {
-          property->apply_inference_property(self, priv->params, error);
-          property->~InferenceProperty();
-          priv->property_list->erase(property_it--);
-          if (error.IsError ()) {
-            GST_ERROR_OBJECT (self, "Failed to set backend parameters");
-	    goto start_error;
-          }
-        }
-        break;
-      }
+  /* The queued properties stay, so a later start gives every instance
+   * the same parameters again */
+  if (priv->engine_instances > 1) {
+    priv->pool = gst_base_backend_start_instances (self, priv->factory,
+                 priv->model, priv->engine, priv->params, params, error);
+    if (!priv->pool) {
+      goto start_error;
     }
   }
 
+  gst_base_backend_apply_properties (self, priv->params, params, TRUE, error);
+  if (error.IsError ()) {
+    goto start_error;
+  }
+
   error = priv->engine->Start ();
   if (error.IsError ()) {
     GST_ERROR_OBJECT (self, "Failed to start the backend engine");
     goto start_error;
   }
 
-  while (!priv->property_list->empty()) {
-    property = priv->property_list->front();
-    property->apply_inference_property(self, priv->params, error);
-    property->~InferenceProperty();
-    priv->property_list->pop_front();
-    if (error.IsError ()) {
-      GST_ERROR_OBJECT (self, "Failed to set backend parameters");
-      goto start_error;
-    }
+  gst_base_backend_apply_properties (self, priv->params, params, FALSE, error);
+  if (error.IsError ()) {
+    priv->engine->Stop ();
+    goto start_error;
   }
   priv->backend_started = true;
   g_mutex_unlock (&priv->backend_mutex);
@@ -402,6 +662,12 @@ gst_base_backend_start (GstBaseBackend *self, const gchar *model_location,
   return TRUE;
 
 start_error:
+  if (priv->pool) {
+    r2i::RuntimeError stop_error;
+
+    priv->pool->stop (stop_error);
+    priv->pool = nullptr;
+  }
   g_mutex_unlock (&priv->backend_mutex);
 error:
   g_set_error (err, GST_BASE_BACKEND_ERROR, error.GetCode (),
@@ -413,12 +679,37 @@ error:
 gboolean
 gst_base_backend_stop (GstBaseBackend *self, GError **err) {
   GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  GstBaseBackendClass *klass = GST_BASE_BACKEND_GET_CLASS (self);
   r2i::RuntimeError error;
 
   g_return_val_if_fail (priv, FALSE);
   g_return_val_if_fail (err, FALSE);
 
-  error = priv->engine->Stop ();
+  if (klass->stop) {
+    return klass->stop (self, err);
+  }
+
+  if (priv->cache_entry) {
+    gst_base_backend_cache_release (self, error);
+  } else {
+    error = priv->engine->Stop ();
+    if (priv->pool) {
+      priv->pool->stop (error);
+      priv->pool = nullptr;
+    }
+
+    /* The next start loads the model again, from a location that may
+     * have changed meanwhile */
+    g_mutex_lock (&priv->backend_mutex);
+    priv->backend_started = false;
+    g_mutex_unlock (&priv->backend_mutex);
+    priv->backend_created = false;
+    priv->factory = nullptr;
+    priv->engine = nullptr;
+    priv->loader = nullptr;
+    priv->model = nullptr;
+    priv->params = nullptr;
+  }
   if (error.IsError ()) {
     GST_ERROR_OBJECT (self, "Failed to stop the backend engine");
     goto error;
@@ -432,6 +723,407 @@ error:
   return FALSE;
 }
 
+static gboolean
+gst_base_backend_load (GstBaseBackend *self, const gchar *model_location,
+                       std::shared_ptr<r2i::IFrameworkFactory> &factory,
+                       std::shared_ptr<r2i::IEngine> &engine, std::shared_ptr<r2i::ILoader> &loader,
+                       std::shared_ptr<r2i::IModel> &model,
+                       std::shared_ptr<r2i::IParameters> &params,
+                       std::vector<r2i::ParameterMeta> &metas, r2i::RuntimeError &error) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+
+  factory = r2i::IFrameworkFactory::MakeFactory (priv->code, error);
+  if (error.IsError ()) {
+    GST_ERROR_OBJECT (self, "Failed to start the backend library");
+    return FALSE;
+  }
+
+  engine = factory->MakeEngine (error);
+  if (error.IsError ()) {
+    GST_ERROR_OBJECT (self, "Failed to start the backend engine");
+    return FALSE;
+  }
+
+  loader = factory->MakeLoader (error);
+  if (error.IsError ()) {
+    GST_ERROR_OBJECT (self, "Failed to start the model loader");
+    return FALSE;
+  }
+
+  model = loader->Load (model_location, error);
+  if (error.IsError ()) {
+    GST_ERROR_OBJECT (self, "Failed to load model");
+    return FALSE;
+  }
+
+  error = engine->SetModel (model);
+  if (error.IsError ()) {
+    GST_ERROR_OBJECT (self, "Failed to set model to engine");
+    return FALSE;
+  }
+
+  params = factory->MakeParameters (error);
+  if (error.IsError ()) {
+    GST_ERROR_OBJECT (self, "Failed to set get parameters for backend");
+    return FALSE;
+  }
+  error = params->Configure(engine, model);
+  if (error.IsError ()) {
+    GST_ERROR_OBJECT (self, "Failed to configure mode to backend");
+    return FALSE;
+  }
+  error = params->List (metas);
+  if (error.IsError ()) {
+    GST_ERROR_OBJECT (self, "Failed to list the backend parameters");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Applies the queued properties that go before the engine starts, or
+ * all the others, without consuming them. Called with the backend lock */
+static void
+gst_base_backend_apply_properties (GstBaseBackend *self,
+                                   std::shared_ptr<r2i::IParameters> params,
+                                   std::vector<r2i::ParameterMeta> &metas, gboolean before_start,
+                                   r2i::RuntimeError &error) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  gboolean property_before_start;
+
+  for (auto property : *priv->property_list) {
+    property_before_start = FALSE;
+    for (auto &meta : metas) {
+      if (!g_strcmp0 (property->get_name (), meta.name.c_str ())) {
+        property_before_start = (r2i::ParameterMeta::Flags::WRITE_BEFORE_START &
+                                 meta.flags) ? TRUE : FALSE;
+        break;
+      }
+    }
+
+    if (property_before_start == before_start) {
+      property->apply_inference_property (self, params, error);
+      if (error.IsError ()) {
+        GST_ERROR_OBJECT (self, "Failed to set backend parameters");
+        return;
+      }
+    }
+  }
+}
+
+/* Starts the engines after the backend engine on the same loaded model,
+ * with the queued properties. Called with the backend lock */
+static std::shared_ptr<EnginePool>
+gst_base_backend_start_instances (GstBaseBackend *self,
+                                  std::shared_ptr<r2i::IFrameworkFactory> factory,
+                                  std::shared_ptr<r2i::IModel> model, std::shared_ptr<r2i::IEngine> engine,
+                                  std::shared_ptr<r2i::IParameters> params,
+                                  std::vector<r2i::ParameterMeta> &metas, r2i::RuntimeError &error) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  std::shared_ptr<EnginePool> pool = std::make_shared<EnginePool> ();
+  std::shared_ptr<r2i::IEngine> instance_engine;
+  std::shared_ptr<r2i::IParameters> instance_params;
+  r2i::RuntimeError stop_error;
+  guint i;
+
+  pool->add (engine, params);
+
+  for (i = 1; i < priv->engine_instances; i++) {
+    instance_engine = factory->MakeEngine (error);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to create engine instance %u", i);
+      goto error;
+    }
+
+    error = instance_engine->SetModel (model);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to set model to engine instance %u", i);
+      goto error;
+    }
+
+    instance_params = factory->MakeParameters (error);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to get parameters for engine instance %u",
+                        i);
+      goto error;
+    }
+    error = instance_params->Configure (instance_engine, model);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to configure engine instance %u", i);
+      goto error;
+    }
+
+    gst_base_backend_apply_properties (self, instance_params, metas, TRUE,
+                                       error);
+    if (error.IsError ()) {
+      goto error;
+    }
+
+    error = instance_engine->Start ();
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to start engine instance %u", i);
+      goto error;
+    }
+
+    gst_base_backend_apply_properties (self, instance_params, metas, FALSE,
+                                       error);
+    if (error.IsError ()) {
+      instance_engine->Stop ();
+      goto error;
+    }
+
+    pool->add (instance_engine, instance_params);
+  }
+
+  GST_INFO_OBJECT (self, "Started %u engine instances", priv->engine_instances);
+
+  return pool;
+
+error:
+  pool->stop (stop_error);
+  return nullptr;
+}
+
+static std::string
+gst_base_backend_cache_key (GstBaseBackend *self, const gchar *model_location) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  GStatBuf stat_buf;
+  gint64 mtime = 0;
+  std::string key;
+
+  /* A model file replaced on disk is loaded again */
+  if (0 == g_stat (model_location, &stat_buf)) {
+    mtime = stat_buf.st_mtime;
+  }
+
+  key = std::to_string ((gint) priv->code) + ":" + model_location + ":" +
+        std::to_string (mtime);
+
+  g_mutex_lock (&priv->backend_mutex);
+  key += ":" + std::to_string (priv->engine_instances);
+  for (auto property : *priv->property_list) {
+    key += ":" + property->to_string ();
+  }
+  g_mutex_unlock (&priv->backend_mutex);
+
+  return key;
+}
+
+static gboolean
+gst_base_backend_cache_acquire (GstBaseBackend *self,
+                                const gchar *model_location, r2i::RuntimeError &error) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  std::vector<r2i::ParameterMeta> metas;
+  EngineCacheEntry *entry;
+  std::string key;
+
+  key = gst_base_backend_cache_key (self, model_location);
+
+  /* The first user loads the model outside the cache lock, so different
+   * models load in parallel. Users of the same model wait for it */
+  g_mutex_lock (&engine_cache_mutex);
+  auto it = engine_cache.find (key);
+  while (it != engine_cache.end () && !it->second->loaded) {
+    g_cond_wait (&engine_cache_cond, &engine_cache_mutex);
+    it = engine_cache.find (key);
+  }
+  if (it != engine_cache.end ()) {
+    entry = it->second;
+    entry->refcount++;
+    g_mutex_unlock (&engine_cache_mutex);
+    GST_INFO_OBJECT (self, "Using the cached engine for %s", model_location);
+  } else {
+    entry = new EngineCacheEntry ();
+    entry->refcount = 1;
+    entry->loaded = FALSE;
+    engine_cache[key] = entry;
+    g_mutex_unlock (&engine_cache_mutex);
+
+    if (gst_base_backend_load (self, model_location, entry->factory,
+                               entry->engine, entry->loader, entry->model, entry->params, metas,
+                               error)) {
+      g_mutex_lock (&priv->backend_mutex);
+      if (priv->engine_instances > 1) {
+        entry->pool = gst_base_backend_start_instances (self, entry->factory,
+                      entry->model, entry->engine, entry->params, metas, error);
+      }
+      if (!error.IsError ()) {
+        gst_base_backend_apply_properties (self, entry->params, metas, TRUE,
+                                           error);
+      }
+      if (!error.IsError ()) {
+        error = entry->engine->Start ();
+        if (!error.IsError ()) {
+          gst_base_backend_apply_properties (self, entry->params, metas, FALSE,
+                                             error);
+          if (error.IsError ()) {
+            entry->engine->Stop ();
+          }
+        }
+      }
+      g_mutex_unlock (&priv->backend_mutex);
+      if (error.IsError () && entry->pool) {
+        r2i::RuntimeError stop_error;
+
+        entry->pool->stop (stop_error);
+      }
+    }
+
+    g_mutex_lock (&engine_cache_mutex);
+    if (error.IsError ()) {
+      /* Waiting users retry the load themselves */
+      engine_cache.erase (key);
+      g_cond_broadcast (&engine_cache_cond);
+      g_mutex_unlock (&engine_cache_mutex);
+      delete entry;
+      return FALSE;
+    }
+
+    GST_INFO_OBJECT (self, "Caching the engine for %s", model_location);
+    /* The limit is per engine instance */
+    entry->slots = std::make_shared<EngineSlots> (priv->engine_concurrency *
+                   priv->engine_instances);
+    entry->loaded = TRUE;
+    g_cond_broadcast (&engine_cache_cond);
+    g_mutex_unlock (&engine_cache_mutex);
+  }
+
+  priv->factory = entry->factory;
+  priv->engine = entry->engine;
+  priv->loader = entry->loader;
+  priv->model = entry->model;
+  priv->params = entry->params;
+  priv->pool = entry->pool;
+  priv->cache_entry = entry;
+
+  return TRUE;
+}
+
+/* Takes the cached engine out of the cache if this backend is its only
+ * user, so its parameters may change without reaching a later user of
+ * the same key. Called with the backend lock */
+static gboolean
+gst_base_backend_cache_detach (GstBaseBackend *self) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  EngineCacheEntry *entry = priv->cache_entry;
+  gboolean detached;
+
+  g_mutex_lock (&engine_cache_mutex);
+  detached = 1 == entry->refcount;
+  for (auto it = engine_cache.begin (); detached && it != engine_cache.end ();
+       ++it) {
+    if (it->second == entry) {
+      GST_INFO_OBJECT (self, "Removing the engine from the cache");
+      engine_cache.erase (it);
+      break;
+    }
+  }
+  g_mutex_unlock (&engine_cache_mutex);
+
+  return detached;
+}
+
+static void
+gst_base_backend_cache_release (GstBaseBackend *self,
+                                r2i::RuntimeError &error) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  EngineCacheEntry *entry = priv->cache_entry;
+
+  g_mutex_lock (&priv->backend_mutex);
+  priv->backend_started = false;
+  g_mutex_unlock (&priv->backend_mutex);
+
+  priv->cache_entry = NULL;
+  priv->pool = nullptr;
+  priv->factory = nullptr;
+  priv->engine = nullptr;
+  priv->loader = nullptr;
+  priv->model = nullptr;
+  priv->params = nullptr;
+
+  g_mutex_lock (&engine_cache_mutex);
+  if (--entry->refcount > 0) {
+    g_mutex_unlock (&engine_cache_mutex);
+    return;
+  }
+  for (auto it = engine_cache.begin (); it != engine_cache.end (); ++it) {
+    if (it->second == entry) {
+      engine_cache.erase (it);
+      break;
+    }
+  }
+  g_mutex_unlock (&engine_cache_mutex);
+
+  GST_INFO_OBJECT (self, "Releasing the last user of a cached engine");
+  error = entry->engine->Stop ();
+  if (entry->pool) {
+    entry->pool->stop (error);
+  }
+  delete entry;
+}
+
+/* Takes a slot of the cached engine and the next free engine instance,
+ * returning the engine to predict with */
+static std::shared_ptr<r2i::IEngine>
+gst_base_backend_engine_enter (GstBaseBackend *self,
+                               std::shared_ptr<EngineSlots> &slots, std::shared_ptr<EnginePool> &pool,
+                               guint &instance) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  EngineCacheEntry *entry = priv->cache_entry;
+
+  slots = entry ? entry->slots : nullptr;
+  if (slots) {
+    slots->enter ();
+  }
+
+  pool = priv->pool;
+  if (!pool) {
+    instance = 0;
+    return priv->engine;
+  }
+
+  instance = pool->acquire ();
+  return pool->engines[instance];
+}
+
+/* Leaves what gst_base_backend_engine_enter took, which stays valid
+ * even if the backend was stopped meanwhile */
+static void
+gst_base_backend_engine_leave (std::shared_ptr<EngineSlots> slots,
+                               std::shared_ptr<EnginePool> pool, guint instance) {
+  if (pool) {
+    pool->release (instance);
+  }
+
+  if (slots) {
+    slots->leave ();
+  }
+}
+
+void
+gst_base_backend_set_engine_instances (GstBaseBackend *self,
+                                       guint instances) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  g_return_if_fail (priv);
+  g_return_if_fail (instances > 0);
+
+  g_mutex_lock (&priv->backend_mutex);
+  priv->engine_instances = instances;
+  g_mutex_unlock (&priv->backend_mutex);
+}
+
+void
+gst_base_backend_set_engine_cache (GstBaseBackend *self, gboolean enable,
+                                   guint concurrency) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  g_return_if_fail (priv);
+
+  g_mutex_lock (&priv->backend_mutex);
+  priv->engine_cache = enable;
+  priv->engine_concurrency = concurrency;
+  g_mutex_unlock (&priv->backend_mutex);
+}
+
 static r2i::ImageFormat::Id
 gst_base_backend_cast_format (GstVideoFormat format) {
   r2i::ImageFormat::Id image_format;
@@ -453,90 +1145,488 @@ gst_base_backend_cast_format (GstVideoFormat format) {
   return image_format;
 }
 
+static gboolean
+gst_base_backend_cast_data_type (GstInferenceTensorType tensor_type,
+                                 r2i::DataType::Id &data_type) {
+  switch (tensor_type) {
+    case GST_INFERENCE_TENSOR_TYPE_FLOAT:
+      data_type = r2i::DataType::Id::FLOAT;
+      break;
+    case GST_INFERENCE_TENSOR_TYPE_FP16:
+      data_type = r2i::DataType::Id::HALF;
+      break;
+#ifdef HAVE_R2I_DATATYPE_INT8
+    case GST_INFERENCE_TENSOR_TYPE_INT8:
+      data_type = r2i::DataType::Id::INT8;
+      break;
+#endif
+#ifdef HAVE_R2I_DATATYPE_UINT8
+    case GST_INFERENCE_TENSOR_TYPE_UINT8:
+      data_type = r2i::DataType::Id::UINT8;
+      break;
+#endif
+    default:
+      return FALSE;
+  }
+  return TRUE;
+}
+
+void
+gst_base_backend_set_tensor_type (GstBaseBackend *self,
+                                  GstInferenceTensorType tensor_type) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  g_return_if_fail (priv);
+
+  g_mutex_lock (&priv->backend_mutex);
+  priv->tensor_type = tensor_type;
+  g_mutex_unlock (&priv->backend_mutex);
+}
+
+GstBaseBackendCapabilities
+gst_base_backend_get_capabilities (GstBaseBackend *self) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  g_return_val_if_fail (priv, GST_BASE_BACKEND_CAPABILITY_NONE);
+
+  /* Edge TPU models are quantized end to end, so their engines receive
+   * the 8 bit pixels as they are */
+  switch (priv->code) {
+#ifdef HAVE_R2I_DATATYPE_UINT8
+    case r2i::FrameworkCode::CORAL:
+    case r2i::FrameworkCode::EDGETPU:
+      return GST_BASE_BACKEND_CAPABILITY_RAW_INPUT;
+#endif
+    default:
+      return GST_BASE_BACKEND_CAPABILITY_NONE;
+  }
+}
+
+static gboolean
+gst_base_backend_holds_engine (GstBaseBackend *self) {
+  return (gst_base_backend_get_capabilities (self) &
+          GST_BASE_BACKEND_CAPABILITY_ENGINE_OUTPUTS) ? TRUE : FALSE;
+}
+
+void
+gst_base_backend_set_tensor_info (GstBaseBackend *self,
+                                  const GstInferenceTensorInfo *tensor_info) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  g_return_if_fail (priv);
+  g_return_if_fail (tensor_info);
+
+  g_mutex_lock (&priv->backend_mutex);
+  priv->tensor_info = *tensor_info;
+  g_mutex_unlock (&priv->backend_mutex);
+}
+
+static gboolean
+gst_base_backend_check_frame (GstVideoFrame *input_frame,
+                              const GstInferenceTensorInfo *tensor_info,
+                              GstInferenceTensorType tensor_type, gboolean raw,
+                              r2i::RuntimeError &error) {
+  gint width, height, channels;
+
+  /* Nothing to validate until the tensor is negotiated */
+  if (0 == tensor_info->size) {
+    return TRUE;
+  }
+
+  gst_inference_tensor_info_get_dims (tensor_info, &width, &height, &channels);
+
+  if (width != GST_VIDEO_INFO_WIDTH (&input_frame->info)
+      || height != GST_VIDEO_INFO_HEIGHT (&input_frame->info)
+      || channels != (gint) GST_VIDEO_INFO_N_COMPONENTS (&input_frame->info)) {
+    error.Set (r2i::RuntimeError::Code::WRONG_API_USAGE,
+               "Frame of " + std::to_string (GST_VIDEO_INFO_WIDTH (&input_frame->info))
+               + "x" + std::to_string (GST_VIDEO_INFO_HEIGHT (&input_frame->info))
+               + " does not match the negotiated tensor of "
+               + std::to_string (width) + "x" + std::to_string (height) + "x"
+               + std::to_string (channels));
+    return FALSE;
+  }
+
+  /* Raw frames are the input buffer itself, already checked by the caps */
+  if (raw) {
+    return TRUE;
+  }
+
+  if (tensor_type != tensor_info->type) {
+    error.Set (r2i::RuntimeError::Code::WRONG_API_USAGE,
+               "Tensor type changed after the tensor was negotiated");
+    return FALSE;
+  }
+
+  if (input_frame->map[0].size < tensor_info->size) {
+    error.Set (r2i::RuntimeError::Code::WRONG_API_USAGE,
+               "Tensor buffer of " + std::to_string (input_frame->map[0].size)
+               + " bytes is smaller than the " + std::to_string (tensor_info->size)
+               + " bytes expected");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
 gboolean
 gst_base_backend_process_frame (GstBaseBackend *self, GstVideoFrame *input_frame,
-                           gpointer *prediction_data, gsize *prediction_size, GError **err) {
+                           GstBuffer **prediction, GError **err) {
+  GstBaseBackendClass *klass = GST_BASE_BACKEND_GET_CLASS (self);
+
+  if (klass->process_frame) {
+    return klass->process_frame (self, input_frame, prediction, err);
+  }
+
+  return gst_base_backend_predict (self, input_frame, FALSE, prediction, err);
+}
+
+gboolean
+gst_base_backend_process_raw_frame (GstBaseBackend *self,
+                                    GstVideoFrame *input_frame, GstBuffer **prediction, GError **err) {
+  g_return_val_if_fail (self, FALSE);
+  g_return_val_if_fail (gst_base_backend_get_capabilities (self) &
+                        GST_BASE_BACKEND_CAPABILITY_RAW_INPUT, FALSE);
+
+  return gst_base_backend_predict (self, input_frame, TRUE, prediction, err);
+}
+
+static void
+gst_base_backend_results_free (gpointer data) {
+  delete static_cast<std::shared_ptr<PredictionResults> *> (data);
+}
+
+static GstMemory *
+gst_base_backend_wrap_result (std::shared_ptr<PredictionResults> &results,
+                              guint index) {
+  std::shared_ptr<r2i::IPrediction> output = results->predictions[index];
+  gsize size = output->GetResultSize ();
+
+  /* Every memory keeps its own reference to the results */
+  return gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+                                 output->GetResultData (), size, 0, size,
+                                 new std::shared_ptr<PredictionResults> (results),
+                                 gst_base_backend_results_free);
+}
+
+static gboolean
+gst_base_backend_predict (GstBaseBackend *self, GstVideoFrame *input_frame,
+                          gboolean raw, GstBuffer **prediction, GError **err) {
   GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
   std::vector<std::shared_ptr<r2i::IPrediction>> predictions;
-  std::shared_ptr < r2i::IFrame > frame;
+  std::shared_ptr<PredictionResults> results;
+  std::shared_ptr<r2i::IEngine> engine;
+  std::shared_ptr<EngineSlots> slots;
+  std::shared_ptr<EnginePool> pool;
   r2i::RuntimeError error;
-  gint num_outputs = 0;
-  gsize extra_size = 0;
-  gpointer data = NULL;
-  gpointer data_offset = 0;
-  gsize size = 0;
-  gint i = 0;
+  r2i::DataType::Id data_type = r2i::DataType::Id::FLOAT;
+  GstInferenceTensorType tensor_type;
+  GstInferenceTensorInfo tensor_info;
+  gboolean ret, hold;
+  guint instance = 0;
+  guint i = 0;
 
   g_return_val_if_fail (priv, FALSE);
   g_return_val_if_fail (input_frame, FALSE);
-  g_return_val_if_fail (prediction_data, FALSE);
-  g_return_val_if_fail (prediction_size, FALSE);
+  g_return_val_if_fail (prediction, FALSE);
   g_return_val_if_fail (err, FALSE);
 
-  frame = priv->factory->MakeFrame (error);
-  if (error.IsError ()) {
+  g_mutex_lock (&priv->backend_mutex);
+  tensor_type = priv->tensor_type;
+  tensor_info = priv->tensor_info;
+  g_mutex_unlock (&priv->backend_mutex);
+
+  if (!gst_base_backend_check_frame (input_frame, &tensor_info, tensor_type,
+                                     raw, error)) {
+    goto error;
+  }
+
+  /* Raw frames are handed over as 8 bit pixels */
+  if (raw) {
+    tensor_type = GST_INFERENCE_TENSOR_TYPE_UINT8;
+  }
+
+  if (!gst_base_backend_cast_data_type (tensor_type, data_type)) {
+    error.Set (r2i::RuntimeError::Code::WRONG_API_USAGE,
+               "The installed R2Inference does not support this tensor type");
     goto error;
   }
 
   GST_LOG_OBJECT (self, "Processing Frame of size %d x %d",
                   input_frame->info.width, input_frame->info.height);
 
-  error =
-    frame->Configure (input_frame->data[0], input_frame->info.width,
-                      input_frame->info.height,
-                      gst_base_backend_cast_format(input_frame->info.finfo->format),
-                      r2i::DataType::Id::FLOAT);
-  if (error.IsError ()) {
+  engine = gst_base_backend_engine_enter (self, slots, pool, instance);
+  ret = gst_base_backend_run (self, engine, input_frame->data[0],
+                              input_frame->info.width, input_frame->info.height,
+                              input_frame->info.finfo->format, data_type, predictions, error);
+  /* Only results living in the engine keep it until they are freed */
+  hold = ret && gst_base_backend_holds_engine (self);
+  if (!hold) {
+    gst_base_backend_engine_leave (slots, pool, instance);
+  }
+  if (!ret) {
     goto error;
   }
 
-  error = priv->engine->Predict (frame, predictions);
+  /* One memory per output tensor, wrapping the results in place */
+  results = std::make_shared<PredictionResults> (engine, slots, pool,
+            instance, hold, predictions);
+  *prediction = gst_buffer_new ();
+  for (i = 0; i < results->predictions.size (); i++) {
+    gst_buffer_append_memory (*prediction,
+                              gst_base_backend_wrap_result (results, i));
+  }
+
+  GST_LOG_OBJECT (self, "Prediction %p has %u outputs of %" G_GSIZE_FORMAT
+                  " bytes", *prediction, gst_buffer_n_memory (*prediction),
+                  gst_buffer_get_size (*prediction));
+
+  return TRUE;
+error:
+  g_set_error (err, GST_BASE_BACKEND_ERROR, error.GetCode (),
+               "R2Inference Error: (Code:%d) %s", error.GetCode (),
+               error.GetDescription ().c_str ());
+  return FALSE;
+}
+
+static gboolean
+gst_base_backend_run (GstBaseBackend *self,
+                      std::shared_ptr<r2i::IEngine> engine, gpointer data, gint width,
+                      gint height, GstVideoFormat format, r2i::DataType::Id data_type,
+                      std::vector<std::shared_ptr<r2i::IPrediction>> &predictions,
+                      r2i::RuntimeError &error) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  std::shared_ptr < r2i::IFrame > frame;
+
+  frame = priv->factory->MakeFrame (error);
+  if (error.IsError ()) {
+    return FALSE;
+  }
+
+  error = frame->Configure (data, width, height,
+                            gst_base_backend_cast_format (format), data_type);
+  if (error.IsError ()) {
+    return FALSE;
+  }
+
+  error = engine->Predict (frame, predictions);
 
   /* We verify it the error is not implemented to keep compatibility with
    backends that do not support multiple predictions */
   if (r2i::RuntimeError::Code::NOT_IMPLEMENTED == error.GetCode()) {
     std::shared_ptr < r2i::IPrediction > prediction;
 
-    prediction = priv->engine->Predict (frame, error);
+    prediction = engine->Predict (frame, error);
     predictions.push_back(prediction);
   }
 
   if (error.IsError ()) {
-    goto error;
+    return FALSE;
   }
 
-  num_outputs = predictions.size();
-  GST_LOG_OBJECT (self, "Got %d predictions", num_outputs);
+  GST_LOG_OBJECT (self, "Got %zu predictions", predictions.size ());
 
-  if (0 == num_outputs) {
+  if (predictions.empty ()) {
     error.Set (r2i::RuntimeError::Code::WRONG_ENGINE_STATE,
                "Engine got 0 predictions");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+gboolean
+gst_base_backend_process_batch (GstBaseBackend *self, GstVideoFrame *frames,
+                                guint batch_size, GstBuffer **predictions_out, GError **err) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  std::vector<std::shared_ptr<r2i::IPrediction>> predictions;
+  std::shared_ptr<PredictionResults> results;
+  std::shared_ptr<r2i::IEngine> engine;
+  std::shared_ptr<EngineSlots> slots;
+  std::shared_ptr<EnginePool> pool;
+  r2i::RuntimeError error;
+  r2i::DataType::Id data_type = r2i::DataType::Id::FLOAT;
+  GstInferenceTensorType tensor_type;
+  GstInferenceTensorInfo tensor_info;
+  gboolean ret, hold;
+  GstMemory *result;
+  guint instance = 0;
+  gsize frame_size, result_size, chunk_size;
+  guint i, j;
+
+  g_return_val_if_fail (priv, FALSE);
+  g_return_val_if_fail (frames, FALSE);
+  g_return_val_if_fail (batch_size > 0, FALSE);
+  g_return_val_if_fail (predictions_out, FALSE);
+  g_return_val_if_fail (err, FALSE);
+
+  for (j = 0; j < batch_size; j++) {
+    predictions_out[j] = NULL;
+  }
+
+  if (1 == batch_size) {
+    return gst_base_backend_predict (self, &frames[0], FALSE,
+                                     &predictions_out[0], err);
+  }
+
+  /* Any engine accepts a taller frame, only a batch model splits it */
+  if (!(gst_base_backend_get_capabilities (self) &
+        GST_BASE_BACKEND_CAPABILITY_BATCH)) {
+    error.Set (r2i::RuntimeError::Code::WRONG_API_USAGE,
+               "The backend can not predict batches");
     goto error;
   }
 
-  /* Concatenate all the outputs in a 1D array */
-  for (i = 0; i < num_outputs; i++) {
-    /* Compute the size including the new tensor and reallocate memory */
-    extra_size = predictions[i]->GetResultSize ();
-    data = g_realloc (data, size + extra_size);
+  g_mutex_lock (&priv->backend_mutex);
+  tensor_type = priv->tensor_type;
+  tensor_info = priv->tensor_info;
+  g_mutex_unlock (&priv->backend_mutex);
+
+  frame_size = GST_VIDEO_INFO_SIZE (&frames[0].info);
+  for (j = 0; j < batch_size; j++) {
+    if (!gst_base_backend_check_frame (&frames[j], &tensor_info, tensor_type,
+                                       FALSE, error)) {
+      goto error;
+    }
+    if (GST_VIDEO_INFO_SIZE (&frames[j].info) != frame_size
+        || GST_VIDEO_INFO_WIDTH (&frames[j].info) !=
+        GST_VIDEO_INFO_WIDTH (&frames[0].info)) {
+      error.Set (r2i::RuntimeError::Code::WRONG_API_USAGE,
+                 "All the frames of a batch must have the same tensor size");
+      goto error;
+    }
+  }
+
+  if (!gst_base_backend_cast_data_type (tensor_type, data_type)) {
+    error.Set (r2i::RuntimeError::Code::WRONG_API_USAGE,
+               "The installed R2Inference does not support this tensor type");
+    goto error;
+  }
 
-    /* Compute the offset to concatenate the new tensor */
-    data_offset = (void *) ((gsize) data + size);
-    /* Could we avoid memory copy ?*/
-    memcpy (data_offset, predictions[i]->GetResultData (), extra_size);
-    size += extra_size;
+  /* Stacking the tensors one after the other gives the NHWC (or NCHW)
+   * batch, with the batch as the outermost dimension. R2Inference frames
+   * have no batch dimension, so the batch goes as a frame batch_size
+   * times taller, which the model must accept as its batch */
+  priv->batch_tensor.resize (frame_size * batch_size);
+  for (j = 0; j < batch_size; j++) {
+    memcpy (priv->batch_tensor.data () + j * frame_size, frames[j].data[0],
+            frame_size);
   }
 
-  *prediction_size = size;
-  *prediction_data = data;
+  GST_LOG_OBJECT (self, "Processing a batch of %u frames of size %d x %d",
+                  batch_size, frames[0].info.width, frames[0].info.height);
 
-  GST_LOG_OBJECT (self, "Size of prediction %p is %lu",
-                  *prediction_data, *prediction_size);
+  engine = gst_base_backend_engine_enter (self, slots, pool, instance);
+  ret = gst_base_backend_run (self, engine, priv->batch_tensor.data (),
+                              frames[0].info.width, frames[0].info.height * batch_size,
+                              frames[0].info.finfo->format, data_type, predictions, error);
+  hold = ret && gst_base_backend_holds_engine (self);
+  if (!hold) {
+    gst_base_backend_engine_leave (slots, pool, instance);
+  }
+  if (!ret) {
+    goto error;
+  }
 
-  frame = nullptr;
-  predictions.clear();
+  for (i = 0; i < predictions.size (); i++) {
+    result_size = predictions[i]->GetResultSize ();
+    if (0 != result_size % batch_size) {
+      error.Set (r2i::RuntimeError::Code::WRONG_ENGINE_STATE,
+                 "Output of " + std::to_string (result_size)
+                 + " bytes can not be split among " + std::to_string (batch_size)
+                 + " frames");
+      if (hold) {
+        gst_base_backend_engine_leave (slots, pool, instance);
+      }
+      goto error;
+    }
+  }
+
+  /* Every output holds the results of the whole batch, each frame gets
+   * a memory per output sharing its part of the results */
+  results = std::make_shared<PredictionResults> (engine, slots, pool,
+            instance, hold, predictions);
+  for (j = 0; j < batch_size; j++) {
+    predictions_out[j] = gst_buffer_new ();
+  }
+  for (i = 0; i < results->predictions.size (); i++) {
+    result = gst_base_backend_wrap_result (results, i);
+    chunk_size = gst_memory_get_sizes (result, NULL, NULL) / batch_size;
+    for (j = 0; j < batch_size; j++) {
+      gst_buffer_append_memory (predictions_out[j],
+                                gst_memory_share (result, j * chunk_size, chunk_size));
+    }
+    gst_memory_unref (result);
+  }
 
   return TRUE;
+
+error:
+  g_set_error (err, GST_BASE_BACKEND_ERROR, error.GetCode (),
+               "R2Inference Error: (Code:%d) %s", error.GetCode (),
+               error.GetDescription ().c_str ());
+  return FALSE;
+}
+
+gboolean
+gst_base_backend_warm_up (GstBaseBackend *self,
+                          const GstInferenceTensorInfo *tensor_info, guint inferences,
+                          GstClockTime *first, GstClockTime *total, GError **err) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  std::vector<std::shared_ptr<r2i::IPrediction>> predictions;
+  std::shared_ptr<r2i::IEngine> engine;
+  std::shared_ptr<EngineSlots> slots;
+  std::shared_ptr<EnginePool> pool;
+  std::vector<guint8> tensor;
+  r2i::RuntimeError error;
+  r2i::DataType::Id data_type = r2i::DataType::Id::FLOAT;
+  GstClockTime elapsed;
+  gint width, height;
+  gint64 start;
+  gboolean ret;
+  guint instance = 0;
+  guint i;
+
+  g_return_val_if_fail (priv, FALSE);
+  g_return_val_if_fail (tensor_info, FALSE);
+  g_return_val_if_fail (tensor_info->size > 0, FALSE);
+  g_return_val_if_fail (first, FALSE);
+  g_return_val_if_fail (total, FALSE);
+  g_return_val_if_fail (err, FALSE);
+
+  *first = 0;
+  *total = 0;
+
+  if (!gst_base_backend_cast_data_type (tensor_info->type, data_type)) {
+    error.Set (r2i::RuntimeError::Code::WRONG_API_USAGE,
+               "The installed R2Inference does not support this tensor type");
+    goto error;
+  }
+
+  /* Zeros are a valid input for every tensor type */
+  tensor.resize (tensor_info->size);
+  gst_inference_tensor_info_get_dims (tensor_info, &width, &height, NULL);
+
+  /* Consecutive inferences go round robin over the engine instances */
+  for (i = 0; i < inferences; i++) {
+    start = g_get_monotonic_time ();
+    engine = gst_base_backend_engine_enter (self, slots, pool, instance);
+    ret = gst_base_backend_run (self, engine, tensor.data (), width, height,
+                                tensor_info->format, data_type, predictions, error);
+    predictions.clear ();
+    gst_base_backend_engine_leave (slots, pool, instance);
+    if (!ret) {
+      goto error;
+    }
+
+    elapsed = (g_get_monotonic_time () - start) * GST_USECOND;
+    GST_DEBUG_OBJECT (self, "Warm up inference %u took %" GST_TIME_FORMAT, i,
+                      GST_TIME_ARGS (elapsed));
+    if (0 == i) {
+      *first = elapsed;
+    }
+    *total += elapsed;
+  }
+
+  return TRUE;
+
 error:
   g_set_error (err, GST_BASE_BACKEND_ERROR, error.GetCode (),
                "R2Inference Error: (Code:%d) %s", error.GetCode (),
@@ -562,6 +1652,16 @@ gst_base_backend_get_framework_code (GstBaseBackend *backend) {
   return priv->code;
 }
 
+/* Identifies the engines a start would load, the same as the engine
+ * cache does */
+gchar *
+gst_base_backend_get_key (GstBaseBackend *self, const gchar *model_location) {
+  g_return_val_if_fail (self, NULL);
+  g_return_val_if_fail (model_location, NULL);
+
+  return g_strdup (gst_base_backend_cache_key (self, model_location).c_str ());
+}
+
 GQuark
 gst_base_backend_error_quark(void) {
   static GQuark q = 0;
@@ -25,6 +25,8 @@
 #include <gst/gst.h>
 #include <gst/video/video.h>
 
+#include "gstinferencepreprocess.h"
+
 G_BEGIN_DECLS
 #define GST_TYPE_BASE_BACKEND gst_base_backend_get_type ()
 G_DECLARE_DERIVABLE_TYPE (GstBaseBackend, gst_base_backend, GST, BASE_BACKEND, GObject);
@@ -33,14 +35,55 @@ struct _GstBaseBackendClass
 {
   GObjectClass parent_class;
 
+  /* Optional, for backends that don't run an R2Inference engine */
+  gboolean (*start) (GstBaseBackend *self, const gchar *model_location,
+                     GError **err);
+  gboolean (*stop) (GstBaseBackend *self, GError **err);
+  gboolean (*process_frame) (GstBaseBackend *self, GstVideoFrame *frame,
+                             GstBuffer **prediction, GError **err);
 };
 
+/**
+ * GstBaseBackendCapabilities:
+ * @GST_BASE_BACKEND_CAPABILITY_NONE: No optional capabilities
+ * @GST_BASE_BACKEND_CAPABILITY_RAW_INPUT: The backend accepts packed
+ * 8 bit RGB, BGR or GRAY8 frames and normalizes them in the model
+ * @GST_BASE_BACKEND_CAPABILITY_ENGINE_OUTPUTS: The prediction outputs
+ * live in the engine until its next prediction, so a prediction keeps
+ * its engine busy until freed
+ * @GST_BASE_BACKEND_CAPABILITY_BATCH: The engine takes a batch of frames
+ * stacked along the outermost tensor dimension and returns one output
+ * per frame
+ */
+typedef enum
+{
+  GST_BASE_BACKEND_CAPABILITY_NONE = 0,
+  GST_BASE_BACKEND_CAPABILITY_RAW_INPUT = 1 << 0,
+  GST_BASE_BACKEND_CAPABILITY_ENGINE_OUTPUTS = 1 << 1,
+  GST_BASE_BACKEND_CAPABILITY_BATCH = 1 << 2,
+} GstBaseBackendCapabilities;
+
 GQuark gst_base_backend_error_quark (void);
 gboolean gst_base_backend_start (GstBaseBackend *, const gchar *, GError **);
 gboolean gst_base_backend_stop (GstBaseBackend *, GError **);
 guint gst_base_backend_get_framework_code (GstBaseBackend *);
+gchar *gst_base_backend_get_key (GstBaseBackend *, const gchar *);
+void gst_base_backend_set_engine_cache (GstBaseBackend *, gboolean, guint);
+void gst_base_backend_set_engine_instances (GstBaseBackend *, guint);
+void gst_base_backend_set_tensor_type (GstBaseBackend *,
+                                       GstInferenceTensorType);
+void gst_base_backend_set_tensor_info (GstBaseBackend *,
+                                       const GstInferenceTensorInfo *);
+GstBaseBackendCapabilities gst_base_backend_get_capabilities (GstBaseBackend *);
 gboolean gst_base_backend_process_frame (GstBaseBackend *, GstVideoFrame *,
-                                    gpointer *, gsize *, GError **);
+                                    GstBuffer **, GError **);
+gboolean gst_base_backend_process_raw_frame (GstBaseBackend *, GstVideoFrame *,
+                                    GstBuffer **, GError **);
+gboolean gst_base_backend_process_batch (GstBaseBackend *, GstVideoFrame *,
+                                    guint, GstBuffer **, GError **);
+gboolean gst_base_backend_warm_up (GstBaseBackend *,
+                                   const GstInferenceTensorInfo *, guint, GstClockTime *,
+                                   GstClockTime *, GError **);
 
 G_END_DECLS
 #endif //__GST_BASE_BACKEND_H__
@@ -0,0 +1,320 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "gstinferencebatch.h"
+
+struct _GstInferenceBatch
+{
+  GThread *thread;
+  GstInferenceBatchFunc func;
+  GstInferenceBatchDropFunc drop;
+  gpointer user_data;
+  guint size;
+  guint64 timeout;
+
+  GMutex mutex;
+  GCond cond;
+  /* The batch being collected and the one being processed, swapped
+   * every time the thread takes a batch */
+  GPtrArray *pending;
+  GPtrArray *running;
+  /* The owner of every item, in the same order */
+  GPtrArray *pending_owners;
+  GPtrArray *running_owners;
+  gint64 deadline;
+  gboolean barrier;
+  gboolean busy;
+  guint draining;
+  gboolean flushing;
+  gboolean quit;
+};
+
+static gpointer gst_inference_batch_loop (gpointer data);
+static gboolean gst_inference_batch_is_ready (GstInferenceBatch * batch);
+static void gst_inference_batch_clear (GstInferenceBatch * batch);
+static gboolean gst_inference_batch_has_owner (GPtrArray * owners,
+    gpointer owner);
+
+static gboolean
+gst_inference_batch_is_ready (GstInferenceBatch * batch)
+{
+  if (0 == batch->pending->len) {
+    return FALSE;
+  }
+
+  return batch->barrier || batch->pending->len >= batch->size
+      || batch->draining > 0 || 0 == batch->timeout
+      || g_get_monotonic_time () >= batch->deadline;
+}
+
+static void
+gst_inference_batch_clear (GstInferenceBatch * batch)
+{
+  guint i;
+
+  for (i = 0; i < batch->pending->len; ++i) {
+    batch->drop (g_ptr_array_index (batch->pending, i), batch->user_data);
+  }
+  g_ptr_array_set_size (batch->pending, 0);
+  g_ptr_array_set_size (batch->pending_owners, 0);
+  batch->barrier = FALSE;
+}
+
+static gboolean
+gst_inference_batch_has_owner (GPtrArray * owners, gpointer owner)
+{
+  guint i;
+
+  for (i = 0; i < owners->len; ++i) {
+    if (g_ptr_array_index (owners, i) == owner) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+static gpointer
+gst_inference_batch_loop (gpointer data)
+{
+  GstInferenceBatch *batch = (GstInferenceBatch *) data;
+  GPtrArray *items;
+  GPtrArray *owners;
+
+  g_mutex_lock (&batch->mutex);
+  while (!batch->quit) {
+    if (0 == batch->pending->len) {
+      g_cond_wait (&batch->cond, &batch->mutex);
+      continue;
+    }
+
+    if (!gst_inference_batch_is_ready (batch)) {
+      g_cond_wait_until (&batch->cond, &batch->mutex, batch->deadline);
+      continue;
+    }
+
+    items = batch->pending;
+    batch->pending = batch->running;
+    batch->running = items;
+    owners = batch->pending_owners;
+    batch->pending_owners = batch->running_owners;
+    batch->running_owners = owners;
+    batch->barrier = FALSE;
+    batch->busy = TRUE;
+    /* Room for the next batch */
+    g_cond_broadcast (&batch->cond);
+    g_mutex_unlock (&batch->mutex);
+
+    batch->func (items->pdata, items->len, batch->user_data);
+
+    g_mutex_lock (&batch->mutex);
+    g_ptr_array_set_size (items, 0);
+    g_ptr_array_set_size (owners, 0);
+    batch->busy = FALSE;
+    g_cond_broadcast (&batch->cond);
+  }
+  g_mutex_unlock (&batch->mutex);
+
+  return NULL;
+}
+
+GstInferenceBatch *
+gst_inference_batch_new (const gchar * name, guint size, guint64 timeout,
+    GstInferenceBatchFunc func, GstInferenceBatchDropFunc drop,
+    gpointer user_data)
+{
+  GstInferenceBatch *batch;
+
+  g_return_val_if_fail (name, NULL);
+  g_return_val_if_fail (size > 0, NULL);
+  g_return_val_if_fail (func, NULL);
+  g_return_val_if_fail (drop, NULL);
+
+  batch = g_new0 (GstInferenceBatch, 1);
+  batch->func = func;
+  batch->drop = drop;
+  batch->user_data = user_data;
+  batch->size = size;
+  batch->timeout = timeout;
+  batch->pending = g_ptr_array_sized_new (size);
+  batch->running = g_ptr_array_sized_new (size);
+  batch->pending_owners = g_ptr_array_sized_new (size);
+  batch->running_owners = g_ptr_array_sized_new (size);
+  g_mutex_init (&batch->mutex);
+  g_cond_init (&batch->cond);
+
+  batch->thread = g_thread_new (name, gst_inference_batch_loop, batch);
+
+  return batch;
+}
+
+void
+gst_inference_batch_free (GstInferenceBatch * batch)
+{
+  g_return_if_fail (batch);
+
+  g_mutex_lock (&batch->mutex);
+  batch->quit = TRUE;
+  g_cond_broadcast (&batch->cond);
+  g_mutex_unlock (&batch->mutex);
+
+  g_thread_join (batch->thread);
+
+  gst_inference_batch_clear (batch);
+  g_ptr_array_free (batch->pending, TRUE);
+  g_ptr_array_free (batch->running, TRUE);
+  g_ptr_array_free (batch->pending_owners, TRUE);
+  g_ptr_array_free (batch->running_owners, TRUE);
+  g_mutex_clear (&batch->mutex);
+  g_cond_clear (&batch->cond);
+  g_free (batch);
+}
+
+gboolean
+gst_inference_batch_push (GstInferenceBatch * batch, gpointer item,
+    gboolean barrier)
+{
+  return gst_inference_batch_push_owned (batch, item, NULL, barrier);
+}
+
+gboolean
+gst_inference_batch_push_owned (GstInferenceBatch * batch, gpointer item,
+    gpointer owner, gboolean barrier)
+{
+  g_return_val_if_fail (batch, FALSE);
+  g_return_val_if_fail (item, FALSE);
+
+  g_mutex_lock (&batch->mutex);
+  /* A barrier closes the batch being collected and waits for the thread
+   * to take it, other items wait for one neither full nor closed */
+  if (barrier && batch->pending->len > 0) {
+    batch->barrier = TRUE;
+    g_cond_broadcast (&batch->cond);
+  }
+  while (!batch->flushing && !batch->quit && (batch->barrier
+          || batch->pending->len >= batch->size
+          || (barrier && batch->pending->len > 0))) {
+    g_cond_wait (&batch->cond, &batch->mutex);
+  }
+
+  if (batch->flushing || batch->quit) {
+    g_mutex_unlock (&batch->mutex);
+    return FALSE;
+  }
+
+  if (0 == batch->pending->len) {
+    batch->deadline = g_get_monotonic_time () + batch->timeout;
+  }
+  g_ptr_array_add (batch->pending, item);
+  g_ptr_array_add (batch->pending_owners, owner);
+  batch->barrier = barrier;
+  g_cond_broadcast (&batch->cond);
+  g_mutex_unlock (&batch->mutex);
+
+  return TRUE;
+}
+
+void
+gst_inference_batch_set_flushing (GstInferenceBatch * batch,
+    gboolean flushing)
+{
+  g_return_if_fail (batch);
+
+  g_mutex_lock (&batch->mutex);
+  if (flushing) {
+    batch->flushing = TRUE;
+    gst_inference_batch_clear (batch);
+  } else {
+    while (batch->busy) {
+      g_cond_wait (&batch->cond, &batch->mutex);
+    }
+    batch->flushing = FALSE;
+  }
+  g_cond_broadcast (&batch->cond);
+  g_mutex_unlock (&batch->mutex);
+}
+
+void
+gst_inference_batch_drain (GstInferenceBatch * batch)
+{
+  g_return_if_fail (batch);
+
+  g_mutex_lock (&batch->mutex);
+  batch->draining++;
+  g_cond_broadcast (&batch->cond);
+  while (!batch->flushing && (batch->busy || batch->pending->len > 0)) {
+    g_cond_wait (&batch->cond, &batch->mutex);
+  }
+  batch->draining--;
+  g_mutex_unlock (&batch->mutex);
+}
+
+void
+gst_inference_batch_flush_owner (GstInferenceBatch * batch, gpointer owner)
+{
+  guint i, kept = 0;
+
+  g_return_if_fail (batch);
+
+  g_mutex_lock (&batch->mutex);
+  for (i = 0; i < batch->pending->len; ++i) {
+    if (g_ptr_array_index (batch->pending_owners, i) == owner) {
+      batch->drop (g_ptr_array_index (batch->pending, i), batch->user_data);
+      continue;
+    }
+    g_ptr_array_index (batch->pending, kept) =
+        g_ptr_array_index (batch->pending, i);
+    g_ptr_array_index (batch->pending_owners, kept) =
+        g_ptr_array_index (batch->pending_owners, i);
+    kept++;
+  }
+  g_ptr_array_set_size (batch->pending, kept);
+  g_ptr_array_set_size (batch->pending_owners, kept);
+  if (0 == kept) {
+    batch->barrier = FALSE;
+  }
+  g_cond_broadcast (&batch->cond);
+
+  while (batch->busy
+      && gst_inference_batch_has_owner (batch->running_owners, owner)) {
+    g_cond_wait (&batch->cond, &batch->mutex);
+  }
+  g_mutex_unlock (&batch->mutex);
+}
+
+void
+gst_inference_batch_drain_owner (GstInferenceBatch * batch, gpointer owner)
+{
+  g_return_if_fail (batch);
+
+  g_mutex_lock (&batch->mutex);
+  batch->draining++;
+  g_cond_broadcast (&batch->cond);
+  while (!batch->flushing
+      && (gst_inference_batch_has_owner (batch->pending_owners, owner)
+          || (batch->busy
+              && gst_inference_batch_has_owner (batch->running_owners,
+                  owner)))) {
+    g_cond_wait (&batch->cond, &batch->mutex);
+  }
+  batch->draining--;
+  g_mutex_unlock (&batch->mutex);
+}
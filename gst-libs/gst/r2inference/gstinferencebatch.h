@@ -0,0 +1,149 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef __GST_INFERENCE_BATCH_H__
+#define __GST_INFERENCE_BATCH_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstInferenceBatch GstInferenceBatch;
+
+/**
+ * \brief Function called from the batch thread for every batch
+ *
+ * \param items The items of the batch, in the order they were pushed,
+ * owned by the function
+ * \param n_items The amount of items in the batch
+ * \param user_data The data passed to gst_inference_batch_new
+ */
+typedef void (*GstInferenceBatchFunc) (gpointer * items, guint n_items,
+    gpointer user_data);
+
+/**
+ * \brief Function releasing an item dropped while flushing
+ *
+ * \param item The item to release
+ * \param user_data The data passed to gst_inference_batch_new
+ */
+typedef void (*GstInferenceBatchDropFunc) (gpointer item, gpointer user_data);
+
+/**
+ * \brief Create a thread processing the pushed items in batches
+ *
+ * A batch is processed once it holds size items, or once its first
+ * item waited for timeout. With a timeout of 0 the thread takes
+ * whatever was pushed while it was busy, so batches only grow under
+ * load.
+ *
+ * \param name The name of the thread
+ * \param size The maximum amount of items per batch
+ * \param timeout The time in microseconds a partial batch waits for
+ * more items
+ * \param func The function processing each batch
+ * \param drop The function releasing the items dropped while flushing
+ * \param user_data The data passed to func and drop
+ */
+GstInferenceBatch *gst_inference_batch_new (const gchar * name, guint size,
+    guint64 timeout, GstInferenceBatchFunc func, GstInferenceBatchDropFunc drop,
+    gpointer user_data);
+
+/**
+ * \brief Stop the batch thread, drop the pending items and free it
+ *
+ * \param batch The batch to free
+ */
+void gst_inference_batch_free (GstInferenceBatch * batch);
+
+/**
+ * \brief Add an item to the batch being collected
+ *
+ * Waits while the previous batch is full and not yet taken by the
+ * thread. A barrier item closes the batch being collected and is
+ * processed in a batch of its own, keeping its place in the order.
+ *
+ * \param batch The batch to use
+ * \param item The item, the batch takes ownership only on success
+ * \param barrier Whether the item must be processed alone
+ * \return FALSE if flushing
+ */
+gboolean gst_inference_batch_push (GstInferenceBatch * batch, gpointer item,
+    gboolean barrier);
+
+/**
+ * \brief Add an item to the batch being collected on behalf of an owner
+ *
+ * Same as gst_inference_batch_push, the owner allows to flush or drain
+ * the items of a single producer when several share the batch.
+ *
+ * \param batch The batch to use
+ * \param item The item, the batch takes ownership only on success
+ * \param owner The producer of the item
+ * \param barrier Whether the item must be processed alone
+ * \return FALSE if flushing
+ */
+gboolean gst_inference_batch_push_owned (GstInferenceBatch * batch,
+    gpointer item, gpointer owner, gboolean barrier);
+
+/**
+ * \brief Start or stop flushing
+ *
+ * While flushing the pending items are dropped and pushes fail.
+ * Stopping the flush waits for the batch being processed.
+ *
+ * \param batch The batch to use
+ * \param flushing Whether to flush
+ */
+void gst_inference_batch_set_flushing (GstInferenceBatch * batch,
+    gboolean flushing);
+
+/**
+ * \brief Process the pending items right away and wait for them
+ *
+ * \param batch The batch to use
+ */
+void gst_inference_batch_drain (GstInferenceBatch * batch);
+
+/**
+ * \brief Drop the pending items of an owner
+ *
+ * Waits for the batch being processed if it holds items of the owner.
+ * The items of other owners are kept.
+ *
+ * \param batch The batch to use
+ * \param owner The owner whose items to drop
+ */
+void gst_inference_batch_flush_owner (GstInferenceBatch * batch,
+    gpointer owner);
+
+/**
+ * \brief Process the pending items right away and wait for those of an
+ * owner
+ *
+ * \param batch The batch to use
+ * \param owner The owner whose items to wait for
+ */
+void gst_inference_batch_drain_owner (GstInferenceBatch * batch,
+    gpointer owner);
+
+G_END_DECLS
+#endif //__GST_INFERENCE_BATCH_H__
@@ -0,0 +1,255 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+
+#include "gstinferencematcher.h"
+
+typedef struct _MatcherEntry MatcherEntry;
+struct _MatcherEntry
+{
+  GstClockTime pts;
+  gint64 slot;
+  gpointer item;
+  /* Position in the arrival order */
+  GList *link;
+};
+
+struct _GstInferenceMatcher
+{
+  GstClockTime window;
+  /* Slot number to the queue of its entries */
+  GHashTable *slots;
+  GQueue entries;
+  GstClockTime latest;
+};
+
+static gint64 matcher_get_slot (GstInferenceMatcher * matcher,
+    GstClockTime pts);
+static GstClockTime matcher_distance (GstClockTime a, GstClockTime b);
+static MatcherEntry *matcher_find (GstInferenceMatcher * matcher,
+    gint64 slot, GstClockTime pts, MatcherEntry * nearest);
+static gpointer matcher_remove (GstInferenceMatcher * matcher,
+    MatcherEntry * entry);
+
+GstInferenceMatcher *
+gst_inference_matcher_new (GstClockTime window)
+{
+  GstInferenceMatcher *matcher;
+
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (window), NULL);
+
+  matcher = g_new0 (GstInferenceMatcher, 1);
+  matcher->window = window;
+  matcher->slots = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+      g_free, (GDestroyNotify) g_queue_free);
+  g_queue_init (&matcher->entries);
+  matcher->latest = GST_CLOCK_TIME_NONE;
+
+  return matcher;
+}
+
+void
+gst_inference_matcher_free (GstInferenceMatcher * matcher,
+    GDestroyNotify notify)
+{
+  g_return_if_fail (matcher);
+
+  gst_inference_matcher_clear (matcher, notify);
+
+  g_hash_table_unref (matcher->slots);
+  g_free (matcher);
+}
+
+void
+gst_inference_matcher_clear (GstInferenceMatcher * matcher,
+    GDestroyNotify notify)
+{
+  gpointer item;
+
+  g_return_if_fail (matcher);
+
+  while ((item = gst_inference_matcher_pop (matcher))) {
+    if (notify) {
+      notify (item);
+    }
+  }
+
+  matcher->latest = GST_CLOCK_TIME_NONE;
+}
+
+static gint64
+matcher_get_slot (GstInferenceMatcher * matcher, GstClockTime pts)
+{
+  return pts / MAX (matcher->window, 1);
+}
+
+static GstClockTime
+matcher_distance (GstClockTime a, GstClockTime b)
+{
+  return a > b ? a - b : b - a;
+}
+
+void
+gst_inference_matcher_add (GstInferenceMatcher * matcher, GstClockTime pts,
+    gpointer item)
+{
+  MatcherEntry *entry;
+  GQueue *slot;
+  gint64 *key;
+
+  g_return_if_fail (matcher);
+  g_return_if_fail (GST_CLOCK_TIME_IS_VALID (pts));
+  g_return_if_fail (item);
+
+  entry = g_slice_new (MatcherEntry);
+  entry->pts = pts;
+  entry->slot = matcher_get_slot (matcher, pts);
+  entry->item = item;
+
+  g_queue_push_tail (&matcher->entries, entry);
+  entry->link = g_queue_peek_tail_link (&matcher->entries);
+
+  slot = g_hash_table_lookup (matcher->slots, &entry->slot);
+  if (NULL == slot) {
+    key = g_new (gint64, 1);
+    *key = entry->slot;
+    slot = g_queue_new ();
+    g_hash_table_insert (matcher->slots, key, slot);
+  }
+  g_queue_push_tail (slot, entry);
+
+  if (!GST_CLOCK_TIME_IS_VALID (matcher->latest) || pts > matcher->latest) {
+    matcher->latest = pts;
+  }
+}
+
+static MatcherEntry *
+matcher_find (GstInferenceMatcher * matcher, gint64 slot, GstClockTime pts,
+    MatcherEntry * nearest)
+{
+  GQueue *entries;
+  GList *link;
+
+  entries = g_hash_table_lookup (matcher->slots, &slot);
+  if (NULL == entries) {
+    return nearest;
+  }
+
+  for (link = entries->head; link; link = link->next) {
+    MatcherEntry *entry = link->data;
+    GstClockTime distance = matcher_distance (entry->pts, pts);
+
+    if (distance > matcher->window) {
+      continue;
+    }
+    if (NULL == nearest || distance < matcher_distance (nearest->pts, pts)) {
+      nearest = entry;
+    }
+  }
+
+  return nearest;
+}
+
+static gpointer
+matcher_remove (GstInferenceMatcher * matcher, MatcherEntry * entry)
+{
+  GQueue *slot;
+  gpointer item = entry->item;
+
+  slot = g_hash_table_lookup (matcher->slots, &entry->slot);
+  g_queue_remove (slot, entry);
+  if (g_queue_is_empty (slot)) {
+    g_hash_table_remove (matcher->slots, &entry->slot);
+  }
+
+  g_queue_delete_link (&matcher->entries, entry->link);
+  g_slice_free (MatcherEntry, entry);
+
+  return item;
+}
+
+gpointer
+gst_inference_matcher_take (GstInferenceMatcher * matcher, GstClockTime pts)
+{
+  MatcherEntry *nearest = NULL;
+  gint64 slot;
+
+  g_return_val_if_fail (matcher, NULL);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (pts), NULL);
+
+  /* Anything within the window lands in a neighbour slot at most */
+  slot = matcher_get_slot (matcher, pts);
+  nearest = matcher_find (matcher, slot - 1, pts, nearest);
+  nearest = matcher_find (matcher, slot, pts, nearest);
+  nearest = matcher_find (matcher, slot + 1, pts, nearest);
+
+  return nearest ? matcher_remove (matcher, nearest) : NULL;
+}
+
+gpointer
+gst_inference_matcher_pop_expired (GstInferenceMatcher * matcher,
+    GstClockTime pts)
+{
+  GList *link;
+
+  g_return_val_if_fail (matcher, NULL);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (pts), NULL);
+
+  /* Items normally arrive in order, so this stops at the head */
+  for (link = g_queue_peek_head_link (&matcher->entries); link;
+      link = link->next) {
+    MatcherEntry *entry = link->data;
+
+    if (entry->pts + matcher->window < pts) {
+      return matcher_remove (matcher, entry);
+    }
+  }
+
+  return NULL;
+}
+
+gpointer
+gst_inference_matcher_pop (GstInferenceMatcher * matcher)
+{
+  MatcherEntry *entry;
+
+  g_return_val_if_fail (matcher, NULL);
+
+  entry = g_queue_peek_head (&matcher->entries);
+
+  return entry ? matcher_remove (matcher, entry) : NULL;
+}
+
+GstClockTime
+gst_inference_matcher_get_latest (GstInferenceMatcher * matcher)
+{
+  g_return_val_if_fail (matcher, GST_CLOCK_TIME_NONE);
+
+  return matcher->latest;
+}
+
+guint
+gst_inference_matcher_get_length (GstInferenceMatcher * matcher)
+{
+  g_return_val_if_fail (matcher, 0);
+
+  return g_queue_get_length (&matcher->entries);
+}
@@ -0,0 +1,116 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+
+#ifndef __GST_INFERENCE_MATCHER_H__
+#define __GST_INFERENCE_MATCHER_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstInferenceMatcher GstInferenceMatcher;
+
+/**
+ * \brief Create an index of pending items, looked up by timestamp
+ *
+ * Items are hashed by the window sized slot their timestamp falls in,
+ * so finding the nearest one only visits three slots.
+ *
+ * \param window The maximum distance between the timestamp looked up
+ * and the one of the item found
+ */
+GstInferenceMatcher *gst_inference_matcher_new (GstClockTime window);
+
+/**
+ * \brief Free the index
+ *
+ * \param matcher The index to free
+ * \param notify Function to free the items still pending, or NULL
+ */
+void gst_inference_matcher_free (GstInferenceMatcher * matcher,
+    GDestroyNotify notify);
+
+/**
+ * \brief Remove every item and forget the latest timestamp
+ *
+ * \param matcher The index to clear
+ * \param notify Function to free the items removed, or NULL
+ */
+void gst_inference_matcher_clear (GstInferenceMatcher * matcher,
+    GDestroyNotify notify);
+
+/**
+ * \brief Add an item to the index
+ *
+ * \param matcher The index to use
+ * \param pts The timestamp of the item, must be valid
+ * \param item The item to add, must not be NULL
+ */
+void gst_inference_matcher_add (GstInferenceMatcher * matcher,
+    GstClockTime pts, gpointer item);
+
+/**
+ * \brief Remove the item nearest to a timestamp, within the window
+ *
+ * \param matcher The index to use
+ * \param pts The timestamp to look up
+ * \return The item, or NULL if none is within the window
+ */
+gpointer gst_inference_matcher_take (GstInferenceMatcher * matcher,
+    GstClockTime pts);
+
+/**
+ * \brief Remove an item that is too old to match a timestamp
+ *
+ * \param matcher The index to use
+ * \param pts The timestamp being looked up
+ * \return The oldest added item whose timestamp is more than the window
+ * before pts, or NULL if there is none
+ */
+gpointer gst_inference_matcher_pop_expired (GstInferenceMatcher * matcher,
+    GstClockTime pts);
+
+/**
+ * \brief Remove the oldest added item
+ *
+ * \param matcher The index to use
+ * \return The item, or NULL if the index is empty
+ */
+gpointer gst_inference_matcher_pop (GstInferenceMatcher * matcher);
+
+/**
+ * \brief Get the latest timestamp added since the index was cleared
+ *
+ * \param matcher The index to query
+ * \return The timestamp, or GST_CLOCK_TIME_NONE if nothing was added
+ */
+GstClockTime gst_inference_matcher_get_latest (GstInferenceMatcher * matcher);
+
+/**
+ * \brief Get the amount of items in the index
+ *
+ * \param matcher The index to query
+ */
+guint gst_inference_matcher_get_length (GstInferenceMatcher * matcher);
+
+G_END_DECLS
+#endif //__GST_INFERENCE_MATCHER_H__
@@ -95,6 +95,7 @@ gst_inference_meta_transform_existing_meta (GstBuffer * dest, GstMeta * meta,
   /* Transfer Stream ID */
   g_free (dmeta->stream_id);
   dmeta->stream_id = g_strdup (smeta->stream_id);
+  dmeta->stale = smeta->stale;
 
   if (GST_META_TRANSFORM_IS_COPY (type)) {
     GST_LOG ("Copy inference metadata");
@@ -145,6 +146,7 @@ gst_inference_meta_transform_new_meta (GstBuffer * dest, GstMeta * meta,
   /* Transfer Stream ID */
   g_free (dmeta->stream_id);
   dmeta->stream_id = g_strdup (smeta->stream_id);
+  dmeta->stale = smeta->stale;
 
   if (GST_META_TRANSFORM_IS_COPY (type)) {
     GST_LOG ("Copy inference metadata");
@@ -200,6 +202,7 @@ gst_inference_meta_init (GstMeta * meta, gpointer params, GstBuffer * buffer)
 
   imeta->prediction = root;
   imeta->stream_id = NULL;
+  imeta->stale = FALSE;
 
   return TRUE;
 }
@@ -55,6 +55,10 @@ struct _GstInferenceMeta
   GstInferencePrediction *prediction;
 
   gchar *stream_id;
+
+  /* TRUE if the prediction was made on an earlier frame because the
+   * inference skipped this one */
+  gboolean stale;
 };
 
 
@@ -0,0 +1,332 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "gstinferencepipeline.h"
+
+#include "gstinferencering.h"
+
+typedef struct _GstInferencePipelineThread GstInferencePipelineThread;
+struct _GstInferencePipelineThread
+{
+  GstInferencePipeline *pipeline;
+  GstInferencePipelineStage stage;
+  GThread **threads;
+  guint n_threads;
+  /* The ring feeding this stage */
+  GstInferenceRing *ring;
+  /* The ring feeding the next stage, NULL for the last one */
+  GstInferenceRing *next;
+
+  /* With several threads, jobs take a ticket as they are popped and
+   * leave the stage in ticket order */
+  GMutex pop_mutex;
+  GMutex order_mutex;
+  GCond order_cond;
+  guint64 popped;
+  guint64 passed;
+
+  guint64 jobs;
+  guint64 total;
+  guint64 max;
+};
+
+struct _GstInferencePipeline
+{
+  GstInferencePipelineThread *threads;
+  guint n_stages;
+  GstInferencePipelineFunc drop;
+  gpointer user_data;
+
+  gint flushing;
+  /* Serializes producers, the rings have a single producer each */
+  GMutex push_mutex;
+
+  GMutex mutex;
+  GCond idle_cond;
+  guint in_flight;
+};
+
+static gpointer gst_inference_pipeline_loop (gpointer data);
+static void gst_inference_pipeline_done (GstInferencePipeline * pipeline);
+static void gst_inference_pipeline_pass (GstInferencePipelineThread * thread,
+    gpointer job, gboolean drop);
+
+static void
+gst_inference_pipeline_done (GstInferencePipeline * pipeline)
+{
+  g_mutex_lock (&pipeline->mutex);
+  pipeline->in_flight--;
+  if (0 == pipeline->in_flight) {
+    g_cond_broadcast (&pipeline->idle_cond);
+  }
+  g_mutex_unlock (&pipeline->mutex);
+}
+
+/* Hands the job to the next stage, or finishes it */
+static void
+gst_inference_pipeline_pass (GstInferencePipelineThread * thread,
+    gpointer job, gboolean drop)
+{
+  GstInferencePipeline *pipeline = thread->pipeline;
+
+  if (drop) {
+    pipeline->drop (job, pipeline->user_data);
+    gst_inference_pipeline_done (pipeline);
+  } else if (!thread->next) {
+    gst_inference_pipeline_done (pipeline);
+  } else if (!gst_inference_ring_push (thread->next, job)) {
+    pipeline->drop (job, pipeline->user_data);
+    gst_inference_pipeline_done (pipeline);
+  }
+}
+
+static gpointer
+gst_inference_pipeline_loop (gpointer data)
+{
+  GstInferencePipelineThread *thread = (GstInferencePipelineThread *) data;
+  GstInferencePipeline *pipeline = thread->pipeline;
+  gboolean ordered = thread->n_threads > 1;
+  gboolean drop;
+  gpointer job;
+  guint64 ticket = 0;
+  gint64 start;
+  guint64 elapsed;
+
+  while (TRUE) {
+    /* The ring has a single consumer, the threads take turns on it */
+    if (ordered) {
+      g_mutex_lock (&thread->pop_mutex);
+      job = gst_inference_ring_pop (thread->ring);
+      ticket = thread->popped++;
+      g_mutex_unlock (&thread->pop_mutex);
+    } else {
+      job = gst_inference_ring_pop (thread->ring);
+    }
+
+    if (!job) {
+      break;
+    }
+
+    drop = g_atomic_int_get (&pipeline->flushing);
+    if (!drop) {
+      start = g_get_monotonic_time ();
+      thread->stage.func (job, pipeline->user_data);
+      elapsed = g_get_monotonic_time () - start;
+
+      g_mutex_lock (&pipeline->mutex);
+      thread->jobs++;
+      thread->total += elapsed;
+      thread->max = MAX (thread->max, elapsed);
+      g_mutex_unlock (&pipeline->mutex);
+    }
+
+    if (!ordered) {
+      gst_inference_pipeline_pass (thread, job, drop);
+      continue;
+    }
+
+    /* Dropped jobs take their turn too, so no ticket is skipped */
+    g_mutex_lock (&thread->order_mutex);
+    while (thread->passed != ticket) {
+      g_cond_wait (&thread->order_cond, &thread->order_mutex);
+    }
+    gst_inference_pipeline_pass (thread, job, drop);
+    thread->passed++;
+    g_cond_broadcast (&thread->order_cond);
+    g_mutex_unlock (&thread->order_mutex);
+  }
+
+  return NULL;
+}
+
+GstInferencePipeline *
+gst_inference_pipeline_new (const GstInferencePipelineStage * stages,
+    guint n_stages, guint depth, GstInferencePipelineFunc drop,
+    gpointer user_data)
+{
+  GstInferencePipeline *pipeline;
+  GstInferencePipelineThread *thread;
+  guint i, j;
+
+  g_return_val_if_fail (stages, NULL);
+  g_return_val_if_fail (n_stages > 0, NULL);
+  g_return_val_if_fail (depth > 0, NULL);
+  g_return_val_if_fail (drop, NULL);
+
+  pipeline = g_new0 (GstInferencePipeline, 1);
+  pipeline->threads = g_new0 (GstInferencePipelineThread, n_stages);
+  pipeline->n_stages = n_stages;
+  pipeline->drop = drop;
+  pipeline->user_data = user_data;
+  g_mutex_init (&pipeline->push_mutex);
+  g_mutex_init (&pipeline->mutex);
+  g_cond_init (&pipeline->idle_cond);
+
+  for (i = 0; i < n_stages; ++i) {
+    thread = &pipeline->threads[i];
+    thread->pipeline = pipeline;
+    thread->stage = stages[i];
+    thread->n_threads = MAX (stages[i].threads, 1);
+    thread->threads = g_new0 (GThread *, thread->n_threads);
+    thread->ring = gst_inference_ring_new (depth);
+    g_mutex_init (&thread->pop_mutex);
+    g_mutex_init (&thread->order_mutex);
+    g_cond_init (&thread->order_cond);
+  }
+
+  for (i = 0; i < n_stages; ++i) {
+    thread = &pipeline->threads[i];
+    if (i + 1 < n_stages) {
+      thread->next = pipeline->threads[i + 1].ring;
+    }
+    for (j = 0; j < thread->n_threads; ++j) {
+      thread->threads[j] = g_thread_new (thread->stage.name,
+          gst_inference_pipeline_loop, thread);
+    }
+  }
+
+  return pipeline;
+}
+
+void
+gst_inference_pipeline_free (GstInferencePipeline * pipeline)
+{
+  GstInferencePipelineThread *thread;
+  gpointer job;
+  guint i, j;
+
+  g_return_if_fail (pipeline);
+
+  /* Stop in processing order, so no stage pushes to a finished one */
+  g_atomic_int_set (&pipeline->flushing, TRUE);
+  for (i = 0; i < pipeline->n_stages; ++i) {
+    thread = &pipeline->threads[i];
+    gst_inference_ring_close (thread->ring);
+    for (j = 0; j < thread->n_threads; ++j) {
+      g_thread_join (thread->threads[j]);
+    }
+  }
+
+  for (i = 0; i < pipeline->n_stages; ++i) {
+    thread = &pipeline->threads[i];
+    while ((job = gst_inference_ring_try_pop (thread->ring))) {
+      pipeline->drop (job, pipeline->user_data);
+    }
+    gst_inference_ring_free (thread->ring);
+    g_mutex_clear (&thread->pop_mutex);
+    g_mutex_clear (&thread->order_mutex);
+    g_cond_clear (&thread->order_cond);
+    g_free (thread->threads);
+  }
+
+  g_mutex_clear (&pipeline->push_mutex);
+  g_mutex_clear (&pipeline->mutex);
+  g_cond_clear (&pipeline->idle_cond);
+  g_free (pipeline->threads);
+  g_free (pipeline);
+}
+
+gboolean
+gst_inference_pipeline_push (GstInferencePipeline * pipeline, gpointer job,
+    gboolean block)
+{
+  GstInferenceRing *ring;
+  gboolean pushed = FALSE;
+
+  g_return_val_if_fail (pipeline, FALSE);
+  g_return_val_if_fail (job, FALSE);
+
+  ring = pipeline->threads[0].ring;
+
+  g_mutex_lock (&pipeline->push_mutex);
+  if (!g_atomic_int_get (&pipeline->flushing)) {
+    /* Account the job first, the stages may finish it before we return */
+    g_mutex_lock (&pipeline->mutex);
+    pipeline->in_flight++;
+    g_mutex_unlock (&pipeline->mutex);
+
+    pushed = block ? gst_inference_ring_push (ring, job) :
+        gst_inference_ring_try_push (ring, job);
+    if (!pushed) {
+      gst_inference_pipeline_done (pipeline);
+    }
+  }
+  g_mutex_unlock (&pipeline->push_mutex);
+
+  return pushed;
+}
+
+void
+gst_inference_pipeline_set_flushing (GstInferencePipeline * pipeline,
+    gboolean flushing)
+{
+  g_return_if_fail (pipeline);
+
+  g_mutex_lock (&pipeline->mutex);
+  if (flushing) {
+    g_atomic_int_set (&pipeline->flushing, TRUE);
+    g_cond_broadcast (&pipeline->idle_cond);
+  } else {
+    /* Jobs caught by the flush must not outlive it */
+    while (pipeline->in_flight > 0) {
+      g_cond_wait (&pipeline->idle_cond, &pipeline->mutex);
+    }
+    g_atomic_int_set (&pipeline->flushing, FALSE);
+  }
+  g_mutex_unlock (&pipeline->mutex);
+}
+
+void
+gst_inference_pipeline_drain (GstInferencePipeline * pipeline)
+{
+  g_return_if_fail (pipeline);
+
+  g_mutex_lock (&pipeline->mutex);
+  while (!g_atomic_int_get (&pipeline->flushing)
+      && pipeline->in_flight > 0) {
+    g_cond_wait (&pipeline->idle_cond, &pipeline->mutex);
+  }
+  g_mutex_unlock (&pipeline->mutex);
+}
+
+void
+gst_inference_pipeline_get_stage_stats (GstInferencePipeline * pipeline,
+    guint stage, guint64 * jobs, guint64 * total, guint64 * max)
+{
+  GstInferencePipelineThread *thread;
+
+  g_return_if_fail (pipeline);
+  g_return_if_fail (stage < pipeline->n_stages);
+
+  thread = &pipeline->threads[stage];
+
+  g_mutex_lock (&pipeline->mutex);
+  if (jobs) {
+    *jobs = thread->jobs;
+  }
+  if (total) {
+    *total = thread->total;
+  }
+  if (max) {
+    *max = thread->max;
+  }
+  g_mutex_unlock (&pipeline->mutex);
+}
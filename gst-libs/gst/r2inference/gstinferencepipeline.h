@@ -0,0 +1,121 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef __GST_INFERENCE_PIPELINE_H__
+#define __GST_INFERENCE_PIPELINE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstInferencePipeline GstInferencePipeline;
+
+/**
+ * \brief Function processing a job in one of the pipeline stages
+ *
+ * The last stage takes ownership of the job.
+ *
+ * \param job The job to process
+ * \param user_data The data passed to gst_inference_pipeline_new
+ */
+typedef void (*GstInferencePipelineFunc) (gpointer job, gpointer user_data);
+
+typedef struct _GstInferencePipelineStage GstInferencePipelineStage;
+struct _GstInferencePipelineStage
+{
+  /* The name of the stage thread */
+  const gchar *name;
+  GstInferencePipelineFunc func;
+  /* The threads running the stage on consecutive jobs, 0 for one. The
+   * jobs still leave the stage in order */
+  guint threads;
+};
+
+/**
+ * \brief Create a thread per stage, connected by rings
+ *
+ * Every job goes through the stages in order, so consecutive jobs are
+ * processed by different stages at the same time. A stage with several
+ * threads also processes consecutive jobs at the same time.
+ *
+ * \param stages The stages, in processing order
+ * \param n_stages The amount of stages
+ * \param depth The amount of jobs each ring can hold, it bounds the
+ * jobs in flight and thus the added latency
+ * \param drop The function releasing a job dropped while flushing
+ * \param user_data The data passed to the stage functions
+ */
+GstInferencePipeline *gst_inference_pipeline_new (const
+    GstInferencePipelineStage * stages, guint n_stages, guint depth,
+    GstInferencePipelineFunc drop, gpointer user_data);
+
+/**
+ * \brief Stop the stage threads, drop the jobs in flight and free it
+ *
+ * \param pipeline The pipeline to free
+ */
+void gst_inference_pipeline_free (GstInferencePipeline * pipeline);
+
+/**
+ * \brief Feed a job to the first stage
+ *
+ * \param pipeline The pipeline to use
+ * \param job The job, the pipeline takes ownership only on success
+ * \param block Whether to wait for room if the first ring is full
+ * \return FALSE if flushing, or if not blocking and the ring is full
+ */
+gboolean gst_inference_pipeline_push (GstInferencePipeline * pipeline,
+    gpointer job, gboolean block);
+
+/**
+ * \brief Start or stop flushing
+ *
+ * While flushing the jobs in flight are released with the drop function
+ * and pushes fail. Stopping the flush waits until all of them are
+ * released.
+ *
+ * \param pipeline The pipeline to use
+ * \param flushing Whether to flush
+ */
+void gst_inference_pipeline_set_flushing (GstInferencePipeline * pipeline,
+    gboolean flushing);
+
+/**
+ * \brief Wait until every job in flight went through the last stage
+ *
+ * \param pipeline The pipeline to use
+ */
+void gst_inference_pipeline_drain (GstInferencePipeline * pipeline);
+
+/**
+ * \brief Get the timing of a stage
+ *
+ * \param pipeline The pipeline to query
+ * \param stage The index of the stage
+ * \param jobs Out, the amount of jobs processed by the stage
+ * \param total Out, the time spent processing them, in microseconds
+ * \param max Out, the longest time spent on a single job, in microseconds
+ */
+void gst_inference_pipeline_get_stage_stats (GstInferencePipeline *
+    pipeline, guint stage, guint64 * jobs, guint64 * total, guint64 * max);
+
+G_END_DECLS
+#endif //__GST_INFERENCE_PIPELINE_H__
@@ -375,21 +375,35 @@ gst_create_boxes_float (GstVideoInference * vi, const gpointer prediction,
     gint * elements, gdouble obj_thresh, gdouble prob_thresh,
     gdouble iou_thresh, gdouble ** probabilities, gint num_classes)
 {
-  BBox boxes[TOTAL_BOXES_15];
+  return gst_create_boxes_float_full (vi, prediction, TOTAL_BOXES_15,
+      valid_prediction, resulting_boxes, elements, obj_thresh, prob_thresh,
+      iou_thresh, probabilities, num_classes);
+}
+
+gboolean
+gst_create_boxes_float_full (GstVideoInference * vi,
+    gconstpointer prediction, gint total_boxes, gboolean * valid_prediction,
+    BBox ** resulting_boxes, gint * elements, gdouble obj_thresh,
+    gdouble prob_thresh, gdouble iou_thresh, gdouble ** probabilities,
+    gint num_classes)
+{
+  BBox *boxes;
 
   g_return_val_if_fail (vi != NULL, FALSE);
   g_return_val_if_fail (prediction != NULL, FALSE);
+  g_return_val_if_fail (total_boxes >= 0, FALSE);
   g_return_val_if_fail (valid_prediction != NULL, FALSE);
   g_return_val_if_fail (resulting_boxes != NULL, FALSE);
   g_return_val_if_fail (elements != NULL, FALSE);
 
   *elements = 0;
 
-  gst_get_boxes_from_prediction_float (obj_thresh, prob_thresh, prediction,
-      boxes, elements, TOTAL_BOXES_15, probabilities, num_classes);
+  boxes = g_new (BBox, total_boxes);
+  gst_get_boxes_from_prediction_float (obj_thresh, prob_thresh,
+      (gpointer) prediction, boxes, elements, total_boxes, probabilities,
+      num_classes);
   gst_remove_duplicated_boxes (iou_thresh, boxes, elements);
 
-  *resulting_boxes = g_malloc (*elements * sizeof (BBox));
-  memcpy (*resulting_boxes, boxes, *elements * sizeof (BBox));
+  *resulting_boxes = g_realloc (boxes, *elements * sizeof (BBox));
   return TRUE;
 }
@@ -65,6 +65,29 @@ gboolean gst_create_boxes_float (GstVideoInference * vi,
     gdouble prob_thresh, gdouble iou_thresh, gdouble ** probabilities,
     gint num_classes);
 
+/**
+ * \brief Fill all the data for the boxes of a prediction with any
+ * number of boxes
+ *
+ * \param vi Father object of every architecture
+ * \param prediction Value of the prediction
+ * \param total_boxes The number of boxes in the prediction
+ * \param valid_prediction Check if the prediction is valid
+ * \param resulting_boxes The output boxes of the prediction
+ * \param elements The number of objects
+ * \param obj_thresh Objectness threshold
+ * \param prob_thresh Class probability threshold
+ * \param iou_thresh Intersection over union threshold
+ * \param probabilities Probabilities of each classes, room for
+ * total_boxes
+ * \param num_classes The number of classes
+ */
+gboolean gst_create_boxes_float_full (GstVideoInference * vi,
+    gconstpointer prediction, gint total_boxes, gboolean * valid_prediction,
+    BBox ** resulting_boxes, gint * elements, gdouble obj_thresh,
+    gdouble prob_thresh, gdouble iou_thresh, gdouble ** probabilities,
+    gint num_classes);
+
 /**
  * \brief Create Prediction from box
  *
@@ -20,7 +20,92 @@
  */
 
 #include "gstinferencepreprocess.h"
+#include "gstinferencepreprocesspool.h"
+#include "gstinferenceresize.h"
 #include <math.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GST_INFERENCE_PREPROCESS_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define GST_INFERENCE_PREPROCESS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define MEANS_STD_CHANNELS 3
+#define LUT_SIZE 256
+#define LUT_BENCHMARK_RUNS 3
+
+typedef struct _GstMeansStdParams GstMeansStdParams;
+struct _GstMeansStdParams
+{
+  gint channels;
+  gint offset;
+  gint first_index;
+  gint last_index;
+  gint model_channels;
+  /* Distance in floats between output channel planes, 0 if interleaved */
+  gint plane_stride;
+  gdouble mean[MEANS_STD_CHANNELS];
+  gdouble std[MEANS_STD_CHANNELS];
+  /* Normalized value of every input byte, per input channel */
+  const gfloat *lut;
+};
+
+/* Row kernels. Each one handles a complete row and falls back to the
+ * scalar kernel for the pixels that do not fill a full vector. All of
+ * them keep the intermediate arithmetic in double precision so the
+ * results are bit exact with respect to the scalar implementation.
+ */
+typedef void (*GstMeansStdRowFunc) (const guchar * src, gfloat * dst,
+    gint width, const GstMeansStdParams * params);
+typedef void (*GstGrayRowFunc) (const guchar * src, gfloat * dst,
+    gint width, gdouble rcp_mean, gdouble offset);
+typedef void (*GstHalfRowFunc) (const gfloat * src, guint16 * dst,
+    gint count);
+
+/* Normalization of a format with a given mean and std, along with the
+ * kernel that turned out to be the fastest for it */
+typedef struct _GstPreprocessCacheEntry GstPreprocessCacheEntry;
+struct _GstPreprocessCacheEntry
+{
+  GstVideoFormat format;
+  GstMeansStdParams params;
+  gfloat lut[MEANS_STD_CHANNELS * LUT_SIZE];
+  gboolean use_lut;
+};
+
+struct _GstInferencePreprocessCache
+{
+  GMutex mutex;
+  GstInferencePreprocessLutMode mode;
+  GList *entries;
+};
+
+/* A frame to be processed in row bands by the preprocess pool */
+typedef struct _GstPreprocessJob GstPreprocessJob;
+struct _GstPreprocessJob
+{
+  const guchar *src;
+  gfloat *dst;
+  gint src_stride;
+  gint dst_stride;
+  gint width;
+
+  GstMeansStdParams params;
+  GstMeansStdRowFunc means_std_func;
+
+  gdouble rcp_mean;
+  gdouble offset;
+  GstGrayRowFunc gray_func;
+
+  /* Reduced precision tensors are written through a float row */
+  gpointer tensor;
+  GstInferenceTensorType tensor_type;
+  gdouble scale;
+  gint zero_point;
+};
 
 static gboolean gst_configure_format_values (GstVideoFrame * inframe,
     gint * first_index, gint * last_index, gint * offset, gint * channels);
@@ -34,6 +119,1379 @@ static void gst_apply_means_std (GstVideoFrame * inframe,
 static void gst_apply_gray_normalization (GstVideoFrame * inframe,
     GstVideoFrame * outframe, gdouble std, gdouble offset);
 
+static void gst_means_std_row_scalar (const guchar * src, gfloat * dst,
+    gint width, const GstMeansStdParams * params);
+static void gst_means_std_row_planar_scalar (const guchar * src, gfloat * dst,
+    gint width, const GstMeansStdParams * params);
+static void gst_half_row_scalar (const gfloat * src, guint16 * dst,
+    gint count);
+static void gst_means_std_row_lut (const guchar * src, gfloat * dst,
+    gint width, const GstMeansStdParams * params);
+static void gst_means_std_row_planar_lut (const guchar * src, gfloat * dst,
+    gint width, const GstMeansStdParams * params);
+static GstPreprocessCacheEntry *gst_means_std_find_entry
+    (GstInferencePreprocessCache * cache, GstVideoFormat format,
+    const GstMeansStdParams * params);
+static void gst_means_std_select_lut (GstPreprocessJob * job,
+    GstVideoFormat format, gint height);
+static void gst_gray_row_scalar (const guchar * src, gfloat * dst,
+    gint width, gdouble rcp_mean, gdouble offset);
+static GstInferencePreprocessImpl gst_inference_preprocess_detect_impl (void);
+static GstInferencePreprocessImpl gst_inference_preprocess_current_impl (void);
+static GstMeansStdRowFunc gst_means_std_get_row_func (const GstMeansStdParams *
+    params);
+static GstGrayRowFunc gst_gray_get_row_func (void);
+#ifdef GST_INFERENCE_PREPROCESS_X86
+static gboolean gst_half_f16c_supported (void);
+#endif
+static GstHalfRowFunc gst_half_get_row_func (void);
+static void gst_means_std_band (gpointer user_data, gint first_row,
+    gint last_row);
+static void gst_gray_band (gpointer user_data, gint first_row, gint last_row);
+
+static gint preprocess_impl = GST_INFERENCE_PREPROCESS_IMPL_AUTO;
+static GPrivate current_layout = G_PRIVATE_INIT (NULL);
+static GPrivate current_tensor_type = G_PRIVATE_INIT (g_free);
+static GPrivate current_cache = G_PRIVATE_INIT (NULL);
+
+/* Tensor data type configured for the calling thread */
+typedef struct _GstTensorTypeParams GstTensorTypeParams;
+struct _GstTensorTypeParams
+{
+  GstInferenceTensorType type;
+  gdouble scale;
+  gint zero_point;
+};
+
+GType
+gst_inference_tensor_layout_get_type (void)
+{
+  static gsize type = 0;
+
+  if (g_once_init_enter (&type)) {
+    static const GEnumValue values[] = {
+      {GST_INFERENCE_TENSOR_LAYOUT_NHWC,
+          "Interleaved channels (NHWC)", "nhwc"},
+      {GST_INFERENCE_TENSOR_LAYOUT_NCHW,
+          "Planar channels (NCHW)", "nchw"},
+      {0, NULL, NULL},
+    };
+    GType new_type = g_enum_register_static ("GstInferenceTensorLayout",
+        values);
+    g_once_init_leave (&type, new_type);
+  }
+
+  return (GType) type;
+}
+
+GType
+gst_inference_tensor_type_get_type (void)
+{
+  static gsize type = 0;
+
+  if (g_once_init_enter (&type)) {
+    static const GEnumValue values[] = {
+      {GST_INFERENCE_TENSOR_TYPE_FLOAT, "32 bit float", "float"},
+      {GST_INFERENCE_TENSOR_TYPE_FP16, "16 bit half float", "fp16"},
+      {GST_INFERENCE_TENSOR_TYPE_INT8,
+          "Quantized signed 8 bit integer", "int8"},
+      {GST_INFERENCE_TENSOR_TYPE_UINT8,
+          "Raw unsigned 8 bit pixel values", "uint8"},
+      {0, NULL, NULL},
+    };
+    GType new_type = g_enum_register_static ("GstInferenceTensorType",
+        values);
+    g_once_init_leave (&type, new_type);
+  }
+
+  return (GType) type;
+}
+
+GType
+gst_inference_preprocess_lut_mode_get_type (void)
+{
+  static gsize type = 0;
+
+  if (g_once_init_enter (&type)) {
+    static const GEnumValue values[] = {
+      {GST_INFERENCE_PREPROCESS_LUT_AUTO,
+          "Use the faster of the table and the vector kernel", "auto"},
+      {GST_INFERENCE_PREPROCESS_LUT_ALWAYS, "Always use the table", "always"},
+      {GST_INFERENCE_PREPROCESS_LUT_NEVER, "Never use the table", "never"},
+      {0, NULL, NULL},
+    };
+    GType new_type = g_enum_register_static ("GstInferencePreprocessLutMode",
+        values);
+    g_once_init_leave (&type, new_type);
+  }
+
+  return (GType) type;
+}
+
+gsize
+gst_inference_tensor_type_get_size (GstInferenceTensorType type)
+{
+  switch (type) {
+    case GST_INFERENCE_TENSOR_TYPE_FP16:
+      return sizeof (guint16);
+    case GST_INFERENCE_TENSOR_TYPE_INT8:
+      return sizeof (gint8);
+    case GST_INFERENCE_TENSOR_TYPE_UINT8:
+      return sizeof (guint8);
+    default:
+      return sizeof (gfloat);
+  }
+}
+
+gboolean
+gst_inference_tensor_info_from_video_info (GstInferenceTensorInfo * info,
+    const GstVideoInfo * vinfo, GstInferenceTensorType type,
+    GstInferenceTensorLayout layout)
+{
+  gsize width, height, channels, element_size;
+
+  g_return_val_if_fail (info, FALSE);
+  g_return_val_if_fail (vinfo, FALSE);
+
+  width = GST_VIDEO_INFO_WIDTH (vinfo);
+  height = GST_VIDEO_INFO_HEIGHT (vinfo);
+  if (0 == width || 0 == height) {
+    return FALSE;
+  }
+
+  /* Alpha and padding bytes are dropped and YUV is expanded to RGB */
+  switch (GST_VIDEO_INFO_FORMAT (vinfo)) {
+    case GST_VIDEO_FORMAT_GRAY8:
+    case GST_VIDEO_FORMAT_GRAY16_BE:
+    case GST_VIDEO_FORMAT_GRAY16_LE:
+      info->format = GST_VIDEO_FORMAT_GRAY8;
+      channels = 1;
+      break;
+    case GST_VIDEO_FORMAT_BGR:
+      info->format = GST_VIDEO_FORMAT_BGR;
+      channels = 3;
+      break;
+    default:
+      info->format = GST_VIDEO_FORMAT_RGB;
+      channels = 3;
+      break;
+  }
+
+  element_size = gst_inference_tensor_type_get_size (type);
+
+  info->type = type;
+  info->layout = layout;
+  info->shape[0] = 1;
+  if (GST_INFERENCE_TENSOR_LAYOUT_NCHW == layout) {
+    info->shape[1] = channels;
+    info->shape[2] = height;
+    info->shape[3] = width;
+  } else {
+    info->shape[1] = height;
+    info->shape[2] = width;
+    info->shape[3] = channels;
+  }
+
+  info->strides[3] = element_size;
+  info->strides[2] = info->strides[3] * info->shape[3];
+  info->strides[1] = info->strides[2] * info->shape[2];
+  info->strides[0] = info->strides[1] * info->shape[1];
+  info->size = info->strides[0] * info->shape[0];
+
+  return TRUE;
+}
+
+void
+gst_inference_tensor_info_get_dims (const GstInferenceTensorInfo * info,
+    gint * width, gint * height, gint * channels)
+{
+  gint w, h, c;
+
+  g_return_if_fail (info);
+
+  if (GST_INFERENCE_TENSOR_LAYOUT_NCHW == info->layout) {
+    c = info->shape[1];
+    h = info->shape[2];
+    w = info->shape[3];
+  } else {
+    h = info->shape[1];
+    w = info->shape[2];
+    c = info->shape[3];
+  }
+
+  if (width) {
+    *width = w;
+  }
+  if (height) {
+    *height = h;
+  }
+  if (channels) {
+    *channels = c;
+  }
+}
+
+void
+gst_inference_tensor_info_to_video_info (const GstInferenceTensorInfo * info,
+    GstVideoInfo * vinfo)
+{
+  gint width, height;
+
+  g_return_if_fail (info);
+  g_return_if_fail (vinfo);
+
+  gst_inference_tensor_info_get_dims (info, &width, &height, NULL);
+  gst_video_info_set_format (vinfo, info->format, width, height);
+
+  /* The video strides are meaningless for non 8 bit or planar tensors,
+   * only the size matters to map the buffer */
+  GST_VIDEO_INFO_PLANE_OFFSET (vinfo, 0) = 0;
+  GST_VIDEO_INFO_PLANE_STRIDE (vinfo, 0) =
+      GST_INFERENCE_TENSOR_LAYOUT_NCHW == info->layout ?
+      info->strides[2] : info->strides[1];
+  GST_VIDEO_INFO_SIZE (vinfo) = info->size;
+}
+
+static void
+gst_means_std_row_scalar (const guchar * src, gfloat * dst, gint width,
+    const GstMeansStdParams * params)
+{
+  gint j;
+  const gint channels = params->channels;
+  const gint model_channels = params->model_channels;
+  const guchar *in = src + params->offset;
+
+  for (j = 0; j < width; ++j) {
+    dst[params->first_index] = (in[0] - params->mean[0]) * params->std[0];
+    dst[1] = (in[1] - params->mean[1]) * params->std[1];
+    dst[params->last_index] = (in[2] - params->mean[2]) * params->std[2];
+    in += channels;
+    dst += model_channels;
+  }
+}
+
+static void
+gst_means_std_row_planar_scalar (const guchar * src, gfloat * dst,
+    gint width, const GstMeansStdParams * params)
+{
+  gint j;
+  const gint channels = params->channels;
+  const guchar *in = src + params->offset;
+  gfloat *first = dst + params->first_index * params->plane_stride;
+  gfloat *second = dst + params->plane_stride;
+  gfloat *last = dst + params->last_index * params->plane_stride;
+
+  for (j = 0; j < width; ++j) {
+    first[j] = (in[0] - params->mean[0]) * params->std[0];
+    second[j] = (in[1] - params->mean[1]) * params->std[1];
+    last[j] = (in[2] - params->mean[2]) * params->std[2];
+    in += channels;
+  }
+}
+
+static void
+gst_means_std_row_lut (const guchar * src, gfloat * dst, gint width,
+    const GstMeansStdParams * params)
+{
+  gint j;
+  const gint channels = params->channels;
+  const gint model_channels = params->model_channels;
+  const guchar *in = src + params->offset;
+  const gfloat *lut = params->lut;
+
+  for (j = 0; j < width; ++j) {
+    dst[params->first_index] = lut[in[0]];
+    dst[1] = lut[LUT_SIZE + in[1]];
+    dst[params->last_index] = lut[2 * LUT_SIZE + in[2]];
+    in += channels;
+    dst += model_channels;
+  }
+}
+
+static void
+gst_means_std_row_planar_lut (const guchar * src, gfloat * dst, gint width,
+    const GstMeansStdParams * params)
+{
+  gint j;
+  const gint channels = params->channels;
+  const guchar *in = src + params->offset;
+  const gfloat *lut = params->lut;
+  gfloat *first = dst + params->first_index * params->plane_stride;
+  gfloat *second = dst + params->plane_stride;
+  gfloat *last = dst + params->last_index * params->plane_stride;
+
+  for (j = 0; j < width; ++j) {
+    first[j] = lut[in[0]];
+    second[j] = lut[LUT_SIZE + in[1]];
+    last[j] = lut[2 * LUT_SIZE + in[2]];
+    in += channels;
+  }
+}
+
+static void
+gst_gray_row_scalar (const guchar * src, gfloat * dst, gint width,
+    gdouble rcp_mean, gdouble offset)
+{
+  gint j;
+
+  for (j = 0; j < width; ++j) {
+    dst[j] = src[j] * rcp_mean - offset;
+  }
+}
+
+/* Round to nearest even float to half conversion. Values too large for
+ * a half float become infinity and NaNs stay NaN.
+ */
+static guint16
+gst_float_to_half (gfloat value)
+{
+  union
+  {
+    gfloat f;
+    guint32 u;
+  } bits, denorm;
+  guint32 sign;
+  guint16 half;
+
+  bits.f = value;
+  sign = bits.u & 0x80000000u;
+  bits.u ^= sign;
+
+  if (bits.u >= 0x47800000u) {
+    half = bits.u > 0x7f800000u ? 0x7e00 : 0x7c00;
+  } else if (bits.u < 0x38800000u) {
+    /* Let the FPU round the subnormal result into the low bits */
+    denorm.u = ((127 - 15) + (23 - 10) + 1) << 23;
+    bits.f += denorm.f;
+    half = bits.u - denorm.u;
+  } else {
+    guint32 odd = (bits.u >> 13) & 1;
+
+    bits.u += ((guint32) (15 - 127) << 23) + 0xfff + odd;
+    half = bits.u >> 13;
+  }
+
+  return half | (sign >> 16);
+}
+
+static void
+gst_half_row_scalar (const gfloat * src, guint16 * dst, gint count)
+{
+  gint j;
+
+  for (j = 0; j < count; ++j) {
+    dst[j] = gst_float_to_half (src[j]);
+  }
+}
+
+/* Fills the per output slot means and standard deviations, so that the
+ * value written at dst[k] uses slot_mean[k % 3] and slot_std[k % 3]
+ */
+static void
+gst_means_std_get_slots (const GstMeansStdParams * params,
+    gdouble slot_mean[MEANS_STD_CHANNELS], gdouble slot_std[MEANS_STD_CHANNELS])
+{
+  const gint slots[MEANS_STD_CHANNELS] =
+      { params->first_index, 1, params->last_index };
+  gint c;
+
+  for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+    slot_mean[slots[c]] = params->mean[c];
+    slot_std[slots[c]] = params->std[c];
+  }
+}
+
+#ifdef GST_INFERENCE_PREPROCESS_X86
+/* Builds a byte shuffle that turns 4 input pixels into 12 bytes that are
+ * already in output order, dropping the padding or alpha channel
+ */
+static void
+gst_means_std_get_shuffle (const GstMeansStdParams * params, guint8 mask[16])
+{
+  const gint slots[MEANS_STD_CHANNELS] =
+      { params->first_index, 1, params->last_index };
+  gint p, c;
+
+  memset (mask, 0x80, 16);
+  for (p = 0; p < 4; ++p) {
+    for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+      mask[p * MEANS_STD_CHANNELS + slots[c]] =
+          p * params->channels + c + params->offset;
+    }
+  }
+}
+
+/* Builds a byte shuffle that groups 4 input pixels by output plane, so
+ * bytes 4 * k to 4 * k + 3 hold the 4 values written to plane k
+ */
+static void
+gst_means_std_get_planar_shuffle (const GstMeansStdParams * params,
+    guint8 mask[16])
+{
+  const gint slots[MEANS_STD_CHANNELS] =
+      { params->first_index, 1, params->last_index };
+  gint p, c;
+
+  memset (mask, 0x80, 16);
+  for (p = 0; p < 4; ++p) {
+    for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+      mask[slots[c] * 4 + p] = p * params->channels + c + params->offset;
+    }
+  }
+}
+
+#define SSE41_CONVERT_QUAD(bytes, dst, q)                                 \
+  G_STMT_START {                                                          \
+    __m128i i32 = _mm_cvtepu8_epi32 (_mm_srli_si128 ((bytes), 4 * (q)));  \
+    __m128d lo = _mm_cvtepi32_pd (i32);                                   \
+    __m128d hi = _mm_cvtepi32_pd (_mm_unpackhi_epi64 (i32, i32));         \
+    lo = _mm_mul_pd (_mm_sub_pd (lo, mean[2 * (q)]), std[2 * (q)]);       \
+    hi = _mm_mul_pd (_mm_sub_pd (hi, mean[2 * (q) + 1]),                  \
+        std[2 * (q) + 1]);                                                \
+    _mm_storeu_ps ((dst) + 4 * (q),                                       \
+        _mm_movelh_ps (_mm_cvtpd_ps (lo), _mm_cvtpd_ps (hi)));            \
+  } G_STMT_END
+
+__attribute__ ((target ("sse4.1")))
+static void
+gst_means_std_row_sse41 (const guchar * src, gfloat * dst, gint width,
+    const GstMeansStdParams * params)
+{
+  gdouble slot_mean[MEANS_STD_CHANNELS], slot_std[MEANS_STD_CHANNELS];
+  guint8 mask_bytes[16];
+  __m128d mean[6], std[6];
+  __m128i mask;
+  gint j, k;
+  const gint channels = params->channels;
+  const gint row_bytes = width * channels;
+
+  gst_means_std_get_slots (params, slot_mean, slot_std);
+  gst_means_std_get_shuffle (params, mask_bytes);
+  mask = _mm_loadu_si128 ((const __m128i *) mask_bytes);
+
+  /* 12 consecutive output values cover 6 pairs of doubles */
+  for (k = 0; k < 6; ++k) {
+    mean[k] = _mm_setr_pd (slot_mean[(2 * k) % 3], slot_mean[(2 * k + 1) % 3]);
+    std[k] = _mm_setr_pd (slot_std[(2 * k) % 3], slot_std[(2 * k + 1) % 3]);
+  }
+
+  /* Every iteration loads 16 bytes and consumes 4 pixels */
+  for (j = 0; j * channels + 16 <= row_bytes; j += 4) {
+    __m128i bytes = _mm_loadu_si128 ((const __m128i *) (src + j * channels));
+    gfloat *out = dst + j * MEANS_STD_CHANNELS;
+
+    bytes = _mm_shuffle_epi8 (bytes, mask);
+    SSE41_CONVERT_QUAD (bytes, out, 0);
+    SSE41_CONVERT_QUAD (bytes, out, 1);
+    SSE41_CONVERT_QUAD (bytes, out, 2);
+  }
+
+  gst_means_std_row_scalar (src + j * channels, dst + j * MEANS_STD_CHANNELS,
+      width - j, params);
+}
+
+#undef SSE41_CONVERT_QUAD
+
+#define SSE41_CONVERT_PLANE(bytes, dst, k)                                \
+  G_STMT_START {                                                          \
+    __m128i i32 = _mm_cvtepu8_epi32 (_mm_srli_si128 ((bytes), 4 * (k)));  \
+    __m128d lo = _mm_cvtepi32_pd (i32);                                   \
+    __m128d hi = _mm_cvtepi32_pd (_mm_unpackhi_epi64 (i32, i32));         \
+    lo = _mm_mul_pd (_mm_sub_pd (lo, mean[(k)]), std[(k)]);               \
+    hi = _mm_mul_pd (_mm_sub_pd (hi, mean[(k)]), std[(k)]);               \
+    _mm_storeu_ps ((dst) + (k) * plane_stride,                            \
+        _mm_movelh_ps (_mm_cvtpd_ps (lo), _mm_cvtpd_ps (hi)));            \
+  } G_STMT_END
+
+__attribute__ ((target ("sse4.1")))
+static void
+gst_means_std_row_planar_sse41 (const guchar * src, gfloat * dst, gint width,
+    const GstMeansStdParams * params)
+{
+  gdouble slot_mean[MEANS_STD_CHANNELS], slot_std[MEANS_STD_CHANNELS];
+  guint8 mask_bytes[16];
+  __m128d mean[MEANS_STD_CHANNELS], std[MEANS_STD_CHANNELS];
+  __m128i mask;
+  gint j, k;
+  const gint channels = params->channels;
+  const gint row_bytes = width * channels;
+  const gint plane_stride = params->plane_stride;
+
+  gst_means_std_get_slots (params, slot_mean, slot_std);
+  gst_means_std_get_planar_shuffle (params, mask_bytes);
+  mask = _mm_loadu_si128 ((const __m128i *) mask_bytes);
+
+  for (k = 0; k < MEANS_STD_CHANNELS; ++k) {
+    mean[k] = _mm_set1_pd (slot_mean[k]);
+    std[k] = _mm_set1_pd (slot_std[k]);
+  }
+
+  /* Every iteration loads 16 bytes and consumes 4 pixels */
+  for (j = 0; j * channels + 16 <= row_bytes; j += 4) {
+    __m128i bytes = _mm_loadu_si128 ((const __m128i *) (src + j * channels));
+
+    bytes = _mm_shuffle_epi8 (bytes, mask);
+    SSE41_CONVERT_PLANE (bytes, dst + j, 0);
+    SSE41_CONVERT_PLANE (bytes, dst + j, 1);
+    SSE41_CONVERT_PLANE (bytes, dst + j, 2);
+  }
+
+  gst_means_std_row_planar_scalar (src + j * channels, dst + j, width - j,
+      params);
+}
+
+#undef SSE41_CONVERT_PLANE
+
+#define AVX2_CONVERT_QUAD(bytes, dst, q)                                  \
+  G_STMT_START {                                                          \
+    __m256d v = _mm256_cvtepi32_pd (                                      \
+        _mm_cvtepu8_epi32 (_mm_srli_si128 ((bytes), 4 * (q))));           \
+    v = _mm256_mul_pd (_mm256_sub_pd (v, mean[(q)]), std[(q)]);           \
+    _mm_storeu_ps ((dst) + 4 * (q), _mm256_cvtpd_ps (v));                 \
+  } G_STMT_END
+
+__attribute__ ((target ("avx2")))
+static void
+gst_means_std_row_avx2 (const guchar * src, gfloat * dst, gint width,
+    const GstMeansStdParams * params)
+{
+  gdouble slot_mean[MEANS_STD_CHANNELS], slot_std[MEANS_STD_CHANNELS];
+  guint8 mask_bytes[16];
+  __m256d mean[3], std[3];
+  __m128i mask;
+  gint j, k;
+  const gint channels = params->channels;
+  const gint row_bytes = width * channels;
+
+  gst_means_std_get_slots (params, slot_mean, slot_std);
+  gst_means_std_get_shuffle (params, mask_bytes);
+  mask = _mm_loadu_si128 ((const __m128i *) mask_bytes);
+
+  /* 12 consecutive output values cover 3 quads of doubles */
+  for (k = 0; k < 3; ++k) {
+    mean[k] = _mm256_setr_pd (slot_mean[(4 * k) % 3],
+        slot_mean[(4 * k + 1) % 3], slot_mean[(4 * k + 2) % 3],
+        slot_mean[(4 * k + 3) % 3]);
+    std[k] = _mm256_setr_pd (slot_std[(4 * k) % 3],
+        slot_std[(4 * k + 1) % 3], slot_std[(4 * k + 2) % 3],
+        slot_std[(4 * k + 3) % 3]);
+  }
+
+  /* Every iteration loads two 16 byte blocks and consumes 8 pixels */
+  for (j = 0; (j + 4) * channels + 16 <= row_bytes; j += 8) {
+    const guchar *in = src + j * channels;
+    gfloat *out = dst + j * MEANS_STD_CHANNELS;
+    __m128i first = _mm_loadu_si128 ((const __m128i *) in);
+    __m128i second = _mm_loadu_si128 ((const __m128i *) (in + 4 * channels));
+
+    first = _mm_shuffle_epi8 (first, mask);
+    second = _mm_shuffle_epi8 (second, mask);
+    AVX2_CONVERT_QUAD (first, out, 0);
+    AVX2_CONVERT_QUAD (first, out, 1);
+    AVX2_CONVERT_QUAD (first, out, 2);
+    out += 4 * MEANS_STD_CHANNELS;
+    AVX2_CONVERT_QUAD (second, out, 0);
+    AVX2_CONVERT_QUAD (second, out, 1);
+    AVX2_CONVERT_QUAD (second, out, 2);
+  }
+
+  gst_means_std_row_scalar (src + j * channels, dst + j * MEANS_STD_CHANNELS,
+      width - j, params);
+}
+
+#undef AVX2_CONVERT_QUAD
+
+#define AVX2_CONVERT_PLANE(bytes, dst, k)                                 \
+  G_STMT_START {                                                          \
+    __m256d v = _mm256_cvtepi32_pd (                                      \
+        _mm_cvtepu8_epi32 (_mm_srli_si128 ((bytes), 4 * (k))));           \
+    v = _mm256_mul_pd (_mm256_sub_pd (v, mean[(k)]), std[(k)]);           \
+    _mm_storeu_ps ((dst) + (k) * plane_stride, _mm256_cvtpd_ps (v));      \
+  } G_STMT_END
+
+__attribute__ ((target ("avx2")))
+static void
+gst_means_std_row_planar_avx2 (const guchar * src, gfloat * dst, gint width,
+    const GstMeansStdParams * params)
+{
+  gdouble slot_mean[MEANS_STD_CHANNELS], slot_std[MEANS_STD_CHANNELS];
+  guint8 mask_bytes[16];
+  __m256d mean[MEANS_STD_CHANNELS], std[MEANS_STD_CHANNELS];
+  __m128i mask;
+  gint j, k;
+  const gint channels = params->channels;
+  const gint row_bytes = width * channels;
+  const gint plane_stride = params->plane_stride;
+
+  gst_means_std_get_slots (params, slot_mean, slot_std);
+  gst_means_std_get_planar_shuffle (params, mask_bytes);
+  mask = _mm_loadu_si128 ((const __m128i *) mask_bytes);
+
+  for (k = 0; k < MEANS_STD_CHANNELS; ++k) {
+    mean[k] = _mm256_set1_pd (slot_mean[k]);
+    std[k] = _mm256_set1_pd (slot_std[k]);
+  }
+
+  /* Every iteration loads two 16 byte blocks and consumes 8 pixels */
+  for (j = 0; (j + 4) * channels + 16 <= row_bytes; j += 8) {
+    const guchar *in = src + j * channels;
+    __m128i first = _mm_loadu_si128 ((const __m128i *) in);
+    __m128i second = _mm_loadu_si128 ((const __m128i *) (in + 4 * channels));
+
+    first = _mm_shuffle_epi8 (first, mask);
+    second = _mm_shuffle_epi8 (second, mask);
+    AVX2_CONVERT_PLANE (first, dst + j, 0);
+    AVX2_CONVERT_PLANE (first, dst + j, 1);
+    AVX2_CONVERT_PLANE (first, dst + j, 2);
+    AVX2_CONVERT_PLANE (second, dst + j + 4, 0);
+    AVX2_CONVERT_PLANE (second, dst + j + 4, 1);
+    AVX2_CONVERT_PLANE (second, dst + j + 4, 2);
+  }
+
+  gst_means_std_row_planar_scalar (src + j * channels, dst + j, width - j,
+      params);
+}
+
+#undef AVX2_CONVERT_PLANE
+
+__attribute__ ((target ("sse4.1")))
+static void
+gst_gray_row_sse41 (const guchar * src, gfloat * dst, gint width,
+    gdouble rcp_mean, gdouble offset)
+{
+  const __m128d scale = _mm_set1_pd (rcp_mean);
+  const __m128d shift = _mm_set1_pd (offset);
+  gint j;
+
+  for (j = 0; j + 4 <= width; j += 4) {
+    gint32 quad;
+    __m128i i32;
+    __m128d lo, hi;
+
+    memcpy (&quad, src + j, sizeof (quad));
+    i32 = _mm_cvtepu8_epi32 (_mm_cvtsi32_si128 (quad));
+    lo = _mm_cvtepi32_pd (i32);
+    hi = _mm_cvtepi32_pd (_mm_unpackhi_epi64 (i32, i32));
+    lo = _mm_sub_pd (_mm_mul_pd (lo, scale), shift);
+    hi = _mm_sub_pd (_mm_mul_pd (hi, scale), shift);
+    _mm_storeu_ps (dst + j,
+        _mm_movelh_ps (_mm_cvtpd_ps (lo), _mm_cvtpd_ps (hi)));
+  }
+
+  gst_gray_row_scalar (src + j, dst + j, width - j, rcp_mean, offset);
+}
+
+__attribute__ ((target ("avx2")))
+static void
+gst_gray_row_avx2 (const guchar * src, gfloat * dst, gint width,
+    gdouble rcp_mean, gdouble offset)
+{
+  const __m256d scale = _mm256_set1_pd (rcp_mean);
+  const __m256d shift = _mm256_set1_pd (offset);
+  gint j;
+
+  for (j = 0; j + 8 <= width; j += 8) {
+    __m128i bytes = _mm_loadl_epi64 ((const __m128i *) (src + j));
+    __m256d lo = _mm256_cvtepi32_pd (_mm_cvtepu8_epi32 (bytes));
+    __m256d hi =
+        _mm256_cvtepi32_pd (_mm_cvtepu8_epi32 (_mm_srli_si128 (bytes, 4)));
+
+    lo = _mm256_sub_pd (_mm256_mul_pd (lo, scale), shift);
+    hi = _mm256_sub_pd (_mm256_mul_pd (hi, scale), shift);
+    _mm_storeu_ps (dst + j, _mm256_cvtpd_ps (lo));
+    _mm_storeu_ps (dst + j + 4, _mm256_cvtpd_ps (hi));
+  }
+
+  gst_gray_row_scalar (src + j, dst + j, width - j, rcp_mean, offset);
+}
+
+/* Only chosen if the CPU reports F16C besides AVX2 */
+__attribute__ ((target ("avx2,f16c")))
+static void
+gst_half_row_avx2 (const gfloat * src, guint16 * dst, gint count)
+{
+  gint j;
+
+  for (j = 0; j + 8 <= count; j += 8) {
+    _mm_storeu_si128 ((__m128i *) (dst + j),
+        _mm256_cvtps_ph (_mm256_loadu_ps (src + j), _MM_FROUND_TO_NEAREST_INT));
+  }
+
+  gst_half_row_scalar (src + j, dst + j, count - j);
+}
+#endif /* GST_INFERENCE_PREPROCESS_X86 */
+
+#ifdef GST_INFERENCE_PREPROCESS_NEON
+/* The structure load and store intrinsics return aggregates */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Waggregate-return"
+
+static inline float32x4_t
+gst_neon_means_std_quad (uint16x4_t values, float64x2_t mean, float64x2_t std)
+{
+  uint32x4_t wide = vmovl_u16 (values);
+  float64x2_t lo = vcvtq_f64_u64 (vmovl_u32 (vget_low_u32 (wide)));
+  float64x2_t hi = vcvtq_f64_u64 (vmovl_u32 (vget_high_u32 (wide)));
+
+  lo = vmulq_f64 (vsubq_f64 (lo, mean), std);
+  hi = vmulq_f64 (vsubq_f64 (hi, mean), std);
+
+  return vcvt_high_f32_f64 (vcvt_f32_f64 (lo), hi);
+}
+
+static void
+gst_means_std_row_neon (const guchar * src, gfloat * dst, gint width,
+    const GstMeansStdParams * params)
+{
+  const gint slots[MEANS_STD_CHANNELS] =
+      { params->first_index, 1, params->last_index };
+  float64x2_t mean[MEANS_STD_CHANNELS], std[MEANS_STD_CHANNELS];
+  gint j, c, q;
+
+  for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+    mean[c] = vdupq_n_f64 (params->mean[c]);
+    std[c] = vdupq_n_f64 (params->std[c]);
+  }
+
+  /* Every iteration deinterleaves and consumes 16 pixels */
+  for (j = 0; j + 16 <= width; j += 16) {
+    uint8x16_t planes[MEANS_STD_CHANNELS];
+    gfloat *out = dst + j * MEANS_STD_CHANNELS;
+
+    if (4 == params->channels) {
+      uint8x16x4_t in = vld4q_u8 (src + j * 4);
+      for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+        planes[c] = in.val[c + params->offset];
+      }
+    } else {
+      uint8x16x3_t in = vld3q_u8 (src + j * 3);
+      for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+        planes[c] = in.val[c];
+      }
+    }
+
+    for (q = 0; q < 4; ++q) {
+      float32x4x3_t values;
+
+      for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+        uint16x8_t half = q < 2 ? vmovl_u8 (vget_low_u8 (planes[c])) :
+            vmovl_u8 (vget_high_u8 (planes[c]));
+        uint16x4_t quad = q % 2 ? vget_high_u16 (half) : vget_low_u16 (half);
+
+        values.val[slots[c]] = gst_neon_means_std_quad (quad, mean[c], std[c]);
+      }
+      vst3q_f32 (out + 4 * q * MEANS_STD_CHANNELS, values);
+    }
+  }
+
+  gst_means_std_row_scalar (src + j * params->channels,
+      dst + j * MEANS_STD_CHANNELS, width - j, params);
+}
+
+static void
+gst_means_std_row_planar_neon (const guchar * src, gfloat * dst, gint width,
+    const GstMeansStdParams * params)
+{
+  const gint slots[MEANS_STD_CHANNELS] =
+      { params->first_index, 1, params->last_index };
+  float64x2_t mean[MEANS_STD_CHANNELS], std[MEANS_STD_CHANNELS];
+  gint j, c, q;
+
+  for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+    mean[c] = vdupq_n_f64 (params->mean[c]);
+    std[c] = vdupq_n_f64 (params->std[c]);
+  }
+
+  /* Every iteration deinterleaves and consumes 16 pixels */
+  for (j = 0; j + 16 <= width; j += 16) {
+    uint8x16_t planes[MEANS_STD_CHANNELS];
+
+    if (4 == params->channels) {
+      uint8x16x4_t in = vld4q_u8 (src + j * 4);
+      for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+        planes[c] = in.val[c + params->offset];
+      }
+    } else {
+      uint8x16x3_t in = vld3q_u8 (src + j * 3);
+      for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+        planes[c] = in.val[c];
+      }
+    }
+
+    for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+      gfloat *out = dst + slots[c] * params->plane_stride + j;
+
+      for (q = 0; q < 4; ++q) {
+        uint16x8_t half = q < 2 ? vmovl_u8 (vget_low_u8 (planes[c])) :
+            vmovl_u8 (vget_high_u8 (planes[c]));
+        uint16x4_t quad = q % 2 ? vget_high_u16 (half) : vget_low_u16 (half);
+
+        vst1q_f32 (out + 4 * q,
+            gst_neon_means_std_quad (quad, mean[c], std[c]));
+      }
+    }
+  }
+
+  gst_means_std_row_planar_scalar (src + j * params->channels, dst + j,
+      width - j, params);
+}
+
+static void
+gst_gray_row_neon (const guchar * src, gfloat * dst, gint width,
+    gdouble rcp_mean, gdouble offset)
+{
+  const float64x2_t scale = vdupq_n_f64 (rcp_mean);
+  const float64x2_t shift = vdupq_n_f64 (offset);
+  gint j, q;
+
+  for (j = 0; j + 8 <= width; j += 8) {
+    uint16x8_t half = vmovl_u8 (vld1_u8 (src + j));
+
+    for (q = 0; q < 2; ++q) {
+      uint32x4_t wide =
+          vmovl_u16 (q ? vget_high_u16 (half) : vget_low_u16 (half));
+      float64x2_t lo = vcvtq_f64_u64 (vmovl_u32 (vget_low_u32 (wide)));
+      float64x2_t hi = vcvtq_f64_u64 (vmovl_u32 (vget_high_u32 (wide)));
+
+      lo = vsubq_f64 (vmulq_f64 (lo, scale), shift);
+      hi = vsubq_f64 (vmulq_f64 (hi, scale), shift);
+      vst1q_f32 (dst + j + 4 * q,
+          vcvt_high_f32_f64 (vcvt_f32_f64 (lo), hi));
+    }
+  }
+
+  gst_gray_row_scalar (src + j, dst + j, width - j, rcp_mean, offset);
+}
+
+static void
+gst_half_row_neon (const gfloat * src, guint16 * dst, gint count)
+{
+  gint j;
+
+  for (j = 0; j + 4 <= count; j += 4) {
+    vst1_u16 (dst + j,
+        vreinterpret_u16_f16 (vcvt_f16_f32 (vld1q_f32 (src + j))));
+  }
+
+  gst_half_row_scalar (src + j, dst + j, count - j);
+}
+
+#pragma GCC diagnostic pop
+#endif /* GST_INFERENCE_PREPROCESS_NEON */
+
+static GstInferencePreprocessImpl
+gst_inference_preprocess_detect_impl (void)
+{
+#ifdef GST_INFERENCE_PREPROCESS_X86
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2")) {
+    return GST_INFERENCE_PREPROCESS_IMPL_AVX2;
+  }
+  if (__builtin_cpu_supports ("sse4.1")) {
+    return GST_INFERENCE_PREPROCESS_IMPL_SSE4_1;
+  }
+#elif defined(GST_INFERENCE_PREPROCESS_NEON)
+  return GST_INFERENCE_PREPROCESS_IMPL_NEON;
+#endif
+  return GST_INFERENCE_PREPROCESS_IMPL_SCALAR;
+}
+
+gboolean
+gst_inference_preprocess_impl_supported (GstInferencePreprocessImpl impl)
+{
+  static gsize detected = 0;
+  GstInferencePreprocessImpl best;
+
+  if (g_once_init_enter (&detected)) {
+    g_once_init_leave (&detected, gst_inference_preprocess_detect_impl () + 1);
+  }
+  best = (GstInferencePreprocessImpl) (detected - 1);
+
+  switch (impl) {
+    case GST_INFERENCE_PREPROCESS_IMPL_AUTO:
+    case GST_INFERENCE_PREPROCESS_IMPL_SCALAR:
+      return TRUE;
+    case GST_INFERENCE_PREPROCESS_IMPL_SSE4_1:
+      return GST_INFERENCE_PREPROCESS_IMPL_SSE4_1 == best
+          || GST_INFERENCE_PREPROCESS_IMPL_AVX2 == best;
+    case GST_INFERENCE_PREPROCESS_IMPL_AVX2:
+    case GST_INFERENCE_PREPROCESS_IMPL_NEON:
+      return impl == best;
+    default:
+      return FALSE;
+  }
+}
+
+gboolean
+gst_inference_preprocess_set_impl (GstInferencePreprocessImpl impl)
+{
+  if (!gst_inference_preprocess_impl_supported (impl)) {
+    return FALSE;
+  }
+
+  g_atomic_int_set (&preprocess_impl, impl);
+  return TRUE;
+}
+
+GstInferencePreprocessImpl
+gst_inference_preprocess_get_impl (void)
+{
+  return (GstInferencePreprocessImpl) g_atomic_int_get (&preprocess_impl);
+}
+
+void
+gst_inference_preprocess_set_layout (GstInferenceTensorLayout layout)
+{
+  g_private_set (&current_layout, GINT_TO_POINTER (layout));
+}
+
+GstInferenceTensorLayout
+gst_inference_preprocess_get_layout (void)
+{
+  return (GstInferenceTensorLayout)
+      GPOINTER_TO_INT (g_private_get (&current_layout));
+}
+
+void
+gst_inference_preprocess_set_tensor_type (GstInferenceTensorType type,
+    gdouble scale, gint zero_point)
+{
+  GstTensorTypeParams *params = g_private_get (&current_tensor_type);
+
+  if (NULL == params) {
+    params = g_new (GstTensorTypeParams, 1);
+    g_private_set (&current_tensor_type, params);
+  }
+
+  params->type = type;
+  params->scale = scale;
+  params->zero_point = zero_point;
+}
+
+GstInferenceTensorType
+gst_inference_preprocess_get_tensor_type (gdouble * scale, gint * zero_point)
+{
+  GstTensorTypeParams *params = g_private_get (&current_tensor_type);
+
+  if (scale) {
+    *scale = params ? params->scale : 1;
+  }
+  if (zero_point) {
+    *zero_point = params ? params->zero_point : 0;
+  }
+
+  return params ? params->type : GST_INFERENCE_TENSOR_TYPE_FLOAT;
+}
+
+GstInferencePreprocessCache *
+gst_inference_preprocess_cache_new (GstInferencePreprocessLutMode mode)
+{
+  GstInferencePreprocessCache *cache = g_new0 (GstInferencePreprocessCache, 1);
+
+  g_mutex_init (&cache->mutex);
+  cache->mode = mode;
+
+  return cache;
+}
+
+void
+gst_inference_preprocess_cache_set_mode (GstInferencePreprocessCache * cache,
+    GstInferencePreprocessLutMode mode)
+{
+  g_return_if_fail (cache != NULL);
+
+  g_mutex_lock (&cache->mutex);
+  cache->mode = mode;
+  g_list_free_full (cache->entries, g_free);
+  cache->entries = NULL;
+  g_mutex_unlock (&cache->mutex);
+}
+
+void
+gst_inference_preprocess_cache_reset (GstInferencePreprocessCache * cache)
+{
+  g_return_if_fail (cache != NULL);
+
+  g_mutex_lock (&cache->mutex);
+  g_list_free_full (cache->entries, g_free);
+  cache->entries = NULL;
+  g_mutex_unlock (&cache->mutex);
+}
+
+void
+gst_inference_preprocess_cache_free (GstInferencePreprocessCache * cache)
+{
+  g_return_if_fail (cache != NULL);
+
+  gst_inference_preprocess_cache_reset (cache);
+  g_mutex_clear (&cache->mutex);
+  g_free (cache);
+}
+
+void
+gst_inference_preprocess_cache_set_current (GstInferencePreprocessCache *
+    cache)
+{
+  g_private_set (&current_cache, cache);
+}
+
+GstInferencePreprocessCache *
+gst_inference_preprocess_cache_get_current (void)
+{
+  return (GstInferencePreprocessCache *) g_private_get (&current_cache);
+}
+
+static GstInferencePreprocessImpl
+gst_inference_preprocess_current_impl (void)
+{
+  GstInferencePreprocessImpl impl = gst_inference_preprocess_get_impl ();
+
+  if (GST_INFERENCE_PREPROCESS_IMPL_AUTO != impl) {
+    return impl;
+  }
+
+  if (gst_inference_preprocess_impl_supported
+      (GST_INFERENCE_PREPROCESS_IMPL_AVX2)) {
+    return GST_INFERENCE_PREPROCESS_IMPL_AVX2;
+  }
+  if (gst_inference_preprocess_impl_supported
+      (GST_INFERENCE_PREPROCESS_IMPL_SSE4_1)) {
+    return GST_INFERENCE_PREPROCESS_IMPL_SSE4_1;
+  }
+  if (gst_inference_preprocess_impl_supported
+      (GST_INFERENCE_PREPROCESS_IMPL_NEON)) {
+    return GST_INFERENCE_PREPROCESS_IMPL_NEON;
+  }
+  return GST_INFERENCE_PREPROCESS_IMPL_SCALAR;
+}
+
+static GstMeansStdRowFunc
+gst_means_std_get_row_func (const GstMeansStdParams * params)
+{
+  /* Vector kernels only handle packed 3 or 4 byte pixels into RGB models */
+  if (MEANS_STD_CHANNELS != params->model_channels
+      || (3 != params->channels && 4 != params->channels)) {
+    return params->plane_stride ? gst_means_std_row_planar_scalar :
+        gst_means_std_row_scalar;
+  }
+
+  if (params->plane_stride) {
+    switch (gst_inference_preprocess_current_impl ()) {
+#ifdef GST_INFERENCE_PREPROCESS_X86
+      case GST_INFERENCE_PREPROCESS_IMPL_AVX2:
+        return gst_means_std_row_planar_avx2;
+      case GST_INFERENCE_PREPROCESS_IMPL_SSE4_1:
+        return gst_means_std_row_planar_sse41;
+#endif
+#ifdef GST_INFERENCE_PREPROCESS_NEON
+      case GST_INFERENCE_PREPROCESS_IMPL_NEON:
+        return gst_means_std_row_planar_neon;
+#endif
+      default:
+        return gst_means_std_row_planar_scalar;
+    }
+  }
+
+  switch (gst_inference_preprocess_current_impl ()) {
+#ifdef GST_INFERENCE_PREPROCESS_X86
+    case GST_INFERENCE_PREPROCESS_IMPL_AVX2:
+      return gst_means_std_row_avx2;
+    case GST_INFERENCE_PREPROCESS_IMPL_SSE4_1:
+      return gst_means_std_row_sse41;
+#endif
+#ifdef GST_INFERENCE_PREPROCESS_NEON
+    case GST_INFERENCE_PREPROCESS_IMPL_NEON:
+      return gst_means_std_row_neon;
+#endif
+    default:
+      return gst_means_std_row_scalar;
+  }
+}
+
+static GstGrayRowFunc
+gst_gray_get_row_func (void)
+{
+  switch (gst_inference_preprocess_current_impl ()) {
+#ifdef GST_INFERENCE_PREPROCESS_X86
+    case GST_INFERENCE_PREPROCESS_IMPL_AVX2:
+      return gst_gray_row_avx2;
+    case GST_INFERENCE_PREPROCESS_IMPL_SSE4_1:
+      return gst_gray_row_sse41;
+#endif
+#ifdef GST_INFERENCE_PREPROCESS_NEON
+    case GST_INFERENCE_PREPROCESS_IMPL_NEON:
+      return gst_gray_row_neon;
+#endif
+    default:
+      return gst_gray_row_scalar;
+  }
+}
+
+#ifdef GST_INFERENCE_PREPROCESS_X86
+static gboolean
+gst_half_f16c_supported (void)
+{
+  static gsize detected = 0;
+
+  if (g_once_init_enter (&detected)) {
+    __builtin_cpu_init ();
+    g_once_init_leave (&detected, __builtin_cpu_supports ("f16c") ? 2 : 1);
+  }
+
+  return 2 == detected;
+}
+#endif /* GST_INFERENCE_PREPROCESS_X86 */
+
+static GstHalfRowFunc
+gst_half_get_row_func (void)
+{
+  switch (gst_inference_preprocess_current_impl ()) {
+#ifdef GST_INFERENCE_PREPROCESS_X86
+    case GST_INFERENCE_PREPROCESS_IMPL_AVX2:
+      /* AVX2 alone doesn't guarantee the half conversions */
+      return gst_half_f16c_supported ()? gst_half_row_avx2 :
+          gst_half_row_scalar;
+#endif
+#ifdef GST_INFERENCE_PREPROCESS_NEON
+    case GST_INFERENCE_PREPROCESS_IMPL_NEON:
+      return gst_half_row_neon;
+#endif
+    default:
+      return gst_half_row_scalar;
+  }
+}
+
+void
+gst_inference_tensor_store (const gfloat * src, gint count, gpointer tensor,
+    gsize index, GstInferenceTensorType type, gdouble scale, gint zero_point)
+{
+  gdouble rcp_scale;
+  gint j;
+
+  g_return_if_fail (src != NULL);
+  g_return_if_fail (tensor != NULL);
+
+  switch (type) {
+    case GST_INFERENCE_TENSOR_TYPE_FP16:
+      gst_half_get_row_func () (src, (guint16 *) tensor + index, count);
+      break;
+    case GST_INFERENCE_TENSOR_TYPE_INT8:
+    {
+      gint8 *dst = (gint8 *) tensor + index;
+
+      rcp_scale = 1. / scale;
+      for (j = 0; j < count; ++j) {
+        gint value = (gint) floor (src[j] * rcp_scale + 0.5) + zero_point;
+
+        dst[j] = CLAMP (value, G_MININT8, G_MAXINT8);
+      }
+      break;
+    }
+    case GST_INFERENCE_TENSOR_TYPE_UINT8:
+    {
+      guint8 *dst = (guint8 *) tensor + index;
+
+      for (j = 0; j < count; ++j) {
+        gint value = (gint) floor (src[j] + 0.5);
+
+        dst[j] = CLAMP (value, 0, G_MAXUINT8);
+      }
+      break;
+    }
+    default:
+      memcpy ((gfloat *) tensor + index, src, count * sizeof (gfloat));
+      break;
+  }
+}
+
+static void
+gst_means_std_band (gpointer user_data, gint first_row, gint last_row)
+{
+  GstPreprocessJob *job = (GstPreprocessJob *) user_data;
+  GstMeansStdParams params;
+  gint channels;
+  gfloat *row;
+  gint i, p;
+
+  if (GST_INFERENCE_TENSOR_TYPE_FLOAT == job->tensor_type) {
+    for (i = first_row; i < last_row; ++i) {
+      job->means_std_func (job->src + i * job->src_stride,
+          job->dst + i * job->dst_stride, job->width, &job->params);
+    }
+    return;
+  }
+
+  /* Planar rows are written to the scratch row one plane after another */
+  params = job->params;
+  if (params.plane_stride) {
+    params.plane_stride = job->width;
+  }
+  channels = MAX (params.model_channels, MEANS_STD_CHANNELS);
+  row = g_new (gfloat, job->width * channels);
+
+  for (i = first_row; i < last_row; ++i) {
+    job->means_std_func (job->src + i * job->src_stride, row, job->width,
+        &params);
+
+    if (params.plane_stride) {
+      for (p = 0; p < MEANS_STD_CHANNELS; ++p) {
+        gst_inference_tensor_store (row + p * job->width, job->width,
+            job->tensor, p * job->params.plane_stride + i * job->dst_stride,
+            job->tensor_type, job->scale, job->zero_point);
+      }
+    } else {
+      gst_inference_tensor_store (row, job->width * params.model_channels,
+          job->tensor, i * job->dst_stride, job->tensor_type, job->scale,
+          job->zero_point);
+    }
+  }
+
+  g_free (row);
+}
+
+static gboolean
+gst_means_std_params_equal (const GstMeansStdParams * a,
+    const GstMeansStdParams * b)
+{
+  gint c;
+
+  if (a->channels != b->channels || a->offset != b->offset
+      || a->first_index != b->first_index || a->last_index != b->last_index
+      || a->model_channels != b->model_channels
+      || !a->plane_stride != !b->plane_stride) {
+    return FALSE;
+  }
+
+  for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+    if (a->mean[c] != b->mean[c] || a->std[c] != b->std[c]) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+static gint64
+gst_means_std_time_kernel (GstPreprocessJob * job, gint height)
+{
+  gint64 best = G_MAXINT64;
+  gint run;
+
+  for (run = 0; run < LUT_BENCHMARK_RUNS; ++run) {
+    gint64 start = g_get_monotonic_time ();
+
+    gst_means_std_band (job, 0, height);
+    best = MIN (best, g_get_monotonic_time () - start);
+  }
+
+  return best;
+}
+
+static GstPreprocessCacheEntry *
+gst_means_std_find_entry (GstInferencePreprocessCache * cache,
+    GstVideoFormat format, const GstMeansStdParams * params)
+{
+  GList *l;
+
+  for (l = cache->entries; l; l = l->next) {
+    GstPreprocessCacheEntry *candidate = (GstPreprocessCacheEntry *) l->data;
+
+    if (candidate->format == format
+        && gst_means_std_params_equal (&candidate->params, params)) {
+      return candidate;
+    }
+  }
+
+  return NULL;
+}
+
+/* Looks up the normalization in the current cache. The first frame of
+ * every new format builds its lookup table and times it against the
+ * vector kernel, the faster one is used from then on. Both produce the
+ * same values, so the benchmark output is a valid result. The timing
+ * runs without the cache lock, other threads keep their kernels.
+ */
+static void
+gst_means_std_select_lut (GstPreprocessJob * job, GstVideoFormat format,
+    gint height)
+{
+  GstInferencePreprocessCache *cache;
+  GstPreprocessCacheEntry *entry = NULL;
+  GstPreprocessCacheEntry *found = NULL;
+  GstInferencePreprocessLutMode mode;
+  GstMeansStdRowFunc kernel_func, lut_func;
+  gint64 kernel_time, lut_time;
+  gint c, v;
+
+  cache = gst_inference_preprocess_cache_get_current ();
+  if (NULL == cache) {
+    return;
+  }
+
+  /* The lookup table only covers packed 3 or 4 byte pixels */
+  if (MEANS_STD_CHANNELS > job->params.channels) {
+    return;
+  }
+
+  kernel_func = job->means_std_func;
+  lut_func = job->params.plane_stride ? gst_means_std_row_planar_lut :
+      gst_means_std_row_lut;
+
+  g_mutex_lock (&cache->mutex);
+  mode = cache->mode;
+  if (GST_INFERENCE_PREPROCESS_LUT_NEVER != mode) {
+    entry = gst_means_std_find_entry (cache, format, &job->params);
+  }
+  g_mutex_unlock (&cache->mutex);
+
+  if (GST_INFERENCE_PREPROCESS_LUT_NEVER == mode) {
+    return;
+  }
+
+  if (NULL == entry) {
+    entry = g_new (GstPreprocessCacheEntry, 1);
+    entry->format = format;
+    entry->params = job->params;
+    entry->params.lut = NULL;
+
+    for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+      for (v = 0; v < LUT_SIZE; ++v) {
+        entry->lut[c * LUT_SIZE + v] =
+            (v - job->params.mean[c]) * job->params.std[c];
+      }
+    }
+
+    if (GST_INFERENCE_PREPROCESS_LUT_ALWAYS == mode) {
+      entry->use_lut = TRUE;
+    } else {
+      kernel_time = gst_means_std_time_kernel (job, height);
+
+      job->params.lut = entry->lut;
+      job->means_std_func = lut_func;
+      lut_time = gst_means_std_time_kernel (job, height);
+
+      entry->use_lut = lut_time < kernel_time;
+      job->params.lut = NULL;
+      job->means_std_func = kernel_func;
+    }
+
+    /* Another thread may have timed the same format meanwhile */
+    g_mutex_lock (&cache->mutex);
+    found = gst_means_std_find_entry (cache, format, &job->params);
+    if (found) {
+      g_free (entry);
+      entry = found;
+    } else {
+      cache->entries = g_list_prepend (cache->entries, entry);
+    }
+    g_mutex_unlock (&cache->mutex);
+  }
+
+  if (entry->use_lut) {
+    job->params.lut = entry->lut;
+    job->means_std_func = lut_func;
+  }
+}
+
 static void
 gst_apply_means_std (GstVideoFrame * inframe, GstVideoFrame * outframe,
     gint first_index, gint last_index, gint offset, gint channels,
@@ -41,30 +1499,68 @@ gst_apply_means_std (GstVideoFrame * inframe, GstVideoFrame * outframe,
     const gdouble mean_blue, const gdouble std_r, const gdouble std_g,
     const gdouble std_b, const gint model_channels)
 {
-  gint i, j, pixel_stride, width, height;
+  GstInferencePreprocessPool *pool;
+  GstInferenceTensorLayout layout;
+  GstPreprocessJob job;
 
   g_return_if_fail (inframe != NULL);
   g_return_if_fail (outframe != NULL);
 
-  pixel_stride = GST_VIDEO_FRAME_COMP_STRIDE (inframe, 0) / channels;
-  width = GST_VIDEO_FRAME_WIDTH (inframe);
-  height = GST_VIDEO_FRAME_HEIGHT (inframe);
+  layout = gst_inference_preprocess_get_layout ();
+  job.params.mean[0] = mean_red;
+  job.params.mean[1] = mean_green;
+  job.params.mean[2] = mean_blue;
+  job.params.std[0] = std_r;
+  job.params.std[1] = std_g;
+  job.params.std[2] = std_b;
+
+  job.tensor = outframe->data[0];
+  job.tensor_type =
+      gst_inference_preprocess_get_tensor_type (&job.scale, &job.zero_point);
+  if (GST_INFERENCE_TENSOR_TYPE_UINT8 == job.tensor_type) {
+    gint c;
 
-  for (i = 0; i < height; ++i) {
-    for (j = 0; j < width; ++j) {
-      ((gfloat *) outframe->data[0])[(i * width + j) * model_channels +
-          first_index] =
-          (((guchar *) inframe->data[0])[(i * pixel_stride + j) * channels +
-              0 + offset] - mean_red) * std_r;
-      ((gfloat *) outframe->data[0])[(i * width + j) * model_channels + 1] =
-          (((guchar *) inframe->data[0])[(i * pixel_stride + j) * channels +
-              1 + offset] - mean_green) * std_g;
-      ((gfloat *) outframe->data[0])[(i * width + j) * model_channels +
-          last_index] =
-          (((guchar *) inframe->data[0])[(i * pixel_stride + j) * channels +
-              2 + offset] - mean_blue) * std_b;
+    for (c = 0; c < MEANS_STD_CHANNELS; ++c) {
+      job.params.mean[c] = 0;
+      job.params.std[c] = 1;
     }
   }
+
+  /* YUV frames are converted to RGB and normalized in the same pass, a
+   * same size bilinear resize only interpolates the subsampled chroma */
+  if (GST_VIDEO_INFO_IS_YUV (&inframe->info)) {
+    gst_inference_resize_normalize (inframe, outframe->data[0],
+        GST_VIDEO_FRAME_WIDTH (inframe), GST_VIDEO_FRAME_HEIGHT (inframe),
+        job.params.mean, job.params.std, GST_INFERENCE_RESIZE_METHOD_BILINEAR);
+    return;
+  }
+
+  job.params.channels = channels;
+  job.params.offset = offset;
+  job.params.first_index = first_index;
+  job.params.last_index = last_index;
+  job.params.model_channels = model_channels;
+
+  job.width = GST_VIDEO_FRAME_WIDTH (inframe);
+  job.src = (const guchar *) inframe->data[0];
+  job.src_stride = GST_VIDEO_FRAME_COMP_STRIDE (inframe, 0);
+  job.dst = (gfloat *) outframe->data[0];
+
+  if (GST_INFERENCE_TENSOR_LAYOUT_NCHW == layout) {
+    job.params.plane_stride = job.width * GST_VIDEO_FRAME_HEIGHT (inframe);
+    job.dst_stride = job.width;
+  } else {
+    job.params.plane_stride = 0;
+    job.dst_stride = job.width * model_channels;
+  }
+  job.params.lut = NULL;
+  job.means_std_func = gst_means_std_get_row_func (&job.params);
+  gst_means_std_select_lut (&job, GST_VIDEO_FRAME_FORMAT (inframe),
+      GST_VIDEO_FRAME_HEIGHT (inframe));
+
+  pool = gst_inference_preprocess_pool_get_current ();
+  gst_inference_preprocess_pool_run (pool, gst_means_std_band, &job,
+      GST_VIDEO_FRAME_HEIGHT (inframe), job.width);
 }
 
 static gboolean
@@ -110,6 +1606,13 @@ gst_configure_format_values (GstVideoFrame * inframe, gint * first_index,
       *last_index = 0;
       *offset = 0;
       break;
+    case GST_VIDEO_FORMAT_I420:
+    case GST_VIDEO_FORMAT_NV12:
+      /* Converted to RGB by gst_apply_means_std */
+      *first_index = 0;
+      *last_index = 2;
+      *offset = 0;
+      break;
     default:
       return FALSE;
       break;
@@ -189,25 +1692,62 @@ gst_normalize_gray_image (GstVideoFrame * inframe, GstVideoFrame * outframe,
   return TRUE;
 }
 
+static void
+gst_gray_band (gpointer user_data, gint first_row, gint last_row)
+{
+  GstPreprocessJob *job = (GstPreprocessJob *) user_data;
+  gfloat *row;
+  gint i;
+
+  if (GST_INFERENCE_TENSOR_TYPE_FLOAT == job->tensor_type) {
+    for (i = first_row; i < last_row; ++i) {
+      job->gray_func (job->src + i * job->src_stride,
+          job->dst + i * job->dst_stride, job->width, job->rcp_mean,
+          job->offset);
+    }
+    return;
+  }
+
+  row = g_new (gfloat, job->width);
+
+  for (i = first_row; i < last_row; ++i) {
+    job->gray_func (job->src + i * job->src_stride, row, job->width,
+        job->rcp_mean, job->offset);
+    gst_inference_tensor_store (row, job->width, job->tensor,
+        i * job->dst_stride, job->tensor_type, job->scale, job->zero_point);
+  }
+
+  g_free (row);
+}
+
 static void
 gst_apply_gray_normalization (GstVideoFrame * inframe, GstVideoFrame * outframe,
     gdouble mean, gdouble offset)
 {
-  gint i = 0, j = 0, pixel_stride = 0, width = 0, height = 0;
-  const gdouble rcp_mean = 1. / mean;
+  GstInferencePreprocessPool *pool;
+  GstPreprocessJob job;
 
   g_return_if_fail (inframe != NULL);
   g_return_if_fail (outframe != NULL);
 
-  pixel_stride = GST_VIDEO_FRAME_COMP_STRIDE (inframe, 0);
-  width = GST_VIDEO_FRAME_WIDTH (inframe);
-  height = GST_VIDEO_FRAME_HEIGHT (inframe);
+  job.width = GST_VIDEO_FRAME_WIDTH (inframe);
+  job.src = (const guchar *) inframe->data[0];
+  job.src_stride = GST_VIDEO_FRAME_COMP_STRIDE (inframe, 0);
+  job.dst = (gfloat *) outframe->data[0];
+  job.dst_stride = job.width;
+  job.rcp_mean = 1. / mean;
+  job.offset = offset;
+  job.gray_func = gst_gray_get_row_func ();
 
-  for (i = 0; i < height; ++i) {
-    for (j = 0; j < width; ++j) {
-      ((gfloat *) outframe->data[0])[(i * width + j)] =
-          (((guchar *) inframe->data[0])[(i * pixel_stride +
-                  j)] * rcp_mean - offset);
-    }
+  job.tensor = outframe->data[0];
+  job.tensor_type =
+      gst_inference_preprocess_get_tensor_type (&job.scale, &job.zero_point);
+  if (GST_INFERENCE_TENSOR_TYPE_UINT8 == job.tensor_type) {
+    job.rcp_mean = 1;
+    job.offset = 0;
   }
+
+  pool = gst_inference_preprocess_pool_get_current ();
+  gst_inference_preprocess_pool_run (pool, gst_gray_band, &job,
+      GST_VIDEO_FRAME_HEIGHT (inframe), job.width);
 }
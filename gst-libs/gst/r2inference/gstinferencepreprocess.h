@@ -26,6 +26,271 @@
 
 G_BEGIN_DECLS
 
+/**
+ * \brief Kernel implementations available for the preprocess functions
+ *
+ * The AUTO mode selects the fastest implementation supported by the
+ * running CPU. All implementations produce bit exact outputs.
+ */
+typedef enum
+{
+  GST_INFERENCE_PREPROCESS_IMPL_AUTO,
+  GST_INFERENCE_PREPROCESS_IMPL_SCALAR,
+  GST_INFERENCE_PREPROCESS_IMPL_SSE4_1,
+  GST_INFERENCE_PREPROCESS_IMPL_AVX2,
+  GST_INFERENCE_PREPROCESS_IMPL_NEON,
+} GstInferencePreprocessImpl;
+
+/**
+ * \brief Check if a kernel implementation can run on this CPU
+ *
+ * \param impl The implementation to check
+ */
+gboolean gst_inference_preprocess_impl_supported (GstInferencePreprocessImpl impl);
+
+/**
+ * \brief Force the kernel implementation used by the preprocess functions
+ *
+ * \param impl The implementation to use
+ * \return FALSE if the implementation is not supported by this CPU
+ */
+gboolean gst_inference_preprocess_set_impl (GstInferencePreprocessImpl impl);
+
+/**
+ * \brief Get the kernel implementation configured for the preprocess
+ * functions
+ */
+GstInferencePreprocessImpl gst_inference_preprocess_get_impl (void);
+
+/**
+ * \brief Memory layout of the tensor written by the preprocess functions
+ *
+ * NHWC interleaves the channels of every pixel, NCHW writes each channel
+ * as a separate plane. The backends receive the tensor as it is, the
+ * model must be built for the selected layout.
+ */
+typedef enum
+{
+  GST_INFERENCE_TENSOR_LAYOUT_NHWC,
+  GST_INFERENCE_TENSOR_LAYOUT_NCHW,
+} GstInferenceTensorLayout;
+
+#define GST_TYPE_INFERENCE_TENSOR_LAYOUT (gst_inference_tensor_layout_get_type ())
+GType gst_inference_tensor_layout_get_type (void);
+
+/**
+ * \brief Set the tensor layout written by the preprocess functions called
+ * from the current thread
+ *
+ * \param layout The layout to write, NHWC by default
+ */
+void gst_inference_preprocess_set_layout (GstInferenceTensorLayout layout);
+
+/**
+ * \brief Get the tensor layout written by the preprocess functions called
+ * from the current thread
+ */
+GstInferenceTensorLayout gst_inference_preprocess_get_layout (void);
+
+/**
+ * \brief Data type of the tensor written by the preprocess functions
+ *
+ * FP16 stores IEEE half floats. INT8 quantizes every normalized value
+ * as round (value / scale) + zero_point. UINT8 skips the normalization
+ * and stores the raw pixel values, for models that quantize their input
+ * internally.
+ */
+typedef enum
+{
+  GST_INFERENCE_TENSOR_TYPE_FLOAT,
+  GST_INFERENCE_TENSOR_TYPE_FP16,
+  GST_INFERENCE_TENSOR_TYPE_INT8,
+  GST_INFERENCE_TENSOR_TYPE_UINT8,
+} GstInferenceTensorType;
+
+#define GST_TYPE_INFERENCE_TENSOR_TYPE (gst_inference_tensor_type_get_type ())
+GType gst_inference_tensor_type_get_type (void);
+
+/**
+ * \brief Size in bytes of a single tensor element
+ *
+ * \param type The tensor data type
+ */
+gsize gst_inference_tensor_type_get_size (GstInferenceTensorType type);
+
+/**
+ * \brief Set the tensor data type written by the preprocess functions
+ * called from the current thread
+ *
+ * \param type The data type to write, FLOAT by default
+ * \param scale The quantization scale, only used by INT8
+ * \param zero_point The quantization zero point, only used by INT8
+ */
+void gst_inference_preprocess_set_tensor_type (GstInferenceTensorType type,
+    gdouble scale, gint zero_point);
+
+/**
+ * \brief Get the tensor data type written by the preprocess functions
+ * called from the current thread
+ *
+ * \param scale Return location for the quantization scale, or NULL
+ * \param zero_point Return location for the quantization zero point,
+ * or NULL
+ */
+GstInferenceTensorType gst_inference_preprocess_get_tensor_type (gdouble *
+    scale, gint * zero_point);
+
+/**
+ * \brief Convert float values and store them in a tensor
+ *
+ * \param src The values to store
+ * \param count The number of values to store
+ * \param tensor The tensor to write
+ * \param index The position of the first value in the tensor, in elements
+ * \param type The tensor data type
+ * \param scale The quantization scale, only used by INT8
+ * \param zero_point The quantization zero point, only used by INT8
+ */
+void gst_inference_tensor_store (const gfloat * src, gint count,
+    gpointer tensor, gsize index, GstInferenceTensorType type, gdouble scale,
+    gint zero_point);
+
+#define GST_INFERENCE_TENSOR_DIMS 4
+
+/**
+ * \brief Description of the tensor written for a video frame
+ *
+ * The shape and strides follow the tensor layout, NHWC or NCHW, with
+ * the batch dimension first. Strides are in bytes. The format holds the
+ * channel order seen by the backend: RGB, BGR or GRAY8.
+ */
+typedef struct _GstInferenceTensorInfo
+{
+  GstInferenceTensorType type;
+  GstInferenceTensorLayout layout;
+  GstVideoFormat format;
+  gsize shape[GST_INFERENCE_TENSOR_DIMS];
+  gsize strides[GST_INFERENCE_TENSOR_DIMS];
+  gsize size;
+} GstInferenceTensorInfo;
+
+/**
+ * \brief Describe the tensor the preprocess functions write for frames
+ * of the given video info
+ *
+ * \param info The tensor info to fill
+ * \param vinfo The video info of the input frames
+ * \param type The tensor data type
+ * \param layout The tensor layout
+ * \return FALSE if the video info has no size
+ */
+gboolean gst_inference_tensor_info_from_video_info (GstInferenceTensorInfo *
+    info, const GstVideoInfo * vinfo, GstInferenceTensorType type,
+    GstInferenceTensorLayout layout);
+
+/**
+ * \brief Get the spatial dimensions of a tensor
+ *
+ * \param info The tensor info
+ * \param width Return location for the width, or NULL
+ * \param height Return location for the height, or NULL
+ * \param channels Return location for the channels, or NULL
+ */
+void gst_inference_tensor_info_get_dims (const GstInferenceTensorInfo * info,
+    gint * width, gint * height, gint * channels);
+
+/**
+ * \brief Build a video info to map a tensor buffer as a video frame
+ *
+ * The video info has the tensor dimensions and format, a single plane
+ * and exactly the tensor size, so a tensor buffer can be mapped as
+ * the preprocess output frame.
+ *
+ * \param info The tensor info
+ * \param vinfo The video info to fill
+ */
+void gst_inference_tensor_info_to_video_info (const GstInferenceTensorInfo *
+    info, GstVideoInfo * vinfo);
+
+/**
+ * \brief Use of lookup tables to normalize 8 bit channels
+ *
+ * AUTO times the lookup table against the vector kernel on the first
+ * frame of every format and keeps the faster one. Both produce bit exact
+ * outputs.
+ */
+typedef enum
+{
+  GST_INFERENCE_PREPROCESS_LUT_AUTO,
+  GST_INFERENCE_PREPROCESS_LUT_ALWAYS,
+  GST_INFERENCE_PREPROCESS_LUT_NEVER,
+} GstInferencePreprocessLutMode;
+
+#define GST_TYPE_INFERENCE_PREPROCESS_LUT_MODE (gst_inference_preprocess_lut_mode_get_type ())
+GType gst_inference_preprocess_lut_mode_get_type (void);
+
+typedef struct _GstInferencePreprocessCache GstInferencePreprocessCache;
+
+/**
+ * \brief Create a cache of normalization lookup tables
+ *
+ * Every combination of format, mean and std seen by the preprocess
+ * functions gets its own table, built the first time it is used.
+ *
+ * \param mode When to use the lookup tables
+ */
+GstInferencePreprocessCache *gst_inference_preprocess_cache_new
+    (GstInferencePreprocessLutMode mode);
+
+/**
+ * \brief Change when the cache uses the lookup tables
+ *
+ * The tables already built are dropped.
+ *
+ * \param cache The cache to update
+ * \param mode When to use the lookup tables
+ */
+void gst_inference_preprocess_cache_set_mode (GstInferencePreprocessCache *
+    cache, GstInferencePreprocessLutMode mode);
+
+/**
+ * \brief Drop all the tables in the cache, typically on a caps change
+ *
+ * \param cache The cache to reset
+ */
+void gst_inference_preprocess_cache_reset (GstInferencePreprocessCache *
+    cache);
+
+/**
+ * \brief Free the cache and all its tables
+ *
+ * \param cache The cache to free
+ */
+void gst_inference_preprocess_cache_free (GstInferencePreprocessCache *
+    cache);
+
+/**
+ * \brief Set the cache used by the preprocess functions called from the
+ * current thread
+ *
+ * \param cache The cache to use, or NULL to never use lookup tables
+ */
+void gst_inference_preprocess_cache_set_current (GstInferencePreprocessCache *
+    cache);
+
+/**
+ * \brief Get the cache used by the preprocess functions called from the
+ * current thread
+ */
+GstInferencePreprocessCache *gst_inference_preprocess_cache_get_current
+    (void);
+
+/*
+ * The RGB preprocess functions below also accept I420 and NV12 frames.
+ * Those are converted to RGB in the same pass that applies the mean and
+ * std, so the model receives the channels in RGB order.
+ */
+
 /**
  * \brief Normalization with values between 0 and 1
  *
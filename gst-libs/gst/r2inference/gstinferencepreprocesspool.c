@@ -0,0 +1,229 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "gstinferencepreprocesspool.h"
+
+/* Smallest band worth handing off to another thread, in pixels */
+#define MIN_BAND_PIXELS 8192
+
+struct _GstInferencePreprocessPool
+{
+  GThread **workers;
+  guint n_workers;
+
+  GMutex mutex;
+  GCond work_cond;
+  GCond done_cond;
+  guint generation;
+  gboolean quit;
+
+  /* Current job, only modified while no worker is active */
+  GstInferencePreprocessPoolFunc func;
+  gpointer user_data;
+  gint n_rows;
+  gint n_bands;
+
+  gint next_band;
+  gint pending_bands;
+  gint active_workers;
+};
+
+static GPrivate current_pool = G_PRIVATE_INIT (NULL);
+
+static void gst_inference_preprocess_pool_do_bands (GstInferencePreprocessPool *
+    pool, GstInferencePreprocessPoolFunc func, gpointer user_data, gint n_rows,
+    gint n_bands);
+static gpointer gst_inference_preprocess_pool_worker (gpointer data);
+
+static void
+gst_inference_preprocess_pool_do_bands (GstInferencePreprocessPool * pool,
+    GstInferencePreprocessPoolFunc func, gpointer user_data, gint n_rows,
+    gint n_bands)
+{
+  gint band;
+
+  while ((band = g_atomic_int_add (&pool->next_band, 1)) < n_bands) {
+    func (user_data, n_rows * band / n_bands, n_rows * (band + 1) / n_bands);
+
+    if (g_atomic_int_dec_and_test (&pool->pending_bands)) {
+      g_mutex_lock (&pool->mutex);
+      g_cond_broadcast (&pool->done_cond);
+      g_mutex_unlock (&pool->mutex);
+    }
+  }
+}
+
+static gpointer
+gst_inference_preprocess_pool_worker (gpointer data)
+{
+  GstInferencePreprocessPool *pool = (GstInferencePreprocessPool *) data;
+  guint seen = 0;
+
+  g_mutex_lock (&pool->mutex);
+  while (TRUE) {
+    GstInferencePreprocessPoolFunc func;
+    gpointer user_data;
+    gint n_rows, n_bands;
+
+    while (!pool->quit && seen == pool->generation) {
+      g_cond_wait (&pool->work_cond, &pool->mutex);
+    }
+    if (pool->quit) {
+      break;
+    }
+
+    seen = pool->generation;
+    func = pool->func;
+    user_data = pool->user_data;
+    n_rows = pool->n_rows;
+    n_bands = pool->n_bands;
+    pool->active_workers++;
+    g_mutex_unlock (&pool->mutex);
+
+    gst_inference_preprocess_pool_do_bands (pool, func, user_data, n_rows,
+        n_bands);
+
+    g_mutex_lock (&pool->mutex);
+    pool->active_workers--;
+    if (0 == pool->active_workers) {
+      g_cond_broadcast (&pool->done_cond);
+    }
+  }
+  g_mutex_unlock (&pool->mutex);
+
+  return NULL;
+}
+
+GstInferencePreprocessPool *
+gst_inference_preprocess_pool_new (guint n_threads)
+{
+  GstInferencePreprocessPool *pool;
+  guint i;
+
+  g_return_val_if_fail (n_threads > 0, NULL);
+
+  pool = g_new0 (GstInferencePreprocessPool, 1);
+  g_mutex_init (&pool->mutex);
+  g_cond_init (&pool->work_cond);
+  g_cond_init (&pool->done_cond);
+
+  /* The caller of gst_inference_preprocess_pool_run is one more worker */
+  pool->n_workers = n_threads - 1;
+  pool->workers = g_new0 (GThread *, pool->n_workers);
+
+  for (i = 0; i < pool->n_workers; ++i) {
+    gchar *name = g_strdup_printf ("preprocess-%u", i);
+    pool->workers[i] =
+        g_thread_new (name, gst_inference_preprocess_pool_worker, pool);
+    g_free (name);
+  }
+
+  return pool;
+}
+
+void
+gst_inference_preprocess_pool_free (GstInferencePreprocessPool * pool)
+{
+  guint i;
+
+  g_return_if_fail (pool);
+
+  g_mutex_lock (&pool->mutex);
+  pool->quit = TRUE;
+  g_cond_broadcast (&pool->work_cond);
+  g_mutex_unlock (&pool->mutex);
+
+  for (i = 0; i < pool->n_workers; ++i) {
+    g_thread_join (pool->workers[i]);
+  }
+
+  g_free (pool->workers);
+  g_mutex_clear (&pool->mutex);
+  g_cond_clear (&pool->work_cond);
+  g_cond_clear (&pool->done_cond);
+  g_free (pool);
+}
+
+guint
+gst_inference_preprocess_pool_get_n_threads (GstInferencePreprocessPool * pool)
+{
+  g_return_val_if_fail (pool, 0);
+
+  return pool->n_workers + 1;
+}
+
+void
+gst_inference_preprocess_pool_run (GstInferencePreprocessPool * pool,
+    GstInferencePreprocessPoolFunc func, gpointer user_data, gint n_rows,
+    gint row_size)
+{
+  gint n_bands;
+
+  g_return_if_fail (func);
+
+  if (NULL == pool || 0 == pool->n_workers || n_rows <= 1) {
+    func (user_data, 0, n_rows);
+    return;
+  }
+
+  n_bands = ((gint64) n_rows * row_size) / MIN_BAND_PIXELS;
+  n_bands = CLAMP (n_bands, 1, MIN ((gint) pool->n_workers + 1, n_rows));
+  if (1 == n_bands) {
+    func (user_data, 0, n_rows);
+    return;
+  }
+
+  g_mutex_lock (&pool->mutex);
+  /* Workers late to the previous job still hold its parameters */
+  while (pool->active_workers > 0) {
+    g_cond_wait (&pool->done_cond, &pool->mutex);
+  }
+  pool->func = func;
+  pool->user_data = user_data;
+  pool->n_rows = n_rows;
+  pool->n_bands = n_bands;
+  g_atomic_int_set (&pool->next_band, 0);
+  g_atomic_int_set (&pool->pending_bands, n_bands);
+  pool->generation++;
+  g_cond_broadcast (&pool->work_cond);
+  g_mutex_unlock (&pool->mutex);
+
+  gst_inference_preprocess_pool_do_bands (pool, func, user_data, n_rows,
+      n_bands);
+
+  g_mutex_lock (&pool->mutex);
+  while (g_atomic_int_get (&pool->pending_bands) > 0) {
+    g_cond_wait (&pool->done_cond, &pool->mutex);
+  }
+  g_mutex_unlock (&pool->mutex);
+}
+
+void
+gst_inference_preprocess_pool_set_current (GstInferencePreprocessPool * pool)
+{
+  g_private_set (&current_pool, pool);
+}
+
+GstInferencePreprocessPool *
+gst_inference_preprocess_pool_get_current (void)
+{
+  return (GstInferencePreprocessPool *) g_private_get (&current_pool);
+}
@@ -0,0 +1,95 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef __GST_INFERENCE_PREPROCESS_POOL_H__
+#define __GST_INFERENCE_PREPROCESS_POOL_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstInferencePreprocessPool GstInferencePreprocessPool;
+
+/**
+ * \brief Function called by the pool to process a band of rows
+ *
+ * \param user_data The data passed to gst_inference_preprocess_pool_run
+ * \param first_row The first row of the band
+ * \param last_row One past the last row of the band
+ */
+typedef void (*GstInferencePreprocessPoolFunc) (gpointer user_data,
+    gint first_row, gint last_row);
+
+/**
+ * \brief Create a persistent pool to split preprocessing in row bands
+ *
+ * \param n_threads The total number of threads working on a frame,
+ * including the caller
+ */
+GstInferencePreprocessPool *gst_inference_preprocess_pool_new (guint n_threads);
+
+/**
+ * \brief Stop the pool workers and free the pool
+ *
+ * \param pool The pool to free
+ */
+void gst_inference_preprocess_pool_free (GstInferencePreprocessPool * pool);
+
+/**
+ * \brief Get the total number of threads working on a frame
+ *
+ * \param pool The pool to query
+ */
+guint gst_inference_preprocess_pool_get_n_threads (GstInferencePreprocessPool * pool);
+
+/**
+ * \brief Process n_rows in parallel bands and wait for all of them
+ *
+ * The calling thread processes bands as well. If pool is NULL or the
+ * image is too small to be split, func is called once for all rows.
+ *
+ * \param pool The pool to use, may be NULL
+ * \param func The function processing each band
+ * \param user_data The data passed to func
+ * \param n_rows The number of rows to process
+ * \param row_size The amount of pixels in a row, used to size the bands
+ */
+void gst_inference_preprocess_pool_run (GstInferencePreprocessPool * pool,
+    GstInferencePreprocessPoolFunc func, gpointer user_data, gint n_rows,
+    gint row_size);
+
+/**
+ * \brief Set the pool used by the preprocess functions called from the
+ * current thread
+ *
+ * \param pool The pool to use, or NULL to process in the calling thread
+ */
+void gst_inference_preprocess_pool_set_current (GstInferencePreprocessPool * pool);
+
+/**
+ * \brief Get the pool used by the preprocess functions called from the
+ * current thread
+ */
+GstInferencePreprocessPool *gst_inference_preprocess_pool_get_current (void);
+
+G_END_DECLS
+
+#endif
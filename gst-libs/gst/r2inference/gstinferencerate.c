@@ -0,0 +1,173 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+
+#include "gstinferencerate.h"
+
+/* Weight of the previous average when a new latency is accounted, out
+ * of LATENCY_WEIGHT + 1 */
+#define LATENCY_WEIGHT 7
+
+struct _GstInferenceRate
+{
+  GMutex mutex;
+  guint interval;
+  GstClockTime min_period;
+  gboolean adaptive;
+
+  guint64 frames;
+  guint64 skipped;
+  GstClockTime last_pts;
+  GstClockTime latency;
+};
+
+GstInferenceRate *
+gst_inference_rate_new (void)
+{
+  GstInferenceRate *rate = g_new0 (GstInferenceRate, 1);
+
+  g_mutex_init (&rate->mutex);
+  rate->interval = 1;
+  rate->last_pts = GST_CLOCK_TIME_NONE;
+
+  return rate;
+}
+
+void
+gst_inference_rate_free (GstInferenceRate * rate)
+{
+  g_return_if_fail (rate);
+
+  g_mutex_clear (&rate->mutex);
+  g_free (rate);
+}
+
+void
+gst_inference_rate_configure (GstInferenceRate * rate, guint interval,
+    gint max_rate_n, gint max_rate_d, gboolean adaptive)
+{
+  g_return_if_fail (rate);
+  g_return_if_fail (interval > 0);
+  g_return_if_fail (max_rate_n >= 0);
+  g_return_if_fail (max_rate_d > 0);
+
+  g_mutex_lock (&rate->mutex);
+  rate->interval = interval;
+  rate->min_period = 0 == max_rate_n ? 0 :
+      gst_util_uint64_scale_int (GST_SECOND, max_rate_d, max_rate_n);
+  rate->adaptive = adaptive;
+  g_mutex_unlock (&rate->mutex);
+}
+
+void
+gst_inference_rate_reset (GstInferenceRate * rate)
+{
+  g_return_if_fail (rate);
+
+  g_mutex_lock (&rate->mutex);
+  rate->frames = 0;
+  rate->skipped = 0;
+  rate->last_pts = GST_CLOCK_TIME_NONE;
+  rate->latency = 0;
+  g_mutex_unlock (&rate->mutex);
+}
+
+gboolean
+gst_inference_rate_check (GstInferenceRate * rate, GstClockTime pts)
+{
+  GstClockTime min_period;
+  gboolean infer = TRUE;
+
+  g_return_val_if_fail (rate, TRUE);
+
+  g_mutex_lock (&rate->mutex);
+  if (0 != rate->frames++ % rate->interval) {
+    infer = FALSE;
+    goto out;
+  }
+
+  /* Inferring faster than the backend predicts only queues frames, the
+   * average latency bounds the useful rate */
+  min_period = rate->min_period;
+  if (rate->adaptive) {
+    min_period = MAX (min_period, rate->latency);
+  }
+
+  if (min_period > 0 && GST_CLOCK_TIME_IS_VALID (pts)
+      && GST_CLOCK_TIME_IS_VALID (rate->last_pts) && pts >= rate->last_pts
+      && pts - rate->last_pts < min_period) {
+    infer = FALSE;
+    goto out;
+  }
+
+  rate->last_pts = pts;
+
+out:
+  if (!infer) {
+    rate->skipped++;
+  }
+  g_mutex_unlock (&rate->mutex);
+
+  return infer;
+}
+
+void
+gst_inference_rate_add_latency (GstInferenceRate * rate, GstClockTime latency)
+{
+  g_return_if_fail (rate);
+
+  g_mutex_lock (&rate->mutex);
+  if (0 == rate->latency) {
+    rate->latency = latency;
+  } else {
+    rate->latency = (rate->latency * LATENCY_WEIGHT + latency) /
+        (LATENCY_WEIGHT + 1);
+  }
+  g_mutex_unlock (&rate->mutex);
+}
+
+GstClockTime
+gst_inference_rate_get_latency (GstInferenceRate * rate)
+{
+  GstClockTime latency;
+
+  g_return_val_if_fail (rate, 0);
+
+  g_mutex_lock (&rate->mutex);
+  latency = rate->latency;
+  g_mutex_unlock (&rate->mutex);
+
+  return latency;
+}
+
+guint64
+gst_inference_rate_get_skipped (GstInferenceRate * rate)
+{
+  guint64 skipped;
+
+  g_return_val_if_fail (rate, 0);
+
+  g_mutex_lock (&rate->mutex);
+  skipped = rate->skipped;
+  g_mutex_unlock (&rate->mutex);
+
+  return skipped;
+}
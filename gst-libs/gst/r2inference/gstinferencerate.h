@@ -0,0 +1,106 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+
+#ifndef __GST_INFERENCE_RATE_H__
+#define __GST_INFERENCE_RATE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstInferenceRate GstInferenceRate;
+
+/**
+ * \brief Create a controller deciding which frames run the inference
+ *
+ * Every frame is inferred until the controller is configured.
+ */
+GstInferenceRate *gst_inference_rate_new (void);
+
+/**
+ * \brief Free the controller
+ *
+ * \param rate The controller to free
+ */
+void gst_inference_rate_free (GstInferenceRate * rate);
+
+/**
+ * \brief Set the limits of the inference rate
+ *
+ * \param rate The controller to configure
+ * \param interval Infer one out of every interval frames
+ * \param max_rate_n The numerator of the maximum inferences per second,
+ * 0 for no limit
+ * \param max_rate_d The denominator of the maximum inferences per
+ * second
+ * \param adaptive Whether to skip the frames arriving while the
+ * average prediction latency has not elapsed since the last inferred
+ * frame
+ */
+void gst_inference_rate_configure (GstInferenceRate * rate, guint interval,
+    gint max_rate_n, gint max_rate_d, gboolean adaptive);
+
+/**
+ * \brief Forget the frames seen and the measured latency
+ *
+ * \param rate The controller to reset
+ */
+void gst_inference_rate_reset (GstInferenceRate * rate);
+
+/**
+ * \brief Decide whether to infer the next frame
+ *
+ * \param rate The controller to use
+ * \param pts The timestamp of the frame
+ * \return TRUE to infer the frame, FALSE to skip it
+ */
+gboolean gst_inference_rate_check (GstInferenceRate * rate, GstClockTime pts);
+
+/**
+ * \brief Account the time a prediction took
+ *
+ * May be called from any thread.
+ *
+ * \param rate The controller to use
+ * \param latency The time the prediction took
+ */
+void gst_inference_rate_add_latency (GstInferenceRate * rate,
+    GstClockTime latency);
+
+/**
+ * \brief Get the average prediction latency
+ *
+ * \param rate The controller to use
+ * \return The average latency, 0 until a prediction is accounted
+ */
+GstClockTime gst_inference_rate_get_latency (GstInferenceRate * rate);
+
+/**
+ * \brief Get the amount of frames skipped since the last reset
+ *
+ * \param rate The controller to use
+ * \return The skipped frames
+ */
+guint64 gst_inference_rate_get_skipped (GstInferenceRate * rate);
+
+G_END_DECLS
+#endif //__GST_INFERENCE_RATE_H__
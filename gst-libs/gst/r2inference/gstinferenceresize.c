@@ -0,0 +1,501 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "gstinferenceresize.h"
+
+#include <string.h>
+
+#include "gstinferencepreprocess.h"
+#include "gstinferencepreprocesspool.h"
+
+#define RESIZE_CHANNELS 3
+
+typedef struct _GstResizeComp GstResizeComp;
+struct _GstResizeComp
+{
+  const guchar *data;
+  gint stride;
+  gint pstride;
+  gint width;
+  gint height;
+
+  /* Horizontal sampling for every output column, in bytes. Bilinear
+   * uses both neighbours and the weight of the second one, area uses
+   * the first and one past the last pixel of the box */
+  gint *x0;
+  gint *x1;
+  gfloat *fx;
+};
+
+/* A resize to be processed in output row bands by the preprocess pool */
+typedef struct _GstResizeJob GstResizeJob;
+struct _GstResizeJob
+{
+  GstResizeComp comps[RESIZE_CHANNELS];
+  GstInferenceResizeMethod method;
+  gint out_width;
+  gint out_height;
+
+  /* YUV to RGB conversion, unused with RGB input */
+  gboolean yuv;
+  gfloat y_offset;
+  gfloat y_scale;
+  gfloat cr_r;
+  gfloat cb_g;
+  gfloat cr_g;
+  gfloat cb_b;
+
+  /* Packed RGB output */
+  GstVideoFrame *outframe;
+
+  /* Normalized tensor output */
+  gpointer tensor;
+  gint plane_stride;
+  gdouble mean[RESIZE_CHANNELS];
+  gdouble std[RESIZE_CHANNELS];
+  GstInferenceTensorType tensor_type;
+  gdouble scale;
+  gint zero_point;
+};
+
+static gboolean gst_resize_job_init (GstResizeJob * job,
+    GstVideoFrame * inframe, gint out_width, gint out_height,
+    GstInferenceResizeMethod method);
+static void gst_resize_job_clear (GstResizeJob * job);
+static void gst_resize_job_init_yuv (GstResizeJob * job,
+    const GstVideoInfo * info);
+static void gst_resize_comp_init_tables (GstResizeComp * comp,
+    gint out_width, GstInferenceResizeMethod method);
+static void gst_resize_bilinear_row (const GstResizeComp * comp, gint y,
+    gint out_width, gint out_height, gfloat * dst);
+static void gst_resize_area_row (const GstResizeComp * comp, gint y,
+    gint out_width, gint out_height, gfloat * dst);
+static void gst_resize_sample_row (const GstResizeJob * job, gint y,
+    gfloat * rgb[RESIZE_CHANNELS]);
+static void gst_resize_band (gpointer user_data, gint first_row,
+    gint last_row);
+static void gst_resize_normalize_band (gpointer user_data, gint first_row,
+    gint last_row);
+
+GType
+gst_inference_resize_method_get_type (void)
+{
+  static gsize type = 0;
+
+  if (g_once_init_enter (&type)) {
+    static const GEnumValue values[] = {
+      {GST_INFERENCE_RESIZE_METHOD_BILINEAR,
+          "Bilinear interpolation", "bilinear"},
+      {GST_INFERENCE_RESIZE_METHOD_AREA, "Area averaging", "area"},
+      {0, NULL, NULL},
+    };
+    GType new_type = g_enum_register_static ("GstInferenceResizeMethod",
+        values);
+    g_once_init_leave (&type, new_type);
+  }
+
+  return (GType) type;
+}
+
+static void
+gst_resize_job_init_yuv (GstResizeJob * job, const GstVideoInfo * info)
+{
+  const GstVideoColorimetry *colorimetry = &GST_VIDEO_INFO_COLORIMETRY (info);
+  gdouble kr, kb, kg, c_scale;
+
+  if (!gst_video_color_matrix_get_Kr_Kb (colorimetry->matrix, &kr, &kb)) {
+    /* Unknown matrix, use BT.601 */
+    kr = 0.299;
+    kb = 0.114;
+  }
+  kg = 1.0 - kr - kb;
+
+  if (GST_VIDEO_COLOR_RANGE_0_255 == colorimetry->range) {
+    job->y_offset = 0;
+    job->y_scale = 1;
+    c_scale = 1;
+  } else {
+    job->y_offset = 16;
+    job->y_scale = 255. / 219.;
+    c_scale = 255. / 224.;
+  }
+
+  job->cr_r = 2 * (1 - kr) * c_scale;
+  job->cb_b = 2 * (1 - kb) * c_scale;
+  job->cb_g = 2 * (1 - kb) * kb / kg * c_scale;
+  job->cr_g = 2 * (1 - kr) * kr / kg * c_scale;
+}
+
+static void
+gst_resize_comp_init_tables (GstResizeComp * comp, gint out_width,
+    GstInferenceResizeMethod method)
+{
+  gint x;
+
+  comp->x0 = g_new (gint, out_width);
+  comp->x1 = g_new (gint, out_width);
+  comp->fx = g_new (gfloat, out_width);
+
+  for (x = 0; x < out_width; ++x) {
+    gint first, last;
+
+    if (GST_INFERENCE_RESIZE_METHOD_AREA == method) {
+      first = (gint64) x * comp->width / out_width;
+      last = ((gint64) (x + 1) * comp->width + out_width - 1) / out_width;
+      last = CLAMP (last, first + 1, comp->width);
+      comp->fx[x] = 0;
+    } else {
+      /* Align pixel centers */
+      gdouble sx = (x + 0.5) * comp->width / out_width - 0.5;
+
+      sx = MAX (sx, 0);
+      first = MIN ((gint) sx, comp->width - 1);
+      last = MIN (first + 1, comp->width - 1);
+      comp->fx[x] = sx - first;
+    }
+
+    comp->x0[x] = first * comp->pstride;
+    comp->x1[x] = last * comp->pstride;
+  }
+}
+
+static gboolean
+gst_resize_job_init (GstResizeJob * job, GstVideoFrame * inframe,
+    gint out_width, gint out_height, GstInferenceResizeMethod method)
+{
+  gint c;
+
+  memset (job, 0, sizeof (*job));
+
+  switch (GST_VIDEO_FRAME_FORMAT (inframe)) {
+    case GST_VIDEO_FORMAT_I420:
+    case GST_VIDEO_FORMAT_NV12:
+      job->yuv = TRUE;
+      gst_resize_job_init_yuv (job, &inframe->info);
+      break;
+    case GST_VIDEO_FORMAT_RGB:
+    case GST_VIDEO_FORMAT_RGBx:
+    case GST_VIDEO_FORMAT_RGBA:
+    case GST_VIDEO_FORMAT_BGR:
+    case GST_VIDEO_FORMAT_BGRx:
+    case GST_VIDEO_FORMAT_BGRA:
+    case GST_VIDEO_FORMAT_xRGB:
+    case GST_VIDEO_FORMAT_ARGB:
+    case GST_VIDEO_FORMAT_xBGR:
+    case GST_VIDEO_FORMAT_ABGR:
+      job->yuv = FALSE;
+      break;
+    default:
+      return FALSE;
+  }
+
+  job->method = method;
+  job->out_width = out_width;
+  job->out_height = out_height;
+
+  /* Components are Y, U, V or R, G, B regardless of the packing */
+  for (c = 0; c < RESIZE_CHANNELS; ++c) {
+    GstResizeComp *comp = &job->comps[c];
+
+    comp->data = (const guchar *) GST_VIDEO_FRAME_COMP_DATA (inframe, c);
+    comp->stride = GST_VIDEO_FRAME_COMP_STRIDE (inframe, c);
+    comp->pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (inframe, c);
+    comp->width = GST_VIDEO_FRAME_COMP_WIDTH (inframe, c);
+    comp->height = GST_VIDEO_FRAME_COMP_HEIGHT (inframe, c);
+    gst_resize_comp_init_tables (comp, out_width, method);
+  }
+
+  return TRUE;
+}
+
+static void
+gst_resize_job_clear (GstResizeJob * job)
+{
+  gint c;
+
+  for (c = 0; c < RESIZE_CHANNELS; ++c) {
+    g_free (job->comps[c].x0);
+    g_free (job->comps[c].x1);
+    g_free (job->comps[c].fx);
+  }
+}
+
+static void
+gst_resize_bilinear_row (const GstResizeComp * comp, gint y, gint out_width,
+    gint out_height, gfloat * dst)
+{
+  const guchar *row0, *row1;
+  gdouble sy;
+  gfloat fy;
+  gint x, y0, y1;
+
+  sy = (y + 0.5) * comp->height / out_height - 0.5;
+  sy = MAX (sy, 0);
+  y0 = MIN ((gint) sy, comp->height - 1);
+  y1 = MIN (y0 + 1, comp->height - 1);
+  fy = sy - y0;
+
+  row0 = comp->data + y0 * comp->stride;
+  row1 = comp->data + y1 * comp->stride;
+
+  for (x = 0; x < out_width; ++x) {
+    const gint x0 = comp->x0[x];
+    const gint x1 = comp->x1[x];
+    gfloat top = row0[x0] + (row0[x1] - row0[x0]) * comp->fx[x];
+    gfloat bottom = row1[x0] + (row1[x1] - row1[x0]) * comp->fx[x];
+
+    dst[x] = top + (bottom - top) * fy;
+  }
+}
+
+static void
+gst_resize_area_row (const GstResizeComp * comp, gint y, gint out_width,
+    gint out_height, gfloat * dst)
+{
+  gint x, i, first, last;
+
+  first = (gint64) y * comp->height / out_height;
+  last = ((gint64) (y + 1) * comp->height + out_height - 1) / out_height;
+  last = CLAMP (last, first + 1, comp->height);
+
+  for (x = 0; x < out_width; ++x) {
+    const gint x0 = comp->x0[x];
+    const gint x1 = comp->x1[x];
+    guint sum = 0;
+    gint o;
+
+    for (i = first; i < last; ++i) {
+      const guchar *row = comp->data + i * comp->stride;
+
+      for (o = x0; o < x1; o += comp->pstride) {
+        sum += row[o];
+      }
+    }
+
+    dst[x] = (gfloat) sum / ((last - first) * ((x1 - x0) / comp->pstride));
+  }
+}
+
+static void
+gst_resize_sample_row (const GstResizeJob * job, gint y,
+    gfloat * rgb[RESIZE_CHANNELS])
+{
+  gint c, x;
+
+  for (c = 0; c < RESIZE_CHANNELS; ++c) {
+    if (GST_INFERENCE_RESIZE_METHOD_AREA == job->method) {
+      gst_resize_area_row (&job->comps[c], y, job->out_width,
+          job->out_height, rgb[c]);
+    } else {
+      gst_resize_bilinear_row (&job->comps[c], y, job->out_width,
+          job->out_height, rgb[c]);
+    }
+  }
+
+  if (!job->yuv) {
+    return;
+  }
+
+  for (x = 0; x < job->out_width; ++x) {
+    const gfloat luma = (rgb[0][x] - job->y_offset) * job->y_scale;
+    const gfloat cb = rgb[1][x] - 128;
+    const gfloat cr = rgb[2][x] - 128;
+
+    rgb[0][x] = CLAMP (luma + job->cr_r * cr, 0, 255);
+    rgb[1][x] = CLAMP (luma - job->cb_g * cb - job->cr_g * cr, 0, 255);
+    rgb[2][x] = CLAMP (luma + job->cb_b * cb, 0, 255);
+  }
+}
+
+static void
+gst_resize_band (gpointer user_data, gint first_row, gint last_row)
+{
+  GstResizeJob *job = (GstResizeJob *) user_data;
+  GstVideoFrame *outframe = job->outframe;
+  gfloat *rgb[RESIZE_CHANNELS];
+  gfloat *rows;
+  gboolean alpha;
+  gint c, x, y;
+
+  alpha = GST_VIDEO_INFO_HAS_ALPHA (&outframe->info);
+  rows = g_new (gfloat, RESIZE_CHANNELS * job->out_width);
+  for (c = 0; c < RESIZE_CHANNELS; ++c) {
+    rgb[c] = rows + c * job->out_width;
+  }
+
+  for (y = first_row; y < last_row; ++y) {
+    gst_resize_sample_row (job, y, rgb);
+
+    for (c = 0; c < RESIZE_CHANNELS; ++c) {
+      guint8 *dst = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (outframe, c) +
+          y * GST_VIDEO_FRAME_COMP_STRIDE (outframe, c);
+      const gint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (outframe, c);
+
+      for (x = 0; x < job->out_width; ++x) {
+        dst[x * pstride] = (guint8) (rgb[c][x] + 0.5f);
+      }
+    }
+
+    if (alpha) {
+      guint8 *dst = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (outframe, 3) +
+          y * GST_VIDEO_FRAME_COMP_STRIDE (outframe, 3);
+      const gint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (outframe, 3);
+
+      for (x = 0; x < job->out_width; ++x) {
+        dst[x * pstride] = 0xff;
+      }
+    }
+  }
+
+  g_free (rows);
+}
+
+static void
+gst_resize_normalize_band (gpointer user_data, gint first_row, gint last_row)
+{
+  GstResizeJob *job = (GstResizeJob *) user_data;
+  const gint width = job->out_width;
+  const gboolean direct =
+      GST_INFERENCE_TENSOR_TYPE_FLOAT == job->tensor_type;
+  gfloat *rgb[RESIZE_CHANNELS];
+  gfloat *rows, *out;
+  gsize index;
+  gint c, x, y;
+
+  /* Float tensors are written in place, other types go through a
+   * normalized row that is converted afterwards */
+  rows = g_new (gfloat, 2 * RESIZE_CHANNELS * width);
+  for (c = 0; c < RESIZE_CHANNELS; ++c) {
+    rgb[c] = rows + c * width;
+  }
+  out = rows + RESIZE_CHANNELS * width;
+
+  for (y = first_row; y < last_row; ++y) {
+    gst_resize_sample_row (job, y, rgb);
+
+    for (c = 0; c < RESIZE_CHANNELS; ++c) {
+      if (job->plane_stride) {
+        gfloat *dst;
+
+        index = c * job->plane_stride + y * width;
+        dst = direct ? (gfloat *) job->tensor + index : out;
+        for (x = 0; x < width; ++x) {
+          dst[x] = (rgb[c][x] - job->mean[c]) * job->std[c];
+        }
+
+        if (!direct) {
+          gst_inference_tensor_store (out, width, job->tensor, index,
+              job->tensor_type, job->scale, job->zero_point);
+        }
+      } else {
+        gfloat *dst;
+
+        index = y * width * RESIZE_CHANNELS;
+        dst = (direct ? (gfloat *) job->tensor + index : out) + c;
+        for (x = 0; x < width; ++x) {
+          dst[x * RESIZE_CHANNELS] =
+              (rgb[c][x] - job->mean[c]) * job->std[c];
+        }
+      }
+    }
+
+    if (!direct && !job->plane_stride) {
+      gst_inference_tensor_store (out, RESIZE_CHANNELS * width, job->tensor,
+          y * width * RESIZE_CHANNELS, job->tensor_type, job->scale,
+          job->zero_point);
+    }
+  }
+
+  g_free (rows);
+}
+
+gboolean
+gst_inference_resize (GstVideoFrame * inframe, GstVideoFrame * outframe,
+    GstInferenceResizeMethod method)
+{
+  GstResizeJob job;
+  gint width, height;
+
+  g_return_val_if_fail (inframe != NULL, FALSE);
+  g_return_val_if_fail (outframe != NULL, FALSE);
+  g_return_val_if_fail (GST_VIDEO_INFO_IS_RGB (&outframe->info), FALSE);
+
+  width = GST_VIDEO_FRAME_WIDTH (outframe);
+  height = GST_VIDEO_FRAME_HEIGHT (outframe);
+
+  if (!gst_resize_job_init (&job, inframe, width, height, method)) {
+    return FALSE;
+  }
+  job.outframe = outframe;
+
+  gst_inference_preprocess_pool_run (gst_inference_preprocess_pool_get_current
+      (), gst_resize_band, &job, height, width);
+
+  gst_resize_job_clear (&job);
+
+  return TRUE;
+}
+
+gboolean
+gst_inference_resize_normalize (GstVideoFrame * inframe, gpointer tensor,
+    gint width, gint height, const gdouble mean[3], const gdouble std[3],
+    GstInferenceResizeMethod method)
+{
+  GstInferenceTensorLayout layout;
+  GstResizeJob job;
+  gint c;
+
+  g_return_val_if_fail (inframe != NULL, FALSE);
+  g_return_val_if_fail (tensor != NULL, FALSE);
+  g_return_val_if_fail (width > 0, FALSE);
+  g_return_val_if_fail (height > 0, FALSE);
+  g_return_val_if_fail (mean != NULL, FALSE);
+  g_return_val_if_fail (std != NULL, FALSE);
+
+  if (!gst_resize_job_init (&job, inframe, width, height, method)) {
+    return FALSE;
+  }
+
+  job.tensor = tensor;
+  job.tensor_type =
+      gst_inference_preprocess_get_tensor_type (&job.scale, &job.zero_point);
+  for (c = 0; c < RESIZE_CHANNELS; ++c) {
+    /* Raw pixel values are stored without normalization */
+    if (GST_INFERENCE_TENSOR_TYPE_UINT8 == job.tensor_type) {
+      job.mean[c] = 0;
+      job.std[c] = 1;
+    } else {
+      job.mean[c] = mean[c];
+      job.std[c] = std[c];
+    }
+  }
+  layout = gst_inference_preprocess_get_layout ();
+  if (GST_INFERENCE_TENSOR_LAYOUT_NCHW == layout) {
+    job.plane_stride = width * height;
+  }
+
+  gst_inference_preprocess_pool_run (gst_inference_preprocess_pool_get_current
+      (), gst_resize_normalize_band, &job, height, width);
+
+  gst_resize_job_clear (&job);
+
+  return TRUE;
+}
@@ -0,0 +1,88 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef __GST_INFERENCE_RESIZE_H__
+#define __GST_INFERENCE_RESIZE_H__
+
+#include <gst/video/video.h>
+
+G_BEGIN_DECLS
+
+/* Formats accepted as input by the resize functions */
+#define GST_INFERENCE_RESIZE_INPUT_FORMATS \
+  "{ I420, NV12, RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR }"
+
+/* Formats written by gst_inference_resize */
+#define GST_INFERENCE_RESIZE_OUTPUT_FORMATS \
+  "{ RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR }"
+
+/**
+ * \brief Sampling used to compute every output pixel
+ *
+ * BILINEAR interpolates the 4 nearest input pixels. AREA averages all
+ * the input pixels covered by the output pixel, which avoids aliasing
+ * on large downscales.
+ */
+typedef enum
+{
+  GST_INFERENCE_RESIZE_METHOD_BILINEAR,
+  GST_INFERENCE_RESIZE_METHOD_AREA,
+} GstInferenceResizeMethod;
+
+#define GST_TYPE_INFERENCE_RESIZE_METHOD (gst_inference_resize_method_get_type ())
+GType gst_inference_resize_method_get_type (void);
+
+/**
+ * \brief Resize and color convert a frame in a single pass
+ *
+ * \param inframe The input frame, in any of GST_INFERENCE_RESIZE_INPUT_FORMATS
+ * \param outframe The output frame, in any of
+ * GST_INFERENCE_RESIZE_OUTPUT_FORMATS and any size
+ * \param method The sampling method
+ */
+gboolean gst_inference_resize (GstVideoFrame * inframe,
+    GstVideoFrame * outframe, GstInferenceResizeMethod method);
+
+/**
+ * \brief Resize, color convert and normalize a frame in a single pass
+ *
+ * Every output value is computed as (pixel - mean) * std, with the
+ * channels in RGB order and the layout and data type configured with
+ * gst_inference_preprocess_set_layout and
+ * gst_inference_preprocess_set_tensor_type. The model preprocess only
+ * uses it for YUV frames already at the model size, inferencescale
+ * outputs RGB frames and does not normalize.
+ *
+ * \param inframe The input frame, in any of GST_INFERENCE_RESIZE_INPUT_FORMATS
+ * \param tensor The output tensor, holding width * height * 3 elements
+ * \param width The width of the model input
+ * \param height The height of the model input
+ * \param mean The mean of the red, green and blue channels
+ * \param std The scale of the red, green and blue channels
+ * \param method The sampling method
+ */
+gboolean gst_inference_resize_normalize (GstVideoFrame * inframe,
+    gpointer tensor, gint width, gint height, const gdouble mean[3],
+    const gdouble std[3], GstInferenceResizeMethod method);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,208 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "gstinferencering.h"
+
+struct _GstInferenceRing
+{
+  gpointer *slots;
+  guint capacity;
+
+  /* Free running counters, the slot is the counter modulo capacity.
+   * Only the producer writes tail, head is claimed with a compare and
+   * exchange so any thread can pop, the producer included */
+  gint head;
+  gint tail;
+
+  /* Set by a side before sleeping, so the other side knows it has to
+   * take the mutex and signal */
+  gint waiting;
+  gint closed;
+  GMutex mutex;
+  GCond cond;
+};
+
+static void gst_inference_ring_wake (GstInferenceRing * ring);
+
+static void
+gst_inference_ring_wake (GstInferenceRing * ring)
+{
+  if (g_atomic_int_get (&ring->waiting)) {
+    g_mutex_lock (&ring->mutex);
+    g_cond_broadcast (&ring->cond);
+    g_mutex_unlock (&ring->mutex);
+  }
+}
+
+GstInferenceRing *
+gst_inference_ring_new (guint capacity)
+{
+  GstInferenceRing *ring;
+
+  g_return_val_if_fail (capacity > 0, NULL);
+
+  ring = g_new0 (GstInferenceRing, 1);
+  ring->slots = g_new0 (gpointer, capacity);
+  ring->capacity = capacity;
+  g_mutex_init (&ring->mutex);
+  g_cond_init (&ring->cond);
+
+  return ring;
+}
+
+void
+gst_inference_ring_free (GstInferenceRing * ring)
+{
+  g_return_if_fail (ring);
+
+  g_mutex_clear (&ring->mutex);
+  g_cond_clear (&ring->cond);
+  g_free (ring->slots);
+  g_free (ring);
+}
+
+gboolean
+gst_inference_ring_try_push (GstInferenceRing * ring, gpointer item)
+{
+  guint tail;
+
+  g_return_val_if_fail (ring, FALSE);
+  g_return_val_if_fail (item, FALSE);
+
+  tail = (guint) g_atomic_int_get (&ring->tail);
+  if (tail - (guint) g_atomic_int_get (&ring->head) >= ring->capacity) {
+    return FALSE;
+  }
+
+  g_atomic_pointer_set (&ring->slots[tail % ring->capacity], item);
+  /* Publish the slot before the new tail */
+  g_atomic_int_set (&ring->tail, (gint) (tail + 1));
+  gst_inference_ring_wake (ring);
+
+  return TRUE;
+}
+
+gboolean
+gst_inference_ring_push (GstInferenceRing * ring, gpointer item)
+{
+  g_return_val_if_fail (ring, FALSE);
+  g_return_val_if_fail (item, FALSE);
+
+  if (g_atomic_int_get (&ring->closed)) {
+    return FALSE;
+  }
+
+  while (!gst_inference_ring_try_push (ring, item)) {
+    g_mutex_lock (&ring->mutex);
+    g_atomic_int_inc (&ring->waiting);
+    /* Check again once the consumer can see we are waiting */
+    while (!g_atomic_int_get (&ring->closed)
+        && gst_inference_ring_get_length (ring) >= ring->capacity) {
+      g_cond_wait (&ring->cond, &ring->mutex);
+    }
+    g_atomic_int_add (&ring->waiting, -1);
+    g_mutex_unlock (&ring->mutex);
+
+    if (g_atomic_int_get (&ring->closed)) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+gpointer
+gst_inference_ring_try_pop (GstInferenceRing * ring)
+{
+  guint head;
+  gpointer item;
+
+  g_return_val_if_fail (ring, NULL);
+
+  /* The slot is read before it is claimed, a concurrent pop makes the
+   * claim fail and the slot is read again */
+  do {
+    head = (guint) g_atomic_int_get (&ring->head);
+    if (head == (guint) g_atomic_int_get (&ring->tail)) {
+      return NULL;
+    }
+    item = g_atomic_pointer_get (&ring->slots[head % ring->capacity]);
+  } while (!g_atomic_int_compare_and_exchange (&ring->head, (gint) head,
+          (gint) (head + 1)));
+  gst_inference_ring_wake (ring);
+
+  return item;
+}
+
+gpointer
+gst_inference_ring_pop (GstInferenceRing * ring)
+{
+  gpointer item;
+
+  g_return_val_if_fail (ring, NULL);
+
+  while (NULL == (item = gst_inference_ring_try_pop (ring))) {
+    g_mutex_lock (&ring->mutex);
+    g_atomic_int_inc (&ring->waiting);
+    /* Check again once the producer can see we are waiting */
+    while (!g_atomic_int_get (&ring->closed)
+        && 0 == gst_inference_ring_get_length (ring)) {
+      g_cond_wait (&ring->cond, &ring->mutex);
+    }
+    g_atomic_int_add (&ring->waiting, -1);
+    g_mutex_unlock (&ring->mutex);
+
+    if (g_atomic_int_get (&ring->closed)
+        && 0 == gst_inference_ring_get_length (ring)) {
+      return NULL;
+    }
+  }
+
+  return item;
+}
+
+void
+gst_inference_ring_close (GstInferenceRing * ring)
+{
+  g_return_if_fail (ring);
+
+  g_mutex_lock (&ring->mutex);
+  g_atomic_int_set (&ring->closed, TRUE);
+  g_cond_broadcast (&ring->cond);
+  g_mutex_unlock (&ring->mutex);
+}
+
+void
+gst_inference_ring_open (GstInferenceRing * ring)
+{
+  g_return_if_fail (ring);
+
+  g_atomic_int_set (&ring->closed, FALSE);
+}
+
+guint
+gst_inference_ring_get_length (GstInferenceRing * ring)
+{
+  g_return_val_if_fail (ring, 0);
+
+  return (guint) g_atomic_int_get (&ring->tail) -
+      (guint) g_atomic_int_get (&ring->head);
+}
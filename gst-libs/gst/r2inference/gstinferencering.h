@@ -0,0 +1,116 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef __GST_INFERENCE_RING_H__
+#define __GST_INFERENCE_RING_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstInferenceRing GstInferenceRing;
+
+/**
+ * \brief Create a bounded single producer, multiple consumer ring
+ *
+ * Pushing and popping are lock free, the mutex is only taken to sleep
+ * while the ring is full or empty. Only one thread may push, any
+ * number of threads may pop at the same time.
+ *
+ * \param capacity The amount of items the ring can hold
+ */
+GstInferenceRing *gst_inference_ring_new (guint capacity);
+
+/**
+ * \brief Free the ring, the items still queued are not freed
+ *
+ * \param ring The ring to free
+ */
+void gst_inference_ring_free (GstInferenceRing * ring);
+
+/**
+ * \brief Queue an item if there is room for it
+ *
+ * Must only be called from the producer thread.
+ *
+ * \param ring The ring to use
+ * \param item The item to queue, must not be NULL
+ * \return FALSE if the ring is full
+ */
+gboolean gst_inference_ring_try_push (GstInferenceRing * ring, gpointer item);
+
+/**
+ * \brief Queue an item, waiting for room if the ring is full
+ *
+ * Must only be called from the producer thread.
+ *
+ * \param ring The ring to use
+ * \param item The item to queue, must not be NULL
+ * \return FALSE if the ring was closed
+ */
+gboolean gst_inference_ring_push (GstInferenceRing * ring, gpointer item);
+
+/**
+ * \brief Dequeue the oldest item if there is one
+ *
+ * Safe to call from several threads at once, including the producer
+ * dropping the oldest item of a full ring.
+ *
+ * \param ring The ring to use
+ * \return The item, or NULL if the ring is empty
+ */
+gpointer gst_inference_ring_try_pop (GstInferenceRing * ring);
+
+/**
+ * \brief Dequeue the oldest item, waiting for one if the ring is empty
+ *
+ * Safe to call from several threads at once.
+ *
+ * \param ring The ring to use
+ * \return The item, or NULL if the ring is empty and closed
+ */
+gpointer gst_inference_ring_pop (GstInferenceRing * ring);
+
+/**
+ * \brief Wake up and fail the blocked and future blocking calls
+ *
+ * Items already queued can still be popped.
+ *
+ * \param ring The ring to close
+ */
+void gst_inference_ring_close (GstInferenceRing * ring);
+
+/**
+ * \brief Let the blocking calls wait again after a close
+ *
+ * \param ring The ring to reopen
+ */
+void gst_inference_ring_open (GstInferenceRing * ring);
+
+/**
+ * \brief Get the amount of items in the ring
+ *
+ * \param ring The ring to query
+ */
+guint gst_inference_ring_get_length (GstInferenceRing * ring);
+
+G_END_DECLS
+#endif //__GST_INFERENCE_RING_H__
@@ -0,0 +1,151 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "gstinferencetensorpool.h"
+
+/* Tensors are aligned to 64 bytes, enough for any vector load and for
+ * backends that require cache line aligned inputs */
+#define TENSOR_ALIGN 63
+#define TENSOR_MIN_BUFFERS 1
+#define TENSOR_MAX_BUFFERS 0
+
+struct _GstInferenceTensorPool
+{
+  GstBufferPool parent;
+
+  gint allocated;
+  guint64 acquired;
+};
+
+G_DEFINE_TYPE (GstInferenceTensorPool, gst_inference_tensor_pool,
+    GST_TYPE_BUFFER_POOL);
+
+static GstFlowReturn gst_inference_tensor_pool_alloc_buffer (GstBufferPool *
+    pool, GstBuffer ** buffer, GstBufferPoolAcquireParams * params);
+static GstFlowReturn gst_inference_tensor_pool_acquire_buffer (GstBufferPool *
+    pool, GstBuffer ** buffer, GstBufferPoolAcquireParams * params);
+
+static void
+gst_inference_tensor_pool_class_init (GstInferenceTensorPoolClass * klass)
+{
+  GstBufferPoolClass *pool_class = GST_BUFFER_POOL_CLASS (klass);
+
+  pool_class->alloc_buffer = gst_inference_tensor_pool_alloc_buffer;
+  pool_class->acquire_buffer = gst_inference_tensor_pool_acquire_buffer;
+}
+
+static void
+gst_inference_tensor_pool_init (GstInferenceTensorPool * self)
+{
+  self->allocated = 0;
+  self->acquired = 0;
+}
+
+static GstFlowReturn
+gst_inference_tensor_pool_alloc_buffer (GstBufferPool * pool,
+    GstBuffer ** buffer, GstBufferPoolAcquireParams * params)
+{
+  GstInferenceTensorPool *self = GST_INFERENCE_TENSOR_POOL (pool);
+  GstFlowReturn ret;
+
+  ret =
+      GST_BUFFER_POOL_CLASS (gst_inference_tensor_pool_parent_class)->
+      alloc_buffer (pool, buffer, params);
+  if (GST_FLOW_OK == ret) {
+    g_atomic_int_inc (&self->allocated);
+  }
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_inference_tensor_pool_acquire_buffer (GstBufferPool * pool,
+    GstBuffer ** buffer, GstBufferPoolAcquireParams * params)
+{
+  GstInferenceTensorPool *self = GST_INFERENCE_TENSOR_POOL (pool);
+  GstFlowReturn ret;
+
+  ret =
+      GST_BUFFER_POOL_CLASS (gst_inference_tensor_pool_parent_class)->
+      acquire_buffer (pool, buffer, params);
+  if (GST_FLOW_OK == ret) {
+    GST_OBJECT_LOCK (self);
+    self->acquired++;
+    GST_OBJECT_UNLOCK (self);
+  }
+
+  return ret;
+}
+
+GstBufferPool *
+gst_inference_tensor_pool_new (gsize size)
+{
+  GstBufferPool *pool;
+  GstStructure *config;
+  GstAllocationParams params;
+
+  g_return_val_if_fail (size > 0, NULL);
+
+  pool = GST_BUFFER_POOL (g_object_new (GST_TYPE_INFERENCE_TENSOR_POOL, NULL));
+  gst_object_ref_sink (pool);
+
+  gst_allocation_params_init (&params);
+  params.align = TENSOR_ALIGN;
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, NULL, size, TENSOR_MIN_BUFFERS,
+      TENSOR_MAX_BUFFERS);
+  gst_buffer_pool_config_set_allocator (config, NULL, &params);
+
+  if (!gst_buffer_pool_set_config (pool, config)
+      || !gst_buffer_pool_set_active (pool, TRUE)) {
+    gst_object_unref (pool);
+    return NULL;
+  }
+
+  return pool;
+}
+
+GstStructure *
+gst_inference_tensor_pool_get_stats (GstInferenceTensorPool * pool)
+{
+  GstStructure *config;
+  GstStructure *stats;
+  guint size = 0;
+  guint64 acquired;
+
+  g_return_val_if_fail (pool, NULL);
+
+  config = gst_buffer_pool_get_config (GST_BUFFER_POOL (pool));
+  gst_buffer_pool_config_get_params (config, NULL, &size, NULL, NULL);
+  gst_structure_free (config);
+
+  GST_OBJECT_LOCK (pool);
+  acquired = pool->acquired;
+  GST_OBJECT_UNLOCK (pool);
+
+  stats = gst_structure_new ("tensor-pool-stats",
+      "size", G_TYPE_UINT, size,
+      "allocated", G_TYPE_UINT, (guint) g_atomic_int_get (&pool->allocated),
+      "acquired", G_TYPE_UINT64, acquired, NULL);
+
+  return stats;
+}
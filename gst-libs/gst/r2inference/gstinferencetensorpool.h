@@ -0,0 +1,54 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef __GST_INFERENCE_TENSOR_POOL_H__
+#define __GST_INFERENCE_TENSOR_POOL_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+#define GST_TYPE_INFERENCE_TENSOR_POOL gst_inference_tensor_pool_get_type ()
+G_DECLARE_FINAL_TYPE (GstInferenceTensorPool, gst_inference_tensor_pool, GST,
+    INFERENCE_TENSOR_POOL, GstBufferPool);
+
+/**
+ * \brief Create an active pool of aligned tensor buffers
+ *
+ * \param size The size in bytes of every tensor buffer
+ * \return The pool, or NULL if it could not be configured
+ */
+GstBufferPool *gst_inference_tensor_pool_new (gsize size);
+
+/**
+ * \brief Get the usage statistics of a tensor pool
+ *
+ * The returned structure holds the buffer "size", the number of buffers
+ * "allocated" by the pool and the number of times a buffer was
+ * "acquired" from it.
+ *
+ * \param pool The pool to query
+ * \return A new structure, free it with gst_structure_free
+ */
+GstStructure *gst_inference_tensor_pool_get_stats (GstInferenceTensorPool *
+    pool);
+
+G_END_DECLS
+#endif //__GST_INFERENCE_TENSOR_POOL_H__
@@ -0,0 +1,215 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "gstinferenceworker.h"
+
+struct _GstInferenceWorker
+{
+  GThread *thread;
+  GstInferenceWorkerFunc func;
+  gpointer user_data;
+
+  GMutex mutex;
+  GCond item_cond;
+  GCond idle_cond;
+  GQueue queue;
+  guint max_buffers;
+  guint n_buffers;
+  guint64 dropped;
+  GstFlowReturn flow;
+  gboolean busy;
+  gboolean flushing;
+  gboolean quit;
+};
+
+static gpointer gst_inference_worker_loop (gpointer data);
+static void gst_inference_worker_clear (GstInferenceWorker * worker);
+
+static void
+gst_inference_worker_clear (GstInferenceWorker * worker)
+{
+  GstMiniObject *item;
+
+  while ((item = (GstMiniObject *) g_queue_pop_head (&worker->queue))) {
+    gst_mini_object_unref (item);
+  }
+  worker->n_buffers = 0;
+}
+
+static gpointer
+gst_inference_worker_loop (gpointer data)
+{
+  GstInferenceWorker *worker = (GstInferenceWorker *) data;
+  GstMiniObject *item;
+  GstFlowReturn ret;
+
+  g_mutex_lock (&worker->mutex);
+  while (TRUE) {
+    while (!worker->quit && g_queue_is_empty (&worker->queue)) {
+      g_cond_wait (&worker->item_cond, &worker->mutex);
+    }
+    if (worker->quit) {
+      break;
+    }
+
+    item = (GstMiniObject *) g_queue_pop_head (&worker->queue);
+    if (GST_IS_BUFFER (item)) {
+      worker->n_buffers--;
+    }
+    worker->busy = TRUE;
+    g_mutex_unlock (&worker->mutex);
+
+    ret = worker->func (item, worker->user_data);
+
+    g_mutex_lock (&worker->mutex);
+    worker->busy = FALSE;
+    if (GST_FLOW_OK != ret && !worker->flushing) {
+      worker->flow = ret;
+    }
+    if (g_queue_is_empty (&worker->queue)) {
+      g_cond_broadcast (&worker->idle_cond);
+    }
+  }
+  g_mutex_unlock (&worker->mutex);
+
+  return NULL;
+}
+
+GstInferenceWorker *
+gst_inference_worker_new (const gchar * name, guint max_buffers,
+    GstInferenceWorkerFunc func, gpointer user_data)
+{
+  GstInferenceWorker *worker;
+
+  g_return_val_if_fail (name, NULL);
+  g_return_val_if_fail (max_buffers > 0, NULL);
+  g_return_val_if_fail (func, NULL);
+
+  worker = g_new0 (GstInferenceWorker, 1);
+  g_mutex_init (&worker->mutex);
+  g_cond_init (&worker->item_cond);
+  g_cond_init (&worker->idle_cond);
+  g_queue_init (&worker->queue);
+  worker->max_buffers = max_buffers;
+  worker->func = func;
+  worker->user_data = user_data;
+  worker->flow = GST_FLOW_OK;
+
+  worker->thread = g_thread_new (name, gst_inference_worker_loop, worker);
+
+  return worker;
+}
+
+void
+gst_inference_worker_free (GstInferenceWorker * worker)
+{
+  g_return_if_fail (worker);
+
+  g_mutex_lock (&worker->mutex);
+  worker->quit = TRUE;
+  g_cond_broadcast (&worker->item_cond);
+  g_mutex_unlock (&worker->mutex);
+
+  g_thread_join (worker->thread);
+
+  gst_inference_worker_clear (worker);
+  g_mutex_clear (&worker->mutex);
+  g_cond_clear (&worker->item_cond);
+  g_cond_clear (&worker->idle_cond);
+  g_free (worker);
+}
+
+GstFlowReturn
+gst_inference_worker_push (GstInferenceWorker * worker, GstMiniObject * item)
+{
+  GstFlowReturn ret;
+
+  g_return_val_if_fail (worker, GST_FLOW_ERROR);
+  g_return_val_if_fail (item, GST_FLOW_ERROR);
+
+  g_mutex_lock (&worker->mutex);
+  ret = worker->flushing ? GST_FLOW_FLUSHING : worker->flow;
+  if (GST_FLOW_OK != ret) {
+    g_mutex_unlock (&worker->mutex);
+    gst_mini_object_unref (item);
+    return ret;
+  }
+
+  if (GST_IS_BUFFER (item)) {
+    if (worker->n_buffers >= worker->max_buffers) {
+      worker->dropped++;
+      g_mutex_unlock (&worker->mutex);
+      gst_mini_object_unref (item);
+      return GST_FLOW_OK;
+    }
+    worker->n_buffers++;
+  }
+
+  g_queue_push_tail (&worker->queue, item);
+  g_cond_signal (&worker->item_cond);
+  g_mutex_unlock (&worker->mutex);
+
+  return GST_FLOW_OK;
+}
+
+void
+gst_inference_worker_set_flushing (GstInferenceWorker * worker,
+    gboolean flushing)
+{
+  g_return_if_fail (worker);
+
+  g_mutex_lock (&worker->mutex);
+  worker->flushing = flushing;
+  if (flushing) {
+    gst_inference_worker_clear (worker);
+    g_cond_broadcast (&worker->idle_cond);
+  } else {
+    worker->flow = GST_FLOW_OK;
+  }
+  g_mutex_unlock (&worker->mutex);
+}
+
+void
+gst_inference_worker_drain (GstInferenceWorker * worker)
+{
+  g_return_if_fail (worker);
+
+  g_mutex_lock (&worker->mutex);
+  while (!worker->flushing && (worker->busy
+          || !g_queue_is_empty (&worker->queue))) {
+    g_cond_wait (&worker->idle_cond, &worker->mutex);
+  }
+  g_mutex_unlock (&worker->mutex);
+}
+
+guint64
+gst_inference_worker_get_dropped (GstInferenceWorker * worker)
+{
+  guint64 dropped;
+
+  g_return_val_if_fail (worker, 0);
+
+  g_mutex_lock (&worker->mutex);
+  dropped = worker->dropped;
+  g_mutex_unlock (&worker->mutex);
+
+  return dropped;
+}
@@ -0,0 +1,100 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef __GST_INFERENCE_WORKER_H__
+#define __GST_INFERENCE_WORKER_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstInferenceWorker GstInferenceWorker;
+
+/**
+ * \brief Function called from the worker thread for every queued item
+ *
+ * \param item The buffer or event to process, owned by the function
+ * \param user_data The data passed to gst_inference_worker_new
+ * \return The flow return reported back to the producer
+ */
+typedef GstFlowReturn (*GstInferenceWorkerFunc) (GstMiniObject * item,
+    gpointer user_data);
+
+/**
+ * \brief Create a thread processing buffers and events in order
+ *
+ * \param name The name of the thread
+ * \param max_buffers The amount of buffers that can be queued, events
+ * are not limited
+ * \param func The function processing each item
+ * \param user_data The data passed to func
+ */
+GstInferenceWorker *gst_inference_worker_new (const gchar * name,
+    guint max_buffers, GstInferenceWorkerFunc func, gpointer user_data);
+
+/**
+ * \brief Stop the worker thread, drop the queued items and free it
+ *
+ * \param worker The worker to free
+ */
+void gst_inference_worker_free (GstInferenceWorker * worker);
+
+/**
+ * \brief Queue an item to be processed by the worker thread
+ *
+ * Never blocks. A buffer arriving while max_buffers are queued is
+ * dropped, so the producer keeps its own rate.
+ *
+ * \param worker The worker to use
+ * \param item The buffer or event to queue, the worker takes ownership
+ * \return GST_FLOW_OK, or the last error returned by the worker function
+ */
+GstFlowReturn gst_inference_worker_push (GstInferenceWorker * worker,
+    GstMiniObject * item);
+
+/**
+ * \brief Start or stop flushing
+ *
+ * While flushing the queued items are dropped and pushes return
+ * GST_FLOW_FLUSHING. Stopping the flush clears the last error.
+ *
+ * \param worker The worker to use
+ * \param flushing Whether to flush
+ */
+void gst_inference_worker_set_flushing (GstInferenceWorker * worker,
+    gboolean flushing);
+
+/**
+ * \brief Wait until every queued item is processed
+ *
+ * \param worker The worker to use
+ */
+void gst_inference_worker_drain (GstInferenceWorker * worker);
+
+/**
+ * \brief Get the amount of buffers dropped because the queue was full
+ *
+ * \param worker The worker to query
+ */
+guint64 gst_inference_worker_get_dropped (GstInferenceWorker * worker);
+
+G_END_DECLS
+#endif //__GST_INFERENCE_WORKER_H__
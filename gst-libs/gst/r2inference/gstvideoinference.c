@@ -23,8 +23,17 @@
 #include "gstinferencebackends.h"
 #include "gstinferencemeta.h"
 #include "gstbasebackend.h"
+#include "gstinferencepreprocess.h"
+#include "gstinferencepreprocesspool.h"
+#include "gstinferencetensorpool.h"
+#include "gstinferenceworker.h"
+#include "gstinferencepipeline.h"
+#include "gstinferencebatch.h"
+#include "gstinferencerate.h"
+#include "gstinferencering.h"
+#include "gstinferencematcher.h"
 
-#include <gst/base/gstcollectpads.h>
+#include <string.h>
 
 
 static GstStaticPadTemplate sink_bypass_factory =
@@ -47,6 +56,75 @@ GST_DEBUG_CATEGORY_STATIC (gst_video_inference_debug_category);
 #define DEFAULT_MODEL_LOCATION   NULL
 #define DEFAULT_LABELS NULL
 #define DEFAULT_NUM_LABELS 0
+#define DEFAULT_PREPROCESS_THREADS 1
+#define MIN_PREPROCESS_THREADS 1
+#define MAX_PREPROCESS_THREADS 64
+#define DEFAULT_PREPROCESS_LUT GST_INFERENCE_PREPROCESS_LUT_AUTO
+#define DEFAULT_TENSOR_LAYOUT GST_INFERENCE_TENSOR_LAYOUT_NHWC
+#define DEFAULT_TENSOR_TYPE GST_INFERENCE_TENSOR_TYPE_FLOAT
+#define DEFAULT_TENSOR_SCALE 1.0
+#define MIN_TENSOR_SCALE G_MINDOUBLE
+#define MAX_TENSOR_SCALE G_MAXDOUBLE
+#define DEFAULT_TENSOR_ZERO_POINT 0
+#define MIN_TENSOR_ZERO_POINT G_MININT8
+#define MAX_TENSOR_ZERO_POINT G_MAXINT8
+#define DEFAULT_BYPASS_PREPROCESS FALSE
+#define DEFAULT_ASYNC FALSE
+#define DEFAULT_ASYNC_QUEUE_SIZE 2
+#define MIN_ASYNC_QUEUE_SIZE 1
+#define MAX_ASYNC_QUEUE_SIZE 64
+#define DEFAULT_PIPELINE_DEPTH 0
+#define MIN_PIPELINE_DEPTH 0
+#define MAX_PIPELINE_DEPTH 16
+#define DEFAULT_BATCH_SIZE 1
+#define MIN_BATCH_SIZE 1
+#define MAX_BATCH_SIZE 64
+#define DEFAULT_BATCH_TIMEOUT 0
+#define MIN_BATCH_TIMEOUT 0
+#define MAX_BATCH_TIMEOUT G_MAXUINT
+#define DEFAULT_SHARED_MODEL FALSE
+#define DEFAULT_ENGINE_CACHE FALSE
+#define DEFAULT_ENGINE_CONCURRENCY 1
+#define MIN_ENGINE_CONCURRENCY 0
+#define MAX_ENGINE_CONCURRENCY 64
+#define DEFAULT_ENGINE_INSTANCES 1
+#define MIN_ENGINE_INSTANCES 1
+#define MAX_ENGINE_INSTANCES 16
+#define DEFAULT_WARM_UP_INFERENCES 0
+#define MIN_WARM_UP_INFERENCES 0
+#define MAX_WARM_UP_INFERENCES 100
+#define DEFAULT_ASYNC_LOAD FALSE
+#define DEFAULT_INFERENCE_INTERVAL 1
+#define MIN_INFERENCE_INTERVAL 1
+#define MAX_INFERENCE_INTERVAL G_MAXUINT
+#define DEFAULT_MAX_INFERENCE_RATE_N 0
+#define DEFAULT_MAX_INFERENCE_RATE_D 1
+#define DEFAULT_ADAPTIVE_SKIP FALSE
+#define DEFAULT_FLAG_STALE FALSE
+#define DEFAULT_QUEUE_SIZE 32
+#define MIN_QUEUE_SIZE 1
+#define MAX_QUEUE_SIZE 1024
+#define DEFAULT_LEAKY GST_VIDEO_INFERENCE_LEAKY_NONE
+#define DEFAULT_BYPASS_TIMEOUT 0
+#define MIN_BYPASS_TIMEOUT 0
+#define MAX_BYPASS_TIMEOUT G_MAXUINT
+#define DEFAULT_MATCH_WINDOW 0
+#define MIN_MATCH_WINDOW 0
+#define MAX_MATCH_WINDOW G_MAXUINT
+/* Change of the average prediction time, as a fraction of the last
+ * reported latency, that triggers a new latency message */
+#define LATENCY_CHANGE_DIVISOR 4
+/* Event queued in place of a model buffer the async mode dropped */
+#define DROPPED_EVENT_NAME "GstVideoInferenceDropped"
+
+typedef enum
+{
+  GST_VIDEO_INFERENCE_LEAKY_NONE,
+  GST_VIDEO_INFERENCE_LEAKY_OLDEST,
+  GST_VIDEO_INFERENCE_LEAKY_NEWEST,
+} GstVideoInferenceLeaky;
+
+#define GST_TYPE_VIDEO_INFERENCE_LEAKY (video_inference_leaky_get_type ())
 enum
 {
   NEW_INFERENCE_SIGNAL,
@@ -60,6 +138,36 @@ enum
   PROP_BACKEND,
   PROP_MODEL_LOCATION,
   PROP_LABELS,
+  PROP_PREPROCESS_THREADS,
+  PROP_PREPROCESS_LUT,
+  PROP_TENSOR_LAYOUT,
+  PROP_TENSOR_TYPE,
+  PROP_TENSOR_SCALE,
+  PROP_TENSOR_ZERO_POINT,
+  PROP_TENSOR_POOL_STATS,
+  PROP_BYPASS_PREPROCESS,
+  PROP_ASYNC,
+  PROP_ASYNC_QUEUE_SIZE,
+  PROP_PIPELINE_DEPTH,
+  PROP_PIPELINE_STATS,
+  PROP_BATCH_SIZE,
+  PROP_BATCH_TIMEOUT,
+  PROP_SHARED_MODEL,
+  PROP_ENGINE_CACHE,
+  PROP_ENGINE_CONCURRENCY,
+  PROP_ENGINE_INSTANCES,
+  PROP_WARM_UP_INFERENCES,
+  PROP_ASYNC_LOAD,
+  PROP_INFERENCE_INTERVAL,
+  PROP_MAX_INFERENCE_RATE,
+  PROP_ADAPTIVE_SKIP,
+  PROP_FLAG_STALE,
+  PROP_MODEL_QUEUE_SIZE,
+  PROP_BYPASS_QUEUE_SIZE,
+  PROP_LEAKY,
+  PROP_BYPASS_TIMEOUT,
+  PROP_MATCH_WINDOW,
+  PROP_QUEUE_STATS,
 };
 
 GQuark _size_quark;
@@ -70,15 +178,66 @@ GQuark _copy_quark;
 typedef struct _GstVideoInferencePad GstVideoInferencePad;
 struct _GstVideoInferencePad
 {
-  GstCollectData data;
+  GstPad *pad;
+
+  GstVideoInfo info;
+};
 
+/* A model buffer, or a serialized model event, on its way through the
+ * preprocess, predict and postprocess stages */
+typedef struct _GstVideoInferenceJob GstVideoInferenceJob;
+struct _GstVideoInferenceJob
+{
+  GstVideoInference *element;
+  GstEvent *event;
+  GstBuffer *buffer;
   GstVideoInfo info;
+  GstMeta *meta;
+  /* FALSE if the root prediction is disabled and the buffer is only
+   * forwarded */
+  gboolean infer;
+  /* TRUE if the rate control skipped the inference, the buffer gets the
+   * last prediction instead */
+  gboolean skipped;
+  gboolean raw;
+  gboolean mapped;
+  GstVideoFrame inframe;
+  GstVideoFrame outframe;
+  /* One memory per output tensor, wrapping the backend results */
+  GstBuffer *prediction;
+  GstFlowReturn ret;
+  /* Model buffers the async mode dropped right before this one */
+  guint gaps;
+};
+
+/* A started backend, and the batch feeding it, used by all the elements
+ * with shared-model enabled that run the same model */
+typedef struct _GstVideoInferenceSharedModel GstVideoInferenceSharedModel;
+struct _GstVideoInferenceSharedModel
+{
+  gchar *key;
+  guint refcount;
+  gboolean loaded;
+  GstBaseBackend *backend;
+  GstInferenceBatch *batch;
+};
+
+static GMutex shared_models_mutex;
+static GCond shared_models_cond;
+static GHashTable *shared_models = NULL;
+
+/* Owned by a model load thread, which keeps the element alive */
+typedef struct _GstVideoInferenceLoad GstVideoInferenceLoad;
+struct _GstVideoInferenceLoad
+{
+  GstVideoInference *self;
+  gchar *location;
+  guint cookie;
 };
 
 typedef struct _GstVideoInferencePrivate GstVideoInferencePrivate;
 struct _GstVideoInferencePrivate
 {
-  GstCollectPads *cpads;
   GstVideoInferencePad *sink_bypass_data;
   GstVideoInferencePad *sink_model_data;
   const GstMetaInfo *inference_meta_info;
@@ -92,18 +251,110 @@ struct _GstVideoInferencePrivate
 
   gchar *model_location;
 
-  GMutex mtx_model_queue;
-  GMutex mtx_bypass_queue;
-
-  GQueue *model_queue;
-  GQueue *bypass_queue;
+  /* The inference thread queues the predicted model buffers and the
+   * bypass streaming thread pairs them with the bypass buffers, oldest
+   * first. The oldest buffer of each queue, once taken out to be paired,
+   * waits in the pending field until it is consumed */
+  GstInferenceRing *model_queue;
+  GstInferenceRing *bypass_queue;
+  GstBuffer *model_pending;
+  GstBuffer *bypass_pending;
+  guint model_queue_size;
+  guint bypass_queue_size;
+  GstVideoInferenceLeaky leaky;
+  gint model_dropped;
+  gint bypass_dropped;
+  guint bypass_timeout;
+
+  /* With a match window the model buffers taken from the queue are
+   * indexed by timestamp, and every bypass buffer is paired with the
+   * nearest one instead of the next one in order */
+  GstInferenceMatcher *matcher;
+  guint match_window;
+
+  /* The model EOS is held while the bypass branch can still pair the
+   * model buffers, the first branch to see both forwards it */
+  GMutex mtx_eos;
+  gboolean model_eos;
+  gboolean bypass_eos;
+  GstEvent *model_eos_event;
+  /* Inference latency in the last latency query answered, protected by
+   * the object lock */
+  GstClockTime reported_latency;
 
   gchar *labels;
   gchar **labels_list;
   gint num_labels;
+
+  guint preprocess_threads;
+  GstInferencePreprocessPool *preprocess_pool;
+  GstInferencePreprocessCache *preprocess_cache;
+  GstInferencePreprocessLutMode preprocess_lut;
+  GstBufferPool *tensor_pool;
+  gsize tensor_pool_size;
+  GstInferenceTensorLayout tensor_layout;
+  GstInferenceTensorType tensor_type;
+  gdouble tensor_scale;
+  gint tensor_zero_point;
+  gboolean bypass_preprocess;
+  gboolean backend_raw_input;
+  GstInferenceTensorInfo tensor_info;
+  GstVideoInfo tensor_video_info;
+
+  gboolean async;
+  guint async_queue_size;
+  GstInferenceWorker *worker;
+
+  guint pipeline_depth;
+  GstInferencePipeline *pipeline;
+
+  guint batch_size;
+  guint batch_timeout;
+  GstInferenceBatch *batch;
+
+  gboolean shared_model;
+  GstVideoInferenceSharedModel *shared;
+  /* Set while this element flushes its buffers out of a shared batch */
+  gint batch_flushing;
+
+  gboolean engine_cache;
+  guint engine_concurrency;
+  guint engine_instances;
+  guint warm_up_inferences;
+  /* The model is loaded from NULL to READY until back to NULL, and
+   * loaded again if a property it depends on changed meanwhile */
+  gboolean backend_open;
+  gboolean backend_stale;
+  gboolean async_load;
+  /* Loads the model from NULL to READY in the background, READY to
+   * PAUSED then completes once it is loaded. The flags are protected
+   * by the load mutex, the cookie tells the current load thread */
+  guint load_cookie;
+  GMutex load_mutex;
+  GCond load_cond;
+  gboolean loading;
+  gboolean async_pending;
+  gboolean load_failed;
+  gboolean load_flushing;
+
+  guint inference_interval;
+  gint max_inference_rate_n;
+  gint max_inference_rate_d;
+  gboolean adaptive_skip;
+  gboolean flag_stale;
+  GstInferenceRate *rate;
+  /* Copy of the last root prediction, protected by the object lock */
+  GstInferencePrediction *last_prediction;
+
+  /* Last flow return of the model buffers finished by another thread */
+  gint model_flow;
+  /* Model buffers dropped since the last job fed to the pipeline, only
+   * used by the model streaming thread */
+  guint pipeline_gaps;
 };
 
 /* GObject methods */
+static void gst_video_inference_constructed (GObject * object);
 static void gst_video_inference_finalize (GObject * object);
 static void gst_video_inference_set_property (GObject * object,
     guint property_id, const GValue * value, GParamSpec * pspec);
@@ -136,25 +387,38 @@ static GstFlowReturn gst_video_inference_process_bypass (GstVideoInference *
     self, GstBuffer * buffer, GstVideoInferencePad * pad);
 static GstFlowReturn gst_video_inference_process_model (GstVideoInference *
     self, GstBuffer * buffer, GstVideoInferencePad * pad);
-static GstFlowReturn gst_video_inference_buffer_function (GstCollectPads * pads,
-    GstCollectData * data, GstBuffer * buffer, gpointer user_data);
+static GstFlowReturn gst_video_inference_sink_chain (GstPad * pad,
+    GstObject * parent, GstBuffer * buffer);
 static GstFlowReturn gst_video_inference_forward_buffer (GstVideoInference *
     self, GstBuffer * buffer, GstPad * pad);
-static gboolean gst_video_inference_model_run_prediction (GstVideoInference *
-    self, GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
-    GstBuffer * buffer, gpointer * prediction_data, gsize * prediction_size);
 
 static gboolean gst_video_inference_preprocess (GstVideoInference * self,
     GstVideoInferenceClass * klass, GstVideoFrame * inframe,
     GstVideoFrame * outframe);
 static gboolean gst_video_inference_predict (GstVideoInference * self,
-    GstVideoInferencePrivate * priv, GstVideoFrame * frame, gpointer * pred,
-    gsize * pred_size);
+    GstVideoInferencePrivate * priv, GstVideoFrame * frame, gboolean raw,
+    GstBuffer ** pred);
+static gboolean video_inference_can_bypass (GstVideoInfo * info);
+static gboolean gst_video_inference_model_map (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstVideoInferenceJob * job);
+static void video_inference_job_unmap (GstVideoInferenceJob * job);
+static void video_inference_job_free (gpointer data, gpointer user_data);
+static GstFlowReturn video_inference_job_start (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePad * pad,
+    GstVideoInferenceJob * job);
+static gboolean video_inference_job_preprocess (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstVideoInferenceJob * job);
+static gboolean video_inference_job_predict (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstVideoInferenceJob * job);
+static GstFlowReturn video_inference_job_finish (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstVideoInferencePad * pad, GstVideoInferenceJob * job);
 
 static GstIterator *gst_video_inference_iterate_internal_links (GstPad * pad,
     GstObject * parent);
-static gboolean gst_video_inference_sink_event (GstCollectPads * pads,
-    GstCollectData * pad, GstEvent * event, gpointer user_data);
+static gboolean gst_video_inference_sink_event (GstPad * pad,
+    GstObject * parent, GstEvent * event);
 static gboolean gst_video_inference_src_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 static GstPad *gst_video_inference_get_src_pad (GstVideoInference * self,
@@ -165,16 +429,128 @@ static void
 gst_video_inference_set_backend (GstVideoInference * self, gint backend);
 static guint gst_video_inference_get_backend_type (GstVideoInference * self);
 static void gst_video_inference_set_caps (GstVideoInference * self,
-    GstVideoInferencePrivate * priv, GstCollectData * pad, GstEvent * event);
-
-static void video_inference_map_buffers (GstVideoInferencePad * data,
-    GstBuffer * inbuf, GstVideoFrame * inframe, GstVideoFrame * outframe);
+    GstVideoInferencePrivate * priv, GstVideoInferencePad * pad,
+    GstEvent * event);
+static gboolean video_inference_model_eos (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstEvent * event);
+static void video_inference_bypass_eos (GstVideoInference * self,
+    GstVideoInferencePrivate * priv);
+static void video_inference_drain_model (GstVideoInference * self,
+    GstVideoInferencePrivate * priv);
+static void video_inference_update_queue (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, gboolean flushing);
+static GstFlowReturn video_inference_pair_bypass (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstClockTime pts, GstClockTime timeout);
+static GstFlowReturn video_inference_make_room (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstClockTime pts, GstClockTime timeout);
+
+static void video_inference_set_tensor_pool (GstVideoInference * self,
+    GstBufferPool * pool, gsize size);
+static GstBuffer *video_inference_acquire_tensor (GstVideoInference * self,
+    gsize size);
+static void video_inference_update_tensor_info (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstVideoInfo * info);
+static gboolean video_inference_map_buffers (GstVideoInference * self,
+    GstVideoInferencePad * data, GstBuffer * inbuf, GstVideoFrame * inframe,
+    GstVideoFrame * outframe);
+static gboolean video_inference_postprocess_tensors (GstVideoInference *
+    self, GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstBuffer * prediction, GstMeta * meta_model, GstVideoInfo * info_model,
+    gboolean * valid_prediction);
+static gboolean video_inference_map_tensor (GstVideoInference * self,
+    GstMemory * memory, const GstVideoInferenceTensorDesc * desc,
+    GstVideoInferenceTensor * tensor, GstMapInfo * map);
 static gboolean video_inference_prepare_postprocess (GstBuffer * buffer,
     GstVideoInfo * video_info, GstMeta ** out_meta);
 static GstMeta *video_inference_transform_meta (GstBuffer * buffer_model,
     GstVideoInfo * info_model, GstMeta * meta_model, GstBuffer * buffer_bypass,
     GstVideoInfo * info_bypass);
-static void video_inference_flush_queue (GQueue * queue, GMutex * mutex);
+static void video_inference_flush_queue (GstInferenceRing * queue,
+    GstBuffer ** pending);
+static GstBuffer *video_inference_match_window (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstBuffer * bypass_buffer,
+    GstFlowReturn * ret);
+static GstFlowReturn video_inference_worker_func (GstMiniObject * item,
+    gpointer user_data);
+static gboolean video_inference_worker_event (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstEvent * event);
+static gboolean video_inference_forward_model_event (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstEvent * event);
+static GstFlowReturn video_inference_queue_model (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstBuffer * buffer, GstEvent * event);
+static GstFlowReturn video_inference_queue_dropped (GstVideoInference * self,
+    GstVideoInferencePrivate * priv);
+static void video_inference_queue_gap (GstVideoInference * self,
+    GstVideoInferencePrivate * priv);
+static void video_inference_forward_model (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstBuffer * buffer);
+static void video_inference_set_flushing (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, gboolean flushing);
+static void video_inference_stage_preprocess (gpointer data,
+    gpointer user_data);
+static void video_inference_stage_predict (gpointer data, gpointer user_data);
+static void video_inference_stage_postprocess (gpointer data,
+    gpointer user_data);
+static GstStructure *video_inference_get_pipeline_stats (GstVideoInference *
+    self, GstVideoInferencePrivate * priv);
+static GstFlowReturn video_inference_queue_batch (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstVideoInferenceJob * job);
+static gboolean gst_video_inference_predict_batch (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstVideoFrame * frames, guint n_frames,
+    GstBuffer ** preds, GError ** error);
+static void video_inference_batch_func (gpointer * items, guint n_items,
+    gpointer user_data);
+static gboolean video_inference_batch_add_owner (GstVideoInference ** owners,
+    guint * n_owners, GstVideoInference * element);
+static GstFlowReturn video_inference_batch_event (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstEvent * event);
+static GstBaseBackend *video_inference_get_backend (GstVideoInferencePrivate *
+    priv);
+static void video_inference_reuse_prediction (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, gboolean own_meta,
+    GstInferenceMeta * imeta);
+static void video_inference_keep_prediction (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstInferenceMeta * imeta);
+static GType video_inference_leaky_get_type (void);
+static void video_inference_queue_push (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstInferenceRing * queue,
+    GstBuffer * buffer);
+static GstBuffer *video_inference_queue_pop (GstInferenceRing * queue,
+    GstBuffer ** pending);
+static GstStructure *video_inference_get_queue_stats (GstVideoInference *
+    self, GstVideoInferencePrivate * priv);
+static GstClockTime video_inference_get_latency (GstVideoInference * self,
+    GstVideoInferencePrivate * priv);
+static void video_inference_add_latency (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, gint64 start);
+static gboolean gst_video_inference_src_query (GstPad * pad,
+    GstObject * parent, GstQuery * query);
+static GstVideoInferenceSharedModel
+    * video_inference_shared_model_acquire (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, const gchar * location, GError ** err);
+static void video_inference_shared_model_release (GstVideoInference * self,
+    GstVideoInferenceSharedModel * shared);
+static gboolean video_inference_open (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, const gchar * location);
+static gboolean video_inference_close (GstVideoInference * self,
+    GstVideoInferencePrivate * priv);
+static void video_inference_warm_up (GstVideoInference * self,
+    GstVideoInferencePrivate * priv);
+static gpointer video_inference_load_func (gpointer data);
+static gboolean video_inference_commit_pending (GstVideoInferencePrivate *
+    priv, guint cookie);
+static void video_inference_commit_state (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, guint cookie);
+static GstFlowReturn video_inference_wait_loaded (GstVideoInference * self,
+    GstVideoInferencePrivate * priv);
+
+/* Stages run by the pipeline threads, in processing order */
+#define VIDEO_INFERENCE_STAGE_PREDICT 1
+static const GstInferencePipelineStage video_inference_stages[] = {
+  {"preprocess", video_inference_stage_preprocess},
+  {"predict", video_inference_stage_predict},
+  {"postprocess", video_inference_stage_postprocess},
+};
 
 static guint gst_video_inference_signals[LAST_SIGNAL] = { 0 };
 
@@ -196,6 +572,7 @@ gst_video_inference_class_init (GstVideoInferenceClass * klass)
   GstElementClass *eclass = GST_ELEMENT_CLASS (klass);
   gchar *backend_blurb, *backends_params = NULL;
 
+  oclass->constructed = gst_video_inference_constructed;
   oclass->finalize = gst_video_inference_finalize;
   oclass->set_property = gst_video_inference_set_property;
   oclass->get_property = gst_video_inference_get_property;
@@ -231,6 +608,205 @@ gst_video_inference_class_init (GstVideoInferenceClass * klass)
       g_param_spec_string ("labels", "labels",
           "Semicolon separated string containing inference labels",
           DEFAULT_LABELS, G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_PREPROCESS_THREADS,
+      g_param_spec_uint ("preprocess-threads", "Preprocess Threads",
+          "Number of threads used to preprocess each model frame in row "
+          "bands. Takes effect on the next READY to PAUSED transition",
+          MIN_PREPROCESS_THREADS, MAX_PREPROCESS_THREADS,
+          DEFAULT_PREPROCESS_THREADS,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_PREPROCESS_LUT,
+      g_param_spec_enum ("preprocess-lut", "Preprocess Lookup Table",
+          "When to normalize 8 bit channels with a lookup table. Auto times "
+          "the table against the vector kernel on the first frame of every "
+          "format and keeps the faster one",
+          GST_TYPE_INFERENCE_PREPROCESS_LUT_MODE, DEFAULT_PREPROCESS_LUT,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_TENSOR_LAYOUT,
+      g_param_spec_enum ("tensor-layout", "Tensor Layout",
+          "Memory layout of the preprocessed tensor handed to the backend. "
+          "NCHW writes every channel as a separate plane. The backend is "
+          "not told the layout, the model itself must take this input",
+          GST_TYPE_INFERENCE_TENSOR_LAYOUT, DEFAULT_TENSOR_LAYOUT,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_TENSOR_TYPE,
+      g_param_spec_enum ("tensor-type", "Tensor Type",
+          "Data type of the preprocessed tensor handed to the backend. "
+          "int8 is quantized with tensor-scale and tensor-zero-point, "
+          "uint8 holds the raw pixel values",
+          GST_TYPE_INFERENCE_TENSOR_TYPE, DEFAULT_TENSOR_TYPE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_TENSOR_SCALE,
+      g_param_spec_double ("tensor-scale", "Tensor Scale",
+          "Quantization scale of the int8 tensor type",
+          MIN_TENSOR_SCALE, MAX_TENSOR_SCALE, DEFAULT_TENSOR_SCALE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_TENSOR_ZERO_POINT,
+      g_param_spec_int ("tensor-zero-point", "Tensor Zero Point",
+          "Quantization zero point of the int8 tensor type",
+          MIN_TENSOR_ZERO_POINT, MAX_TENSOR_ZERO_POINT,
+          DEFAULT_TENSOR_ZERO_POINT,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_TENSOR_POOL_STATS,
+      g_param_spec_boxed ("tensor-pool-stats", "Tensor Pool Statistics",
+          "Size of the preprocessed tensors, number of tensor buffers "
+          "allocated and number of times a tensor buffer was acquired",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE));
+  g_object_class_install_property (oclass, PROP_BYPASS_PREPROCESS,
+      g_param_spec_boolean ("bypass-preprocess", "Bypass Preprocess",
+          "Hand packed RGB, BGR or GRAY8 frames to the backend as they are "
+          "if it normalizes 8 bit inputs in the model",
+          DEFAULT_BYPASS_PREPROCESS,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_ASYNC,
+      g_param_spec_boolean ("async", "Asynchronous Inference",
+          "Run the inference on the model buffers in a dedicated thread, "
+          "so a slow model does not hold back the bypass branch",
+          DEFAULT_ASYNC, G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_ASYNC_QUEUE_SIZE,
+      g_param_spec_uint ("async-queue-size", "Asynchronous Queue Size",
+          "Model buffers waiting for the inference thread, further buffers "
+          "are dropped until it catches up. Their bypass buffers are "
+          "forwarded without a prediction",
+          MIN_ASYNC_QUEUE_SIZE, MAX_ASYNC_QUEUE_SIZE, DEFAULT_ASYNC_QUEUE_SIZE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_PIPELINE_DEPTH,
+      g_param_spec_uint ("pipeline-depth", "Pipeline Depth",
+          "Run preprocess, prediction and postprocess of consecutive model "
+          "buffers in separate threads, with up to this many buffers "
+          "waiting for each stage. 0 runs the stages in sequence. With async "
+          "the model buffers arriving while the first stage is full are "
+          "dropped, otherwise they wait",
+          MIN_PIPELINE_DEPTH, MAX_PIPELINE_DEPTH, DEFAULT_PIPELINE_DEPTH,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_PIPELINE_STATS,
+      g_param_spec_boxed ("pipeline-stats", "Pipeline Statistics",
+          "Number of buffers and average and maximum time in microseconds "
+          "spent by each stage of the pipeline",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE));
+  g_object_class_install_property (oclass, PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch Size",
+          "Maximum number of model buffers predicted together in a single "
+          "backend call. The backend must support batches and the model "
+          "must accept the batch as the outermost tensor dimension",
+          MIN_BATCH_SIZE, MAX_BATCH_SIZE, DEFAULT_BATCH_SIZE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_BATCH_TIMEOUT,
+      g_param_spec_uint ("batch-timeout", "Batch Timeout",
+          "Milliseconds a partial batch waits for more model buffers. 0 "
+          "predicts the buffers gathered while the previous batch ran",
+          MIN_BATCH_TIMEOUT, MAX_BATCH_TIMEOUT, DEFAULT_BATCH_TIMEOUT,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_SHARED_MODEL,
+      g_param_spec_boolean ("shared-model", "Shared Model",
+          "Share the loaded model with the other elements running the same "
+          "backend, model location, backend properties, tensor type and "
+          "layout, engine and batch settings. Their model buffers are "
+          "batched together",
+          DEFAULT_SHARED_MODEL, G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_ENGINE_CACHE,
+      g_param_spec_boolean ("engine-cache", "Engine Cache",
+          "Reuse the engine already loaded in this process for the same "
+          "backend, model file and backend properties instead of loading "
+          "the model again. The elements sharing an engine share its "
+          "engine-concurrency limit, and backend properties only change "
+          "at runtime on an engine used by one element", DEFAULT_ENGINE_CACHE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_ENGINE_CONCURRENCY,
+      g_param_spec_uint ("engine-concurrency", "Engine Concurrency",
+          "Maximum number of predictions running at once on a cached engine, "
+          "taken from the element that loaded it. 0 for no limit, only for "
+          "backends whose engines are thread safe",
+          MIN_ENGINE_CONCURRENCY, MAX_ENGINE_CONCURRENCY,
+          DEFAULT_ENGINE_CONCURRENCY,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_ENGINE_INSTANCES,
+      g_param_spec_uint ("engine-instances", "Engine Instances",
+          "Number of backend engines running the loaded model. Above 1 the "
+          "stages are pipelined and as many model buffers are predicted at "
+          "once, the predictions still leave in order",
+          MIN_ENGINE_INSTANCES, MAX_ENGINE_INSTANCES,
+          DEFAULT_ENGINE_INSTANCES,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_WARM_UP_INFERENCES,
+      g_param_spec_uint ("warm-up-inferences", "Warm Up Inferences",
+          "Inferences run on blank tensors of the model input size when the "
+          "model is loaded, going from NULL to READY, so the first buffers "
+          "do not wait for the engine initialization. Their time is posted "
+          "as an \"inference-warm-up\" element message",
+          MIN_WARM_UP_INFERENCES, MAX_WARM_UP_INFERENCES,
+          DEFAULT_WARM_UP_INFERENCES, G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_ASYNC_LOAD,
+      g_param_spec_boolean ("async-load", "Async Load",
+          "Load the model in a background thread from NULL to READY, so "
+          "the elements of a pipeline load their models at once. The "
+          "change to PAUSED completes asynchronously when the model is "
+          "loaded. The load is reported by the \"inference-load-start\" and "
+          "\"inference-load-done\" element messages",
+          DEFAULT_ASYNC_LOAD, G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_INFERENCE_INTERVAL,
+      g_param_spec_uint ("inference-interval", "Inference Interval",
+          "Run the inference on one out of every N model buffers. The "
+          "skipped buffers get the last prediction",
+          MIN_INFERENCE_INTERVAL, MAX_INFERENCE_INTERVAL,
+          DEFAULT_INFERENCE_INTERVAL,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_MAX_INFERENCE_RATE,
+      gst_param_spec_fraction ("max-inference-rate", "Max Inference Rate",
+          "Maximum inferences per second, by buffer timestamps. The "
+          "skipped buffers get the last prediction. 0/1 for no limit",
+          0, 1, G_MAXINT, 1, DEFAULT_MAX_INFERENCE_RATE_N,
+          DEFAULT_MAX_INFERENCE_RATE_D,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_ADAPTIVE_SKIP,
+      g_param_spec_boolean ("adaptive-skip", "Adaptive Skip",
+          "Skip the model buffers arriving faster than the average "
+          "prediction time, they get the last prediction",
+          DEFAULT_ADAPTIVE_SKIP, G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_FLAG_STALE,
+      g_param_spec_boolean ("flag-stale", "Flag Stale",
+          "Mark the metadata of the buffers that got the last prediction "
+          "instead of their own as stale", DEFAULT_FLAG_STALE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_MODEL_QUEUE_SIZE,
+      g_param_spec_uint ("model-queue-size", "Model Queue Size",
+          "Maximum number of predicted model buffers waiting for their "
+          "bypass buffer, the model branch waits or the leaky policy drops "
+          "the excess",
+          MIN_QUEUE_SIZE, MAX_QUEUE_SIZE, DEFAULT_QUEUE_SIZE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_BYPASS_QUEUE_SIZE,
+      g_param_spec_uint ("bypass-queue-size", "Bypass Queue Size",
+          "Maximum number of bypass buffers waiting for their prediction, "
+          "the bypass branch waits or the leaky policy drops the excess",
+          MIN_QUEUE_SIZE, MAX_QUEUE_SIZE, DEFAULT_QUEUE_SIZE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_LEAKY,
+      g_param_spec_enum ("leaky", "Leaky",
+          "Buffer to drop when the model or bypass queue is full, or none "
+          "to wait for room",
+          GST_TYPE_VIDEO_INFERENCE_LEAKY, DEFAULT_LEAKY,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_BYPASS_TIMEOUT,
+      g_param_spec_uint ("bypass-timeout", "Bypass Timeout",
+          "Maximum time in milliseconds, by buffer timestamps, a bypass "
+          "buffer waits for its prediction before being forwarded without "
+          "it. 0 to always wait",
+          MIN_BYPASS_TIMEOUT, MAX_BYPASS_TIMEOUT, DEFAULT_BYPASS_TIMEOUT,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_MATCH_WINDOW,
+      g_param_spec_uint ("match-window", "Match Window",
+          "Maximum distance in milliseconds between the timestamps of a "
+          "bypass buffer and the model buffer it is paired with. Tolerates "
+          "frames dropped or reordered by the model branch. 0 to pair them "
+          "in order by prediction ID",
+          MIN_MATCH_WINDOW, MAX_MATCH_WINDOW, DEFAULT_MATCH_WINDOW,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (oclass, PROP_QUEUE_STATS,
+      g_param_spec_boxed ("queue-stats", "Queue Statistics",
+          "Buffers waiting and dropped in the model and bypass queues and "
+          "average prediction time in nanoseconds",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE));
 
   gst_video_inference_signals[NEW_INFERENCE_SIGNAL] =
       g_signal_new ("new-inference", G_TYPE_FROM_CLASS (klass),
@@ -245,6 +821,9 @@ gst_video_inference_class_init (GstVideoInferenceClass * klass)
   klass->stop = NULL;
   klass->preprocess = NULL;
   klass->postprocess = NULL;
+  klass->postprocess_tensors = NULL;
+  klass->output_tensors = NULL;
+  klass->num_output_tensors = 0;
 
   _size_quark = g_quark_from_static_string (GST_META_TAG_VIDEO_SIZE_STR);
   _orientation_quark =
@@ -261,6 +840,61 @@ gst_video_inference_init (GstVideoInference * self)
   priv->labels = DEFAULT_LABELS;
   priv->labels_list = DEFAULT_LABELS;
   priv->num_labels = DEFAULT_NUM_LABELS;
+  priv->preprocess_threads = DEFAULT_PREPROCESS_THREADS;
+  priv->preprocess_pool = NULL;
+  priv->preprocess_lut = DEFAULT_PREPROCESS_LUT;
+  priv->preprocess_cache =
+      gst_inference_preprocess_cache_new (priv->preprocess_lut);
+  priv->tensor_pool = NULL;
+  priv->tensor_pool_size = 0;
+  priv->bypass_preprocess = DEFAULT_BYPASS_PREPROCESS;
+  priv->backend_raw_input = FALSE;
+  memset (&priv->tensor_info, 0, sizeof (priv->tensor_info));
+  gst_video_info_init (&priv->tensor_video_info);
+  priv->async = DEFAULT_ASYNC;
+  priv->async_queue_size = DEFAULT_ASYNC_QUEUE_SIZE;
+  priv->worker = NULL;
+  priv->pipeline_depth = DEFAULT_PIPELINE_DEPTH;
+  priv->pipeline = NULL;
+  priv->batch_size = DEFAULT_BATCH_SIZE;
+  priv->batch_timeout = DEFAULT_BATCH_TIMEOUT;
+  priv->batch = NULL;
+  priv->shared_model = DEFAULT_SHARED_MODEL;
+  priv->shared = NULL;
+  priv->batch_flushing = FALSE;
+  priv->engine_cache = DEFAULT_ENGINE_CACHE;
+  priv->engine_concurrency = DEFAULT_ENGINE_CONCURRENCY;
+  priv->engine_instances = DEFAULT_ENGINE_INSTANCES;
+  priv->warm_up_inferences = DEFAULT_WARM_UP_INFERENCES;
+  priv->backend_open = FALSE;
+  priv->backend_stale = FALSE;
+  priv->async_load = DEFAULT_ASYNC_LOAD;
+  priv->load_cookie = 0;
+  g_mutex_init (&priv->load_mutex);
+  g_cond_init (&priv->load_cond);
+  priv->loading = FALSE;
+  priv->async_pending = FALSE;
+  priv->load_failed = FALSE;
+  priv->load_flushing = FALSE;
+  priv->inference_interval = DEFAULT_INFERENCE_INTERVAL;
+  priv->max_inference_rate_n = DEFAULT_MAX_INFERENCE_RATE_N;
+  priv->max_inference_rate_d = DEFAULT_MAX_INFERENCE_RATE_D;
+  priv->adaptive_skip = DEFAULT_ADAPTIVE_SKIP;
+  priv->flag_stale = DEFAULT_FLAG_STALE;
+  priv->rate = gst_inference_rate_new ();
+  priv->last_prediction = NULL;
+  priv->model_queue_size = DEFAULT_QUEUE_SIZE;
+  priv->bypass_queue_size = DEFAULT_QUEUE_SIZE;
+  priv->leaky = DEFAULT_LEAKY;
+  priv->model_dropped = 0;
+  priv->bypass_dropped = 0;
+  priv->reported_latency = GST_CLOCK_TIME_NONE;
+  priv->model_flow = GST_FLOW_OK;
+  priv->pipeline_gaps = 0;
+  priv->tensor_layout = DEFAULT_TENSOR_LAYOUT;
+  priv->tensor_type = DEFAULT_TENSOR_TYPE;
+  priv->tensor_scale = DEFAULT_TENSOR_SCALE;
+  priv->tensor_zero_point = DEFAULT_TENSOR_ZERO_POINT;
 
   priv->sink_bypass_data = NULL;
   priv->sink_model_data = NULL;
@@ -271,20 +905,18 @@ gst_video_inference_init (GstVideoInference * self)
   priv->src_model = NULL;
   priv->inference_meta_info = gst_inference_meta_get_info ();
 
-  priv->cpads = gst_collect_pads_new ();
-
-  g_mutex_init (&priv->mtx_model_queue);
-  g_mutex_init (&priv->mtx_bypass_queue);
-
-  priv->model_queue = g_queue_new ();
-  priv->bypass_queue = g_queue_new ();
-
-  /* Use buffer function to handle each pad buffer independently */
-  gst_collect_pads_set_buffer_function (priv->cpads,
-      gst_video_inference_buffer_function, (gpointer) self);
+  priv->model_queue = NULL;
+  priv->bypass_queue = NULL;
+  priv->model_pending = NULL;
+  priv->bypass_pending = NULL;
 
-  gst_collect_pads_set_event_function (priv->cpads,
-      gst_video_inference_sink_event, (gpointer) (self));
+  priv->bypass_timeout = DEFAULT_BYPASS_TIMEOUT;
+  priv->matcher = NULL;
+  priv->match_window = DEFAULT_MATCH_WINDOW;
+  g_mutex_init (&priv->mtx_eos);
+  priv->model_eos = FALSE;
+  priv->bypass_eos = FALSE;
+  priv->model_eos_event = NULL;
 
   priv->model_location = g_strdup (DEFAULT_MODEL_LOCATION);
 
@@ -299,6 +931,7 @@ gst_video_inference_set_property (GObject * object,
   GstVideoInference *self = GST_VIDEO_INFERENCE (object);
   GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
   GstState actual_state;
+  gboolean loading;
 
   GST_LOG_OBJECT (self, "Set Property");
 
@@ -309,12 +942,19 @@ gst_video_inference_set_property (GObject * object,
       GST_OBJECT_UNLOCK (self);
       break;
     case PROP_MODEL_LOCATION:
-      gst_element_get_state (GST_ELEMENT (self), &actual_state, NULL,
-          GST_SECOND);
+      /* Don't wait on the state, a model being loaded could block it */
       GST_OBJECT_LOCK (self);
-      if (actual_state <= GST_STATE_READY) {
+      actual_state = MAX (GST_STATE (self), GST_STATE_NEXT (self));
+      g_mutex_lock (&priv->load_mutex);
+      loading = priv->loading;
+      g_mutex_unlock (&priv->load_mutex);
+      if (loading) {
+        GST_ERROR_OBJECT (self,
+            "Model location can not be set while the model is loading");
+      } else if (actual_state <= GST_STATE_READY) {
         g_free (priv->model_location);
         priv->model_location = g_value_dup_string (value);
+        priv->backend_stale = TRUE;
       } else {
         GST_ERROR_OBJECT (self,
             "Model location can only be set in the NULL or READY states");
@@ -333,6 +973,153 @@ gst_video_inference_set_property (GObject * object,
       priv->num_labels = g_strv_length (priv->labels_list);
       GST_DEBUG_OBJECT (self, "Changed inference labels %s", priv->labels);
       break;
+    case PROP_PREPROCESS_THREADS:
+      GST_OBJECT_LOCK (self);
+      priv->preprocess_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_PREPROCESS_LUT:
+      GST_OBJECT_LOCK (self);
+      priv->preprocess_lut = g_value_get_enum (value);
+      gst_inference_preprocess_cache_set_mode (priv->preprocess_cache,
+          priv->preprocess_lut);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_TENSOR_LAYOUT:
+      GST_OBJECT_LOCK (self);
+      priv->tensor_layout = g_value_get_enum (value);
+      priv->backend_stale |= priv->shared_model;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_TENSOR_TYPE:
+      GST_OBJECT_LOCK (self);
+      priv->tensor_type = g_value_get_enum (value);
+      priv->backend_stale = TRUE;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_TENSOR_SCALE:
+      GST_OBJECT_LOCK (self);
+      priv->tensor_scale = g_value_get_double (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_TENSOR_ZERO_POINT:
+      GST_OBJECT_LOCK (self);
+      priv->tensor_zero_point = g_value_get_int (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BYPASS_PREPROCESS:
+      GST_OBJECT_LOCK (self);
+      priv->bypass_preprocess = g_value_get_boolean (value);
+      priv->backend_stale = TRUE;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ASYNC:
+      GST_OBJECT_LOCK (self);
+      priv->async = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ASYNC_QUEUE_SIZE:
+      GST_OBJECT_LOCK (self);
+      priv->async_queue_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_PIPELINE_DEPTH:
+      GST_OBJECT_LOCK (self);
+      priv->pipeline_depth = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BATCH_SIZE:
+      GST_OBJECT_LOCK (self);
+      priv->batch_size = g_value_get_uint (value);
+      priv->backend_stale |= priv->shared_model;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BATCH_TIMEOUT:
+      GST_OBJECT_LOCK (self);
+      priv->batch_timeout = g_value_get_uint (value);
+      priv->backend_stale |= priv->shared_model;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_SHARED_MODEL:
+      GST_OBJECT_LOCK (self);
+      priv->shared_model = g_value_get_boolean (value);
+      priv->backend_stale = TRUE;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ENGINE_CACHE:
+      GST_OBJECT_LOCK (self);
+      priv->engine_cache = g_value_get_boolean (value);
+      priv->backend_stale = TRUE;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ENGINE_CONCURRENCY:
+      GST_OBJECT_LOCK (self);
+      priv->engine_concurrency = g_value_get_uint (value);
+      priv->backend_stale = TRUE;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ENGINE_INSTANCES:
+      GST_OBJECT_LOCK (self);
+      priv->engine_instances = g_value_get_uint (value);
+      priv->backend_stale = TRUE;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_WARM_UP_INFERENCES:
+      GST_OBJECT_LOCK (self);
+      priv->warm_up_inferences = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ASYNC_LOAD:
+      GST_OBJECT_LOCK (self);
+      priv->async_load = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_INFERENCE_INTERVAL:
+      GST_OBJECT_LOCK (self);
+      priv->inference_interval = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MAX_INFERENCE_RATE:
+      GST_OBJECT_LOCK (self);
+      priv->max_inference_rate_n = gst_value_get_fraction_numerator (value);
+      priv->max_inference_rate_d = gst_value_get_fraction_denominator (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ADAPTIVE_SKIP:
+      GST_OBJECT_LOCK (self);
+      priv->adaptive_skip = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_FLAG_STALE:
+      GST_OBJECT_LOCK (self);
+      priv->flag_stale = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MODEL_QUEUE_SIZE:
+      GST_OBJECT_LOCK (self);
+      priv->model_queue_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BYPASS_QUEUE_SIZE:
+      GST_OBJECT_LOCK (self);
+      priv->bypass_queue_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_LEAKY:
+      GST_OBJECT_LOCK (self);
+      priv->leaky = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BYPASS_TIMEOUT:
+      GST_OBJECT_LOCK (self);
+      priv->bypass_timeout = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MATCH_WINDOW:
+      GST_OBJECT_LOCK (self);
+      priv->match_window = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -358,6 +1145,165 @@ gst_video_inference_get_property (GObject * object,
     case PROP_LABELS:
       g_value_set_string (value, priv->labels);
       break;
+    case PROP_PREPROCESS_THREADS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->preprocess_threads);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_PREPROCESS_LUT:
+      GST_OBJECT_LOCK (self);
+      g_value_set_enum (value, priv->preprocess_lut);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_TENSOR_LAYOUT:
+      GST_OBJECT_LOCK (self);
+      g_value_set_enum (value, priv->tensor_layout);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_TENSOR_TYPE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_enum (value, priv->tensor_type);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_TENSOR_SCALE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_double (value, priv->tensor_scale);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_TENSOR_ZERO_POINT:
+      GST_OBJECT_LOCK (self);
+      g_value_set_int (value, priv->tensor_zero_point);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_TENSOR_POOL_STATS:
+      GST_OBJECT_LOCK (self);
+      if (priv->tensor_pool) {
+        g_value_take_boxed (value,
+            gst_inference_tensor_pool_get_stats (GST_INFERENCE_TENSOR_POOL
+                (priv->tensor_pool)));
+      } else {
+        g_value_take_boxed (value, gst_structure_new ("tensor-pool-stats",
+                "size", G_TYPE_UINT, 0, "allocated", G_TYPE_UINT, 0,
+                "acquired", G_TYPE_UINT64, G_GUINT64_CONSTANT (0), NULL));
+      }
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BYPASS_PREPROCESS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, priv->bypass_preprocess);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ASYNC:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, priv->async);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ASYNC_QUEUE_SIZE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->async_queue_size);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_PIPELINE_DEPTH:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->pipeline_depth);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_PIPELINE_STATS:
+      GST_OBJECT_LOCK (self);
+      g_value_take_boxed (value, video_inference_get_pipeline_stats (self,
+              priv));
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BATCH_SIZE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->batch_size);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BATCH_TIMEOUT:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->batch_timeout);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_SHARED_MODEL:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, priv->shared_model);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ENGINE_CACHE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, priv->engine_cache);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ENGINE_CONCURRENCY:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->engine_concurrency);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ENGINE_INSTANCES:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->engine_instances);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_WARM_UP_INFERENCES:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->warm_up_inferences);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ASYNC_LOAD:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, priv->async_load);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_INFERENCE_INTERVAL:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->inference_interval);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MAX_INFERENCE_RATE:
+      GST_OBJECT_LOCK (self);
+      gst_value_set_fraction (value, priv->max_inference_rate_n,
+          priv->max_inference_rate_d);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ADAPTIVE_SKIP:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, priv->adaptive_skip);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_FLAG_STALE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, priv->flag_stale);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MODEL_QUEUE_SIZE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->model_queue_size);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BYPASS_QUEUE_SIZE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->bypass_queue_size);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_LEAKY:
+      GST_OBJECT_LOCK (self);
+      g_value_set_enum (value, priv->leaky);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BYPASS_TIMEOUT:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->bypass_timeout);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MATCH_WINDOW:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->match_window);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_QUEUE_STATS:
+      g_value_take_boxed (value, video_inference_get_queue_stats (self,
+              priv));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -417,29 +1363,100 @@ gst_video_inference_start (GstVideoInference * self)
   GstVideoInferenceClass *klass = GST_VIDEO_INFERENCE_GET_CLASS (self);
   GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
   gboolean ret = TRUE;
-  GError *err = NULL;
+  gchar *location;
 
   GST_INFO_OBJECT (self, "Starting video inference");
-  if (NULL == priv->model_location) {
-    GST_ELEMENT_ERROR (self, RESOURCE, NOT_FOUND,
-        ("Model Location has not been set"), (NULL));
-    ret = FALSE;
-    goto out;
-  }
 
-  if (!gst_base_backend_start (priv->backend, priv->model_location, &err)) {
-    GST_ELEMENT_ERROR (self, LIBRARY, INIT,
-        ("Could not start the selected backend: (%s)", err->message), (NULL));
-    ret = FALSE;
+  /* The backend is loaded again if its properties changed in READY */
+  if (priv->backend_open && priv->backend_stale) {
+    GST_INFO_OBJECT (self, "Backend properties changed, loading it again");
+    video_inference_close (self, priv);
+  }
+  if (!priv->backend_open) {
+    GST_OBJECT_LOCK (self);
+    location = g_strdup (priv->model_location);
+    GST_OBJECT_UNLOCK (self);
+
+    ret = video_inference_open (self, priv, location);
+    g_free (location);
+    if (!ret) {
+      goto out;
+    }
   }
 
+  GST_OBJECT_LOCK (self);
+  gst_inference_rate_configure (priv->rate, priv->inference_interval,
+      priv->max_inference_rate_n, priv->max_inference_rate_d,
+      priv->adaptive_skip);
+  gst_inference_rate_reset (priv->rate);
+  priv->reported_latency = GST_CLOCK_TIME_NONE;
+  g_atomic_int_set (&priv->model_dropped, 0);
+  g_atomic_int_set (&priv->bypass_dropped, 0);
+  GST_OBJECT_UNLOCK (self);
+
   if (klass->start != NULL) {
     ret = klass->start (self);
   }
 
+  GST_OBJECT_LOCK (self);
+  if (NULL == priv->model_queue) {
+    priv->model_queue = gst_inference_ring_new (priv->model_queue_size);
+    priv->bypass_queue = gst_inference_ring_new (priv->bypass_queue_size);
+  }
+  if (priv->match_window > 0 && NULL == priv->matcher) {
+    priv->matcher =
+        gst_inference_matcher_new (priv->match_window * GST_MSECOND);
+  }
+  if (priv->preprocess_threads > 1 && NULL == priv->preprocess_pool) {
+    GST_INFO_OBJECT (self, "Preprocessing with %u threads",
+        priv->preprocess_threads);
+    priv->preprocess_pool =
+        gst_inference_preprocess_pool_new (priv->preprocess_threads);
+  }
+  if (priv->shared && NULL == priv->batch) {
+    priv->batch = priv->shared->batch;
+    priv->batch_flushing = FALSE;
+    priv->model_flow = GST_FLOW_OK;
+  } else if (priv->batch_size > 1 && NULL == priv->batch) {
+    GST_INFO_OBJECT (self, "Predicting in batches of up to %u buffers",
+        priv->batch_size);
+    if (priv->pipeline_depth > 0) {
+      GST_WARNING_OBJECT (self, "Batches are not pipelined, ignoring the "
+          "pipeline depth");
+    }
+    if (priv->engine_instances > 1) {
+      GST_WARNING_OBJECT (self, "Batches are predicted one at a time, only "
+          "one engine instance is used");
+    }
+    priv->model_flow = GST_FLOW_OK;
+    priv->batch = gst_inference_batch_new ("inference-batch",
+        priv->batch_size, (guint64) priv->batch_timeout * 1000,
+        video_inference_batch_func, video_inference_job_free, self);
+  }
+  if ((priv->pipeline_depth > 0 || priv->engine_instances > 1)
+      && NULL == priv->batch && NULL == priv->pipeline) {
+    GstInferencePipelineStage stages[G_N_ELEMENTS (video_inference_stages)];
+    /* Enough buffers waiting to keep every engine busy */
+    guint depth = MAX (priv->pipeline_depth, priv->engine_instances);
+
+    GST_INFO_OBJECT (self, "Pipelining the inference stages, up to %u "
+        "buffers waiting for each stage and %u predicting at once", depth,
+        priv->engine_instances);
+    memcpy (stages, video_inference_stages, sizeof (stages));
+    stages[VIDEO_INFERENCE_STAGE_PREDICT].threads = priv->engine_instances;
+    priv->model_flow = GST_FLOW_OK;
+    priv->pipeline_gaps = 0;
+    priv->pipeline = gst_inference_pipeline_new (stages,
+        G_N_ELEMENTS (stages), depth, video_inference_job_free, self);
+  } else if (priv->async && NULL == priv->worker) {
+    GST_INFO_OBJECT (self, "Running the inference asynchronously, up to %u "
+        "queued buffers", priv->async_queue_size);
+    priv->worker = gst_inference_worker_new ("inference",
+        priv->async_queue_size, video_inference_worker_func, self);
+  }
+  GST_OBJECT_UNLOCK (self);
+
 out:
-  if (err)
-    g_error_free (err);
   return ret;
 }
 
@@ -449,23 +1466,85 @@ gst_video_inference_stop (GstVideoInference * self)
   GstVideoInferenceClass *klass = GST_VIDEO_INFERENCE_GET_CLASS (self);
   GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
   gboolean ret = TRUE;
-  GError *err = NULL;
 
   GST_INFO_OBJECT (self, "Stopping video inference");
 
-  video_inference_flush_queue (priv->model_queue, &priv->mtx_model_queue);
-  video_inference_flush_queue (priv->bypass_queue, &priv->mtx_bypass_queue);
+  if (priv->worker) {
+    gst_inference_worker_free (priv->worker);
+    priv->worker = NULL;
+  }
 
-  if (!gst_base_backend_stop (priv->backend, &err)) {
-    GST_ELEMENT_ERROR (self, LIBRARY, INIT,
-        ("Could not stop the selected backend: (%s)", err->message), (NULL));
-    ret = FALSE;
+  /* After the worker, which feeds it */
+  if (priv->batch && priv->shared) {
+    gst_inference_batch_flush_owner (priv->batch, self);
+    priv->batch = NULL;
+  } else if (priv->batch) {
+    gst_inference_batch_free (priv->batch);
+    priv->batch = NULL;
   }
 
+  if (priv->pipeline) {
+    GstInferencePipeline *pipeline;
+    GstStructure *stats;
+
+    GST_OBJECT_LOCK (self);
+    stats = video_inference_get_pipeline_stats (self, priv);
+    pipeline = priv->pipeline;
+    priv->pipeline = NULL;
+    GST_OBJECT_UNLOCK (self);
+
+    GST_INFO_OBJECT (self, "Pipeline statistics: %" GST_PTR_FORMAT, stats);
+    gst_structure_free (stats);
+    /* The stage threads take the object lock, join them without it */
+    gst_inference_pipeline_free (pipeline);
+  }
+
+  if (priv->model_queue) {
+    GstInferenceRing *model_queue, *bypass_queue;
+    GstStructure *stats = video_inference_get_queue_stats (self, priv);
+
+    GST_INFO_OBJECT (self, "Queue statistics: %" GST_PTR_FORMAT, stats);
+    gst_structure_free (stats);
+
+    GST_OBJECT_LOCK (self);
+    model_queue = priv->model_queue;
+    bypass_queue = priv->bypass_queue;
+    priv->model_queue = NULL;
+    priv->bypass_queue = NULL;
+    GST_OBJECT_UNLOCK (self);
+
+    video_inference_flush_queue (model_queue, &priv->model_pending);
+    video_inference_flush_queue (bypass_queue, &priv->bypass_pending);
+    gst_inference_ring_free (model_queue);
+    gst_inference_ring_free (bypass_queue);
+  }
+
+  if (priv->matcher) {
+    gst_inference_matcher_free (priv->matcher,
+        (GDestroyNotify) gst_buffer_unref);
+    priv->matcher = NULL;
+  }
+
+  GST_INFO_OBJECT (self, "Skipped the inference on %" G_GUINT64_FORMAT
+      " buffers", gst_inference_rate_get_skipped (priv->rate));
+  GST_OBJECT_LOCK (self);
+  if (priv->last_prediction) {
+    gst_inference_prediction_unref (priv->last_prediction);
+    priv->last_prediction = NULL;
+  }
+  GST_OBJECT_UNLOCK (self);
+
   if (klass->stop != NULL) {
     ret = klass->stop (self);
   }
 
+  if (priv->preprocess_pool) {
+    gst_inference_preprocess_pool_free (priv->preprocess_pool);
+    priv->preprocess_pool = NULL;
+  }
+
+  video_inference_set_tensor_pool (self, NULL, 0);
+
   return ret;
 }
 
@@ -476,19 +1555,78 @@ gst_video_inference_change_state (GstElement * element,
   GstStateChangeReturn ret;
   GstVideoInference *self = GST_VIDEO_INFERENCE (element);
   GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstVideoInferenceLoad *load;
+  gboolean async_load;
+  gboolean async_pending = FALSE;
+  gboolean opened;
+  gchar *location;
 
   switch (transition) {
+    case GST_STATE_CHANGE_NULL_TO_READY:
+      GST_OBJECT_LOCK (self);
+      location = g_strdup (priv->model_location);
+      async_load = priv->async_load;
+      GST_OBJECT_UNLOCK (self);
+
+      /* Otherwise the model is loaded once set, going to PAUSED */
+      if (NULL == location || priv->backend_open) {
+        g_free (location);
+        break;
+      }
+
+      if (async_load) {
+        load = g_new0 (GstVideoInferenceLoad, 1);
+        load->self = (GstVideoInference *) gst_object_ref (self);
+        load->location = location;
+        g_mutex_lock (&priv->load_mutex);
+        priv->loading = TRUE;
+        load->cookie = ++priv->load_cookie;
+        g_mutex_unlock (&priv->load_mutex);
+        /* Not joined, it may be waiting for the state lock held by the
+         * change that cancels its commit */
+        g_thread_unref (g_thread_new ("model-load", video_inference_load_func,
+                load));
+        break;
+      }
+
+      opened = video_inference_open (self, priv, location);
+      g_free (location);
+      if (FALSE == opened) {
+        ret = GST_STATE_CHANGE_FAILURE;
+        goto out;
+      }
+      break;
     case GST_STATE_CHANGE_READY_TO_PAUSED:
-      if (FALSE == gst_video_inference_start (self)) {
+      /* The load thread starts it once the model is loaded */
+      g_mutex_lock (&priv->load_mutex);
+      priv->load_flushing = FALSE;
+      priv->load_failed = FALSE;
+      priv->async_pending = priv->loading;
+      async_pending = priv->async_pending;
+      g_mutex_unlock (&priv->load_mutex);
+
+      if (!async_pending && FALSE == gst_video_inference_start (self)) {
         GST_ERROR_OBJECT (self, "Subclass failed to start");
         ret = GST_STATE_CHANGE_FAILURE;
         goto out;
       }
 
-      gst_collect_pads_start (priv->cpads);
+      g_mutex_lock (&priv->mtx_eos);
+      priv->model_eos = FALSE;
+      priv->bypass_eos = FALSE;
+      gst_event_replace (&priv->model_eos_event, NULL);
+      g_mutex_unlock (&priv->mtx_eos);
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
-      gst_collect_pads_stop (priv->cpads);
+      /* Cancels a start still waiting for the model */
+      g_mutex_lock (&priv->load_mutex);
+      priv->async_pending = FALSE;
+      priv->load_flushing = TRUE;
+      g_cond_broadcast (&priv->load_cond);
+      g_mutex_unlock (&priv->load_mutex);
+
+      video_inference_set_flushing (self, priv, TRUE);
+      video_inference_update_queue (self, priv, TRUE);
       break;
     default:
       break;
@@ -499,10 +1637,23 @@ gst_video_inference_change_state (GstElement * element,
       (element, transition);
   if (GST_STATE_CHANGE_FAILURE == ret) {
     GST_ERROR_OBJECT (self, "Parent failed to change state");
+    if (async_pending) {
+      g_mutex_lock (&priv->load_mutex);
+      priv->async_pending = FALSE;
+      g_mutex_unlock (&priv->load_mutex);
+    }
     goto out;
   }
 
   switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      if (async_pending) {
+        GST_INFO_OBJECT (self, "Waiting for the model to load");
+        gst_element_post_message (element,
+            gst_message_new_async_start (GST_OBJECT (self)));
+        ret = GST_STATE_CHANGE_ASYNC;
+      }
+      break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       if (FALSE == gst_video_inference_stop (self)) {
         GST_ERROR_OBJECT (self, "Subclass failed to stop");
@@ -510,7 +1661,19 @@ gst_video_inference_change_state (GstElement * element,
         goto out;
       }
       break;
-    default:
+    case GST_STATE_CHANGE_READY_TO_NULL:
+      /* A model still loading is closed once loaded */
+      g_mutex_lock (&priv->load_mutex);
+      while (priv->loading) {
+        g_cond_wait (&priv->load_cond, &priv->load_mutex);
+      }
+      g_mutex_unlock (&priv->load_mutex);
+      if (priv->backend_open && FALSE == video_inference_close (self, priv)) {
+        ret = GST_STATE_CHANGE_FAILURE;
+        goto out;
+      }
+      break;
+    default:
       break;
   }
 
@@ -532,15 +1695,15 @@ gst_video_inference_create_pad (GstVideoInference * self,
   if (GST_PAD_IS_SINK (pad)) {
     g_return_val_if_fail (data, NULL);
 
-    *data =
-        (GstVideoInferencePad *) gst_collect_pads_add_pad (priv->cpads, pad,
-        sizeof (GstVideoInferencePad), NULL, FALSE);
-    if (NULL == *data) {
-      GST_ERROR_OBJECT (self, "Unable to add pad %s to collect pads", name);
-      goto free_pad;
-    }
+    /* Each branch is processed in its own streaming thread */
+    *data = g_new0 (GstVideoInferencePad, 1);
+    (*data)->pad = pad;
+    gst_video_info_init (&(*data)->info);
+    gst_pad_set_chain_function (pad, gst_video_inference_sink_chain);
+    gst_pad_set_event_function (pad, gst_video_inference_sink_event);
   } else {
     gst_pad_set_event_function (pad, gst_video_inference_src_event);
+    gst_pad_set_query_function (pad, gst_video_inference_src_query);
   }
 
   if (FALSE == gst_element_add_pad (element, pad)) {
@@ -558,9 +1721,10 @@ gst_video_inference_create_pad (GstVideoInference * self,
   return GST_PAD_CAST (gst_object_ref (pad));
 
 remove_pad:
-  gst_collect_pads_remove_pad (priv->cpads, pad);
-
-free_pad:
+  if (data) {
+    g_free (*data);
+    *data = NULL;
+  }
   gst_object_unref (pad);
   return NULL;
 }
@@ -630,8 +1794,8 @@ gst_video_inference_release_pad (GstElement * element, GstPad * pad)
   }
 
   if (GST_PAD_IS_SINK (pad)) {
+    g_free (*data);
     *data = NULL;
-    gst_collect_pads_remove_pad (priv->cpads, pad);
   }
 
   g_clear_object (ourpad);
@@ -696,36 +1860,149 @@ gst_video_inference_forward_buffer (GstVideoInference * self,
 }
 
 static void
-video_inference_map_buffers (GstVideoInferencePad * cpad, GstBuffer * inbuf,
-    GstVideoFrame * inframe, GstVideoFrame * outframe)
+video_inference_set_tensor_pool (GstVideoInference * self,
+    GstBufferPool * pool, gsize size)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstBufferPool *old;
+
+  GST_OBJECT_LOCK (self);
+  old = priv->tensor_pool;
+  priv->tensor_pool = pool;
+  priv->tensor_pool_size = size;
+  GST_OBJECT_UNLOCK (self);
+
+  if (old) {
+    gst_buffer_pool_set_active (old, FALSE);
+    gst_object_unref (old);
+  }
+}
+
+static GstBuffer *
+video_inference_acquire_tensor (GstVideoInference * self, gsize size)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstBufferPool *pool = NULL;
+  GstBuffer *buffer = NULL;
+  gsize pool_size = 0;
+
+  /* The size is kept with the pool, reading the pool config would
+   * copy its structure on every frame */
+  GST_OBJECT_LOCK (self);
+  if (priv->tensor_pool) {
+    pool = gst_object_ref (priv->tensor_pool);
+    pool_size = priv->tensor_pool_size;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  /* Tensors keep their size until the caps or the tensor type change,
+   * so the pool is only rebuilt on those renegotiations */
+  if (pool_size != size) {
+    GST_DEBUG_OBJECT (self, "Creating tensor pool of %" G_GSIZE_FORMAT
+        " byte buffers", size);
+    if (pool) {
+      gst_object_unref (pool);
+    }
+    pool = gst_inference_tensor_pool_new (size);
+    if (pool) {
+      video_inference_set_tensor_pool (self, gst_object_ref (pool), size);
+    }
+  }
+
+  if (pool) {
+    if (GST_FLOW_OK != gst_buffer_pool_acquire_buffer (pool, &buffer, NULL)) {
+      buffer = NULL;
+    }
+    gst_object_unref (pool);
+  }
+
+  /* Fall back to a one-shot allocation if the pool is not usable */
+  if (NULL == buffer) {
+    GST_WARNING_OBJECT (self, "Unable to acquire a pooled tensor buffer");
+    buffer = gst_buffer_new_allocate (NULL, size, NULL);
+  }
+
+  return buffer;
+}
+
+static void
+video_inference_update_tensor_info (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstVideoInfo * info)
+{
+  GstInferenceTensorInfo tensor_info;
+  GstInferenceTensorType tensor_type;
+  GstInferenceTensorLayout tensor_layout;
+
+  GST_OBJECT_LOCK (self);
+  tensor_type = priv->tensor_type;
+  tensor_layout = priv->tensor_layout;
+  GST_OBJECT_UNLOCK (self);
+
+  if (!gst_inference_tensor_info_from_video_info (&tensor_info, info,
+          tensor_type, tensor_layout)) {
+    GST_WARNING_OBJECT (self, "Unable to describe the model tensor");
+    return;
+  }
+
+  GST_INFO_OBJECT (self, "Model tensor of %" G_GSIZE_FORMAT " x %"
+      G_GSIZE_FORMAT " x %" G_GSIZE_FORMAT " x %" G_GSIZE_FORMAT
+      ", %" G_GSIZE_FORMAT " bytes", tensor_info.shape[0],
+      tensor_info.shape[1], tensor_info.shape[2], tensor_info.shape[3],
+      tensor_info.size);
+
+  GST_OBJECT_LOCK (self);
+  priv->tensor_info = tensor_info;
+  gst_inference_tensor_info_to_video_info (&priv->tensor_info,
+      &priv->tensor_video_info);
+  GST_OBJECT_UNLOCK (self);
+
+  gst_base_backend_set_tensor_info (video_inference_get_backend (priv),
+      &tensor_info);
+}
+
+static gboolean
+video_inference_map_buffers (GstVideoInference * self,
+    GstVideoInferencePad * cpad, GstBuffer * inbuf, GstVideoFrame * inframe,
+    GstVideoFrame * outframe)
 {
-  GstVideoInfo *info;
-  GstAllocationParams params;
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstVideoInfo tensor_video_info;
   GstBuffer *outbuf;
-  gsize size;
   GstMapFlags inflags;
   GstMapFlags outflags;
 
-  g_return_if_fail (cpad);
-  g_return_if_fail (inbuf);
-  g_return_if_fail (inframe);
-  g_return_if_fail (outframe);
+  g_return_val_if_fail (self, FALSE);
+  g_return_val_if_fail (cpad, FALSE);
+  g_return_val_if_fail (inbuf, FALSE);
+  g_return_val_if_fail (inframe, FALSE);
+  g_return_val_if_fail (outframe, FALSE);
 
-  info = &(cpad->info);
+  GST_OBJECT_LOCK (self);
+  tensor_video_info = priv->tensor_video_info;
+  GST_OBJECT_UNLOCK (self);
 
-  /* Allocate an output buffer for the pre-processed data */
-  gst_allocation_params_init (&params);
-  size = gst_buffer_get_size (inbuf);
-  outbuf = gst_buffer_new_allocate (NULL, size * sizeof (float), &params);
+  /* Acquire an output buffer with the exact size of the negotiated
+   * tensor, the frame maps it with the tensor dimensions */
+  outbuf = video_inference_acquire_tensor (self,
+      GST_VIDEO_INFO_SIZE (&tensor_video_info));
 
   /* Map buffers into their respective output frames but dont increase
    * the refcount so we can add metas later on.
    */
   inflags = (GstMapFlags) (GST_MAP_READ | GST_VIDEO_FRAME_MAP_FLAG_NO_REF);
-  gst_video_frame_map (inframe, info, inbuf, inflags);
+  if (!gst_video_frame_map (inframe, &cpad->info, inbuf, inflags)) {
+    gst_buffer_unref (outbuf);
+    return FALSE;
+  }
 
   outflags = (GstMapFlags) (GST_MAP_WRITE | GST_VIDEO_FRAME_MAP_FLAG_NO_REF);
-  gst_video_frame_map (outframe, info, outbuf, outflags);
+  if (!gst_video_frame_map (outframe, &tensor_video_info, outbuf, outflags)) {
+    gst_video_frame_unmap (inframe);
+    gst_buffer_unref (outbuf);
+    return FALSE;
+  }
+
+  return TRUE;
 }
 
 static gboolean
@@ -733,6 +2010,13 @@ gst_video_inference_preprocess (GstVideoInference * self,
     GstVideoInferenceClass * klass, GstVideoFrame * inframe,
     GstVideoFrame * outframe)
 {
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstInferenceTensorLayout layout;
+  GstInferenceTensorType tensor_type;
+  gdouble tensor_scale;
+  gint tensor_zero_point;
+  gboolean ret;
+
   g_return_val_if_fail (self, FALSE);
   g_return_val_if_fail (klass, FALSE);
   g_return_val_if_fail (inframe, FALSE);
@@ -746,7 +2030,28 @@ gst_video_inference_preprocess (GstVideoInference * self,
 
   GST_LOG_OBJECT (self, "Calling frame preprocess");
 
-  if (!klass->preprocess (self, inframe, outframe)) {
+  GST_OBJECT_LOCK (self);
+  layout = priv->tensor_layout;
+  tensor_type = priv->tensor_type;
+  tensor_scale = priv->tensor_scale;
+  tensor_zero_point = priv->tensor_zero_point;
+  GST_OBJECT_UNLOCK (self);
+
+  /* Preprocess helpers called by the subclass will split the frame
+   * among the pool threads and write the configured layout and type */
+  gst_inference_preprocess_pool_set_current (priv->preprocess_pool);
+  gst_inference_preprocess_cache_set_current (priv->preprocess_cache);
+  gst_inference_preprocess_set_layout (layout);
+  gst_inference_preprocess_set_tensor_type (tensor_type, tensor_scale,
+      tensor_zero_point);
+  ret = klass->preprocess (self, inframe, outframe);
+  gst_inference_preprocess_set_tensor_type (GST_INFERENCE_TENSOR_TYPE_FLOAT,
+      DEFAULT_TENSOR_SCALE, DEFAULT_TENSOR_ZERO_POINT);
+  gst_inference_preprocess_set_layout (GST_INFERENCE_TENSOR_LAYOUT_NHWC);
+  gst_inference_preprocess_cache_set_current (NULL);
+  gst_inference_preprocess_pool_set_current (NULL);
+
+  if (!ret) {
     GST_ELEMENT_ERROR (self, STREAM, FAILED,
         ("Subclass failed to preprocess"), (NULL));
     return FALSE;
@@ -757,21 +2062,32 @@ gst_video_inference_preprocess (GstVideoInference * self,
 
 static gboolean
 gst_video_inference_predict (GstVideoInference * self,
-    GstVideoInferencePrivate * priv, GstVideoFrame * frame, gpointer * pred,
-    gsize * pred_size)
+    GstVideoInferencePrivate * priv, GstVideoFrame * frame, gboolean raw,
+    GstBuffer ** pred)
 {
   GError *error = NULL;
+  gboolean ret;
+  gint64 start;
 
   g_return_val_if_fail (self, FALSE);
   g_return_val_if_fail (priv, FALSE);
   g_return_val_if_fail (frame, FALSE);
   g_return_val_if_fail (pred, FALSE);
-  g_return_val_if_fail (pred_size, FALSE);
 
   GST_LOG_OBJECT (self, "Running prediction on frame");
 
-  if (!gst_base_backend_process_frame (priv->backend, frame, pred, pred_size,
-          &error)) {
+  start = g_get_monotonic_time ();
+
+  if (raw) {
+    ret = gst_base_backend_process_raw_frame (video_inference_get_backend
+        (priv), frame, pred, &error);
+  } else {
+    ret = gst_base_backend_process_frame (video_inference_get_backend (priv),
+        frame, pred, &error);
+  }
+  video_inference_add_latency (self, priv, start);
+
+  if (!ret) {
     GST_ELEMENT_ERROR (self, STREAM, FAILED,
         ("Could not process using the selected backend: (%s)", error->message),
         (NULL));
@@ -783,42 +2099,334 @@ gst_video_inference_predict (GstVideoInference * self,
 }
 
 static gboolean
-gst_video_inference_model_run_prediction (GstVideoInference * self,
-    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
-    GstBuffer * buffer, gpointer * prediction_data, gsize * prediction_size)
+gst_video_inference_predict_batch (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstVideoFrame * frames, guint n_frames,
+    GstBuffer ** preds, GError ** error)
 {
-  GstVideoFrame inframe, outframe;
-  GstBuffer *outbuf;
-  gboolean ret;
+  g_return_val_if_fail (self, FALSE);
+  g_return_val_if_fail (priv, FALSE);
+  g_return_val_if_fail (frames, FALSE);
+  g_return_val_if_fail (preds, FALSE);
+
+  GST_LOG_OBJECT (self, "Running prediction on a batch of %u frames",
+      n_frames);
+
+  /* The latency and the errors go to every element with frames in it */
+  return gst_base_backend_process_batch (video_inference_get_backend (priv),
+      frames, n_frames, preds, error);
+}
+
+static gboolean
+video_inference_can_bypass (GstVideoInfo * info)
+{
+  GstVideoFormat format;
+
+  g_return_val_if_fail (info, FALSE);
+
+  format = GST_VIDEO_INFO_FORMAT (info);
+  if (GST_VIDEO_FORMAT_RGB != format && GST_VIDEO_FORMAT_BGR != format
+      && GST_VIDEO_FORMAT_GRAY8 != format) {
+    return FALSE;
+  }
+
+  /* The backend expects tightly packed rows */
+  return GST_VIDEO_INFO_PLANE_STRIDE (info, 0) ==
+      GST_VIDEO_INFO_WIDTH (info) * GST_VIDEO_INFO_COMP_PSTRIDE (info, 0);
+}
+
+static gboolean
+gst_video_inference_model_map (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstVideoInferenceJob * job)
+{
+  GstMapFlags inflags;
+  gboolean raw_input;
 
   g_return_val_if_fail (self, FALSE);
-  g_return_val_if_fail (klass, FALSE);
   g_return_val_if_fail (priv, FALSE);
-  g_return_val_if_fail (buffer, FALSE);
-  g_return_val_if_fail (prediction_data, FALSE);
-  g_return_val_if_fail (prediction_size, FALSE);
+  g_return_val_if_fail (job, FALSE);
+
+  GST_OBJECT_LOCK (self);
+  raw_input = priv->backend_raw_input;
+  GST_OBJECT_UNLOCK (self);
+
+  /* Backends that normalize in the model take the input frame directly,
+   * skipping the tensor copy altogether */
+  job->raw = raw_input && video_inference_can_bypass (&job->info);
+  if (job->raw) {
+    inflags = (GstMapFlags) (GST_MAP_READ | GST_VIDEO_FRAME_MAP_FLAG_NO_REF);
+    if (!gst_video_frame_map (&job->inframe, &job->info, job->buffer,
+            inflags)) {
+      GST_ELEMENT_ERROR (self, STREAM, FAILED,
+          ("Unable to map the model frame"), (NULL));
+      return FALSE;
+    }
+    GST_LOG_OBJECT (self, "Bypassing preprocess");
+  } else if (!video_inference_map_buffers (self, priv->sink_model_data,
+          job->buffer, &job->inframe, &job->outframe)) {
+    GST_ELEMENT_ERROR (self, STREAM, FAILED,
+        ("Unable to map the model frame and tensor"), (NULL));
+    return FALSE;
+  }
+
+  job->mapped = TRUE;
+
+  return TRUE;
+}
+
+static void
+video_inference_job_unmap (GstVideoInferenceJob * job)
+{
+  GstBuffer *outbuf;
+
+  g_return_if_fail (job);
+
+  if (!job->mapped) {
+    return;
+  }
+
+  gst_video_frame_unmap (&job->inframe);
+  if (!job->raw) {
+    outbuf = job->outframe.buffer;
+    gst_video_frame_unmap (&job->outframe);
+    gst_buffer_unref (outbuf);
+  }
+  job->mapped = FALSE;
+}
+
+static void
+video_inference_job_free (gpointer data, gpointer user_data)
+{
+  GstVideoInferenceJob *job = (GstVideoInferenceJob *) data;
+
+  g_return_if_fail (job);
+
+  video_inference_job_unmap (job);
+  if (job->event) {
+    gst_event_unref (job->event);
+  }
+  if (job->buffer) {
+    gst_buffer_unref (job->buffer);
+  }
+  gst_buffer_replace (&job->prediction, NULL);
+  g_free (job);
+}
+
+static GstFlowReturn
+video_inference_job_start (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePad * pad,
+    GstVideoInferenceJob * job)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstInferenceMeta *inference_meta;
+
+  g_return_val_if_fail (self, GST_FLOW_ERROR);
+  g_return_val_if_fail (klass, GST_FLOW_ERROR);
+  g_return_val_if_fail (pad, GST_FLOW_ERROR);
+  g_return_val_if_fail (job, GST_FLOW_ERROR);
+
+  if (NULL == klass->postprocess && NULL == klass->postprocess_tensors) {
+    GST_ELEMENT_ERROR (self, STREAM, FAILED,
+        ("Subclass didn't implement post-process"), (NULL));
+    return GST_FLOW_ERROR;
+  }
+
+  /* Later stages may run after a renegotiation, keep the format this
+   * buffer was negotiated with */
+  job->info = pad->info;
+  job->buffer = gst_buffer_make_writable (job->buffer);
+  job->meta =
+      gst_buffer_get_meta (job->buffer, gst_inference_meta_api_get_type ());
+  job->infer = TRUE;
+  if (job->meta) {
+    /* Check if root is enabled to be processed, if not, just forward buffer */
+    inference_meta = (GstInferenceMeta *) job->meta;
+    if (!inference_meta->prediction->enabled) {
+      GST_INFO_OBJECT (self,
+          "Current Prediction is not enabled, bypassing processing...");
+      job->infer = FALSE;
+    }
+  }
 
-  video_inference_map_buffers (priv->sink_model_data, buffer, &inframe,
-      &outframe);
-  outbuf = outframe.buffer;
+  if (job->infer && !gst_inference_rate_check (priv->rate,
+          GST_BUFFER_PTS (job->buffer))) {
+    GST_LOG_OBJECT (self, "Skipping the inference on this buffer");
+    job->infer = FALSE;
+    job->skipped = TRUE;
+  }
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+video_inference_job_preprocess (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstVideoInferenceJob * job)
+{
+  g_return_val_if_fail (job, FALSE);
+
+  if (!gst_video_inference_model_map (self, priv, job)) {
+    return FALSE;
+  }
+
+  if (!job->raw && !gst_video_inference_preprocess (self, klass,
+          &job->inframe, &job->outframe)) {
+    video_inference_job_unmap (job);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+video_inference_job_predict (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstVideoInferenceJob * job)
+{
+  gboolean ret;
+
+  g_return_val_if_fail (job, FALSE);
+
+  ret = gst_video_inference_predict (self, priv,
+      job->raw ? &job->inframe : &job->outframe, job->raw, &job->prediction);
+
+  /* Return the tensor to the pool as soon as the backend is done */
+  video_inference_job_unmap (job);
+
+  return ret;
+}
+
+void
+gst_video_inference_class_set_output_tensors (GstVideoInferenceClass * klass,
+    const GstVideoInferenceTensorDesc * tensors, guint num_tensors)
+{
+  guint i;
+
+  g_return_if_fail (klass);
+  g_return_if_fail (tensors || 0 == num_tensors);
+
+  for (i = 0; i < num_tensors; ++i) {
+    g_return_if_fail (tensors[i].num_dims > 0);
+    g_return_if_fail (tensors[i].num_dims <= GST_INFERENCE_TENSOR_DIMS);
+  }
+
+  klass->output_tensors = tensors;
+  klass->num_output_tensors = num_tensors;
+}
+
+const GstVideoInferenceTensor *
+gst_video_inference_tensor_find (const GstVideoInferenceTensor * tensors,
+    guint num_tensors, const gchar * name)
+{
+  guint i;
+
+  g_return_val_if_fail (tensors || 0 == num_tensors, NULL);
+  g_return_val_if_fail (name, NULL);
+
+  for (i = 0; i < num_tensors; ++i) {
+    if (tensors[i].name && 0 == g_strcmp0 (tensors[i].name, name)) {
+      return &tensors[i];
+    }
+  }
+
+  return NULL;
+}
+
+static gboolean
+video_inference_map_tensor (GstVideoInference * self, GstMemory * memory,
+    const GstVideoInferenceTensorDesc * desc, GstVideoInferenceTensor * tensor,
+    GstMapInfo * map)
+{
+  gsize element_size, known = 1;
+  gint unknown = -1;
+  guint i;
+
+  if (desc) {
+    tensor->name = desc->name;
+    tensor->type = desc->type;
+    tensor->num_dims = desc->num_dims;
+    memcpy (tensor->shape, desc->shape, sizeof (tensor->shape));
+  } else {
+    tensor->name = NULL;
+    tensor->type = GST_INFERENCE_TENSOR_TYPE_FLOAT;
+    tensor->num_dims = 1;
+    memset (tensor->shape, 0, sizeof (tensor->shape));
+  }
+
+  if (!gst_memory_map (memory, map, GST_MAP_READ)) {
+    GST_ERROR_OBJECT (self, "Could not map output tensor %s", tensor->name);
+    return FALSE;
+  }
+  tensor->data = map->data;
+  tensor->size = map->size;
+
+  element_size = gst_inference_tensor_type_get_size (tensor->type);
+  for (i = 0; i < tensor->num_dims; ++i) {
+    if (0 == tensor->shape[i]) {
+      unknown = i;
+    } else {
+      known *= tensor->shape[i];
+    }
+  }
+
+  /* Only the unknown dimension can absorb the rest of the output */
+  if (0 != tensor->size % (element_size * known)
+      || (unknown < 0 && tensor->size != element_size * known)) {
+    GST_ERROR_OBJECT (self, "Output tensor %s has %" G_GSIZE_FORMAT
+        " bytes, which don't fit its shape", tensor->name, tensor->size);
+    return FALSE;
+  }
+  if (unknown >= 0) {
+    tensor->shape[unknown] = tensor->size / (element_size * known);
+  }
+
+  return TRUE;
+}
+
+static gboolean
+video_inference_postprocess_tensors (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstBuffer * prediction, GstMeta * meta_model, GstVideoInfo * info_model,
+    gboolean * valid_prediction)
+{
+  GstVideoInferenceTensor *tensors;
+  GstMapInfo *maps;
+  guint num_tensors, num_mapped = 0;
+  gboolean ret = FALSE;
+  guint i;
 
-  if (!gst_video_inference_preprocess (self, klass, &inframe, &outframe)) {
-    ret = FALSE;
-    goto free_frames;
+  num_tensors = gst_buffer_n_memory (prediction);
+  if (klass->num_output_tensors > 0
+      && num_tensors != klass->num_output_tensors) {
+    GST_ERROR_OBJECT (self, "The model has %u outputs, %u expected",
+        num_tensors, klass->num_output_tensors);
+    return FALSE;
   }
 
-  if (!gst_video_inference_predict (self, priv, &outframe, prediction_data,
-          prediction_size)) {
-    ret = FALSE;
-    goto free_frames;
+  tensors = g_new0 (GstVideoInferenceTensor, num_tensors);
+  maps = g_new0 (GstMapInfo, num_tensors);
+
+  /* Every output is read in place */
+  for (num_mapped = 0; num_mapped < num_tensors; ++num_mapped) {
+    if (!video_inference_map_tensor (self, gst_buffer_peek_memory (prediction,
+                num_mapped), klass->num_output_tensors > 0 ?
+            &klass->output_tensors[num_mapped] : NULL, &tensors[num_mapped],
+            &maps[num_mapped])) {
+      goto unmap;
+    }
   }
 
-  ret = TRUE;
+  ret = klass->postprocess_tensors (self, tensors, num_tensors, meta_model,
+      info_model, valid_prediction, priv->labels_list, priv->num_labels);
 
-free_frames:
-  gst_video_frame_unmap (&inframe);
-  gst_video_frame_unmap (&outframe);
-  gst_buffer_unref (outbuf);
+unmap:
+  for (i = 0; i < num_mapped; ++i) {
+    gst_memory_unmap (maps[i].memory, &maps[i]);
+  }
+  /* The failed one may have been mapped */
+  if (num_mapped < num_tensors && maps[num_mapped].memory) {
+    gst_memory_unmap (maps[num_mapped].memory, &maps[num_mapped]);
+  }
+  g_free (maps);
+  g_free (tensors);
 
   return ret;
 }
@@ -879,91 +2487,97 @@ video_inference_transform_meta (GstBuffer * buffer_model,
 }
 
 static GstFlowReturn
-gst_video_inference_process_model (GstVideoInference * self, GstBuffer * buffer,
-    GstVideoInferencePad * pad)
+video_inference_job_finish (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstVideoInferencePad * pad, GstVideoInferenceJob * job)
 {
-  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
-  GstVideoInferenceClass *klass = GST_VIDEO_INFERENCE_GET_CLASS (self);
   GstFlowReturn ret = GST_FLOW_OK;
-  GstMeta *current_meta = NULL;
   GstMeta *meta_model = NULL;
   GstVideoInfo *info_model = NULL;
   GstBuffer *buffer_model = NULL;
-  gpointer prediction_data = NULL;
-  gsize prediction_size;
   gboolean pred_valid = FALSE;
+  gboolean pred_ok;
+  GstMapInfo map;
 
-  g_return_val_if_fail (self != NULL, GST_FLOW_ERROR);
-  g_return_val_if_fail (buffer != NULL, GST_FLOW_ERROR);
-  g_return_val_if_fail (pad != NULL, GST_FLOW_ERROR);
-
-  GST_LOG_OBJECT (self, "Processing model buffer");
+  g_return_val_if_fail (job, GST_FLOW_ERROR);
 
-  if (NULL == klass->postprocess) {
-    GST_ELEMENT_ERROR (self, STREAM, FAILED,
-        ("Subclass didn't implement post-process"), (NULL));
-    ret = GST_FLOW_ERROR;
-    goto out;
-  }
+  buffer_model = job->buffer;
+  job->buffer = NULL;
 
-  buffer_model = gst_buffer_make_writable (buffer);
-  current_meta =
-      gst_buffer_get_meta (buffer_model, gst_inference_meta_api_get_type ());
-  if (current_meta) {
-    /* Check if root is enabled to be processed, if not, just forward buffer */
-    GstInferenceMeta *inference_meta = (GstInferenceMeta *) current_meta;
-    GstInferencePrediction *root = inference_meta->prediction;
-    if (!root->enabled) {
-      GST_INFO_OBJECT (self,
-          "Current Prediction is not enabled, bypassing processing...");
-      goto forward_buffer;
-    }
+  if (GST_FLOW_OK != job->ret) {
+    ret = job->ret;
+    goto buffer_free;
   }
 
-  /* Run preprocess and inference on the model and generate prediction */
-  if (!gst_video_inference_model_run_prediction (self, klass, priv,
-          buffer_model, &prediction_data, &prediction_size)) {
-    ret = GST_FLOW_ERROR;
-    goto buffer_free;
+  if (!job->infer && !job->skipped) {
+    goto forward_buffer;
   }
 
   /* Assign already created inferencemeta, no need to create a new one */
-  meta_model = current_meta;
+  meta_model = job->meta;
 
   /* Prepare postprocess */
-  info_model = &(pad->info);
+  info_model = &job->info;
   if (!video_inference_prepare_postprocess (buffer_model, info_model,
       &meta_model)) {
     ret = GST_FLOW_ERROR;
     goto buffer_free;
   }
 
+  /* Skipped buffers keep the overlays going with the last prediction */
+  if (job->skipped) {
+    video_inference_reuse_prediction (self, priv, NULL == job->meta,
+        (GstInferenceMeta *) meta_model);
+    goto queue_buffer;
+  }
+
   /* Subclass Processing */
-  if (!klass->postprocess (self, prediction_data, prediction_size,
-          meta_model, info_model, &pred_valid, priv->labels_list,
-          priv->num_labels)) {
+  if (klass->postprocess_tensors) {
+    pred_ok = video_inference_postprocess_tensors (self, klass, priv,
+        job->prediction, meta_model, info_model, &pred_valid);
+  } else if (gst_buffer_map (job->prediction, &map, GST_MAP_READ)) {
+    /* A single output is read in place, several are merged */
+    pred_ok = klass->postprocess (self, map.data, map.size, meta_model,
+        info_model, &pred_valid, priv->labels_list, priv->num_labels);
+    gst_buffer_unmap (job->prediction, &map);
+  } else {
+    GST_ERROR_OBJECT (self, "Could not map the prediction");
+    pred_ok = FALSE;
+  }
+  if (!pred_ok) {
     GST_ELEMENT_ERROR (self, STREAM, FAILED, ("Subclass failed at preprocess"),
         (NULL));
     ret = GST_FLOW_ERROR;
     goto buffer_free;
   }
 
+  if (NULL == job->meta) {
+    video_inference_keep_prediction (self, priv,
+        (GstInferenceMeta *) meta_model);
+  }
+
+queue_buffer:
   /* Check if bypass pad was requested, if not, forward buffer */
   if (NULL == priv->sink_bypass) {
     GST_LOG_OBJECT (self,
         "There is no sinkpad for bypass, forwarding model buffer...");
     goto forward_buffer;
+  } else if (g_atomic_int_get (&priv->bypass_eos)) {
+    GST_LOG_OBJECT (self, "Bypass is over, forwarding model buffer...");
+    goto forward_buffer;
   } else {
     GstInferenceMeta *imeta = (GstInferenceMeta *) meta_model;
-    /* Queue buffer */
-    GST_LOG_OBJECT (self, "Queue model buffer");
-    g_mutex_lock (&priv->mtx_model_queue);
-    g_queue_push_head (priv->model_queue, (gpointer) buffer_model);
-    g_mutex_unlock (&priv->mtx_model_queue);
-    /* Keep current Stream ID */
+    /* Keep current Stream ID, the buffer belongs to the queue after */
     if (imeta) {
       g_free (imeta->stream_id);
-      imeta->stream_id = gst_pad_get_stream_id (pad->data.pad);
+      imeta->stream_id = gst_pad_get_stream_id (pad->pad);
+    }
+    /* Queue buffer */
+    GST_LOG_OBJECT (self, "Queue model buffer");
+    video_inference_queue_push (self, priv, priv->model_queue, buffer_model);
+    /* The bypass EOS may have drained the queue while this one waited */
+    if (g_atomic_int_get (&priv->bypass_eos)) {
+      video_inference_drain_model (self, priv);
     }
     goto out;
   }
@@ -976,28 +2590,67 @@ buffer_free:
   gst_buffer_unref (buffer_model);
 
 out:
-  g_free (prediction_data);
+  /* Releases the backend results */
+  gst_buffer_replace (&job->prediction, NULL);
 
   return ret;
 }
 
-static void
-video_inference_notify (GstVideoInference * self, GstBuffer * model_buffer,
-    GstMeta * meta_model, GstBuffer * bypass_buffer,
-    GstMeta * meta_bypass)
+static GstFlowReturn
+gst_video_inference_process_model (GstVideoInference * self, GstBuffer * buffer,
+    GstVideoInferencePad * pad)
 {
   GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
-  GstVideoFrame frame_model;
-  GstVideoFrame frame_bypass;
-  GstVideoInfo *info_model = NULL;
-  GstVideoInfo *info_bypass = NULL;
-  GstMapFlags flags;
-  GstInferenceMeta *imeta = NULL;
-  GstInferencePrediction *pred = NULL;
-  gchar *prediction_string;
+  GstVideoInferenceClass *klass = GST_VIDEO_INFERENCE_GET_CLASS (self);
+  GstVideoInferenceJob job;
 
-  g_return_if_fail (model_buffer);
-  g_return_if_fail (meta_model);
+  g_return_val_if_fail (self != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (buffer != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (pad != NULL, GST_FLOW_ERROR);
+
+  GST_LOG_OBJECT (self, "Processing model buffer");
+
+  memset (&job, 0, sizeof (job));
+  job.element = self;
+  job.buffer = buffer;
+
+  /* Run preprocess and inference on the model and generate prediction */
+  job.ret = video_inference_job_start (self, klass, pad, &job);
+  if (GST_FLOW_OK == job.ret && job.infer
+      && !video_inference_job_preprocess (self, klass, priv, &job)) {
+    job.ret = GST_FLOW_ERROR;
+  }
+
+  /* The batch thread predicts and finishes it along with its batch */
+  if (priv->batch) {
+    return video_inference_queue_batch (self, priv, &job);
+  }
+
+  if (GST_FLOW_OK == job.ret && job.infer
+      && !video_inference_job_predict (self, priv, &job)) {
+    job.ret = GST_FLOW_ERROR;
+  }
+
+  return video_inference_job_finish (self, klass, priv, pad, &job);
+}
+
+static void
+video_inference_notify (GstVideoInference * self, GstBuffer * model_buffer,
+    GstMeta * meta_model, GstBuffer * bypass_buffer,
+    GstMeta * meta_bypass)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstVideoFrame frame_model;
+  GstVideoFrame frame_bypass;
+  GstVideoInfo *info_model = NULL;
+  GstVideoInfo *info_bypass = NULL;
+  GstMapFlags flags;
+  GstInferenceMeta *imeta = NULL;
+  GstInferencePrediction *pred = NULL;
+  gchar *prediction_string;
+
+  g_return_if_fail (model_buffer);
+  g_return_if_fail (meta_model);
 
   info_model = &(priv->sink_model_data->info);
   info_bypass = &(priv->sink_bypass_data->info);
@@ -1024,6 +2677,84 @@ video_inference_notify (GstVideoInference * self, GstBuffer * model_buffer,
   g_free (prediction_string);
 }
 
+static GstBuffer *
+video_inference_match_window (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstBuffer * bypass_buffer,
+    GstFlowReturn * ret)
+{
+  GstBuffer *model_buffer = NULL;
+  GstClockTime window;
+
+  GST_OBJECT_LOCK (self);
+  window = priv->match_window * GST_MSECOND;
+  GST_OBJECT_UNLOCK (self);
+
+  /* Index every model buffer the inference thread finished */
+  while ((model_buffer = video_inference_queue_pop (priv->model_queue,
+              &priv->model_pending))) {
+    if (!GST_BUFFER_PTS_IS_VALID (model_buffer)) {
+      *ret = gst_video_inference_forward_buffer (self, model_buffer,
+          priv->src_model);
+      continue;
+    }
+    gst_inference_matcher_add (priv->matcher, GST_BUFFER_PTS (model_buffer),
+        model_buffer);
+  }
+
+  while (bypass_buffer) {
+    GstClockTime pts = GST_BUFFER_PTS (bypass_buffer);
+    GstClockTime latest;
+
+    model_buffer = NULL;
+    if (GST_CLOCK_TIME_IS_VALID (pts)) {
+      /* The bypass branch is past them, they will never be paired */
+      while ((model_buffer =
+              gst_inference_matcher_pop_expired (priv->matcher, pts))) {
+        *ret = gst_video_inference_forward_buffer (self, model_buffer,
+            priv->src_model);
+      }
+
+      model_buffer = gst_inference_matcher_take (priv->matcher, pts);
+      latest = gst_inference_matcher_get_latest (priv->matcher);
+      if (NULL == model_buffer && (!GST_CLOCK_TIME_IS_VALID (latest)
+              || latest <= pts + window)) {
+        /* Its prediction may still arrive */
+        return bypass_buffer;
+      }
+    }
+
+    if (model_buffer) {
+      GstVideoInfo *info_model = &(priv->sink_model_data->info);
+      GstVideoInfo *info_bypass = &(priv->sink_bypass_data->info);
+      GstMeta *meta_model = gst_buffer_get_meta (model_buffer,
+          gst_inference_meta_api_get_type ());
+      GstMeta *meta_bypass;
+
+      GST_LOG_OBJECT (self, "Pairing buffers %" GST_STIME_FORMAT " apart",
+          GST_STIME_ARGS (GST_CLOCK_DIFF (GST_BUFFER_PTS (model_buffer),
+                  pts)));
+      meta_bypass = video_inference_transform_meta (model_buffer, info_model,
+          meta_model, bypass_buffer, info_bypass);
+      video_inference_notify (self, model_buffer, meta_model, bypass_buffer,
+          meta_bypass);
+
+      *ret = gst_video_inference_forward_buffer (self, model_buffer,
+          priv->src_model);
+    } else {
+      /* The model branch dropped it, or it can't be matched */
+      GST_LOG_OBJECT (self, "No prediction for bypass buffer %"
+          GST_TIME_FORMAT, GST_TIME_ARGS (pts));
+    }
+
+    *ret = gst_video_inference_forward_buffer (self, bypass_buffer,
+        priv->src_bypass);
+    bypass_buffer = video_inference_queue_pop (priv->bypass_queue,
+        &priv->bypass_pending);
+  }
+
+  return NULL;
+}
+
 static GstFlowReturn
 gst_video_inference_process_bypass (GstVideoInference * self,
     GstBuffer * buffer, GstVideoInferencePad * pad)
@@ -1032,8 +2763,10 @@ gst_video_inference_process_bypass (GstVideoInference * self,
   GstFlowReturn ret = GST_FLOW_OK;
   GstMeta *current_meta = NULL;
   GstBuffer *bypass_buffer = NULL;
-  GstBuffer *model_buffer = NULL;
-  gboolean model_empty = FALSE;
+  GstClockTime pts;
+  GstClockTime timeout;
+  GstVideoInferenceLeaky leaky;
+  guint queue_size;
 
   g_return_val_if_fail (self != NULL, GST_FLOW_ERROR);
   g_return_val_if_fail (buffer != NULL, GST_FLOW_ERROR);
@@ -1041,6 +2774,13 @@ gst_video_inference_process_bypass (GstVideoInference * self,
 
   GST_LOG_OBJECT (self, "Processing bypass buffer");
 
+  pts = GST_BUFFER_PTS (buffer);
+  GST_OBJECT_LOCK (self);
+  timeout = priv->bypass_timeout * GST_MSECOND;
+  leaky = priv->leaky;
+  queue_size = priv->bypass_queue_size;
+  GST_OBJECT_UNLOCK (self);
+
   /* Check if model pad was requested, if not, forward buffer */
   if (NULL == priv->sink_model) {
     GST_LOG_OBJECT (self,
@@ -1065,19 +2805,99 @@ gst_video_inference_process_bypass (GstVideoInference * self,
     g_list_free (found);
   }
 
-  /* Queue this new buffer at the head and dequeue the older one */
+  /* Without a leaky policy the oldest buffers must leave first */
+  while (GST_VIDEO_INFERENCE_LEAKY_NONE == leaky
+      && gst_inference_ring_get_length (priv->bypass_queue) >= queue_size) {
+    ret = video_inference_make_room (self, priv, pts, timeout);
+    if (GST_FLOW_OK != ret) {
+      GST_DEBUG_OBJECT (self, "Could not make room for the bypass buffer: %s",
+          gst_flow_get_name (ret));
+      gst_buffer_unref (bypass_buffer);
+      return ret;
+    }
+  }
+
+  /* Queue this new buffer and take the oldest one */
   GST_LOG_OBJECT (self, "Queue bypass buffer and get older one");
-  g_mutex_lock (&priv->mtx_bypass_queue);
-  g_queue_push_head (priv->bypass_queue, (gpointer) bypass_buffer);
-  bypass_buffer = GST_BUFFER_CAST (g_queue_pop_tail (priv->bypass_queue));
-  g_mutex_unlock (&priv->mtx_bypass_queue);
+  video_inference_queue_push (self, priv, priv->bypass_queue, bypass_buffer);
+
+  return video_inference_pair_bypass (self, priv, pts, timeout);
+
+forward_buffer:
+  /* Forward buffer to bypass src pad */
+  GST_LOG_OBJECT (self, "Forward bypass buffer");
+  ret =
+      gst_video_inference_forward_buffer (self, bypass_buffer,
+      priv->src_bypass);
+
+  return ret;
+}
+
+static GstFlowReturn
+video_inference_make_room (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstClockTime pts, GstClockTime timeout)
+{
+  GstBuffer *bypass_buffer = priv->bypass_pending;
+
+  /* Taking the oldest queued buffer, or timing out the pending one,
+   * makes room without waiting */
+  if (NULL == bypass_buffer || (timeout > 0 && GST_CLOCK_TIME_IS_VALID (pts)
+          && GST_BUFFER_PTS_IS_VALID (bypass_buffer)
+          && pts >= GST_BUFFER_PTS (bypass_buffer) + timeout)) {
+    return video_inference_pair_bypass (self, priv, pts, timeout);
+  }
+
+  if (NULL == priv->model_pending) {
+    /* The bypass thread is the only consumer of the model queue */
+    GST_LOG_OBJECT (self, "Bypass queue full, waiting for a prediction");
+    priv->model_pending =
+        GST_BUFFER_CAST (gst_inference_ring_pop (priv->model_queue));
+  }
+
+  if (priv->model_pending) {
+    return video_inference_pair_bypass (self, priv, pts, timeout);
+  }
+
+  /* The model branch is over or flushing, nothing will pair it */
+  GST_LOG_OBJECT (self, "Forwarding bypass buffer without a prediction");
+  bypass_buffer = video_inference_queue_pop (priv->bypass_queue,
+      &priv->bypass_pending);
+
+  return gst_video_inference_forward_buffer (self, bypass_buffer,
+      priv->src_bypass);
+}
+
+static GstFlowReturn
+video_inference_pair_bypass (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstClockTime pts, GstClockTime timeout)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstMeta *current_meta = NULL;
+  GstBuffer *bypass_buffer = NULL;
+  GstBuffer *model_buffer = NULL;
+  gboolean model_empty = FALSE;
+
+  bypass_buffer = video_inference_queue_pop (priv->bypass_queue,
+      &priv->bypass_pending);
+  if (NULL == bypass_buffer) {
+    /* The leaky policy dropped it */
+    return ret;
+  }
+
+  if (priv->matcher) {
+    bypass_buffer = video_inference_match_window (self, priv, bypass_buffer,
+        &ret);
+    if (NULL == bypass_buffer) {
+      return ret;
+    }
+    goto keep_buffer;
+  }
 
   while (!model_empty) {
-    /* Dequeue oldest model buffer from tail */
-    g_mutex_lock (&priv->mtx_model_queue);
+    /* Take the oldest model buffer */
     GST_LOG_OBJECT (self, "Dequeue model buffer");
-    model_buffer = GST_BUFFER_CAST (g_queue_pop_tail (priv->model_queue));
-    g_mutex_unlock (&priv->mtx_model_queue);
+    model_buffer = video_inference_queue_pop (priv->model_queue,
+        &priv->model_pending);
 
     if (NULL == model_buffer) {
       /* Model queue is empty */
@@ -1094,23 +2914,34 @@ gst_video_inference_process_bypass (GstVideoInference * self,
       meta_model = gst_buffer_get_meta (model_buffer,
           gst_inference_meta_api_get_type ());
 
-      root_model = ((GstInferenceMeta *) meta_model)->prediction;
-
       /* If bypass doesn't have meta, just transfer the model meta */
       current_meta = gst_buffer_get_meta (bypass_buffer,
           gst_inference_meta_api_get_type ());
 
+      if (NULL == meta_model) {
+        /* The gap of a dropped model buffer */
+        if (current_meta) {
+          GST_LOG_OBJECT (self, "Keep the gap for the next bypass buffer");
+          priv->model_pending = model_buffer;
+        } else {
+          GST_LOG_OBJECT (self, "Model buffer dropped, forwarding bypass "
+              "buffer without prediction");
+          gst_buffer_unref (model_buffer);
+        }
+        goto forward_buffer;
+      }
+
+      root_model = ((GstInferenceMeta *) meta_model)->prediction;
+
       if (current_meta) {
         /* Check if model and bypass IDs match */
         GST_LOG_OBJECT (self, "Checking if model and bypass IDs match");
         root_bypass = gst_inference_prediction_find (((GstInferenceMeta *)
                 current_meta)->prediction, root_model->prediction_id);
         if (NULL == root_bypass) {
-          /* Queue model buffer to tail again */
-          g_mutex_lock (&priv->mtx_model_queue);
-          GST_LOG_OBJECT (self, "Queue model buffer");
-          g_queue_push_tail (priv->model_queue, (gpointer) model_buffer);
-          g_mutex_unlock (&priv->mtx_model_queue);
+          /* Keep the model buffer as the oldest one */
+          GST_LOG_OBJECT (self, "Keep model buffer");
+          priv->model_pending = model_buffer;
           goto forward_buffer;
         } else {
           gst_inference_prediction_unref (root_bypass);
@@ -1136,11 +2967,24 @@ gst_video_inference_process_bypass (GstVideoInference * self,
     }
   }
 
-  /* Queue old bypass buffer at the tail */
-  GST_LOG_OBJECT (self, "Queue bypass buffer");
-  g_mutex_lock (&priv->mtx_bypass_queue);
-  g_queue_push_tail (priv->bypass_queue, (gpointer) bypass_buffer);
-  g_mutex_unlock (&priv->mtx_bypass_queue);
+keep_buffer:
+  /* Don't hold the bypass branch forever waiting for a slow model */
+  while (timeout > 0 && GST_CLOCK_TIME_IS_VALID (pts)
+      && GST_BUFFER_PTS_IS_VALID (bypass_buffer)
+      && pts >= GST_BUFFER_PTS (bypass_buffer) + timeout) {
+    GST_LOG_OBJECT (self, "Bypass buffer timed out, forwarding it");
+    ret = gst_video_inference_forward_buffer (self, bypass_buffer,
+        priv->src_bypass);
+    bypass_buffer = video_inference_queue_pop (priv->bypass_queue,
+        &priv->bypass_pending);
+    if (NULL == bypass_buffer) {
+      return ret;
+    }
+  }
+
+  /* Keep the old bypass buffer as the oldest one */
+  GST_LOG_OBJECT (self, "Keep bypass buffer");
+  priv->bypass_pending = bypass_buffer;
 
   return ret;
 
@@ -1155,32 +2999,35 @@ forward_buffer:
 }
 
 static GstFlowReturn
-gst_video_inference_buffer_function (GstCollectPads * pads,
-    GstCollectData * data, GstBuffer * buffer, gpointer user_data)
+gst_video_inference_sink_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer)
 {
-  GstVideoInference *self = (GstVideoInference *) user_data;
-  GstVideoInferencePrivate *priv = NULL;
-  GstVideoInferencePad *pad = (GstVideoInferencePad *) data;
+  GstVideoInference *self = GST_VIDEO_INFERENCE (parent);
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
   GstFlowReturn ret = GST_FLOW_OK;
 
-  if (!buffer) {
-    /* EOS reached the pad */
-    ret = GST_FLOW_EOS;
+  g_return_val_if_fail (buffer != NULL, GST_FLOW_ERROR);
+
+  ret = video_inference_wait_loaded (self, priv);
+  if (GST_FLOW_OK != ret) {
+    gst_buffer_unref (buffer);
     goto out;
   }
 
-  g_return_val_if_fail (pads != NULL, GST_FLOW_ERROR);
-  g_return_val_if_fail (self != NULL, GST_FLOW_ERROR);
-
-  priv = GST_VIDEO_INFERENCE_PRIVATE (self);
-
-  if (data->pad == priv->sink_model) {
+  if (pad == priv->sink_model && (priv->worker || priv->pipeline
+          || priv->batch)) {
+    GST_LOG_OBJECT (self, "Model buffer arrived, queueing it...");
+    ret = video_inference_queue_model (self, priv, buffer, NULL);
+    goto out;
+  } else if (pad == priv->sink_model) {
     GST_LOG_OBJECT (self, "Model buffer arrived, processing it...");
-    ret = gst_video_inference_process_model (self, buffer, pad);
+    ret = gst_video_inference_process_model (self, buffer,
+        priv->sink_model_data);
     goto out;
   } else {
     GST_LOG_OBJECT (self, "Bypass buffer arrived, processing it...");
-    ret = gst_video_inference_process_bypass (self, buffer, pad);
+    ret = gst_video_inference_process_bypass (self, buffer,
+        priv->sink_bypass_data);
     goto out;
   }
 
@@ -1224,28 +3071,33 @@ gst_video_inference_get_sink_pad (GstVideoInference * self,
 
 static void
 gst_video_inference_set_caps (GstVideoInference * self,
-    GstVideoInferencePrivate * priv, GstCollectData * data, GstEvent * event)
+    GstVideoInferencePrivate * priv, GstVideoInferencePad * cpad,
+    GstEvent * event)
 {
   GstCaps *caps;
-  GstVideoInferencePad *cpad;
 
   g_return_if_fail (self);
   g_return_if_fail (priv);
-  g_return_if_fail (data);
+  g_return_if_fail (cpad);
   g_return_if_fail (event);
 
-  cpad = (GstVideoInferencePad *) data;
-
   gst_event_parse_caps (event, &caps);
 
   if (gst_caps_is_fixed (caps)) {
     GstVideoInfo *info = &(cpad->info);
 
     GST_INFO_OBJECT (self,
-        "Updating caps in %" GST_PTR_FORMAT " to %" GST_PTR_FORMAT, data->pad,
+        "Updating caps in %" GST_PTR_FORMAT " to %" GST_PTR_FORMAT, cpad->pad,
         caps);
     gst_video_info_init (info);
     gst_video_info_from_caps (info, caps);
+
+    /* Normalization tables and the tensor are rebuilt for the new
+     * format */
+    if (cpad == priv->sink_model_data) {
+      gst_inference_preprocess_cache_reset (priv->preprocess_cache);
+      video_inference_update_tensor_info (self, priv, info);
+    }
   }
 }
 
@@ -1286,46 +3138,119 @@ out:
 }
 
 static gboolean
-gst_video_inference_sink_event (GstCollectPads * pads, GstCollectData * pad,
-    GstEvent * event, gpointer user_data)
+gst_video_inference_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
 {
-  GstVideoInference *self = GST_VIDEO_INFERENCE (user_data);
+  GstVideoInference *self = GST_VIDEO_INFERENCE (parent);
   GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
-  gboolean ret = FALSE;
+  GstVideoInferencePad *data;
   GstPad *srcpad;
 
   GST_LOG_OBJECT (self, "Received event %s from %" GST_PTR_FORMAT,
-      GST_EVENT_TYPE_NAME (event), pad->pad);
+      GST_EVENT_TYPE_NAME (event), pad);
+
+  data = pad == priv->sink_model ? priv->sink_model_data :
+      priv->sink_bypass_data;
 
-  srcpad = gst_video_inference_get_src_pad (self, priv, pad->pad);
+  /* Serialized events wait for the model like the buffers */
+  if (GST_EVENT_IS_SERIALIZED (event)
+      && GST_FLOW_OK != video_inference_wait_loaded (self, priv)) {
+    GST_DEBUG_OBJECT (self, "Dropping event %s, the model is not loaded",
+        GST_EVENT_TYPE_NAME (event));
+    gst_event_unref (event);
+    return FALSE;
+  }
+
+  /* Serialized events must stay behind the model buffers still waiting
+   * for the inference thread */
+  if (pad == priv->sink_model && (priv->worker || priv->pipeline
+          || priv->batch)) {
+    switch (GST_EVENT_TYPE (event)) {
+      case GST_EVENT_FLUSH_START:
+        video_inference_set_flushing (self, priv, TRUE);
+        break;
+      case GST_EVENT_FLUSH_STOP:
+        video_inference_set_flushing (self, priv, FALSE);
+        break;
+      case GST_EVENT_EOS:
+        /* The inference thread forwards it, once the pending inferences
+         * finish */
+        video_inference_queue_model (self, priv, NULL, event);
+        if (priv->worker) {
+          gst_inference_worker_drain (priv->worker);
+        }
+        if (priv->pipeline) {
+          gst_inference_pipeline_drain (priv->pipeline);
+        }
+        if (priv->batch && priv->shared) {
+          gst_inference_batch_drain_owner (priv->batch, self);
+        } else if (priv->batch) {
+          gst_inference_batch_drain (priv->batch);
+        }
+        return TRUE;
+      default:
+        if (GST_EVENT_IS_SERIALIZED (event)) {
+          /* The inference thread forwards it */
+          video_inference_queue_model (self, priv, NULL, event);
+          return TRUE;
+        }
+        break;
+    }
+  }
 
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_CAPS:
-      gst_video_inference_set_caps (self, priv, pad, event);
+      gst_video_inference_set_caps (self, priv, data, event);
+      break;
+    case GST_EVENT_FLUSH_START:
+      /* Wakes a branch waiting on the other one */
+      video_inference_update_queue (self, priv, TRUE);
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      g_mutex_lock (&priv->mtx_eos);
+      if (pad == priv->sink_model) {
+        priv->model_eos = FALSE;
+        gst_event_replace (&priv->model_eos_event, NULL);
+      } else {
+        priv->bypass_eos = FALSE;
+      }
+      g_mutex_unlock (&priv->mtx_eos);
+      /* Both queues are consumed by the bypass thread */
+      if (pad == priv->sink_bypass && priv->model_queue) {
+        video_inference_flush_queue (priv->bypass_queue,
+            &priv->bypass_pending);
+        video_inference_flush_queue (priv->model_queue, &priv->model_pending);
+        if (priv->matcher) {
+          gst_inference_matcher_clear (priv->matcher,
+              (GDestroyNotify) gst_buffer_unref);
+        }
+      }
+      video_inference_update_queue (self, priv, FALSE);
+      break;
+    case GST_EVENT_EOS:
+      if (pad == priv->sink_bypass) {
+        video_inference_bypass_eos (self, priv);
+      }
       break;
     default:
       break;
   }
 
-  if (NULL != srcpad) {
-    GST_LOG_OBJECT (self, "Forwarding event %s from %" GST_PTR_FORMAT,
-        GST_EVENT_TYPE_NAME (event), pad->pad);
-    /* Collect pads will decrease the refcount of the event when we return */
-    gst_event_ref (event);
-    if (FALSE == gst_pad_push_event (srcpad, event)) {
-      GST_ERROR_OBJECT (self, "Event %s failed in %" GST_PTR_FORMAT,
-          GST_EVENT_TYPE_NAME (event), srcpad);
-      goto out;
-    }
-  } else {
-    GST_LOG_OBJECT (self, "Dropping event %s from %" GST_PTR_FORMAT,
-        GST_EVENT_TYPE_NAME (event), pad->pad);
+  if (pad == priv->sink_model) {
+    return video_inference_forward_model_event (self, priv, event);
   }
 
-  ret = gst_collect_pads_event_default (priv->cpads, pad, event, FALSE);
+  srcpad = gst_video_inference_get_src_pad (self, priv, pad);
+  if (NULL == srcpad) {
+    GST_LOG_OBJECT (self, "Dropping event %s from %" GST_PTR_FORMAT,
+        GST_EVENT_TYPE_NAME (event), pad);
+    gst_event_unref (event);
+    return TRUE;
+  }
 
-out:
-  return ret;
+  GST_LOG_OBJECT (self, "Forwarding event %s from %" GST_PTR_FORMAT,
+      GST_EVENT_TYPE_NAME (event), pad);
+  return gst_pad_push_event (srcpad, event);
 }
 
 static gboolean
@@ -1334,60 +3259,1339 @@ gst_video_inference_src_event (GstPad * pad, GstObject * parent,
 {
   GstVideoInference *self = GST_VIDEO_INFERENCE (parent);
   GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  gboolean ret = FALSE;
+
+  if (GST_EVENT_SEEK != GST_EVENT_TYPE (event)) {
+    return gst_pad_event_default (pad, parent, event);
+  }
 
-  return gst_collect_pads_src_event_default (priv->cpads, pad, event);
+  /* Both branches must seek, or the pairing would mix positions */
+  GST_DEBUG_OBJECT (self, "Sending seek upstream both branches");
+  if (priv->sink_model) {
+    ret |= gst_pad_push_event (priv->sink_model, gst_event_ref (event));
+  }
+  if (priv->sink_bypass) {
+    ret |= gst_pad_push_event (priv->sink_bypass, gst_event_ref (event));
+  }
+  gst_event_unref (event);
+
+  return ret;
 }
 
-static void
-video_inference_flush_queue (GQueue * queue, GMutex * mutex)
+static gboolean
+video_inference_model_eos (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstEvent * event)
 {
-  GstBuffer *buf = NULL;
+  gboolean bypass_eos;
+
+  g_mutex_lock (&priv->mtx_eos);
+  priv->model_eos = TRUE;
+  bypass_eos = priv->bypass_eos;
+  /* The bypass thread pushes this same event, keeping its seqnum */
+  if (!bypass_eos && priv->sink_bypass) {
+    gst_event_replace (&priv->model_eos_event, event);
+  }
+  g_mutex_unlock (&priv->mtx_eos);
 
-  g_return_if_fail (queue);
-  g_return_if_fail (mutex);
+  /* Don't leave the bypass thread waiting for more predictions */
+  video_inference_update_queue (self, priv, FALSE);
 
-  g_mutex_lock (mutex);
-  while ((buf = GST_BUFFER_CAST (g_queue_pop_tail (queue)))) {
-    gst_buffer_unref (buf);
+  if (NULL == priv->sink_bypass) {
+    return TRUE;
+  }
+
+  if (!bypass_eos) {
+    GST_DEBUG_OBJECT (self, "Holding the model EOS until the bypass EOS");
+    return FALSE;
   }
-  g_mutex_unlock (mutex);
+
+  /* The bypass thread is done pairing, forward what is left */
+  video_inference_drain_model (self, priv);
+
+  return TRUE;
 }
 
 static void
-gst_video_inference_finalize (GObject * object)
+video_inference_bypass_eos (GstVideoInference * self,
+    GstVideoInferencePrivate * priv)
 {
-  GstVideoInference *self = GST_VIDEO_INFERENCE (object);
-  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstBuffer *buffer;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstEvent *model_eos_event;
+  gboolean model_eos;
 
-  g_clear_object (&(priv->cpads));
-  g_clear_object (&(priv->sink_bypass));
-  g_clear_object (&(priv->sink_model));
-  g_clear_object (&(priv->src_bypass));
-  g_clear_object (&(priv->src_model));
+  if (NULL == priv->model_queue) {
+    return;
+  }
 
-  priv->sink_bypass_data = NULL;
-  priv->sink_model_data = NULL;
-  g_free (priv->model_location);
-  priv->model_location = NULL;
-  g_free (priv->labels);
-  priv->labels = NULL;
-  g_free (priv->labels_list);
-  priv->labels_list = NULL;
+  /* Nothing else will be paired, forward what is still waiting */
+  while ((buffer = video_inference_queue_pop (priv->bypass_queue,
+              &priv->bypass_pending))) {
+    if (priv->matcher) {
+      /* Pair what can still be paired */
+      buffer = video_inference_match_window (self, priv, buffer, &ret);
+    }
+    gst_video_inference_forward_buffer (self, buffer, priv->src_bypass);
+  }
+  while (priv->matcher
+      && (buffer = gst_inference_matcher_pop (priv->matcher))) {
+    gst_video_inference_forward_buffer (self, buffer, priv->src_model);
+  }
+  while ((buffer = video_inference_queue_pop (priv->model_queue,
+              &priv->model_pending))) {
+    video_inference_forward_model (self, priv, buffer);
+  }
 
-  g_mutex_clear (&priv->mtx_model_queue);
-  g_mutex_clear (&priv->mtx_bypass_queue);
+  g_mutex_lock (&priv->mtx_eos);
+  priv->bypass_eos = TRUE;
+  model_eos = priv->model_eos;
+  model_eos_event = priv->model_eos_event;
+  priv->model_eos_event = NULL;
+  g_mutex_unlock (&priv->mtx_eos);
 
-  g_queue_free (priv->model_queue);
-  g_queue_free (priv->bypass_queue);
+  /* The model EOS was held for us */
+  if (model_eos) {
+    video_inference_drain_model (self, priv);
+  }
+  if (model_eos_event && priv->src_model) {
+    gst_pad_push_event (priv->src_model, model_eos_event);
+  } else if (model_eos_event) {
+    gst_event_unref (model_eos_event);
+  }
+}
 
-  g_clear_object (&priv->backend);
+static void
+video_inference_drain_model (GstVideoInference * self,
+    GstVideoInferencePrivate * priv)
+{
+  GstBuffer *buffer;
 
-  G_OBJECT_CLASS (gst_video_inference_parent_class)->finalize (object);
+  /* Both sides may drain at the same time, the ring hands every buffer
+   * to only one of them */
+  while ((buffer = GST_BUFFER_CAST (gst_inference_ring_try_pop
+              (priv->model_queue)))) {
+    video_inference_forward_model (self, priv, buffer);
+  }
 }
 
 static void
-gst_video_inference_set_backend (GstVideoInference * self, gint backend)
+video_inference_update_queue (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, gboolean flushing)
+{
+  GstInferenceRing *model_queue;
+  gboolean model_eos;
+
+  g_mutex_lock (&priv->mtx_eos);
+  model_eos = priv->model_eos;
+  g_mutex_unlock (&priv->mtx_eos);
+
+  GST_OBJECT_LOCK (self);
+  model_queue = priv->model_queue;
+  GST_OBJECT_UNLOCK (self);
+
+  if (NULL == model_queue) {
+    return;
+  }
+
+  /* Closing it wakes the model thread waiting for room and the bypass
+   * thread waiting for a prediction */
+  if (flushing || model_eos) {
+    gst_inference_ring_close (model_queue);
+  } else {
+    gst_inference_ring_open (model_queue);
+  }
+}
+
+static gboolean
+video_inference_worker_event (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstEvent * event)
 {
+  if (GST_EVENT_CAPS == GST_EVENT_TYPE (event)) {
+    gst_video_inference_set_caps (self, priv, priv->sink_model_data, event);
+  }
+
+  /* Keep it behind the buffers still waiting for their batch */
+  if (priv->batch) {
+    return GST_FLOW_OK == video_inference_batch_event (self, priv, event);
+  }
+
+  return video_inference_forward_model_event (self, priv, event);
+}
+
+static gboolean
+video_inference_forward_model_event (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstEvent * event)
+{
+  if (gst_event_has_name (event, DROPPED_EVENT_NAME)) {
+    video_inference_queue_gap (self, priv);
+    gst_event_unref (event);
+    return TRUE;
+  }
+
+  /* Even without a model src pad, the bypass thread must know */
+  if (GST_EVENT_EOS == GST_EVENT_TYPE (event)
+      && !video_inference_model_eos (self, priv, event)) {
+    gst_event_unref (event);
+    return TRUE;
+  }
+
+  if (NULL == priv->src_model) {
+    gst_event_unref (event);
+    return TRUE;
+  }
+
+  GST_LOG_OBJECT (self, "Forwarding event %s from the inference thread",
+      GST_EVENT_TYPE_NAME (event));
+  return gst_pad_push_event (priv->src_model, event);
+}
+
+static GstFlowReturn
+video_inference_worker_func (GstMiniObject * item, gpointer user_data)
+{
+  GstVideoInference *self = GST_VIDEO_INFERENCE (user_data);
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+
+  if (GST_IS_EVENT (item)) {
+    if (!video_inference_worker_event (self, priv, GST_EVENT_CAST (item))) {
+      GST_WARNING_OBJECT (self, "Failed to forward the model event");
+    }
+    return GST_FLOW_OK;
+  }
+
+  return gst_video_inference_process_model (self, GST_BUFFER_CAST (item),
+      priv->sink_model_data);
+}
+
+static GstFlowReturn
+video_inference_queue_model (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstBuffer * buffer, GstEvent * event)
+{
+  GstVideoInferenceJob *job;
+  GstFlowReturn ret;
+  gboolean block;
+  guint64 dropped;
+
+  if (priv->worker) {
+    dropped = gst_inference_worker_get_dropped (priv->worker);
+    ret = gst_inference_worker_push (priv->worker, buffer ?
+        GST_MINI_OBJECT_CAST (buffer) : GST_MINI_OBJECT_CAST (event));
+    /* This is the only thread pushing, a new drop is this buffer */
+    if (GST_FLOW_OK == ret
+        && gst_inference_worker_get_dropped (priv->worker) != dropped) {
+      ret = video_inference_queue_dropped (self, priv);
+    }
+    return ret;
+  }
+
+  /* Buffers are preprocessed here and predicted by the batch thread */
+  if (priv->batch) {
+    if (buffer) {
+      return gst_video_inference_process_model (self, buffer,
+          priv->sink_model_data);
+    }
+    if (GST_EVENT_CAPS == GST_EVENT_TYPE (event)) {
+      gst_video_inference_set_caps (self, priv, priv->sink_model_data, event);
+    }
+    return video_inference_batch_event (self, priv, event);
+  }
+
+  ret = (GstFlowReturn) g_atomic_int_get (&priv->model_flow);
+  if (GST_FLOW_OK != ret) {
+    gst_mini_object_unref (buffer ? GST_MINI_OBJECT_CAST (buffer) :
+        GST_MINI_OBJECT_CAST (event));
+    return ret;
+  }
+
+  job = g_new0 (GstVideoInferenceJob, 1);
+  job->element = self;
+  job->buffer = buffer;
+  job->event = event;
+  job->ret = GST_FLOW_OK;
+  job->gaps = priv->pipeline_gaps;
+
+  /* Events are never dropped, buffers only in async mode */
+  block = NULL != event || !priv->async;
+  if (gst_inference_pipeline_push (priv->pipeline, job, block)) {
+    priv->pipeline_gaps = 0;
+  } else {
+    if (block) {
+      ret = GST_FLOW_FLUSHING;
+    } else {
+      /* The next job carries its gap, the pipeline has no room for it */
+      GST_LOG_OBJECT (self, "Pipeline is full, dropping model buffer");
+      priv->pipeline_gaps++;
+    }
+    video_inference_job_free (job, self);
+  }
+
+  return ret;
+}
+
+static GstFlowReturn
+video_inference_queue_dropped (GstVideoInference * self,
+    GstVideoInferencePrivate * priv)
+{
+  /* Queued in order with the model buffers, so the bypass thread knows
+   * which bypass buffer lost its prediction */
+  return video_inference_queue_model (self, priv, NULL,
+      gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+          gst_structure_new_empty (DROPPED_EVENT_NAME)));
+}
+
+static void
+video_inference_queue_gap (GstVideoInference * self,
+    GstVideoInferencePrivate * priv)
+{
+  /* The pairing by timestamps doesn't need it */
+  if (NULL == priv->sink_bypass || priv->matcher
+      || g_atomic_int_get (&priv->bypass_eos)) {
+    return;
+  }
+
+  /* A buffer without inference meta, its bypass buffer is forwarded
+   * without a prediction */
+  GST_LOG_OBJECT (self, "Queue the gap of a dropped model buffer");
+  video_inference_queue_push (self, priv, priv->model_queue,
+      gst_buffer_new ());
+  if (g_atomic_int_get (&priv->bypass_eos)) {
+    video_inference_drain_model (self, priv);
+  }
+}
+
+static void
+video_inference_forward_model (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstBuffer * buffer)
+{
+  /* The gap of a dropped buffer is not forwarded */
+  if (NULL == gst_buffer_get_meta (buffer,
+          gst_inference_meta_api_get_type ())) {
+    gst_buffer_unref (buffer);
+    return;
+  }
+
+  gst_video_inference_forward_buffer (self, buffer, priv->src_model);
+}
+
+static void
+video_inference_set_flushing (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, gboolean flushing)
+{
+  if (priv->worker) {
+    gst_inference_worker_set_flushing (priv->worker, flushing);
+  }
+
+  if (priv->pipeline) {
+    gst_inference_pipeline_set_flushing (priv->pipeline, flushing);
+    g_atomic_int_set (&priv->model_flow, GST_FLOW_OK);
+    priv->pipeline_gaps = 0;
+  }
+
+  /* Other elements keep using a shared batch, only drop our buffers */
+  if (priv->batch && priv->shared) {
+    g_atomic_int_set (&priv->batch_flushing, TRUE);
+    gst_inference_batch_flush_owner (priv->batch, self);
+    g_atomic_int_set (&priv->batch_flushing, flushing);
+    g_atomic_int_set (&priv->model_flow, GST_FLOW_OK);
+  } else if (priv->batch) {
+    gst_inference_batch_set_flushing (priv->batch, flushing);
+    g_atomic_int_set (&priv->model_flow, GST_FLOW_OK);
+  }
+}
+
+static GstFlowReturn
+video_inference_queue_batch (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstVideoInferenceJob * job)
+{
+  GstVideoInferenceJob *batch_job;
+  GstFlowReturn ret;
+
+  ret = (GstFlowReturn) g_atomic_int_get (&priv->model_flow);
+  if (g_atomic_int_get (&priv->batch_flushing)) {
+    ret = GST_FLOW_FLUSHING;
+  }
+  if (GST_FLOW_OK != ret) {
+    video_inference_job_unmap (job);
+    gst_buffer_unref (job->buffer);
+    return ret;
+  }
+
+  batch_job = g_new (GstVideoInferenceJob, 1);
+  *batch_job = *job;
+  if (!gst_inference_batch_push_owned (priv->batch, batch_job, self, FALSE)) {
+    video_inference_job_free (batch_job, self);
+    return GST_FLOW_FLUSHING;
+  }
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+video_inference_batch_event (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstEvent * event)
+{
+  GstVideoInferenceJob *job;
+
+  job = g_new0 (GstVideoInferenceJob, 1);
+  job->element = self;
+  job->event = event;
+  job->ret = GST_FLOW_OK;
+
+  /* Events close the batch, a new caps may change the tensor size */
+  if (g_atomic_int_get (&priv->batch_flushing)
+      || !gst_inference_batch_push_owned (priv->batch, job, self, TRUE)) {
+    video_inference_job_free (job, self);
+    return GST_FLOW_FLUSHING;
+  }
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+video_inference_batch_job_ready (GstVideoInferenceJob * job)
+{
+  return NULL == job->event && GST_FLOW_OK == job->ret && job->infer
+      && !job->raw;
+}
+
+static void
+video_inference_batch_func (gpointer * items, guint n_items,
+    gpointer user_data)
+{
+  GstVideoInference *self = NULL;
+  GstVideoInferencePrivate *priv;
+  GstVideoInferenceClass *klass;
+  GstVideoInferenceJob *job;
+  GstVideoFrame *frames;
+  GstBuffer **preds;
+  GError *error = NULL;
+  gboolean batch_ok = TRUE;
+  GstFlowReturn ret;
+  GstVideoInference **owners;
+  gint64 start = 0;
+  guint i, n_frames = 0, n_owners = 0;
+
+  frames = g_new (GstVideoFrame, n_items);
+  preds = g_new0 (GstBuffer *, n_items);
+  owners = g_new (GstVideoInference *, n_items);
+
+  /* A shared batch holds the buffers of several elements, each job is
+   * finished by the element it came from */
+  for (i = 0; i < n_items; ++i) {
+    job = (GstVideoInferenceJob *) items[i];
+    priv = GST_VIDEO_INFERENCE_PRIVATE (job->element);
+    if (g_atomic_int_get (&priv->batch_flushing)) {
+      job->ret = GST_FLOW_FLUSHING;
+    }
+
+    /* Frames the backend takes directly can't be stacked in a tensor */
+    if (video_inference_batch_job_ready (job)) {
+      frames[n_frames++] = job->outframe;
+      self = job->element;
+    } else if (NULL == job->event && GST_FLOW_OK == job->ret && job->infer
+        && !video_inference_job_predict (job->element, priv, job)) {
+      job->ret = GST_FLOW_ERROR;
+    }
+  }
+
+  if (n_frames > 0) {
+    start = g_get_monotonic_time ();
+    batch_ok = gst_video_inference_predict_batch (self,
+        GST_VIDEO_INFERENCE_PRIVATE (self), frames, n_frames, preds, &error);
+  }
+
+  n_frames = 0;
+  for (i = 0; i < n_items; ++i) {
+    job = (GstVideoInferenceJob *) items[i];
+    if (video_inference_batch_job_ready (job)) {
+      job->prediction = preds[n_frames];
+      n_frames++;
+      if (!batch_ok) {
+        job->ret = GST_FLOW_ERROR;
+      }
+
+      /* Once for each element, its frames waited for the whole batch */
+      if (video_inference_batch_add_owner (owners, &n_owners, job->element)) {
+        video_inference_add_latency (job->element,
+            GST_VIDEO_INFERENCE_PRIVATE (job->element), start);
+        if (!batch_ok) {
+          GST_ELEMENT_ERROR (job->element, STREAM, FAILED,
+              ("Could not process the batch using the selected backend: "
+                  "(%s)", error->message), (NULL));
+        }
+      }
+    }
+    video_inference_job_unmap (job);
+  }
+  g_clear_error (&error);
+
+  for (i = 0; i < n_items; ++i) {
+    job = (GstVideoInferenceJob *) items[i];
+    priv = GST_VIDEO_INFERENCE_PRIVATE (job->element);
+    klass = GST_VIDEO_INFERENCE_GET_CLASS (job->element);
+    if (GST_FLOW_FLUSHING == job->ret) {
+      /* Dropped along with the rest of the flushed buffers */
+    } else if (job->event) {
+      if (!video_inference_forward_model_event (job->element, priv,
+              job->event)) {
+        GST_WARNING_OBJECT (job->element,
+            "Failed to forward the model event");
+      }
+      job->event = NULL;
+    } else {
+      ret = video_inference_job_finish (job->element, klass, priv,
+          priv->sink_model_data, job);
+      /* Reported back to the streaming thread on the next buffer */
+      if (GST_FLOW_OK != ret) {
+        g_atomic_int_set (&priv->model_flow, ret);
+      }
+    }
+    video_inference_job_free (job, user_data);
+  }
+
+  g_free (owners);
+  g_free (preds);
+  g_free (frames);
+}
+
+static gboolean
+video_inference_batch_add_owner (GstVideoInference ** owners,
+    guint * n_owners, GstVideoInference * element)
+{
+  guint i;
+
+  for (i = 0; i < *n_owners; ++i) {
+    if (owners[i] == element) {
+      return FALSE;
+    }
+  }
+  owners[(*n_owners)++] = element;
+
+  return TRUE;
+}
+
+static GstBaseBackend *
+video_inference_get_backend (GstVideoInferencePrivate * priv)
+{
+  return priv->shared ? priv->shared->backend : priv->backend;
+}
+
+static void
+video_inference_keep_prediction (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstInferenceMeta * imeta)
+{
+  GstInferencePrediction *prediction;
+
+  /* Copied, downstream may modify the one on the buffer */
+  prediction = gst_inference_prediction_copy (imeta->prediction);
+
+  GST_OBJECT_LOCK (self);
+  if (priv->last_prediction) {
+    gst_inference_prediction_unref (priv->last_prediction);
+  }
+  priv->last_prediction = prediction;
+  GST_OBJECT_UNLOCK (self);
+}
+
+static GType
+video_inference_leaky_get_type (void)
+{
+  static gsize type = 0;
+
+  if (g_once_init_enter (&type)) {
+    static const GEnumValue values[] = {
+      {GST_VIDEO_INFERENCE_LEAKY_NONE, "Never drop, wait for room", "none"},
+      {GST_VIDEO_INFERENCE_LEAKY_OLDEST, "Drop the oldest buffer",
+          "drop-oldest"},
+      {GST_VIDEO_INFERENCE_LEAKY_NEWEST, "Drop the newest buffer",
+          "drop-newest"},
+      {0, NULL, NULL},
+    };
+    GType new_type = g_enum_register_static ("GstVideoInferenceLeaky",
+        values);
+    g_once_init_leave (&type, new_type);
+  }
+
+  return (GType) type;
+}
+
+static void
+video_inference_queue_push (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstInferenceRing * queue,
+    GstBuffer * buffer)
+{
+  GstVideoInferenceLeaky leaky;
+  gint *dropped;
+  GstBuffer *drop;
+
+  dropped = queue == priv->model_queue ? &priv->model_dropped :
+      &priv->bypass_dropped;
+
+  GST_OBJECT_LOCK (self);
+  leaky = priv->leaky;
+  GST_OBJECT_UNLOCK (self);
+
+  if (GST_VIDEO_INFERENCE_LEAKY_NONE == leaky) {
+    /* Waits for the bypass thread to make room, unless closed */
+    if (!gst_inference_ring_push (queue, buffer)) {
+      GST_DEBUG_OBJECT (self, "%s queue closed, dropping %" GST_PTR_FORMAT,
+          queue == priv->model_queue ? "Model" : "Bypass", buffer);
+      gst_buffer_unref (buffer);
+    }
+    return;
+  }
+
+  while (!gst_inference_ring_try_push (queue, buffer)) {
+    if (GST_VIDEO_INFERENCE_LEAKY_NEWEST == leaky) {
+      drop = buffer;
+    } else {
+      /* The pairing may have taken it meanwhile */
+      drop = GST_BUFFER_CAST (gst_inference_ring_try_pop (queue));
+    }
+
+    if (drop) {
+      GST_DEBUG_OBJECT (self, "%s queue full, dropping %" GST_PTR_FORMAT,
+          queue == priv->model_queue ? "Model" : "Bypass", drop);
+      g_atomic_int_inc (dropped);
+      gst_buffer_unref (drop);
+    }
+
+    if (drop == buffer) {
+      break;
+    }
+  }
+}
+
+static GstBuffer *
+video_inference_queue_pop (GstInferenceRing * queue, GstBuffer ** pending)
+{
+  GstBuffer *buffer = *pending;
+
+  if (buffer) {
+    *pending = NULL;
+  } else {
+    buffer = GST_BUFFER_CAST (gst_inference_ring_try_pop (queue));
+  }
+
+  return buffer;
+}
+
+static GstStructure *
+video_inference_get_queue_stats (GstVideoInference * self,
+    GstVideoInferencePrivate * priv)
+{
+  guint model_queued = 0, bypass_queued = 0;
+
+  GST_OBJECT_LOCK (self);
+  if (priv->model_queue) {
+    model_queued = gst_inference_ring_get_length (priv->model_queue);
+    bypass_queued = gst_inference_ring_get_length (priv->bypass_queue);
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  return gst_structure_new ("queue-stats",
+      "model-queued", G_TYPE_UINT, model_queued,
+      "model-dropped", G_TYPE_UINT64,
+      (guint64) g_atomic_int_get (&priv->model_dropped),
+      "bypass-queued", G_TYPE_UINT, bypass_queued,
+      "bypass-dropped", G_TYPE_UINT64,
+      (guint64) g_atomic_int_get (&priv->bypass_dropped),
+      "prediction-time", G_TYPE_UINT64,
+      gst_inference_rate_get_latency (priv->rate), NULL);
+}
+
+static GstClockTime
+video_inference_get_latency (GstVideoInference * self,
+    GstVideoInferencePrivate * priv)
+{
+  GstClockTime latency;
+
+  latency = gst_inference_rate_get_latency (priv->rate);
+
+  /* A partial batch waits for the timeout before being predicted */
+  GST_OBJECT_LOCK (self);
+  if (priv->batch_size > 1) {
+    latency += priv->batch_timeout * GST_MSECOND;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  return latency;
+}
+
+static void
+video_inference_add_latency (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, gint64 start)
+{
+  GstClockTime latency;
+  GstClockTime reported;
+  gboolean changed = FALSE;
+
+  gst_inference_rate_add_latency (priv->rate,
+      (g_get_monotonic_time () - start) * GST_USECOND);
+  latency = video_inference_get_latency (self, priv);
+
+  /* Let the pipeline query the latency again once the prediction time
+   * is known or has moved away from what was reported */
+  GST_OBJECT_LOCK (self);
+  reported = priv->reported_latency;
+  if (GST_CLOCK_TIME_IS_VALID (reported)
+      && (latency > reported + reported / LATENCY_CHANGE_DIVISOR
+          || latency < reported - reported / LATENCY_CHANGE_DIVISOR)) {
+    priv->reported_latency = latency;
+    changed = TRUE;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  if (changed) {
+    GST_DEBUG_OBJECT (self, "Inference latency changed to %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (latency));
+    gst_element_post_message (GST_ELEMENT (self),
+        gst_message_new_latency (GST_OBJECT (self)));
+  }
+}
+
+static gboolean
+gst_video_inference_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query)
+{
+  GstVideoInference *self = GST_VIDEO_INFERENCE (parent);
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstClockTime min, max, latency;
+  gboolean live;
+  guint queue_size;
+
+  if (GST_QUERY_LATENCY != GST_QUERY_TYPE (query)) {
+    return gst_pad_query_default (pad, parent, query);
+  }
+
+  if (!gst_pad_query_default (pad, parent, query)) {
+    return FALSE;
+  }
+
+  gst_query_parse_latency (query, &live, &min, &max);
+  latency = video_inference_get_latency (self, priv);
+
+  GST_OBJECT_LOCK (self);
+  priv->reported_latency = latency;
+  queue_size = priv->model_queue_size;
+  GST_OBJECT_UNLOCK (self);
+
+  /* Every buffer waits for its prediction, the model queue can hold
+   * them for that long each */
+  min += latency;
+  if (GST_CLOCK_TIME_IS_VALID (max)) {
+    max += latency * queue_size;
+  }
+
+  GST_DEBUG_OBJECT (self, "Reporting latency min %" GST_TIME_FORMAT
+      " max %" GST_TIME_FORMAT, GST_TIME_ARGS (min), GST_TIME_ARGS (max));
+  gst_query_set_latency (query, live, min, max);
+
+  return TRUE;
+}
+
+static void
+video_inference_reuse_prediction (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, gboolean own_meta,
+    GstInferenceMeta * imeta)
+{
+  guint64 id;
+
+  GST_OBJECT_LOCK (self);
+  /* A root prediction that came from upstream must be kept, it is how
+   * the bypass buffer is matched */
+  if (own_meta && priv->last_prediction) {
+    /* The copy keeps this buffer's root id, or the bypass buffer paired
+     * with the last prediction would match this one too */
+    id = imeta->prediction->prediction_id;
+    gst_inference_prediction_unref (imeta->prediction);
+    imeta->prediction = gst_inference_prediction_copy (priv->last_prediction);
+    imeta->prediction->prediction_id = id;
+  }
+  imeta->stale = priv->flag_stale;
+  GST_OBJECT_UNLOCK (self);
+}
+
+static GstVideoInferenceSharedModel *
+video_inference_shared_model_acquire (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, const gchar * location, GError ** err)
+{
+  GstVideoInferenceSharedModel *shared;
+  gchar *backend_key;
+  gchar *key;
+  guint batch_size, batch_timeout;
+
+  /* Only elements that would load the same engines, and use them the
+   * same way, share them */
+  backend_key = gst_base_backend_get_key (priv->backend, location);
+  GST_OBJECT_LOCK (self);
+  batch_size = priv->batch_size;
+  batch_timeout = priv->batch_timeout;
+  key = g_strdup_printf ("%s:%d:%d:%d:%u:%u:%u", backend_key,
+      priv->tensor_type, priv->tensor_layout, priv->engine_cache,
+      priv->engine_concurrency, batch_size, batch_timeout);
+  GST_OBJECT_UNLOCK (self);
+  g_free (backend_key);
+
+  /* The first element loads the model outside the lock, so different
+   * models load in parallel. Elements of the same model wait for it */
+  g_mutex_lock (&shared_models_mutex);
+  if (NULL == shared_models) {
+    shared_models = g_hash_table_new (g_str_hash, g_str_equal);
+  }
+
+  shared = (GstVideoInferenceSharedModel *) g_hash_table_lookup (shared_models,
+      key);
+  while (shared && !shared->loaded) {
+    g_cond_wait (&shared_models_cond, &shared_models_mutex);
+    shared = (GstVideoInferenceSharedModel *)
+        g_hash_table_lookup (shared_models, key);
+  }
+  if (shared) {
+    GST_INFO_OBJECT (self, "Using the model already loaded for %s", key);
+    shared->refcount++;
+    g_mutex_unlock (&shared_models_mutex);
+    g_free (key);
+    return shared;
+  }
+
+  shared = g_new0 (GstVideoInferenceSharedModel, 1);
+  shared->key = key;
+  shared->refcount = 1;
+  shared->loaded = FALSE;
+  g_hash_table_insert (shared_models, shared->key, shared);
+  g_mutex_unlock (&shared_models_mutex);
+
+  if (!gst_base_backend_start (priv->backend, location, err)) {
+    /* Waiting elements retry the load themselves */
+    g_mutex_lock (&shared_models_mutex);
+    g_hash_table_remove (shared_models, shared->key);
+    g_cond_broadcast (&shared_models_cond);
+    g_mutex_unlock (&shared_models_mutex);
+    g_free (shared->key);
+    g_free (shared);
+    return NULL;
+  }
+
+  GST_INFO_OBJECT (self, "Sharing the model loaded for %s", key);
+  shared->backend = (GstBaseBackend *) g_object_ref (priv->backend);
+  if (batch_size > 1) {
+    shared->batch = gst_inference_batch_new ("inference-shared",
+        batch_size, (guint64) batch_timeout * 1000,
+        video_inference_batch_func, video_inference_job_free, NULL);
+  }
+
+  g_mutex_lock (&shared_models_mutex);
+  shared->loaded = TRUE;
+  g_cond_broadcast (&shared_models_cond);
+  g_mutex_unlock (&shared_models_mutex);
+
+  return shared;
+}
+
+static void
+video_inference_shared_model_release (GstVideoInference * self,
+    GstVideoInferenceSharedModel * shared)
+{
+  GError *err = NULL;
+
+  g_mutex_lock (&shared_models_mutex);
+  if (--shared->refcount > 0) {
+    g_mutex_unlock (&shared_models_mutex);
+    return;
+  }
+  g_hash_table_remove (shared_models, shared->key);
+  g_mutex_unlock (&shared_models_mutex);
+
+  GST_INFO_OBJECT (self, "Unloading the shared model for %s", shared->key);
+  if (shared->batch) {
+    gst_inference_batch_free (shared->batch);
+  }
+  if (!gst_base_backend_stop (shared->backend, &err)) {
+    GST_WARNING_OBJECT (self, "Could not stop the shared backend: %s",
+        err->message);
+    g_error_free (err);
+  }
+  g_object_unref (shared->backend);
+  g_free (shared->key);
+  g_free (shared);
+}
+
+/* Loads the model ahead of the first buffer, on NULL to READY if the
+ * model location is known by then. The location is a copy owned by the
+ * caller, the property may change meanwhile */
+static gboolean
+video_inference_open (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, const gchar * location)
+{
+  GError *err = NULL;
+  gboolean ret;
+  gint64 start;
+  GstClockTime load_time;
+  guint batch_size;
+
+  if (NULL == location) {
+    GST_ELEMENT_ERROR (self, RESOURCE, NOT_FOUND,
+        ("Model Location has not been set"), (NULL));
+    return FALSE;
+  }
+
+  GST_OBJECT_LOCK (self);
+  batch_size = priv->batch_size;
+  GST_OBJECT_UNLOCK (self);
+
+  /* Otherwise every frame would silently get a slice of one output */
+  if (batch_size > 1 && !(gst_base_backend_get_capabilities (priv->backend) &
+          GST_BASE_BACKEND_CAPABILITY_BATCH)) {
+    GST_ELEMENT_ERROR (self, LIBRARY, SETTINGS,
+        ("The selected backend can not predict batches"),
+        ("batch-size is %u, set it to 1", batch_size));
+    return FALSE;
+  }
+
+  GST_INFO_OBJECT (self, "Loading the model %s", location);
+  start = g_get_monotonic_time ();
+  gst_element_post_message (GST_ELEMENT (self),
+      gst_message_new_element (GST_OBJECT (self),
+          gst_structure_new ("inference-load-start",
+              "location", G_TYPE_STRING, location, NULL)));
+
+  GST_OBJECT_LOCK (self);
+  gst_base_backend_set_tensor_type (priv->backend, priv->tensor_type);
+  gst_base_backend_set_engine_cache (priv->backend, priv->engine_cache,
+      priv->engine_concurrency);
+  gst_base_backend_set_engine_instances (priv->backend,
+      priv->engine_instances);
+  priv->backend_raw_input = priv->bypass_preprocess &&
+      (gst_base_backend_get_capabilities (priv->backend) &
+      GST_BASE_BACKEND_CAPABILITY_RAW_INPUT);
+  if (priv->bypass_preprocess && !priv->backend_raw_input) {
+    GST_WARNING_OBJECT (self, "The backend does not accept raw frames, "
+        "preprocess will not be bypassed");
+  }
+  priv->backend_stale = FALSE;
+  GST_OBJECT_UNLOCK (self);
+
+  if (priv->shared_model) {
+    priv->shared = video_inference_shared_model_acquire (self, priv, location,
+        &err);
+    ret = NULL != priv->shared;
+  } else {
+    ret = gst_base_backend_start (priv->backend, location, &err);
+  }
+
+  load_time = (g_get_monotonic_time () - start) * GST_USECOND;
+  GST_INFO_OBJECT (self, "Model load %s after %" GST_TIME_FORMAT,
+      ret ? "done" : "failed", GST_TIME_ARGS (load_time));
+  gst_element_post_message (GST_ELEMENT (self),
+      gst_message_new_element (GST_OBJECT (self),
+          gst_structure_new ("inference-load-done",
+              "location", G_TYPE_STRING, location,
+              "success", G_TYPE_BOOLEAN, ret,
+              "load-time", G_TYPE_UINT64, load_time, NULL)));
+
+  if (!ret) {
+    GST_ELEMENT_ERROR (self, LIBRARY, INIT,
+        ("Could not start the selected backend: (%s)", err->message), (NULL));
+    g_error_free (err);
+    return FALSE;
+  }
+
+  priv->backend_open = TRUE;
+  video_inference_warm_up (self, priv);
+
+  return TRUE;
+}
+
+static gboolean
+video_inference_close (GstVideoInference * self,
+    GstVideoInferencePrivate * priv)
+{
+  GError *err = NULL;
+
+  priv->backend_open = FALSE;
+
+  if (priv->shared) {
+    video_inference_shared_model_release (self, priv->shared);
+    priv->shared = NULL;
+  } else if (!gst_base_backend_stop (priv->backend, &err)) {
+    GST_ELEMENT_ERROR (self, LIBRARY, INIT,
+        ("Could not stop the selected backend: (%s)", err->message), (NULL));
+    g_error_free (err);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Predicts on zeroed tensors of the model input size, as fixed by the
+ * model pad template, so the engine allocations and compilation done
+ * on the first predictions happen before the first buffer */
+static void
+video_inference_warm_up (GstVideoInference * self,
+    GstVideoInferencePrivate * priv)
+{
+  GstPadTemplate *templ;
+  GstCaps *caps;
+  GstStructure *structure;
+  GstVideoInfo info;
+  GstInferenceTensorInfo tensor_info;
+  GstInferenceTensorType tensor_type;
+  GstInferenceTensorLayout tensor_layout;
+  GstClockTime first = 0, total = 0;
+  GError *err = NULL;
+  guint inferences;
+
+  GST_OBJECT_LOCK (self);
+  inferences = priv->warm_up_inferences;
+  tensor_type = priv->backend_raw_input ? GST_INFERENCE_TENSOR_TYPE_UINT8 :
+      priv->tensor_type;
+  tensor_layout = priv->backend_raw_input ? GST_INFERENCE_TENSOR_LAYOUT_NHWC :
+      priv->tensor_layout;
+  GST_OBJECT_UNLOCK (self);
+
+  if (0 == inferences) {
+    return;
+  }
+
+  templ = gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (self),
+      "sink_model");
+  if (NULL == templ) {
+    GST_WARNING_OBJECT (self, "No model pad template, skipping the warm up");
+    return;
+  }
+
+  caps = gst_pad_template_get_caps (templ);
+  structure = gst_caps_is_empty (caps) || gst_caps_is_any (caps) ? NULL :
+      gst_caps_get_structure (caps, 0);
+  if (NULL == structure
+      || !gst_structure_has_field_typed (structure, "width", G_TYPE_INT)
+      || !gst_structure_has_field_typed (structure, "height", G_TYPE_INT)) {
+    GST_WARNING_OBJECT (self, "The model input size is not fixed, skipping "
+        "the warm up");
+    gst_caps_unref (caps);
+    return;
+  }
+
+  caps = gst_caps_fixate (caps);
+  if (!gst_video_info_from_caps (&info, caps)
+      || !gst_inference_tensor_info_from_video_info (&tensor_info, &info,
+          tensor_type, tensor_layout)) {
+    GST_WARNING_OBJECT (self, "Could not size the warm up tensor from %"
+        GST_PTR_FORMAT, caps);
+    gst_caps_unref (caps);
+    return;
+  }
+  gst_caps_unref (caps);
+
+  if (!gst_base_backend_warm_up (video_inference_get_backend (priv),
+          &tensor_info, inferences, &first, &total, &err)) {
+    /* Not fatal, the model may only fail on synthetic inputs */
+    GST_WARNING_OBJECT (self, "Warm up failed: %s", err->message);
+    g_error_free (err);
+    return;
+  }
+
+  GST_INFO_OBJECT (self, "Warmed up with %u inferences in %" GST_TIME_FORMAT
+      ", the first one took %" GST_TIME_FORMAT, inferences,
+      GST_TIME_ARGS (total), GST_TIME_ARGS (first));
+
+  gst_element_post_message (GST_ELEMENT (self),
+      gst_message_new_element (GST_OBJECT (self),
+          gst_structure_new ("inference-warm-up",
+              "inferences", G_TYPE_UINT, inferences,
+              "first-time", G_TYPE_UINT64, first,
+              "total-time", G_TYPE_UINT64, total, NULL)));
+}
+
+/* Loads the model away from the state change, so the elements of a
+ * pipeline load their models at once */
+static gpointer
+video_inference_load_func (gpointer data)
+{
+  GstVideoInferenceLoad *load = (GstVideoInferenceLoad *) data;
+  GstVideoInference *self = load->self;
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+
+  video_inference_open (self, priv, load->location);
+
+  g_mutex_lock (&priv->load_mutex);
+  priv->loading = FALSE;
+  g_cond_broadcast (&priv->load_cond);
+  g_mutex_unlock (&priv->load_mutex);
+
+  video_inference_commit_state (self, priv, load->cookie);
+
+  g_free (load->location);
+  gst_object_unref (self);
+  g_free (load);
+
+  return NULL;
+}
+
+static gboolean
+video_inference_commit_pending (GstVideoInferencePrivate * priv,
+    guint cookie)
+{
+  gboolean pending;
+
+  g_mutex_lock (&priv->load_mutex);
+  pending = priv->async_pending && cookie == priv->load_cookie;
+  g_mutex_unlock (&priv->load_mutex);
+
+  return pending;
+}
+
+/* Completes the change to PAUSED that waited for the model, under the
+ * state lock like the bin does for its children. No state change waits
+ * for this thread, so it blocks on the lock: a change back to READY
+ * holding it cancels the commit, and a later load changes the cookie */
+static void
+video_inference_commit_state (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, guint cookie)
+{
+  gboolean ret;
+
+  if (!video_inference_commit_pending (priv, cookie)) {
+    return;
+  }
+
+  GST_STATE_LOCK (self);
+  if (!video_inference_commit_pending (priv, cookie)) {
+    GST_DEBUG_OBJECT (self, "The change to PAUSED was cancelled");
+    goto out;
+  }
+
+  ret = priv->backend_open && gst_video_inference_start (self);
+  if (priv->backend_open && !ret) {
+    GST_ELEMENT_ERROR (self, LIBRARY, INIT,
+        ("Could not start the video inference"), (NULL));
+  }
+
+  g_mutex_lock (&priv->load_mutex);
+  priv->async_pending = FALSE;
+  priv->load_failed = !ret;
+  g_cond_broadcast (&priv->load_cond);
+  g_mutex_unlock (&priv->load_mutex);
+
+  if (ret) {
+    GST_INFO_OBJECT (self, "Model loaded, completing the change to PAUSED");
+    gst_element_continue_state (GST_ELEMENT (self), GST_STATE_CHANGE_SUCCESS);
+    gst_element_post_message (GST_ELEMENT (self),
+        gst_message_new_async_done (GST_OBJECT (self), GST_CLOCK_TIME_NONE));
+  } else {
+    gst_element_abort_state (GST_ELEMENT (self));
+  }
+
+out:
+  GST_STATE_UNLOCK (self);
+}
+
+/* Holds the streaming threads until the model loaded in the background
+ * is started */
+static GstFlowReturn
+video_inference_wait_loaded (GstVideoInference * self,
+    GstVideoInferencePrivate * priv)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  g_mutex_lock (&priv->load_mutex);
+  while ((priv->loading || priv->async_pending) && !priv->load_flushing) {
+    g_cond_wait (&priv->load_cond, &priv->load_mutex);
+  }
+  if (priv->load_flushing) {
+    ret = GST_FLOW_FLUSHING;
+  } else if (priv->load_failed) {
+    ret = GST_FLOW_ERROR;
+  }
+  g_mutex_unlock (&priv->load_mutex);
+
+  return ret;
+}
+
+static void
+video_inference_stage_preprocess (gpointer data, gpointer user_data)
+{
+  GstVideoInference *self = GST_VIDEO_INFERENCE (user_data);
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstVideoInferenceClass *klass = GST_VIDEO_INFERENCE_GET_CLASS (self);
+  GstVideoInferenceJob *job = (GstVideoInferenceJob *) data;
+
+  /* The buffers behind new caps are preprocessed with them, so they are
+   * applied here rather than when the event leaves the pipeline */
+  if (job->event) {
+    if (GST_EVENT_CAPS == GST_EVENT_TYPE (job->event)) {
+      gst_video_inference_set_caps (self, priv,
+          priv->sink_model_data, job->event);
+    }
+    return;
+  }
+
+  job->ret = video_inference_job_start (self, klass, priv->sink_model_data,
+      job);
+  if (GST_FLOW_OK == job->ret && job->infer
+      && !video_inference_job_preprocess (self, klass, priv, job)) {
+    job->ret = GST_FLOW_ERROR;
+  }
+}
+
+static void
+video_inference_stage_predict (gpointer data, gpointer user_data)
+{
+  GstVideoInference *self = GST_VIDEO_INFERENCE (user_data);
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstVideoInferenceJob *job = (GstVideoInferenceJob *) data;
+
+  if (job->event || GST_FLOW_OK != job->ret || !job->infer) {
+    return;
+  }
+
+  if (!video_inference_job_predict (self, priv, job)) {
+    job->ret = GST_FLOW_ERROR;
+  }
+}
+
+static void
+video_inference_stage_postprocess (gpointer data, gpointer user_data)
+{
+  GstVideoInference *self = GST_VIDEO_INFERENCE (user_data);
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstVideoInferenceClass *klass = GST_VIDEO_INFERENCE_GET_CLASS (self);
+  GstVideoInferenceJob *job = (GstVideoInferenceJob *) data;
+  GstFlowReturn ret;
+  guint i;
+
+  for (i = 0; i < job->gaps; ++i) {
+    video_inference_queue_gap (self, priv);
+  }
+
+  if (job->event) {
+    if (!video_inference_forward_model_event (self, priv, job->event)) {
+      GST_WARNING_OBJECT (self, "Failed to forward the model event");
+    }
+    job->event = NULL;
+  } else {
+    ret = video_inference_job_finish (self, klass, priv,
+        priv->sink_model_data, job);
+    /* Reported back to the streaming thread on the next buffer */
+    if (GST_FLOW_OK != ret) {
+      g_atomic_int_set (&priv->model_flow, ret);
+    }
+  }
+
+  video_inference_job_free (job, self);
+}
+
+static GstStructure *
+video_inference_get_pipeline_stats (GstVideoInference * self,
+    GstVideoInferencePrivate * priv)
+{
+  GstStructure *stats;
+  guint64 jobs = 0, total = 0, max = 0;
+  gchar *field;
+  guint i;
+
+  stats = gst_structure_new_empty ("pipeline-stats");
+
+  for (i = 0; i < G_N_ELEMENTS (video_inference_stages); ++i) {
+    if (priv->pipeline) {
+      gst_inference_pipeline_get_stage_stats (priv->pipeline, i, &jobs,
+          &total, &max);
+    }
+
+    field = g_strdup_printf ("%s-buffers", video_inference_stages[i].name);
+    gst_structure_set (stats, field, G_TYPE_UINT64, jobs, NULL);
+    g_free (field);
+    field = g_strdup_printf ("%s-time", video_inference_stages[i].name);
+    gst_structure_set (stats, field, G_TYPE_UINT64, jobs ? total / jobs : 0,
+        NULL);
+    g_free (field);
+    field = g_strdup_printf ("%s-max-time", video_inference_stages[i].name);
+    gst_structure_set (stats, field, G_TYPE_UINT64, max, NULL);
+    g_free (field);
+  }
+
+  return stats;
+}
+
+static void
+video_inference_flush_queue (GstInferenceRing * queue, GstBuffer ** pending)
+{
+  GstBuffer *buf = NULL;
+
+  g_return_if_fail (queue);
+  g_return_if_fail (pending);
+
+  while ((buf = video_inference_queue_pop (queue, pending))) {
+    gst_buffer_unref (buf);
+  }
+}
+
+static void
+gst_video_inference_finalize (GObject * object)
+{
+  GstVideoInference *self = GST_VIDEO_INFERENCE (object);
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+
+  g_clear_object (&(priv->sink_bypass));
+  g_clear_object (&(priv->sink_model));
+  g_clear_object (&(priv->src_bypass));
+  g_clear_object (&(priv->src_model));
+
+  g_free (priv->sink_bypass_data);
+  priv->sink_bypass_data = NULL;
+  g_free (priv->sink_model_data);
+  priv->sink_model_data = NULL;
+  gst_event_replace (&priv->model_eos_event, NULL);
+  g_mutex_clear (&priv->mtx_eos);
+  g_free (priv->model_location);
+  priv->model_location = NULL;
+  g_free (priv->labels);
+  priv->labels = NULL;
+  g_free (priv->labels_list);
+  priv->labels_list = NULL;
+
+  /* A failed start leaves them behind */
+  if (priv->model_queue) {
+    video_inference_flush_queue (priv->model_queue, &priv->model_pending);
+    video_inference_flush_queue (priv->bypass_queue, &priv->bypass_pending);
+    gst_inference_ring_free (priv->model_queue);
+    gst_inference_ring_free (priv->bypass_queue);
+  }
+  if (priv->matcher) {
+    gst_inference_matcher_free (priv->matcher,
+        (GDestroyNotify) gst_buffer_unref);
+  }
+
+  gst_inference_preprocess_cache_free (priv->preprocess_cache);
+  video_inference_set_tensor_pool (self, NULL, 0);
+  gst_inference_rate_free (priv->rate);
+
+  g_clear_object (&priv->backend);
+
+  /* A load thread holds a reference, none is left running by now */
+  g_mutex_clear (&priv->load_mutex);
+  g_cond_clear (&priv->load_cond);
+
+  G_OBJECT_CLASS (gst_video_inference_parent_class)->finalize (object);
+}
+
+static void
+gst_video_inference_constructed (GObject * object)
+{
+  GstVideoInference *self = GST_VIDEO_INFERENCE (object);
+
+  /* The subclass backend type is unknown while the base class inits */
+  if (GST_VIDEO_INFERENCE_GET_CLASS (self)->backend_type) {
+    gst_video_inference_set_backend (self, 0);
+  }
+
+  G_OBJECT_CLASS (gst_video_inference_parent_class)->constructed (object);
+}
+
+static void
+gst_video_inference_set_backend (GstVideoInference * self, gint backend)
+{
+  GstVideoInferenceClass *klass = GST_VIDEO_INFERENCE_GET_CLASS (self);
   GstBaseBackend *backend_new;
   GType backend_type;
   GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
@@ -1402,7 +4606,8 @@ gst_video_inference_set_backend (GstVideoInference * self, gint backend)
   if (priv->backend)
     g_object_unref (priv->backend);
 
-  backend_type = gst_inference_backends_search_type (backend);
+  backend_type = klass->backend_type ? klass->backend_type :
+      gst_inference_backends_search_type (backend);
   backend_new = (GstBaseBackend *) g_object_new (backend_type, NULL);
   priv->backend = backend_new;
 
@@ -24,12 +24,44 @@
 
 #include <gst/gst.h>
 #include <gst/video/video.h>
+#include <gst/r2inference/gstinferencepreprocess.h>
 
 G_BEGIN_DECLS
 #define GST_TYPE_VIDEO_INFERENCE gst_video_inference_get_type ()
 G_DECLARE_DERIVABLE_TYPE (GstVideoInference, gst_video_inference, GST,
     VIDEO_INFERENCE, GstElement);
 
+/**
+ * \brief Output tensor a model is expected to produce
+ *
+ * A dimension of 0 is unknown and is computed from the size of the
+ * output, at most one dimension can be unknown.
+ */
+typedef struct _GstVideoInferenceTensorDesc
+{
+  const gchar *name;
+  GstInferenceTensorType type;
+  guint num_dims;
+  gsize shape[GST_INFERENCE_TENSOR_DIMS];
+} GstVideoInferenceTensorDesc;
+
+/**
+ * \brief Output tensor of a prediction, read in place
+ *
+ * The shape is the one of the matching description, with the unknown
+ * dimension filled in. Outputs without a description are a single
+ * dimension of FLOAT values.
+ */
+typedef struct _GstVideoInferenceTensor
+{
+  const gchar *name;
+  GstInferenceTensorType type;
+  guint num_dims;
+  gsize shape[GST_INFERENCE_TENSOR_DIMS];
+  gsize size;
+  gconstpointer data;
+} GstVideoInferenceTensor;
+
 struct _GstVideoInferenceClass
 {
   GstElementClass parent_class;
@@ -41,7 +73,43 @@ struct _GstVideoInferenceClass
     gboolean (*postprocess) (GstVideoInference * self,
       const gpointer prediction, gsize size, GstMeta * meta_model,
       GstVideoInfo * info_model, gboolean * valid_prediction, gchar **labels_list, gint num_labels);
+    gboolean (*postprocess_tensors) (GstVideoInference * self,
+      const GstVideoInferenceTensor * tensors, guint num_tensors,
+      GstMeta * meta_model, GstVideoInfo * info_model,
+      gboolean * valid_prediction, gchar **labels_list, gint num_labels);
+
+  const GstVideoInferenceTensorDesc *output_tensors;
+  guint num_output_tensors;
+
+  /* A GstBaseBackend subclass used instead of the backend property, 0
+   * for the R2Inference frameworks */
+  GType backend_type;
 };
 
+/**
+ * \brief Describe the output tensors of the model of a subclass
+ *
+ * The outputs of every prediction are checked against them before
+ * postprocess_tensors is called.
+ *
+ * \param klass The subclass
+ * \param tensors The descriptions, in the order the backend outputs
+ * them. They must stay valid for the lifetime of the class
+ * \param num_tensors The number of descriptions
+ */
+void gst_video_inference_class_set_output_tensors (GstVideoInferenceClass *
+    klass, const GstVideoInferenceTensorDesc * tensors, guint num_tensors);
+
+/**
+ * \brief Find an output tensor by name
+ *
+ * \param tensors The tensors of a prediction
+ * \param num_tensors The number of tensors
+ * \param name The name to look for
+ * \return The tensor, or NULL if there is none with that name
+ */
+const GstVideoInferenceTensor *gst_video_inference_tensor_find (const
+    GstVideoInferenceTensor * tensors, guint num_tensors, const gchar * name);
+
 G_END_DECLS
 #endif //__GST_VIDEO_INFERENCE_H__
@@ -202,7 +202,10 @@ gst_inference_bin_class_init (GstInferenceBinClass * klass)
 
   g_object_class_install_property (object_class, PROP_SCALER,
       g_param_spec_string ("scaler", "Video Scaler",
-          "Bin description to use as video scaler",
+          "Bin description to use as video scaler. Use inferencescale to "
+          "color convert and scale the model branch in a single pass, "
+          "in which case the converter only processes the bypass branch. "
+          "The model still normalizes the scaled frames",
           PROP_SCALER_DEFAULT, G_PARAM_READWRITE));
 
   g_object_class_install_property (object_class, PROP_CONVERTER,
@@ -390,22 +393,33 @@ gst_inference_bin_build_pipe (GstInferenceBin * self)
   GString *desc = NULL;
   const gchar *crop = NULL;
   const gchar *overlay = NULL;
+  gboolean fused_scaler = FALSE;
 
   g_return_val_if_fail (self, FALSE);
 
   crop = self->crop ? "true" : "false";
   overlay = self->overlay ? "true" : "false";
 
+  /* The fused scaler converts the model branch by itself */
+  fused_scaler = g_str_has_prefix (self->scaler, "inferencescale");
+
   desc = g_string_new (NULL);
 
   g_string_append_printf (desc, "inferencefilter filter-class=%d name=filter "
       "! ", self->filter);
   g_string_append (desc, "inferencedebug name=debug_before ! ");
-  g_string_append_printf (desc, "%s name=converter_before ! ", self->converter);
+  if (!fused_scaler) {
+    g_string_append_printf (desc, "%s name=converter_before ! ",
+        self->converter);
+  }
   g_string_append (desc, "tee name=tee ");
   g_string_append (desc,
-      "tee. ! queue max-size-buffers=3 leaky=no name=queue_bypass ! "
-      "arch.sink_bypass ");
+      "tee. ! queue max-size-buffers=3 leaky=no name=queue_bypass ! ");
+  if (fused_scaler) {
+    g_string_append_printf (desc, "%s name=converter_before ! ",
+        self->converter);
+  }
+  g_string_append (desc, "arch.sink_bypass ");
   g_string_append_printf (desc, "tee. ! queue max-size-buffers=3 leaky=no "
       "name=queue_sink ! inferencecrop enable=%s name=crop ! ", crop);
   g_string_append_printf (desc, "%s name=scaler ! arch.sink_model ",
@@ -0,0 +1,355 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/**
+ * SECTION:element-gstinferencescale
+ *
+ * The inferencescale element resizes and color converts I420, NV12 or
+ * RGB frames into the RGB size expected by a model in a single pass,
+ * replacing the videoconvert ! videoscale chain in front of the model.
+ * It outputs RGB frames, the model still normalizes them on its own.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 v4l2src device=$CAMERA ! "video/x-raw, width=1280, height=720, format=NV12" ! tee name=t \
+   t. ! queue ! inferencescale method=area ! net.sink_model t. ! queue ! videoconvert ! net.sink_bypass \
+   tinyyolov2 name=net model-location=$MODEL_LOCATION backend=tensorflow backend::input-layer=$INPUT_LAYER \
+   backend::output-layer=$OUTPUT_LAYER net.src_bypass ! inferenceoverlay ! videoconvert ! xvimagesink
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstinferencescale.h"
+
+#include <gst/r2inference/gstinferencepreprocesspool.h>
+#include <gst/r2inference/gstinferenceresize.h>
+
+GST_DEBUG_CATEGORY_STATIC (gst_inference_scale_debug_category);
+#define GST_CAT_DEFAULT gst_inference_scale_debug_category
+
+#define GST_INFERENCE_SCALE_PROPERTY_FLAGS (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)
+#define PROP_METHOD_DEFAULT GST_INFERENCE_RESIZE_METHOD_BILINEAR
+#define PROP_N_THREADS_DEFAULT 1
+#define PROP_N_THREADS_MIN 1
+#define PROP_N_THREADS_MAX 64
+
+/* prototypes */
+
+static void gst_inference_scale_set_property (GObject * object,
+    guint property_id, const GValue * value, GParamSpec * pspec);
+static void gst_inference_scale_get_property (GObject * object,
+    guint property_id, GValue * value, GParamSpec * pspec);
+static gboolean gst_inference_scale_start (GstBaseTransform * trans);
+static gboolean gst_inference_scale_stop (GstBaseTransform * trans);
+static GstCaps *gst_inference_scale_transform_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * filter);
+static GstCaps *gst_inference_scale_fixate_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * othercaps);
+static gboolean gst_inference_scale_transform_meta (GstBaseTransform * trans,
+    GstBuffer * outbuf, GstMeta * meta, GstBuffer * inbuf);
+static GstFlowReturn gst_inference_scale_transform_frame (GstVideoFilter *
+    filter, GstVideoFrame * inframe, GstVideoFrame * outframe);
+
+enum
+{
+  PROP_0,
+  PROP_METHOD,
+  PROP_N_THREADS,
+};
+
+struct _GstInferenceScale
+{
+  GstVideoFilter base_inferencescale;
+  GstInferenceResizeMethod method;
+  guint n_threads;
+  GstInferencePreprocessPool *pool;
+};
+
+/* pad templates */
+
+static GstStaticPadTemplate gst_inference_scale_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (GST_INFERENCE_RESIZE_OUTPUT_FORMATS)));
+
+static GstStaticPadTemplate gst_inference_scale_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (GST_INFERENCE_RESIZE_INPUT_FORMATS)));
+
+/* class initialization */
+
+G_DEFINE_TYPE_WITH_CODE (GstInferenceScale, gst_inference_scale,
+    GST_TYPE_VIDEO_FILTER,
+    GST_DEBUG_CATEGORY_INIT (gst_inference_scale_debug_category,
+        "inferencescale", 0, "debug category for inferencescale element"));
+
+static void
+gst_inference_scale_class_init (GstInferenceScaleClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstBaseTransformClass *base_transform_class =
+      GST_BASE_TRANSFORM_CLASS (klass);
+  GstVideoFilterClass *video_filter_class = GST_VIDEO_FILTER_CLASS (klass);
+
+  gst_element_class_add_static_pad_template (GST_ELEMENT_CLASS (klass),
+      &gst_inference_scale_src_template);
+  gst_element_class_add_static_pad_template (GST_ELEMENT_CLASS (klass),
+      &gst_inference_scale_sink_template);
+
+  gst_element_class_set_static_metadata (GST_ELEMENT_CLASS (klass),
+      "Inference Scale", "Filter/Converter/Video/Scaler",
+      "Resizes and color converts frames to the model input in a single pass",
+      "<support@ridgerun.com>");
+
+  gobject_class->set_property = gst_inference_scale_set_property;
+  gobject_class->get_property = gst_inference_scale_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_METHOD,
+      g_param_spec_enum ("method", "Method", "Sampling method",
+          GST_TYPE_INFERENCE_RESIZE_METHOD, PROP_METHOD_DEFAULT,
+          GST_INFERENCE_SCALE_PROPERTY_FLAGS));
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to process each frame in row bands",
+          PROP_N_THREADS_MIN, PROP_N_THREADS_MAX, PROP_N_THREADS_DEFAULT,
+          GST_INFERENCE_SCALE_PROPERTY_FLAGS | GST_PARAM_MUTABLE_READY));
+
+  base_transform_class->passthrough_on_same_caps = TRUE;
+  base_transform_class->start = GST_DEBUG_FUNCPTR (gst_inference_scale_start);
+  base_transform_class->stop = GST_DEBUG_FUNCPTR (gst_inference_scale_stop);
+  base_transform_class->transform_caps =
+      GST_DEBUG_FUNCPTR (gst_inference_scale_transform_caps);
+  base_transform_class->fixate_caps =
+      GST_DEBUG_FUNCPTR (gst_inference_scale_fixate_caps);
+  base_transform_class->transform_meta =
+      GST_DEBUG_FUNCPTR (gst_inference_scale_transform_meta);
+  video_filter_class->transform_frame =
+      GST_DEBUG_FUNCPTR (gst_inference_scale_transform_frame);
+}
+
+static void
+gst_inference_scale_init (GstInferenceScale * inferencescale)
+{
+  inferencescale->method = PROP_METHOD_DEFAULT;
+  inferencescale->n_threads = PROP_N_THREADS_DEFAULT;
+  inferencescale->pool = NULL;
+}
+
+static void
+gst_inference_scale_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstInferenceScale *inferencescale = GST_INFERENCE_SCALE (object);
+
+  GST_DEBUG_OBJECT (inferencescale, "set_property");
+
+  GST_OBJECT_LOCK (inferencescale);
+  switch (property_id) {
+    case PROP_METHOD:
+      inferencescale->method = g_value_get_enum (value);
+      break;
+    case PROP_N_THREADS:
+      inferencescale->n_threads = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (inferencescale);
+}
+
+static void
+gst_inference_scale_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstInferenceScale *inferencescale = GST_INFERENCE_SCALE (object);
+
+  GST_DEBUG_OBJECT (inferencescale, "get_property");
+
+  GST_OBJECT_LOCK (inferencescale);
+  switch (property_id) {
+    case PROP_METHOD:
+      g_value_set_enum (value, inferencescale->method);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, inferencescale->n_threads);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (inferencescale);
+}
+
+static gboolean
+gst_inference_scale_start (GstBaseTransform * trans)
+{
+  GstInferenceScale *inferencescale = GST_INFERENCE_SCALE (trans);
+
+  GST_OBJECT_LOCK (inferencescale);
+  if (inferencescale->n_threads > 1 && NULL == inferencescale->pool) {
+    inferencescale->pool =
+        gst_inference_preprocess_pool_new (inferencescale->n_threads);
+  }
+  GST_OBJECT_UNLOCK (inferencescale);
+
+  return TRUE;
+}
+
+static gboolean
+gst_inference_scale_stop (GstBaseTransform * trans)
+{
+  GstInferenceScale *inferencescale = GST_INFERENCE_SCALE (trans);
+
+  if (inferencescale->pool) {
+    gst_inference_preprocess_pool_free (inferencescale->pool);
+    inferencescale->pool = NULL;
+  }
+
+  return TRUE;
+}
+
+static GstCaps *
+gst_inference_scale_transform_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * filter)
+{
+  GstCaps *ret, *templ, *tmp;
+  GstPad *other;
+  guint i;
+
+  /* Any size and any supported format can be produced from any input */
+  tmp = gst_caps_new_empty ();
+  for (i = 0; i < gst_caps_get_size (caps); ++i) {
+    GstStructure *structure =
+        gst_structure_copy (gst_caps_get_structure (caps, i));
+
+    gst_structure_remove_fields (structure, "format", "width", "height",
+        "pixel-aspect-ratio", "colorimetry", "chroma-site", NULL);
+    tmp = gst_caps_merge_structure (tmp, structure);
+  }
+
+  other = GST_PAD_SINK == direction ? GST_BASE_TRANSFORM_SRC_PAD (trans) :
+      GST_BASE_TRANSFORM_SINK_PAD (trans);
+  templ = gst_pad_get_pad_template_caps (other);
+  ret = gst_caps_intersect (tmp, templ);
+  gst_caps_unref (templ);
+  gst_caps_unref (tmp);
+
+  if (filter) {
+    tmp = gst_caps_intersect_full (filter, ret, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref (ret);
+    ret = tmp;
+  }
+
+  GST_DEBUG_OBJECT (trans, "Transformed %" GST_PTR_FORMAT " into %"
+      GST_PTR_FORMAT, caps, ret);
+
+  return ret;
+}
+
+static GstCaps *
+gst_inference_scale_fixate_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * othercaps)
+{
+  GstStructure *ins, *outs;
+  gint width, height;
+
+  othercaps = gst_caps_truncate (othercaps);
+  othercaps = gst_caps_make_writable (othercaps);
+
+  ins = gst_caps_get_structure (caps, 0);
+  outs = gst_caps_get_structure (othercaps, 0);
+
+  /* Keep the original size unless downstream requires a different one */
+  if (gst_structure_get_int (ins, "width", &width)) {
+    gst_structure_fixate_field_nearest_int (outs, "width", width);
+  }
+  if (gst_structure_get_int (ins, "height", &height)) {
+    gst_structure_fixate_field_nearest_int (outs, "height", height);
+  }
+
+  return gst_caps_fixate (othercaps);
+}
+
+static gboolean
+gst_inference_scale_transform_meta (GstBaseTransform * trans,
+    GstBuffer * outbuf, GstMeta * meta, GstBuffer * inbuf)
+{
+  GstVideoFilter *filter = GST_VIDEO_FILTER (trans);
+  const GstMetaInfo *info = meta->info;
+  const gchar *const *tags;
+  GQuark size_quark;
+
+  tags = gst_meta_api_type_get_tags (info->api);
+  if (NULL == tags || NULL == tags[0]) {
+    return TRUE;
+  }
+
+  /* Scale the metas that depend on the frame size, such as the
+   * inference meta, and drop the rest */
+  size_quark = g_quark_from_static_string (GST_META_TAG_VIDEO_SIZE_STR);
+  if (gst_meta_api_type_has_tag (info->api, size_quark)
+      && info->transform_func) {
+    GstVideoMetaTransform transform = { &filter->in_info, &filter->out_info };
+
+    info->transform_func (outbuf, meta, inbuf,
+        gst_video_meta_transform_scale_get_quark (), &transform);
+  }
+
+  return FALSE;
+}
+
+static GstFlowReturn
+gst_inference_scale_transform_frame (GstVideoFilter * filter,
+    GstVideoFrame * inframe, GstVideoFrame * outframe)
+{
+  GstInferenceScale *inferencescale = GST_INFERENCE_SCALE (filter);
+  GstInferenceResizeMethod method;
+  gboolean ret;
+
+  GST_LOG_OBJECT (inferencescale, "transform_frame");
+
+  GST_OBJECT_LOCK (inferencescale);
+  method = inferencescale->method;
+  GST_OBJECT_UNLOCK (inferencescale);
+
+  gst_inference_preprocess_pool_set_current (inferencescale->pool);
+  ret = gst_inference_resize (inframe, outframe, method);
+  gst_inference_preprocess_pool_set_current (NULL);
+
+  if (!ret) {
+    GST_ELEMENT_ERROR (inferencescale, STREAM, FORMAT,
+        ("Unable to scale %s frames",
+            gst_video_format_to_string (GST_VIDEO_FRAME_FORMAT (inframe))),
+        (NULL));
+    return GST_FLOW_ERROR;
+  }
+
+  return GST_FLOW_OK;
+}
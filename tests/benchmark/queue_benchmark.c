@@ -0,0 +1,266 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+
+/*
+ * Compares the model and bypass queues of the video inference element,
+ * GQueues guarded by mutexes against lock free rings, under a synthetic
+ * load. An inference thread queues the predicted model buffers while the
+ * bypass thread pairs them, both at the same frame rate. Both modes hold
+ * BENCH_QUEUE_SIZE buffers at most and drop the oldest one when full.
+ *
+ * Run: ./queue_benchmark [SECONDS]
+ *
+ * Reports the average and maximum time in nanoseconds each side spent
+ * in the queue operations per frame, at 60, 120 and 240 fps.
+ */
+
+#include <glib.h>
+#include <time.h>
+
+#include "gst/r2inference/gstinferencering.h"
+
+#define BENCH_DEFAULT_SECONDS 2
+#define BENCH_QUEUE_SIZE 32
+#define NSECONDS_PER_SECOND G_GINT64_CONSTANT (1000000000)
+
+typedef enum
+{
+  BENCH_MODE_LOCKED,
+  BENCH_MODE_RING,
+} BenchMode;
+
+typedef struct _BenchStats BenchStats;
+struct _BenchStats
+{
+  guint64 total;
+  guint64 max;
+};
+
+typedef struct _Bench Bench;
+struct _Bench
+{
+  BenchMode mode;
+  guint frames;
+  gint64 period;
+  gint64 start;
+
+  GMutex mtx_model_queue;
+  GMutex mtx_bypass_queue;
+  GQueue *model_queue;
+  GQueue *bypass_queue;
+
+  GstInferenceRing *model_ring;
+  GstInferenceRing *bypass_ring;
+  gpointer model_pending;
+  gpointer bypass_pending;
+
+  BenchStats model;
+  BenchStats bypass;
+};
+
+static const guint bench_rates[] = { 60, 120, 240 };
+
+static gint64
+bench_now (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec * NSECONDS_PER_SECOND + ts.tv_nsec;
+}
+
+static void
+bench_wait (Bench * bench, guint frame)
+{
+  gint64 left = bench->start + frame * bench->period - bench_now ();
+
+  if (left > 0) {
+    g_usleep (left / 1000);
+  }
+}
+
+static void
+bench_account (BenchStats * stats, gint64 start)
+{
+  guint64 elapsed = bench_now () - start;
+
+  stats->total += elapsed;
+  stats->max = MAX (stats->max, elapsed);
+}
+
+static gpointer
+bench_ring_pop (GstInferenceRing * ring, gpointer * pending)
+{
+  gpointer item = *pending;
+
+  if (item) {
+    *pending = NULL;
+  } else {
+    item = gst_inference_ring_try_pop (ring);
+  }
+
+  return item;
+}
+
+static void
+bench_push_model (Bench * bench, gpointer item)
+{
+  if (BENCH_MODE_LOCKED == bench->mode) {
+    g_mutex_lock (&bench->mtx_model_queue);
+    if (g_queue_get_length (bench->model_queue) >= BENCH_QUEUE_SIZE) {
+      g_queue_pop_tail (bench->model_queue);
+    }
+    g_queue_push_head (bench->model_queue, item);
+    g_mutex_unlock (&bench->mtx_model_queue);
+    return;
+  }
+
+  /* Drop the oldest buffers like the element does when full */
+  while (!gst_inference_ring_try_push (bench->model_ring, item)) {
+    gst_inference_ring_try_pop (bench->model_ring);
+  }
+}
+
+static void
+bench_pair_bypass (Bench * bench, gpointer item)
+{
+  gpointer bypass, model;
+  gboolean paired = FALSE;
+
+  /* Same queue operations as the bypass processing */
+  if (BENCH_MODE_LOCKED == bench->mode) {
+    g_mutex_lock (&bench->mtx_bypass_queue);
+    if (g_queue_get_length (bench->bypass_queue) >= BENCH_QUEUE_SIZE) {
+      g_queue_pop_tail (bench->bypass_queue);
+    }
+    g_queue_push_head (bench->bypass_queue, item);
+    bypass = g_queue_pop_tail (bench->bypass_queue);
+    g_mutex_unlock (&bench->mtx_bypass_queue);
+
+    do {
+      g_mutex_lock (&bench->mtx_model_queue);
+      model = g_queue_pop_tail (bench->model_queue);
+      g_mutex_unlock (&bench->mtx_model_queue);
+      paired |= NULL != model;
+    } while (model);
+
+    if (!paired) {
+      g_mutex_lock (&bench->mtx_bypass_queue);
+      g_queue_push_tail (bench->bypass_queue, bypass);
+      g_mutex_unlock (&bench->mtx_bypass_queue);
+    }
+    return;
+  }
+
+  while (!gst_inference_ring_try_push (bench->bypass_ring, item)) {
+    bench_ring_pop (bench->bypass_ring, &bench->bypass_pending);
+  }
+  bypass = bench_ring_pop (bench->bypass_ring, &bench->bypass_pending);
+
+  do {
+    model = bench_ring_pop (bench->model_ring, &bench->model_pending);
+    paired |= NULL != model;
+  } while (model);
+
+  if (!paired) {
+    bench->bypass_pending = bypass;
+  }
+}
+
+static gpointer
+bench_model_func (gpointer user_data)
+{
+  Bench *bench = (Bench *) user_data;
+  gint64 start;
+  guint i;
+
+  for (i = 0; i < bench->frames; ++i) {
+    bench_wait (bench, i);
+    start = bench_now ();
+    bench_push_model (bench, GUINT_TO_POINTER (i + 1));
+    bench_account (&bench->model, start);
+  }
+
+  return NULL;
+}
+
+static void
+bench_run (BenchMode mode, guint fps, guint seconds)
+{
+  Bench bench = { 0 };
+  GThread *model_thread;
+  gint64 start;
+  guint i;
+
+  bench.mode = mode;
+  bench.frames = fps * seconds;
+  bench.period = NSECONDS_PER_SECOND / fps;
+  g_mutex_init (&bench.mtx_model_queue);
+  g_mutex_init (&bench.mtx_bypass_queue);
+  bench.model_queue = g_queue_new ();
+  bench.bypass_queue = g_queue_new ();
+  bench.model_ring = gst_inference_ring_new (BENCH_QUEUE_SIZE);
+  bench.bypass_ring = gst_inference_ring_new (BENCH_QUEUE_SIZE);
+  bench.start = bench_now ();
+
+  model_thread = g_thread_new ("model", bench_model_func, &bench);
+  for (i = 0; i < bench.frames; ++i) {
+    bench_wait (&bench, i);
+    start = bench_now ();
+    bench_pair_bypass (&bench, GUINT_TO_POINTER (i + 1));
+    bench_account (&bench.bypass, start);
+  }
+  g_thread_join (model_thread);
+
+  g_print ("%-8s %4u fps  model avg %6" G_GUINT64_FORMAT " max %8"
+      G_GUINT64_FORMAT "  bypass avg %6" G_GUINT64_FORMAT " max %8"
+      G_GUINT64_FORMAT "\n", BENCH_MODE_LOCKED == mode ? "locked" : "ring",
+      fps, bench.model.total / bench.frames, bench.model.max,
+      bench.bypass.total / bench.frames, bench.bypass.max);
+
+  g_mutex_clear (&bench.mtx_model_queue);
+  g_mutex_clear (&bench.mtx_bypass_queue);
+  g_queue_free (bench.model_queue);
+  g_queue_free (bench.bypass_queue);
+  gst_inference_ring_free (bench.model_ring);
+  gst_inference_ring_free (bench.bypass_ring);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint seconds = BENCH_DEFAULT_SECONDS;
+  guint i;
+
+  if (argc > 1) {
+    seconds = MAX (1, g_ascii_strtoull (argv[1], NULL, 10));
+  }
+
+  g_print ("Queue operation time per frame in nanoseconds\n");
+  for (i = 0; i < G_N_ELEMENTS (bench_rates); ++i) {
+    bench_run (BENCH_MODE_LOCKED, bench_rates[i], seconds);
+    bench_run (BENCH_MODE_RING, bench_rates[i], seconds);
+  }
+
+  return 0;
+}
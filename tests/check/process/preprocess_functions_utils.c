@@ -20,6 +20,7 @@
  */
 
 #include "preprocess_functions_utils.h"
+#include "gst/r2inference/gstinferencepreprocess.h"
 
 void
 gst_check_output_pixels (GstVideoFrame * outframe, gfloat expected_value_red,
@@ -133,3 +134,17 @@ gst_create_test_frames (GstVideoFrame * inframe, GstVideoFrame * outframe,
   gst_video_frame_unmap (inframe);
   gst_video_frame_unmap (outframe);
 }
+
+void
+gst_preprocess_use_scalar (void)
+{
+  fail_unless (gst_inference_preprocess_set_impl
+      (GST_INFERENCE_PREPROCESS_IMPL_SCALAR));
+}
+
+void
+gst_preprocess_use_default (void)
+{
+  fail_unless (gst_inference_preprocess_set_impl
+      (GST_INFERENCE_PREPROCESS_IMPL_AUTO));
+}
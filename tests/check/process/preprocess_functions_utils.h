@@ -35,6 +35,10 @@ void gst_check_output_pixels (GstVideoFrame * outframe,
     gfloat expected_value_blue, gint first_index, gint last_index,
     gint model_channels);
 
+void gst_preprocess_use_scalar (void);
+
+void gst_preprocess_use_default (void);
+
 G_END_DECLS
 
 #endif
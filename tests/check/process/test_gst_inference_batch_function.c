@@ -0,0 +1,301 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+
+#include <gst/check/gstcheck.h>
+#include "gst/r2inference/gstinferencebatch.h"
+
+#define TEST_BATCH_SIZE 4
+#define TEST_ITEMS 64
+#define TEST_NO_TIMEOUT (G_GUINT64_CONSTANT (60) * 1000000)
+#define TEST_TIMEOUT 20000
+
+typedef struct _TestBatchData TestBatchData;
+struct _TestBatchData
+{
+  GMutex mutex;
+  GCond cond;
+  gboolean blocked;
+  gint items[TEST_ITEMS];
+  gint n_items;
+  guint sizes[TEST_ITEMS];
+  gint n_batches;
+  gint n_dropped;
+};
+
+static void
+test_batch_func (gpointer * items, guint n_items, gpointer user_data)
+{
+  TestBatchData *data = (TestBatchData *) user_data;
+  guint i;
+
+  g_mutex_lock (&data->mutex);
+  while (data->blocked) {
+    g_cond_wait (&data->cond, &data->mutex);
+  }
+
+  fail_unless (n_items > 0);
+  data->sizes[data->n_batches++] = n_items;
+  for (i = 0; i < n_items; ++i) {
+    data->items[data->n_items++] = *(gint *) items[i];
+    g_free (items[i]);
+  }
+  g_cond_broadcast (&data->cond);
+  g_mutex_unlock (&data->mutex);
+}
+
+static void
+test_batch_drop (gpointer item, gpointer user_data)
+{
+  TestBatchData *data = (TestBatchData *) user_data;
+
+  g_mutex_lock (&data->mutex);
+  data->n_dropped++;
+  g_mutex_unlock (&data->mutex);
+
+  g_free (item);
+}
+
+static GstInferenceBatch *
+test_batch_new (TestBatchData * data, guint64 timeout)
+{
+  g_mutex_init (&data->mutex);
+  g_cond_init (&data->cond);
+  data->blocked = FALSE;
+  data->n_items = 0;
+  data->n_batches = 0;
+  data->n_dropped = 0;
+
+  return gst_inference_batch_new ("test-batch", TEST_BATCH_SIZE, timeout,
+      test_batch_func, test_batch_drop, data);
+}
+
+static void
+test_batch_free (GstInferenceBatch * batch, TestBatchData * data)
+{
+  gst_inference_batch_free (batch);
+  g_mutex_clear (&data->mutex);
+  g_cond_clear (&data->cond);
+}
+
+static gpointer
+test_item_new (gint id)
+{
+  gint *item = g_new (gint, 1);
+
+  *item = id;
+
+  return item;
+}
+
+static void
+test_batch_unblock (TestBatchData * data)
+{
+  g_mutex_lock (&data->mutex);
+  data->blocked = FALSE;
+  g_cond_broadcast (&data->cond);
+  g_mutex_unlock (&data->mutex);
+}
+
+GST_START_TEST (test_gst_inference_batch_full)
+{
+  TestBatchData data;
+  GstInferenceBatch *batch;
+  gint i;
+
+  batch = test_batch_new (&data, TEST_NO_TIMEOUT);
+
+  /* Without a timeout only full batches are processed */
+  for (i = 0; i < TEST_ITEMS; ++i) {
+    fail_unless (gst_inference_batch_push (batch, test_item_new (i), FALSE));
+  }
+  gst_inference_batch_drain (batch);
+
+  fail_unless_equals_int (data.n_batches, TEST_ITEMS / TEST_BATCH_SIZE);
+  for (i = 0; i < data.n_batches; ++i) {
+    fail_unless_equals_int (data.sizes[i], TEST_BATCH_SIZE);
+  }
+  fail_unless_equals_int (data.n_items, TEST_ITEMS);
+  for (i = 0; i < TEST_ITEMS; ++i) {
+    fail_unless_equals_int (data.items[i], i);
+  }
+
+  test_batch_free (batch, &data);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_batch_barrier)
+{
+  TestBatchData data;
+  GstInferenceBatch *batch;
+
+  batch = test_batch_new (&data, TEST_NO_TIMEOUT);
+
+  /* The barrier closes the partial batch and is processed alone */
+  fail_unless (gst_inference_batch_push (batch, test_item_new (0), FALSE));
+  fail_unless (gst_inference_batch_push (batch, test_item_new (1), FALSE));
+  fail_unless (gst_inference_batch_push (batch, test_item_new (2), TRUE));
+  fail_unless (gst_inference_batch_push (batch, test_item_new (3), FALSE));
+  gst_inference_batch_drain (batch);
+
+  fail_unless_equals_int (data.n_batches, 3);
+  fail_unless_equals_int (data.sizes[0], 2);
+  fail_unless_equals_int (data.sizes[1], 1);
+  fail_unless_equals_int (data.sizes[2], 1);
+  fail_unless_equals_int (data.items[2], 2);
+  fail_unless_equals_int (data.items[3], 3);
+
+  test_batch_free (batch, &data);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_batch_timeout)
+{
+  TestBatchData data;
+  GstInferenceBatch *batch;
+
+  batch = test_batch_new (&data, TEST_TIMEOUT);
+
+  /* A partial batch is processed once its first item timed out */
+  fail_unless (gst_inference_batch_push (batch, test_item_new (0), FALSE));
+  g_mutex_lock (&data.mutex);
+  while (0 == data.n_batches) {
+    g_cond_wait (&data.cond, &data.mutex);
+  }
+  g_mutex_unlock (&data.mutex);
+
+  fail_unless_equals_int (data.sizes[0], 1);
+
+  test_batch_free (batch, &data);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_batch_dynamic)
+{
+  TestBatchData data;
+  GstInferenceBatch *batch;
+  gint i;
+
+  batch = test_batch_new (&data, 0);
+  data.blocked = TRUE;
+
+  /* Without timeout the batches grow while the thread is busy */
+  for (i = 0; i < TEST_BATCH_SIZE + 1; ++i) {
+    fail_unless (gst_inference_batch_push (batch, test_item_new (i), FALSE));
+  }
+  test_batch_unblock (&data);
+  gst_inference_batch_drain (batch);
+
+  fail_unless_equals_int (data.n_items, TEST_BATCH_SIZE + 1);
+  fail_unless (data.n_batches < TEST_BATCH_SIZE + 1);
+  for (i = 0; i < data.n_items; ++i) {
+    fail_unless_equals_int (data.items[i], i);
+  }
+
+  test_batch_free (batch, &data);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_batch_flush)
+{
+  TestBatchData data;
+  GstInferenceBatch *batch;
+  gpointer item;
+  gint i;
+
+  batch = test_batch_new (&data, 0);
+  data.blocked = TRUE;
+
+  for (i = 0; i < TEST_BATCH_SIZE; ++i) {
+    fail_unless (gst_inference_batch_push (batch, test_item_new (i), FALSE));
+  }
+
+  gst_inference_batch_set_flushing (batch, TRUE);
+  item = test_item_new (TEST_BATCH_SIZE);
+  fail_if (gst_inference_batch_push (batch, item, FALSE));
+  g_free (item);
+
+  /* Stopping the flush waits for the batch being processed */
+  test_batch_unblock (&data);
+  gst_inference_batch_set_flushing (batch, FALSE);
+  fail_unless_equals_int (data.n_items + data.n_dropped, TEST_BATCH_SIZE);
+
+  fail_unless (gst_inference_batch_push (batch,
+          test_item_new (TEST_BATCH_SIZE), FALSE));
+  gst_inference_batch_drain (batch);
+  fail_unless_equals_int (data.n_items + data.n_dropped,
+      TEST_BATCH_SIZE + 1);
+
+  test_batch_free (batch, &data);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_batch_owner)
+{
+  TestBatchData data;
+  GstInferenceBatch *batch;
+  gint owners[2];
+  gint i;
+
+  batch = test_batch_new (&data, TEST_NO_TIMEOUT);
+
+  /* Flushing an owner keeps the items of the others */
+  for (i = 0; i < TEST_BATCH_SIZE - 1; ++i) {
+    fail_unless (gst_inference_batch_push_owned (batch, test_item_new (i),
+            &owners[i % 2], FALSE));
+  }
+  gst_inference_batch_flush_owner (batch, &owners[0]);
+  fail_unless_equals_int (data.n_dropped, 2);
+
+  gst_inference_batch_drain_owner (batch, &owners[1]);
+  fail_unless_equals_int (data.n_batches, 1);
+  fail_unless_equals_int (data.n_items, 1);
+  fail_unless_equals_int (data.items[0], 1);
+
+  test_batch_free (batch, &data);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_inference_batch_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_inference_batch");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_inference_batch_full);
+  tcase_add_test (tc, test_gst_inference_batch_barrier);
+  tcase_add_test (tc, test_gst_inference_batch_timeout);
+  tcase_add_test (tc, test_gst_inference_batch_dynamic);
+  tcase_add_test (tc, test_gst_inference_batch_flush);
+  tcase_add_test (tc, test_gst_inference_batch_owner);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_inference_batch);
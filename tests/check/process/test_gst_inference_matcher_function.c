@@ -0,0 +1,162 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+
+#include <gst/check/gstcheck.h>
+#include "gst/r2inference/gstinferencematcher.h"
+
+#define TEST_WINDOW (10 * GST_MSECOND)
+#define TEST_FRAME_PERIOD (GST_SECOND / 30)
+
+static gint freed = 0;
+
+static void
+count_freed (gpointer item)
+{
+  freed++;
+}
+
+GST_START_TEST (test_gst_inference_matcher_nearest)
+{
+  GstInferenceMatcher *matcher = gst_inference_matcher_new (TEST_WINDOW);
+  gint i;
+
+  for (i = 0; i < 3; ++i) {
+    gst_inference_matcher_add (matcher, i * TEST_FRAME_PERIOD,
+        GINT_TO_POINTER (i + 1));
+  }
+
+  /* Halfway between two frames nothing is within the window */
+  fail_unless (NULL == gst_inference_matcher_take (matcher,
+          TEST_FRAME_PERIOD / 2));
+  fail_unless_equals_int (GPOINTER_TO_INT (gst_inference_matcher_take
+          (matcher, TEST_FRAME_PERIOD + TEST_WINDOW / 2)), 2);
+  fail_unless_equals_int (GPOINTER_TO_INT (gst_inference_matcher_take
+          (matcher, 2 * TEST_FRAME_PERIOD - TEST_WINDOW)), 3);
+  fail_unless_equals_int (GPOINTER_TO_INT (gst_inference_matcher_take
+          (matcher, 0)), 1);
+  fail_unless_equals_int (gst_inference_matcher_get_length (matcher), 0);
+
+  gst_inference_matcher_free (matcher, NULL);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_matcher_reordered)
+{
+  GstInferenceMatcher *matcher = gst_inference_matcher_new (TEST_WINDOW);
+  gint i;
+
+  /* The second frame was dropped and the rest arrive reversed */
+  gst_inference_matcher_add (matcher, 3 * TEST_FRAME_PERIOD,
+      GINT_TO_POINTER (4));
+  gst_inference_matcher_add (matcher, 2 * TEST_FRAME_PERIOD,
+      GINT_TO_POINTER (3));
+  gst_inference_matcher_add (matcher, 0, GINT_TO_POINTER (1));
+  fail_unless_equals_uint64 (gst_inference_matcher_get_latest (matcher),
+      3 * TEST_FRAME_PERIOD);
+
+  for (i = 0; i < 4; ++i) {
+    gpointer item =
+        gst_inference_matcher_take (matcher, i * TEST_FRAME_PERIOD + 1);
+
+    fail_unless_equals_int (GPOINTER_TO_INT (item), 1 == i ? 0 : i + 1);
+  }
+
+  gst_inference_matcher_free (matcher, NULL);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_matcher_same_slot)
+{
+  GstInferenceMatcher *matcher = gst_inference_matcher_new (TEST_WINDOW);
+
+  /* Both land in the same slot, the nearest one is taken */
+  gst_inference_matcher_add (matcher, TEST_WINDOW + 1, GINT_TO_POINTER (1));
+  gst_inference_matcher_add (matcher, TEST_WINDOW + 5, GINT_TO_POINTER (2));
+
+  fail_unless_equals_int (GPOINTER_TO_INT (gst_inference_matcher_take
+          (matcher, TEST_WINDOW + 4)), 2);
+  fail_unless_equals_int (GPOINTER_TO_INT (gst_inference_matcher_take
+          (matcher, TEST_WINDOW + 4)), 1);
+  fail_unless (NULL == gst_inference_matcher_take (matcher, TEST_WINDOW));
+
+  gst_inference_matcher_free (matcher, NULL);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_matcher_expired)
+{
+  GstInferenceMatcher *matcher = gst_inference_matcher_new (TEST_WINDOW);
+
+  gst_inference_matcher_add (matcher, 0, GINT_TO_POINTER (1));
+  gst_inference_matcher_add (matcher, TEST_FRAME_PERIOD, GINT_TO_POINTER (2));
+
+  fail_unless_equals_int (GPOINTER_TO_INT (gst_inference_matcher_pop_expired
+          (matcher, TEST_FRAME_PERIOD)), 1);
+  fail_unless (NULL == gst_inference_matcher_pop_expired (matcher,
+          TEST_FRAME_PERIOD));
+  fail_unless_equals_int (GPOINTER_TO_INT (gst_inference_matcher_pop
+          (matcher)), 2);
+  fail_unless (NULL == gst_inference_matcher_pop (matcher));
+
+  gst_inference_matcher_free (matcher, NULL);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_matcher_free)
+{
+  GstInferenceMatcher *matcher = gst_inference_matcher_new (TEST_WINDOW);
+  gint i;
+
+  for (i = 0; i < 5; ++i) {
+    gst_inference_matcher_add (matcher, i * TEST_FRAME_PERIOD,
+        GINT_TO_POINTER (i + 1));
+  }
+
+  freed = 0;
+  gst_inference_matcher_free (matcher, count_freed);
+  fail_unless_equals_int (freed, 5);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_inference_matcher_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_inference_matcher");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_inference_matcher_nearest);
+  tcase_add_test (tc, test_gst_inference_matcher_reordered);
+  tcase_add_test (tc, test_gst_inference_matcher_same_slot);
+  tcase_add_test (tc, test_gst_inference_matcher_expired);
+  tcase_add_test (tc, test_gst_inference_matcher_free);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_inference_matcher);
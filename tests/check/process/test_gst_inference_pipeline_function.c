@@ -0,0 +1,420 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include "gst/r2inference/gstinferencepipeline.h"
+#include "gst/r2inference/gstinferencering.h"
+
+#define TEST_RING_SIZE 4
+#define TEST_DEPTH 2
+#define TEST_JOBS 1000
+#define TEST_THREADS 4
+
+typedef struct _TestJob TestJob;
+struct _TestJob
+{
+  gint id;
+  gint stage;
+};
+
+typedef struct _TestPipelineData TestPipelineData;
+struct _TestPipelineData
+{
+  GMutex mutex;
+  GCond cond;
+  gboolean blocked;
+  gint finished[TEST_JOBS];
+  gint n_finished;
+  gint n_dropped;
+};
+
+static void
+test_stage_first (gpointer job, gpointer user_data)
+{
+  TestPipelineData *data = (TestPipelineData *) user_data;
+
+  g_mutex_lock (&data->mutex);
+  while (data->blocked) {
+    g_cond_wait (&data->cond, &data->mutex);
+  }
+  g_mutex_unlock (&data->mutex);
+
+  fail_unless_equals_int (((TestJob *) job)->stage, 0);
+  ((TestJob *) job)->stage = 1;
+}
+
+static void
+test_stage_second (gpointer job, gpointer user_data)
+{
+  fail_unless_equals_int (((TestJob *) job)->stage, 1);
+  ((TestJob *) job)->stage = 2;
+}
+
+static void
+test_stage_second_slow (gpointer job, gpointer user_data)
+{
+  /* Consecutive jobs finish out of order among the threads */
+  g_usleep (g_random_int_range (0, 100));
+  test_stage_second (job, user_data);
+}
+
+static void
+test_stage_last (gpointer job, gpointer user_data)
+{
+  TestPipelineData *data = (TestPipelineData *) user_data;
+
+  fail_unless_equals_int (((TestJob *) job)->stage, 2);
+
+  g_mutex_lock (&data->mutex);
+  data->finished[data->n_finished++] = ((TestJob *) job)->id;
+  g_mutex_unlock (&data->mutex);
+
+  g_free (job);
+}
+
+static void
+test_stage_drop (gpointer job, gpointer user_data)
+{
+  TestPipelineData *data = (TestPipelineData *) user_data;
+
+  g_mutex_lock (&data->mutex);
+  data->n_dropped++;
+  g_mutex_unlock (&data->mutex);
+
+  g_free (job);
+}
+
+static const GstInferencePipelineStage test_stages[] = {
+  {"first", test_stage_first},
+  {"second", test_stage_second},
+  {"last", test_stage_last},
+};
+
+static const GstInferencePipelineStage test_threaded_stages[] = {
+  {"first", test_stage_first},
+  {"second", test_stage_second_slow, TEST_THREADS},
+  {"last", test_stage_last},
+};
+
+static GstInferencePipeline *
+test_pipeline_new_full (TestPipelineData * data,
+    const GstInferencePipelineStage * stages)
+{
+  g_mutex_init (&data->mutex);
+  g_cond_init (&data->cond);
+  data->blocked = FALSE;
+  data->n_finished = 0;
+  data->n_dropped = 0;
+
+  return gst_inference_pipeline_new (stages, G_N_ELEMENTS (test_stages),
+      TEST_DEPTH, test_stage_drop, data);
+}
+
+static GstInferencePipeline *
+test_pipeline_new (TestPipelineData * data)
+{
+  return test_pipeline_new_full (data, test_stages);
+}
+
+static void
+test_pipeline_free (GstInferencePipeline * pipeline, TestPipelineData * data)
+{
+  gst_inference_pipeline_free (pipeline);
+  g_mutex_clear (&data->mutex);
+  g_cond_clear (&data->cond);
+}
+
+static TestJob *
+test_job_new (gint id)
+{
+  TestJob *job = g_new0 (TestJob, 1);
+
+  job->id = id;
+
+  return job;
+}
+
+GST_START_TEST (test_gst_inference_ring_bounds)
+{
+  GstInferenceRing *ring;
+  gint items[TEST_RING_SIZE + 1];
+  gint i;
+
+  ring = gst_inference_ring_new (TEST_RING_SIZE);
+
+  fail_unless (NULL == gst_inference_ring_try_pop (ring));
+  for (i = 0; i < TEST_RING_SIZE; ++i) {
+    fail_unless (gst_inference_ring_try_push (ring, &items[i]));
+  }
+  fail_if (gst_inference_ring_try_push (ring, &items[TEST_RING_SIZE]));
+  fail_unless_equals_int (gst_inference_ring_get_length (ring),
+      TEST_RING_SIZE);
+
+  /* Items come out in order and free their slot */
+  fail_unless (gst_inference_ring_try_pop (ring) == &items[0]);
+  fail_unless (gst_inference_ring_try_push (ring, &items[TEST_RING_SIZE]));
+  for (i = 1; i <= TEST_RING_SIZE; ++i) {
+    fail_unless (gst_inference_ring_pop (ring) == &items[i]);
+  }
+
+  /* Blocking calls fail once closed and empty */
+  gst_inference_ring_close (ring);
+  fail_unless (NULL == gst_inference_ring_pop (ring));
+  fail_if (gst_inference_ring_push (ring, &items[0]));
+
+  /* And block again once reopened */
+  gst_inference_ring_open (ring);
+  fail_unless (gst_inference_ring_push (ring, &items[0]));
+  fail_unless (gst_inference_ring_pop (ring) == &items[0]);
+
+  gst_inference_ring_free (ring);
+}
+
+GST_END_TEST;
+
+static gpointer
+test_ring_consumer (gpointer user_data)
+{
+  GstInferenceRing *ring = (GstInferenceRing *) user_data;
+  gint *item;
+  gint last = -1;
+  gint popped = 0;
+
+  while (NULL != (item = gst_inference_ring_pop (ring))) {
+    fail_unless (*item > last);
+    last = *item;
+    popped++;
+  }
+
+  return GINT_TO_POINTER (popped);
+}
+
+GST_START_TEST (test_gst_inference_ring_drop_oldest)
+{
+  GstInferenceRing *ring;
+  GThread *consumer;
+  gint items[TEST_JOBS];
+  gint i, dropped = 0, last = -1;
+  gint *item;
+
+  ring = gst_inference_ring_new (TEST_RING_SIZE);
+  consumer = g_thread_new ("consumer", test_ring_consumer, ring);
+
+  /* The producer makes room by dropping the oldest item, racing with
+   * the consumer */
+  for (i = 0; i < TEST_JOBS; ++i) {
+    items[i] = i;
+    while (!gst_inference_ring_try_push (ring, &items[i])) {
+      item = gst_inference_ring_try_pop (ring);
+      if (item) {
+        fail_unless (*item > last);
+        last = *item;
+        dropped++;
+      }
+    }
+  }
+  gst_inference_ring_close (ring);
+
+  /* Every item is either consumed or dropped, exactly once */
+  fail_unless_equals_int (GPOINTER_TO_INT (g_thread_join (consumer)) +
+      dropped, TEST_JOBS);
+
+  gst_inference_ring_free (ring);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_pipeline_order)
+{
+  TestPipelineData data;
+  GstInferencePipeline *pipeline;
+  guint64 jobs, total, max;
+  gint i;
+
+  pipeline = test_pipeline_new (&data);
+
+  for (i = 0; i < TEST_JOBS; ++i) {
+    fail_unless (gst_inference_pipeline_push (pipeline, test_job_new (i),
+            TRUE));
+  }
+  gst_inference_pipeline_drain (pipeline);
+
+  /* Every job went through every stage, in order */
+  fail_unless_equals_int (data.n_finished, TEST_JOBS);
+  for (i = 0; i < TEST_JOBS; ++i) {
+    fail_unless_equals_int (data.finished[i], i);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (test_stages); ++i) {
+    gst_inference_pipeline_get_stage_stats (pipeline, i, &jobs, &total, &max);
+    fail_unless_equals_uint64 (jobs, TEST_JOBS);
+    fail_unless (max <= total);
+  }
+
+  test_pipeline_free (pipeline, &data);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_pipeline_full)
+{
+  TestPipelineData data;
+  GstInferencePipeline *pipeline;
+  TestJob *job;
+  gint i, pushed = 0;
+
+  pipeline = test_pipeline_new (&data);
+  data.blocked = TRUE;
+
+  /* With the first stage stuck, the jobs in flight are bounded */
+  for (i = 0; i < TEST_JOBS; ++i) {
+    job = test_job_new (i);
+    if (gst_inference_pipeline_push (pipeline, job, FALSE)) {
+      pushed++;
+    } else {
+      g_free (job);
+    }
+  }
+  fail_unless (pushed <= TEST_DEPTH + 1);
+
+  g_mutex_lock (&data.mutex);
+  data.blocked = FALSE;
+  g_cond_broadcast (&data.cond);
+  g_mutex_unlock (&data.mutex);
+
+  gst_inference_pipeline_drain (pipeline);
+  fail_unless_equals_int (data.n_finished, pushed);
+
+  test_pipeline_free (pipeline, &data);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_pipeline_flush)
+{
+  TestPipelineData data;
+  GstInferencePipeline *pipeline;
+  TestJob *job;
+  gint i;
+
+  pipeline = test_pipeline_new (&data);
+  data.blocked = TRUE;
+
+  for (i = 0; i < TEST_DEPTH; ++i) {
+    fail_unless (gst_inference_pipeline_push (pipeline, test_job_new (i),
+            TRUE));
+  }
+
+  gst_inference_pipeline_set_flushing (pipeline, TRUE);
+  job = test_job_new (TEST_DEPTH);
+  fail_if (gst_inference_pipeline_push (pipeline, job, TRUE));
+  g_free (job);
+
+  g_mutex_lock (&data.mutex);
+  data.blocked = FALSE;
+  g_cond_broadcast (&data.cond);
+  g_mutex_unlock (&data.mutex);
+
+  /* Stopping the flush waits for the flushed jobs to be released */
+  gst_inference_pipeline_set_flushing (pipeline, FALSE);
+  fail_unless_equals_int (data.n_finished + data.n_dropped, TEST_DEPTH);
+
+  fail_unless (gst_inference_pipeline_push (pipeline,
+          test_job_new (TEST_DEPTH), TRUE));
+  gst_inference_pipeline_drain (pipeline);
+  fail_unless_equals_int (data.n_finished + data.n_dropped, TEST_DEPTH + 1);
+
+  test_pipeline_free (pipeline, &data);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_pipeline_threads)
+{
+  TestPipelineData data;
+  GstInferencePipeline *pipeline;
+  guint64 jobs;
+  gint i;
+
+  pipeline = test_pipeline_new_full (&data, test_threaded_stages);
+
+  for (i = 0; i < TEST_JOBS; ++i) {
+    fail_unless (gst_inference_pipeline_push (pipeline, test_job_new (i),
+            TRUE));
+  }
+  gst_inference_pipeline_drain (pipeline);
+
+  /* The threads of the second stage hand the jobs over in order */
+  fail_unless_equals_int (data.n_finished, TEST_JOBS);
+  for (i = 0; i < TEST_JOBS; ++i) {
+    fail_unless_equals_int (data.finished[i], i);
+  }
+  gst_inference_pipeline_get_stage_stats (pipeline, 1, &jobs, NULL, NULL);
+  fail_unless_equals_uint64 (jobs, TEST_JOBS);
+
+  /* Jobs dropped by a flush do not break the order of the next ones */
+  data.blocked = TRUE;
+  for (i = 0; i < TEST_DEPTH; ++i) {
+    fail_unless (gst_inference_pipeline_push (pipeline, test_job_new (i),
+            TRUE));
+  }
+  gst_inference_pipeline_set_flushing (pipeline, TRUE);
+  g_mutex_lock (&data.mutex);
+  data.blocked = FALSE;
+  g_cond_broadcast (&data.cond);
+  g_mutex_unlock (&data.mutex);
+  gst_inference_pipeline_set_flushing (pipeline, FALSE);
+
+  data.n_finished = 0;
+  for (i = 0; i < TEST_JOBS; ++i) {
+    fail_unless (gst_inference_pipeline_push (pipeline, test_job_new (i),
+            TRUE));
+  }
+  gst_inference_pipeline_drain (pipeline);
+  fail_unless_equals_int (data.n_finished, TEST_JOBS);
+  for (i = 0; i < TEST_JOBS; ++i) {
+    fail_unless_equals_int (data.finished[i], i);
+  }
+
+  test_pipeline_free (pipeline, &data);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_inference_pipeline_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_inference_pipeline");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_inference_ring_bounds);
+  tcase_add_test (tc, test_gst_inference_ring_drop_oldest);
+  tcase_add_test (tc, test_gst_inference_pipeline_order);
+  tcase_add_test (tc, test_gst_inference_pipeline_full);
+  tcase_add_test (tc, test_gst_inference_pipeline_flush);
+  tcase_add_test (tc, test_gst_inference_pipeline_threads);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_inference_pipeline);
@@ -0,0 +1,167 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+
+#include <gst/check/gstcheck.h>
+#include "gst/r2inference/gstinferencerate.h"
+
+#define TEST_FRAMES 12
+#define TEST_FRAME_PERIOD (GST_SECOND / 50)
+
+static guint
+count_inferred (GstInferenceRate * rate, guint frames, GstClockTime period)
+{
+  guint inferred = 0;
+  guint i;
+
+  for (i = 0; i < frames; ++i) {
+    if (gst_inference_rate_check (rate, i * period)) {
+      inferred++;
+    }
+  }
+
+  return inferred;
+}
+
+GST_START_TEST (test_gst_inference_rate_default)
+{
+  GstInferenceRate *rate = gst_inference_rate_new ();
+
+  fail_unless_equals_int (count_inferred (rate, TEST_FRAMES,
+          TEST_FRAME_PERIOD), TEST_FRAMES);
+  fail_unless_equals_int (gst_inference_rate_get_skipped (rate), 0);
+
+  gst_inference_rate_free (rate);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_rate_interval)
+{
+  GstInferenceRate *rate = gst_inference_rate_new ();
+  guint i;
+
+  gst_inference_rate_configure (rate, 3, 0, 1, FALSE);
+
+  /* The first frame is always inferred */
+  for (i = 0; i < TEST_FRAMES; ++i) {
+    fail_unless_equals_int (gst_inference_rate_check (rate,
+            i * TEST_FRAME_PERIOD), 0 == i % 3);
+  }
+  fail_unless_equals_int (gst_inference_rate_get_skipped (rate),
+      TEST_FRAMES - TEST_FRAMES / 3);
+
+  gst_inference_rate_free (rate);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_rate_max_rate)
+{
+  GstInferenceRate *rate = gst_inference_rate_new ();
+  guint i;
+
+  /* 50 fps limited to 10 inferences per second */
+  gst_inference_rate_configure (rate, 1, 10, 1, FALSE);
+  fail_unless_equals_int (count_inferred (rate, TEST_FRAMES,
+          TEST_FRAME_PERIOD), 3);
+
+  /* Buffers without timestamps are not limited */
+  gst_inference_rate_reset (rate);
+  for (i = 0; i < TEST_FRAMES; ++i) {
+    fail_unless (gst_inference_rate_check (rate, GST_CLOCK_TIME_NONE));
+  }
+
+  gst_inference_rate_free (rate);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_rate_adaptive)
+{
+  GstInferenceRate *rate = gst_inference_rate_new ();
+
+  gst_inference_rate_configure (rate, 1, 0, 1, TRUE);
+  fail_unless_equals_int (count_inferred (rate, TEST_FRAMES,
+          TEST_FRAME_PERIOD), TEST_FRAMES);
+
+  /* A prediction slower than three frames */
+  gst_inference_rate_reset (rate);
+  gst_inference_rate_add_latency (rate, 3 * TEST_FRAME_PERIOD - 1);
+  fail_unless_equals_int (gst_inference_rate_get_latency (rate),
+      3 * TEST_FRAME_PERIOD - 1);
+  fail_unless_equals_int (count_inferred (rate, TEST_FRAMES,
+          TEST_FRAME_PERIOD), TEST_FRAMES / 3);
+
+  /* The average moves towards the new latencies */
+  gst_inference_rate_add_latency (rate, 3 * TEST_FRAME_PERIOD + 7);
+  fail_unless (gst_inference_rate_get_latency (rate) > 3 * TEST_FRAME_PERIOD
+      - 1);
+  fail_unless (gst_inference_rate_get_latency (rate) < 3 * TEST_FRAME_PERIOD
+      + 7);
+
+  gst_inference_rate_free (rate);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_rate_reset)
+{
+  GstInferenceRate *rate = gst_inference_rate_new ();
+
+  gst_inference_rate_configure (rate, 2, 0, 1, TRUE);
+  gst_inference_rate_add_latency (rate, GST_SECOND);
+  count_inferred (rate, TEST_FRAMES, TEST_FRAME_PERIOD);
+  fail_unless (gst_inference_rate_get_skipped (rate) > 0);
+
+  gst_inference_rate_reset (rate);
+  fail_unless_equals_int (gst_inference_rate_get_skipped (rate), 0);
+  fail_unless_equals_int (gst_inference_rate_get_latency (rate), 0);
+
+  /* A seek back in time does not hold the inference */
+  fail_unless (gst_inference_rate_check (rate, GST_SECOND));
+  gst_inference_rate_add_latency (rate, GST_SECOND);
+  gst_inference_rate_check (rate, GST_SECOND);
+  fail_unless (gst_inference_rate_check (rate, 0));
+
+  gst_inference_rate_free (rate);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_inference_rate_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_inference_rate");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_inference_rate_default);
+  tcase_add_test (tc, test_gst_inference_rate_interval);
+  tcase_add_test (tc, test_gst_inference_rate_max_rate);
+  tcase_add_test (tc, test_gst_inference_rate_adaptive);
+  tcase_add_test (tc, test_gst_inference_rate_reset);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_inference_rate);
@@ -0,0 +1,203 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+
+#include <gst/check/gstcheck.h>
+#include "gst/r2inference/gstinferenceworker.h"
+
+#define TEST_QUEUE_SIZE 2
+#define TEST_BUFFERS 10
+
+typedef struct _TestWorkerData TestWorkerData;
+struct _TestWorkerData
+{
+  GMutex mutex;
+  GCond cond;
+  gboolean blocked;
+  gboolean started;
+  GQueue processed;
+  GstFlowReturn ret;
+};
+
+static GstFlowReturn
+test_worker_func (GstMiniObject * item, gpointer user_data)
+{
+  TestWorkerData *data = (TestWorkerData *) user_data;
+
+  g_mutex_lock (&data->mutex);
+  data->started = TRUE;
+  g_cond_broadcast (&data->cond);
+  while (data->blocked) {
+    g_cond_wait (&data->cond, &data->mutex);
+  }
+  g_queue_push_tail (&data->processed, item);
+  g_mutex_unlock (&data->mutex);
+
+  return data->ret;
+}
+
+static void
+test_worker_data_init (TestWorkerData * data)
+{
+  g_mutex_init (&data->mutex);
+  g_cond_init (&data->cond);
+  g_queue_init (&data->processed);
+  data->blocked = FALSE;
+  data->started = FALSE;
+  data->ret = GST_FLOW_OK;
+}
+
+static void
+test_worker_data_clear (TestWorkerData * data)
+{
+  GstMiniObject *item;
+
+  while ((item = (GstMiniObject *) g_queue_pop_head (&data->processed))) {
+    gst_mini_object_unref (item);
+  }
+  g_mutex_clear (&data->mutex);
+  g_cond_clear (&data->cond);
+}
+
+GST_START_TEST (test_gst_inference_worker_order)
+{
+  TestWorkerData data;
+  GstInferenceWorker *worker;
+  GstMiniObject *items[3];
+  gint i;
+
+  test_worker_data_init (&data);
+  worker = gst_inference_worker_new ("test", TEST_QUEUE_SIZE,
+      test_worker_func, &data);
+
+  items[0] = GST_MINI_OBJECT_CAST (gst_buffer_new ());
+  items[1] = GST_MINI_OBJECT_CAST (gst_event_new_eos ());
+  items[2] = GST_MINI_OBJECT_CAST (gst_buffer_new ());
+  for (i = 0; i < G_N_ELEMENTS (items); ++i) {
+    fail_unless_equals_int (gst_inference_worker_push (worker, items[i]),
+        GST_FLOW_OK);
+  }
+  gst_inference_worker_drain (worker);
+
+  /* Events are processed between the buffers they were queued with */
+  fail_unless_equals_int (g_queue_get_length (&data.processed),
+      G_N_ELEMENTS (items));
+  for (i = 0; i < G_N_ELEMENTS (items); ++i) {
+    fail_unless (g_queue_peek_nth (&data.processed, i) == items[i]);
+  }
+
+  gst_inference_worker_free (worker);
+  test_worker_data_clear (&data);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_worker_drop)
+{
+  TestWorkerData data;
+  GstInferenceWorker *worker;
+  gint i;
+
+  test_worker_data_init (&data);
+  data.blocked = TRUE;
+  worker = gst_inference_worker_new ("test", TEST_QUEUE_SIZE,
+      test_worker_func, &data);
+
+  /* Wait for the worker to hold the first buffer */
+  gst_inference_worker_push (worker, GST_MINI_OBJECT_CAST (gst_buffer_new ()));
+  g_mutex_lock (&data.mutex);
+  while (!data.started) {
+    g_cond_wait (&data.cond, &data.mutex);
+  }
+  g_mutex_unlock (&data.mutex);
+
+  /* Pushing never blocks, buffers beyond the queue size are dropped */
+  for (i = 1; i < TEST_BUFFERS; ++i) {
+    fail_unless_equals_int (gst_inference_worker_push (worker,
+            GST_MINI_OBJECT_CAST (gst_buffer_new ())), GST_FLOW_OK);
+  }
+  fail_unless_equals_uint64 (gst_inference_worker_get_dropped (worker),
+      TEST_BUFFERS - 1 - TEST_QUEUE_SIZE);
+
+  g_mutex_lock (&data.mutex);
+  data.blocked = FALSE;
+  g_cond_broadcast (&data.cond);
+  g_mutex_unlock (&data.mutex);
+
+  gst_inference_worker_drain (worker);
+  fail_unless_equals_int (g_queue_get_length (&data.processed),
+      TEST_QUEUE_SIZE + 1);
+
+  gst_inference_worker_free (worker);
+  test_worker_data_clear (&data);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_worker_flow)
+{
+  TestWorkerData data;
+  GstInferenceWorker *worker;
+
+  test_worker_data_init (&data);
+  data.ret = GST_FLOW_NOT_LINKED;
+  worker = gst_inference_worker_new ("test", TEST_QUEUE_SIZE,
+      test_worker_func, &data);
+
+  /* Errors are reported on the following push */
+  fail_unless_equals_int (gst_inference_worker_push (worker,
+          GST_MINI_OBJECT_CAST (gst_buffer_new ())), GST_FLOW_OK);
+  gst_inference_worker_drain (worker);
+  fail_unless_equals_int (gst_inference_worker_push (worker,
+          GST_MINI_OBJECT_CAST (gst_buffer_new ())), GST_FLOW_NOT_LINKED);
+
+  gst_inference_worker_set_flushing (worker, TRUE);
+  fail_unless_equals_int (gst_inference_worker_push (worker,
+          GST_MINI_OBJECT_CAST (gst_buffer_new ())), GST_FLOW_FLUSHING);
+
+  /* Stopping the flush clears the error */
+  data.ret = GST_FLOW_OK;
+  gst_inference_worker_set_flushing (worker, FALSE);
+  fail_unless_equals_int (gst_inference_worker_push (worker,
+          GST_MINI_OBJECT_CAST (gst_buffer_new ())), GST_FLOW_OK);
+
+  gst_inference_worker_free (worker);
+  test_worker_data_clear (&data);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_inference_worker_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_inference_worker");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_inference_worker_order);
+  tcase_add_test (tc, test_gst_inference_worker_drop);
+  tcase_add_test (tc, test_gst_inference_worker_flow);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_inference_worker);
@@ -1222,14 +1222,67 @@ GST_START_TEST (test_gst_normalize_zero_mean_null_outframe)
 
 GST_END_TEST;
 
-static Suite *
-gst_normalize_suite (void)
+static void
+gst_check_normalize_yuv (GstVideoFormat format)
 {
-  Suite *suite = suite_create ("GstInference");
-  TCase *tc = tcase_create ("gst_normalize");
+  GstVideoInfo info;
+  GstVideoFrame inframe;
+  GstVideoFrame outframe;
+  GstBuffer *inbuf, *outbuf;
+  gint width, height, model_channels, i;
+  gdouble mean, std;
+  gfloat *out;
 
-  suite_add_tcase (suite, tc);
+  width = 6;
+  height = 4;
+  model_channels = 3;
+
+  mean = 0;
+  std = 1 / 255.0;
+
+  /* Limited range white */
+  gst_video_info_set_format (&info, format, width, height);
+  inbuf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  outbuf = gst_buffer_new_allocate (NULL,
+      width * height * model_channels * sizeof (float), NULL);
+  gst_buffer_memset (inbuf, 0, 128, GST_VIDEO_INFO_SIZE (&info));
+  gst_buffer_memset (inbuf, GST_VIDEO_INFO_PLANE_OFFSET (&info, 0), 235,
+      GST_VIDEO_INFO_PLANE_STRIDE (&info, 0) * height);
+
+  fail_unless (gst_video_frame_map (&inframe, &info, inbuf, GST_MAP_READ));
+  fail_unless (gst_video_frame_map (&outframe, &info, outbuf, GST_MAP_WRITE));
+
+  fail_unless (gst_normalize (&inframe, &outframe, mean, std,
+          model_channels));
+
+  out = (gfloat *) outframe.data[0];
+  for (i = 0; i < width * height * model_channels; ++i) {
+    fail_if (ABS (out[i] - 1.0) > 0.001);
+  }
+
+  gst_video_frame_unmap (&inframe);
+  gst_video_frame_unmap (&outframe);
+  gst_buffer_unref (inbuf);
+  gst_buffer_unref (outbuf);
+}
+
+GST_START_TEST (test_gst_normalize_I420)
+{
+  gst_check_normalize_yuv (GST_VIDEO_FORMAT_I420);
+}
+
+GST_END_TEST;
 
+GST_START_TEST (test_gst_normalize_NV12)
+{
+  gst_check_normalize_yuv (GST_VIDEO_FORMAT_NV12);
+}
+
+GST_END_TEST;
+
+static void
+gst_normalize_add_tests (TCase * tc)
+{
   tcase_add_test (tc, test_gst_normalize_RGBA);
   tcase_add_test (tc, test_gst_normalize_RGB);
   tcase_add_test (tc, test_gst_normalize_RGBx);
@@ -1240,6 +1293,8 @@ gst_normalize_suite (void)
   tcase_add_test (tc, test_gst_normalize_ARGB);
   tcase_add_test (tc, test_gst_normalize_xBGR);
   tcase_add_test (tc, test_gst_normalize_ABGR);
+  tcase_add_test (tc, test_gst_normalize_I420);
+  tcase_add_test (tc, test_gst_normalize_NV12);
   tcase_add_test (tc, test_gst_normalize_invalid_format);
   tcase_add_test (tc, test_gst_normalize_odd_width);
   tcase_add_test (tc, test_gst_normalize_odd_height);
@@ -1260,6 +1315,23 @@ gst_normalize_suite (void)
   tcase_add_test (tc, test_gst_normalize_zero_mean_odd_height);
   tcase_add_test (tc, test_gst_normalize_zero_mean_null_inframe);
   tcase_add_test (tc, test_gst_normalize_zero_mean_null_outframe);
+}
+
+static Suite *
+gst_normalize_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_normalize");
+  TCase *tc_scalar = tcase_create ("gst_normalize_scalar");
+
+  suite_add_tcase (suite, tc);
+  suite_add_tcase (suite, tc_scalar);
+
+  tcase_add_checked_fixture (tc_scalar, gst_preprocess_use_scalar,
+      gst_preprocess_use_default);
+
+  gst_normalize_add_tests (tc);
+  gst_normalize_add_tests (tc_scalar);
 
   return suite;
 }
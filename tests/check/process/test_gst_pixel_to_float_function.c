@@ -563,14 +563,9 @@ GST_START_TEST (test_gst_pixel_to_float_null_outframe)
 
 GST_END_TEST;
 
-static Suite *
-gst_pixel_to_float_suite (void)
+static void
+gst_pixel_to_float_add_tests (TCase * tc)
 {
-  Suite *suite = suite_create ("GstInference");
-  TCase *tc = tcase_create ("gst_pixel_to_float");
-
-  suite_add_tcase (suite, tc);
-
   tcase_add_test (tc, test_gst_pixel_to_float_RGBA);
   tcase_add_test (tc, test_gst_pixel_to_float_RGB);
   tcase_add_test (tc, test_gst_pixel_to_float_RGBx);
@@ -586,6 +581,23 @@ gst_pixel_to_float_suite (void)
   tcase_add_test (tc, test_gst_pixel_to_float_odd_height);
   tcase_add_test (tc, test_gst_pixel_to_float_null_inframe);
   tcase_add_test (tc, test_gst_pixel_to_float_null_outframe);
+}
+
+static Suite *
+gst_pixel_to_float_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_pixel_to_float");
+  TCase *tc_scalar = tcase_create ("gst_pixel_to_float_scalar");
+
+  suite_add_tcase (suite, tc);
+  suite_add_tcase (suite, tc_scalar);
+
+  tcase_add_checked_fixture (tc_scalar, gst_preprocess_use_scalar,
+      gst_preprocess_use_default);
+
+  gst_pixel_to_float_add_tests (tc);
+  gst_pixel_to_float_add_tests (tc_scalar);
 
   return suite;
 }
@@ -0,0 +1,364 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include <string.h>
+#include "gst/r2inference/gstinferencepreprocess.h"
+
+#define TEST_WIDTH 67
+#define TEST_HEIGHT 5
+#define MODEL_CHANNELS 3
+
+typedef enum
+{
+  TEST_NORMALIZE,
+  TEST_SUBTRACT_MEAN,
+  TEST_PIXEL_TO_FLOAT,
+  TEST_GRAY_NORMALIZE,
+} TestFunction;
+
+static const GstVideoFormat rgb_formats[] = {
+  GST_VIDEO_FORMAT_RGB, GST_VIDEO_FORMAT_RGBx, GST_VIDEO_FORMAT_RGBA,
+  GST_VIDEO_FORMAT_BGR, GST_VIDEO_FORMAT_BGRx, GST_VIDEO_FORMAT_BGRA,
+  GST_VIDEO_FORMAT_xRGB, GST_VIDEO_FORMAT_ARGB, GST_VIDEO_FORMAT_xBGR,
+  GST_VIDEO_FORMAT_ABGR
+};
+
+static const GstInferencePreprocessImpl simd_impls[] = {
+  GST_INFERENCE_PREPROCESS_IMPL_SSE4_1,
+  GST_INFERENCE_PREPROCESS_IMPL_AVX2,
+  GST_INFERENCE_PREPROCESS_IMPL_NEON
+};
+
+static void
+run_function (TestFunction function, GstVideoFrame * inframe,
+    GstVideoFrame * outframe)
+{
+  gboolean ret = FALSE;
+
+  switch (function) {
+    case TEST_NORMALIZE:
+      ret = gst_normalize (inframe, outframe, 127.5, 1 / 127.5,
+          MODEL_CHANNELS);
+      break;
+    case TEST_SUBTRACT_MEAN:
+      ret = gst_subtract_mean (inframe, outframe, 123.68, 116.78, 103.94,
+          MODEL_CHANNELS);
+      break;
+    case TEST_PIXEL_TO_FLOAT:
+      ret = gst_pixel_to_float (inframe, outframe, MODEL_CHANNELS);
+      break;
+    case TEST_GRAY_NORMALIZE:
+      ret = gst_normalize_gray_image (inframe, outframe, 127.5, -1, 1);
+      break;
+  }
+
+  fail_unless (ret);
+}
+
+static void
+compare_impls (GstVideoFormat format, TestFunction function)
+{
+  GstVideoInfo info;
+  GstVideoFrame inframe, scalar_frame, simd_frame;
+  GstBuffer *inbuf, *scalar_buf, *simd_buf;
+  GstMapInfo map;
+  gsize buf_size, out_size;
+  guint channels;
+  guint i;
+
+  gst_video_info_set_format (&info, format, TEST_WIDTH, TEST_HEIGHT);
+  buf_size = TEST_WIDTH * TEST_HEIGHT * MODEL_CHANNELS * sizeof (gfloat);
+  /* Only the bytes the function writes are compared */
+  channels = TEST_GRAY_NORMALIZE == function ? 1 : MODEL_CHANNELS;
+  out_size = TEST_WIDTH * TEST_HEIGHT * channels * sizeof (gfloat);
+
+  inbuf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  scalar_buf = gst_buffer_new_allocate (NULL, buf_size, NULL);
+  simd_buf = gst_buffer_new_allocate (NULL, buf_size, NULL);
+
+  fail_unless (gst_buffer_map (inbuf, &map, GST_MAP_WRITE));
+  for (i = 0; i < map.size; ++i) {
+    map.data[i] = g_random_int_range (0, 256);
+  }
+  gst_buffer_unmap (inbuf, &map);
+
+  fail_unless (gst_video_frame_map (&inframe, &info, inbuf, GST_MAP_READ));
+  fail_unless (gst_video_frame_map (&scalar_frame, &info, scalar_buf,
+          GST_MAP_WRITE));
+  fail_unless (gst_video_frame_map (&simd_frame, &info, simd_buf,
+          GST_MAP_WRITE));
+
+  fail_unless (gst_inference_preprocess_set_impl
+      (GST_INFERENCE_PREPROCESS_IMPL_SCALAR));
+  memset (scalar_frame.data[0], 0, out_size);
+  run_function (function, &inframe, &scalar_frame);
+
+  for (i = 0; i < G_N_ELEMENTS (simd_impls); ++i) {
+    if (!gst_inference_preprocess_set_impl (simd_impls[i])) {
+      GST_INFO ("Implementation %d not supported, skipping", simd_impls[i]);
+      continue;
+    }
+
+    memset (simd_frame.data[0], 0, out_size);
+    run_function (function, &inframe, &simd_frame);
+    fail_unless (0 == memcmp (scalar_frame.data[0], simd_frame.data[0],
+            out_size), "Implementation %d differs from scalar for %s",
+        simd_impls[i], gst_video_format_to_string (format));
+  }
+
+  gst_inference_preprocess_set_impl (GST_INFERENCE_PREPROCESS_IMPL_AUTO);
+
+  gst_video_frame_unmap (&inframe);
+  gst_video_frame_unmap (&scalar_frame);
+  gst_video_frame_unmap (&simd_frame);
+  gst_buffer_unref (inbuf);
+  gst_buffer_unref (scalar_buf);
+  gst_buffer_unref (simd_buf);
+}
+
+GST_START_TEST (test_gst_preprocess_impl_normalize)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (rgb_formats); ++i) {
+    compare_impls (rgb_formats[i], TEST_NORMALIZE);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_preprocess_impl_subtract_mean)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (rgb_formats); ++i) {
+    compare_impls (rgb_formats[i], TEST_SUBTRACT_MEAN);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_preprocess_impl_pixel_to_float)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (rgb_formats); ++i) {
+    compare_impls (rgb_formats[i], TEST_PIXEL_TO_FLOAT);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_preprocess_impl_gray)
+{
+  compare_impls (GST_VIDEO_FORMAT_GRAY8, TEST_GRAY_NORMALIZE);
+}
+
+GST_END_TEST;
+
+static void
+compare_layouts (GstVideoFormat format)
+{
+  GstVideoInfo info;
+  GstVideoFrame inframe, nhwc_frame, nchw_frame;
+  GstBuffer *inbuf, *nhwc_buf, *nchw_buf;
+  GstMapInfo map;
+  const gfloat *nhwc, *nchw;
+  const gint pixels = TEST_WIDTH * TEST_HEIGHT;
+  gsize out_size, b;
+  gint i, c;
+  guint impl;
+
+  gst_video_info_set_format (&info, format, TEST_WIDTH, TEST_HEIGHT);
+  out_size = pixels * MODEL_CHANNELS * sizeof (gfloat);
+
+  inbuf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  nhwc_buf = gst_buffer_new_allocate (NULL, out_size, NULL);
+  nchw_buf = gst_buffer_new_allocate (NULL, out_size, NULL);
+
+  fail_unless (gst_buffer_map (inbuf, &map, GST_MAP_WRITE));
+  for (b = 0; b < map.size; ++b) {
+    map.data[b] = g_random_int_range (0, 256);
+  }
+  gst_buffer_unmap (inbuf, &map);
+
+  fail_unless (gst_video_frame_map (&inframe, &info, inbuf, GST_MAP_READ));
+  fail_unless (gst_video_frame_map (&nhwc_frame, &info, nhwc_buf,
+          GST_MAP_WRITE));
+  fail_unless (gst_video_frame_map (&nchw_frame, &info, nchw_buf,
+          GST_MAP_WRITE));
+  nhwc = (const gfloat *) nhwc_frame.data[0];
+  nchw = (const gfloat *) nchw_frame.data[0];
+
+  fail_unless (gst_inference_preprocess_set_impl
+      (GST_INFERENCE_PREPROCESS_IMPL_SCALAR));
+  run_function (TEST_SUBTRACT_MEAN, &inframe, &nhwc_frame);
+
+  gst_inference_preprocess_set_layout (GST_INFERENCE_TENSOR_LAYOUT_NCHW);
+  for (impl = GST_INFERENCE_PREPROCESS_IMPL_SCALAR;
+      impl <= GST_INFERENCE_PREPROCESS_IMPL_NEON; ++impl) {
+    if (!gst_inference_preprocess_set_impl (impl)) {
+      continue;
+    }
+
+    memset (nchw_frame.data[0], 0, out_size);
+    run_function (TEST_SUBTRACT_MEAN, &inframe, &nchw_frame);
+    for (i = 0; i < pixels; ++i) {
+      for (c = 0; c < MODEL_CHANNELS; ++c) {
+        fail_unless (nhwc[i * MODEL_CHANNELS + c] == nchw[c * pixels + i],
+            "Implementation %d planar output differs for %s", impl,
+            gst_video_format_to_string (format));
+      }
+    }
+  }
+
+  gst_inference_preprocess_set_layout (GST_INFERENCE_TENSOR_LAYOUT_NHWC);
+  gst_inference_preprocess_set_impl (GST_INFERENCE_PREPROCESS_IMPL_AUTO);
+
+  gst_video_frame_unmap (&inframe);
+  gst_video_frame_unmap (&nhwc_frame);
+  gst_video_frame_unmap (&nchw_frame);
+  gst_buffer_unref (inbuf);
+  gst_buffer_unref (nhwc_buf);
+  gst_buffer_unref (nchw_buf);
+}
+
+GST_START_TEST (test_gst_preprocess_impl_nchw)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (rgb_formats); ++i) {
+    compare_layouts (rgb_formats[i]);
+  }
+}
+
+GST_END_TEST;
+
+static void
+compare_lut (GstVideoFormat format, GstInferenceTensorLayout layout)
+{
+  const GstInferencePreprocessLutMode modes[] = {
+    GST_INFERENCE_PREPROCESS_LUT_ALWAYS,
+    GST_INFERENCE_PREPROCESS_LUT_AUTO
+  };
+  GstInferencePreprocessCache *cache;
+  GstVideoInfo info;
+  GstVideoFrame inframe, scalar_frame, lut_frame;
+  GstBuffer *inbuf, *scalar_buf, *lut_buf;
+  GstMapInfo map;
+  gsize out_size;
+  guint i, run;
+
+  gst_video_info_set_format (&info, format, TEST_WIDTH, TEST_HEIGHT);
+  out_size = TEST_WIDTH * TEST_HEIGHT * MODEL_CHANNELS * sizeof (gfloat);
+
+  inbuf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  scalar_buf = gst_buffer_new_allocate (NULL, out_size, NULL);
+  lut_buf = gst_buffer_new_allocate (NULL, out_size, NULL);
+
+  fail_unless (gst_buffer_map (inbuf, &map, GST_MAP_WRITE));
+  for (i = 0; i < map.size; ++i) {
+    map.data[i] = g_random_int_range (0, 256);
+  }
+  gst_buffer_unmap (inbuf, &map);
+
+  fail_unless (gst_video_frame_map (&inframe, &info, inbuf, GST_MAP_READ));
+  fail_unless (gst_video_frame_map (&scalar_frame, &info, scalar_buf,
+          GST_MAP_WRITE));
+  fail_unless (gst_video_frame_map (&lut_frame, &info, lut_buf,
+          GST_MAP_WRITE));
+
+  gst_inference_preprocess_set_layout (layout);
+  fail_unless (gst_inference_preprocess_set_impl
+      (GST_INFERENCE_PREPROCESS_IMPL_SCALAR));
+  run_function (TEST_SUBTRACT_MEAN, &inframe, &scalar_frame);
+  gst_inference_preprocess_set_impl (GST_INFERENCE_PREPROCESS_IMPL_AUTO);
+
+  for (i = 0; i < G_N_ELEMENTS (modes); ++i) {
+    cache = gst_inference_preprocess_cache_new (modes[i]);
+    gst_inference_preprocess_cache_set_current (cache);
+
+    /* The first run builds the table, the second one reuses it */
+    for (run = 0; run < 2; ++run) {
+      memset (lut_frame.data[0], 0, out_size);
+      run_function (TEST_SUBTRACT_MEAN, &inframe, &lut_frame);
+      fail_unless (0 == memcmp (scalar_frame.data[0], lut_frame.data[0],
+              out_size), "Lookup table mode %d differs from scalar for %s",
+          modes[i], gst_video_format_to_string (format));
+    }
+
+    gst_inference_preprocess_cache_set_current (NULL);
+    gst_inference_preprocess_cache_free (cache);
+  }
+
+  gst_inference_preprocess_set_layout (GST_INFERENCE_TENSOR_LAYOUT_NHWC);
+
+  gst_video_frame_unmap (&inframe);
+  gst_video_frame_unmap (&scalar_frame);
+  gst_video_frame_unmap (&lut_frame);
+  gst_buffer_unref (inbuf);
+  gst_buffer_unref (scalar_buf);
+  gst_buffer_unref (lut_buf);
+}
+
+GST_START_TEST (test_gst_preprocess_impl_lut)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (rgb_formats); ++i) {
+    compare_lut (rgb_formats[i], GST_INFERENCE_TENSOR_LAYOUT_NHWC);
+    compare_lut (rgb_formats[i], GST_INFERENCE_TENSOR_LAYOUT_NCHW);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_preprocess_impl_scalar_always_supported)
+{
+  fail_unless (gst_inference_preprocess_impl_supported
+      (GST_INFERENCE_PREPROCESS_IMPL_SCALAR));
+  fail_unless (gst_inference_preprocess_impl_supported
+      (GST_INFERENCE_PREPROCESS_IMPL_AUTO));
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_preprocess_impl_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_preprocess_impl");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_preprocess_impl_normalize);
+  tcase_add_test (tc, test_gst_preprocess_impl_subtract_mean);
+  tcase_add_test (tc, test_gst_preprocess_impl_pixel_to_float);
+  tcase_add_test (tc, test_gst_preprocess_impl_gray);
+  tcase_add_test (tc, test_gst_preprocess_impl_nchw);
+  tcase_add_test (tc, test_gst_preprocess_impl_lut);
+  tcase_add_test (tc, test_gst_preprocess_impl_scalar_always_supported);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_preprocess_impl);
@@ -0,0 +1,157 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include <string.h>
+#include "gst/r2inference/gstinferencepreprocess.h"
+#include "gst/r2inference/gstinferencepreprocesspool.h"
+
+#define TEST_WIDTH 608
+#define TEST_HEIGHT 608
+#define TEST_THREADS 4
+#define TEST_ITERATIONS 16
+#define MODEL_CHANNELS 3
+
+static void
+fill_random (GstBuffer * buffer)
+{
+  GstMapInfo map;
+  gsize i;
+
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_WRITE));
+  for (i = 0; i < map.size; ++i) {
+    map.data[i] = g_random_int_range (0, 256);
+  }
+  gst_buffer_unmap (buffer, &map);
+}
+
+static void
+compare_pool (GstVideoFormat format, gint model_channels)
+{
+  GstInferencePreprocessPool *pool;
+  GstVideoInfo info;
+  GstVideoFrame inframe, single_frame, pool_frame;
+  GstBuffer *inbuf, *single_buf, *pool_buf;
+  gsize out_size;
+  gint i;
+
+  gst_video_info_set_format (&info, format, TEST_WIDTH, TEST_HEIGHT);
+  out_size = TEST_WIDTH * TEST_HEIGHT * MODEL_CHANNELS * sizeof (gfloat);
+
+  inbuf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  single_buf = gst_buffer_new_allocate (NULL, out_size, NULL);
+  pool_buf = gst_buffer_new_allocate (NULL, out_size, NULL);
+  fill_random (inbuf);
+
+  fail_unless (gst_video_frame_map (&inframe, &info, inbuf, GST_MAP_READ));
+  fail_unless (gst_video_frame_map (&single_frame, &info, single_buf,
+          GST_MAP_WRITE));
+  fail_unless (gst_video_frame_map (&pool_frame, &info, pool_buf,
+          GST_MAP_WRITE));
+
+  memset (single_frame.data[0], 0, out_size);
+  if (GST_VIDEO_FORMAT_GRAY8 == format) {
+    fail_unless (gst_normalize_gray_image (&inframe, &single_frame, 127.5, -1,
+            model_channels));
+  } else {
+    fail_unless (gst_normalize (&inframe, &single_frame, 128, 1 / 128.0,
+            model_channels));
+  }
+
+  pool = gst_inference_preprocess_pool_new (TEST_THREADS);
+  fail_unless_equals_int (TEST_THREADS,
+      gst_inference_preprocess_pool_get_n_threads (pool));
+  gst_inference_preprocess_pool_set_current (pool);
+
+  /* Run several frames to exercise the hand-off between jobs */
+  for (i = 0; i < TEST_ITERATIONS; ++i) {
+    memset (pool_frame.data[0], 0, out_size);
+    if (GST_VIDEO_FORMAT_GRAY8 == format) {
+      fail_unless (gst_normalize_gray_image (&inframe, &pool_frame, 127.5, -1,
+              model_channels));
+    } else {
+      fail_unless (gst_normalize (&inframe, &pool_frame, 128, 1 / 128.0,
+              model_channels));
+    }
+    fail_unless (0 == memcmp (single_frame.data[0], pool_frame.data[0],
+            out_size));
+  }
+
+  gst_inference_preprocess_pool_set_current (NULL);
+  gst_inference_preprocess_pool_free (pool);
+
+  gst_video_frame_unmap (&inframe);
+  gst_video_frame_unmap (&single_frame);
+  gst_video_frame_unmap (&pool_frame);
+  gst_buffer_unref (inbuf);
+  gst_buffer_unref (single_buf);
+  gst_buffer_unref (pool_buf);
+}
+
+GST_START_TEST (test_gst_preprocess_pool_RGB)
+{
+  compare_pool (GST_VIDEO_FORMAT_RGB, MODEL_CHANNELS);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_preprocess_pool_BGRx)
+{
+  compare_pool (GST_VIDEO_FORMAT_BGRx, MODEL_CHANNELS);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_preprocess_pool_GRAY8)
+{
+  compare_pool (GST_VIDEO_FORMAT_GRAY8, 1);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_preprocess_pool_single_thread)
+{
+  GstInferencePreprocessPool *pool = gst_inference_preprocess_pool_new (1);
+
+  fail_unless_equals_int (1,
+      gst_inference_preprocess_pool_get_n_threads (pool));
+  gst_inference_preprocess_pool_free (pool);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_preprocess_pool_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_preprocess_pool");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_preprocess_pool_RGB);
+  tcase_add_test (tc, test_gst_preprocess_pool_BGRx);
+  tcase_add_test (tc, test_gst_preprocess_pool_GRAY8);
+  tcase_add_test (tc, test_gst_preprocess_pool_single_thread);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_preprocess_pool);
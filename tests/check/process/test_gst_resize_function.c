@@ -0,0 +1,252 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include <string.h>
+#include "gst/r2inference/gstinferencepreprocess.h"
+#include "gst/r2inference/gstinferenceresize.h"
+
+#define MODEL_CHANNELS 3
+
+/* BT.601 limited range red */
+#define RED_Y 81
+#define RED_U 90
+#define RED_V 240
+
+static void
+fill_random (GstBuffer * buffer)
+{
+  GstMapInfo map;
+  gsize i;
+
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_WRITE));
+  for (i = 0; i < map.size; ++i) {
+    map.data[i] = g_random_int_range (0, 256);
+  }
+  gst_buffer_unmap (buffer, &map);
+}
+
+static void
+fill_red_yuv (GstVideoFrame * frame)
+{
+  gint i, j;
+  guint8 *data;
+
+  for (i = 0; i < GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0); ++i) {
+    data = GST_VIDEO_FRAME_COMP_DATA (frame, 0) +
+        i * GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
+    memset (data, RED_Y, GST_VIDEO_FRAME_COMP_WIDTH (frame, 0));
+  }
+
+  for (i = 0; i < GST_VIDEO_FRAME_COMP_HEIGHT (frame, 1); ++i) {
+    for (j = 0; j < GST_VIDEO_FRAME_COMP_WIDTH (frame, 1); ++j) {
+      data = GST_VIDEO_FRAME_COMP_DATA (frame, 1) +
+          i * GST_VIDEO_FRAME_COMP_STRIDE (frame, 1) +
+          j * GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 1);
+      *data = RED_U;
+      data = GST_VIDEO_FRAME_COMP_DATA (frame, 2) +
+          i * GST_VIDEO_FRAME_COMP_STRIDE (frame, 2) +
+          j * GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 2);
+      *data = RED_V;
+    }
+  }
+}
+
+static void
+check_identity (GstVideoFormat informat, GstVideoFormat outformat,
+    GstInferenceResizeMethod method)
+{
+  GstVideoInfo ininfo, outinfo;
+  GstVideoFrame inframe, outframe;
+  GstBuffer *inbuf, *outbuf;
+  gint i, j, c;
+
+  gst_video_info_set_format (&ininfo, informat, 37, 11);
+  gst_video_info_set_format (&outinfo, outformat, 37, 11);
+
+  inbuf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&ininfo), NULL);
+  outbuf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&outinfo),
+      NULL);
+  fill_random (inbuf);
+
+  fail_unless (gst_video_frame_map (&inframe, &ininfo, inbuf, GST_MAP_READ));
+  fail_unless (gst_video_frame_map (&outframe, &outinfo, outbuf,
+          GST_MAP_WRITE));
+
+  fail_unless (gst_inference_resize (&inframe, &outframe, method));
+
+  for (i = 0; i < 11; ++i) {
+    for (j = 0; j < 37; ++j) {
+      for (c = 0; c < MODEL_CHANNELS; ++c) {
+        const guint8 *in = GST_VIDEO_FRAME_COMP_DATA (&inframe, c) +
+            i * GST_VIDEO_FRAME_COMP_STRIDE (&inframe, c) +
+            j * GST_VIDEO_FRAME_COMP_PSTRIDE (&inframe, c);
+        const guint8 *out = GST_VIDEO_FRAME_COMP_DATA (&outframe, c) +
+            i * GST_VIDEO_FRAME_COMP_STRIDE (&outframe, c) +
+            j * GST_VIDEO_FRAME_COMP_PSTRIDE (&outframe, c);
+
+        fail_unless_equals_int (*in, *out);
+      }
+    }
+  }
+
+  gst_video_frame_unmap (&inframe);
+  gst_video_frame_unmap (&outframe);
+  gst_buffer_unref (inbuf);
+  gst_buffer_unref (outbuf);
+}
+
+GST_START_TEST (test_gst_resize_identity)
+{
+  check_identity (GST_VIDEO_FORMAT_RGB, GST_VIDEO_FORMAT_BGRA,
+      GST_INFERENCE_RESIZE_METHOD_BILINEAR);
+  check_identity (GST_VIDEO_FORMAT_xBGR, GST_VIDEO_FORMAT_RGB,
+      GST_INFERENCE_RESIZE_METHOD_BILINEAR);
+  check_identity (GST_VIDEO_FORMAT_RGBx, GST_VIDEO_FORMAT_ARGB,
+      GST_INFERENCE_RESIZE_METHOD_AREA);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_resize_area_half)
+{
+  GstVideoInfo ininfo, outinfo;
+  GstVideoFrame inframe, outframe;
+  GstBuffer *inbuf, *outbuf;
+  const guint8 *in, *out;
+  gint i, j, c, sum;
+
+  gst_video_info_set_format (&ininfo, GST_VIDEO_FORMAT_RGBx, 40, 20);
+  gst_video_info_set_format (&outinfo, GST_VIDEO_FORMAT_RGB, 20, 10);
+
+  inbuf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&ininfo), NULL);
+  outbuf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&outinfo),
+      NULL);
+  fill_random (inbuf);
+
+  fail_unless (gst_video_frame_map (&inframe, &ininfo, inbuf, GST_MAP_READ));
+  fail_unless (gst_video_frame_map (&outframe, &outinfo, outbuf,
+          GST_MAP_WRITE));
+
+  fail_unless (gst_inference_resize (&inframe, &outframe,
+          GST_INFERENCE_RESIZE_METHOD_AREA));
+
+  in = GST_VIDEO_FRAME_PLANE_DATA (&inframe, 0);
+  out = GST_VIDEO_FRAME_PLANE_DATA (&outframe, 0);
+  for (i = 0; i < 10; ++i) {
+    for (j = 0; j < 20; ++j) {
+      for (c = 0; c < MODEL_CHANNELS; ++c) {
+        const gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (&inframe, 0);
+
+        sum = in[2 * i * stride + 8 * j + c] +
+            in[2 * i * stride + 8 * j + 4 + c] +
+            in[(2 * i + 1) * stride + 8 * j + c] +
+            in[(2 * i + 1) * stride + 8 * j + 4 + c];
+        fail_unless_equals_int ((gint) (sum / 4.0 + 0.5),
+            out[i * GST_VIDEO_FRAME_PLANE_STRIDE (&outframe, 0) + 3 * j + c]);
+      }
+    }
+  }
+
+  gst_video_frame_unmap (&inframe);
+  gst_video_frame_unmap (&outframe);
+  gst_buffer_unref (inbuf);
+  gst_buffer_unref (outbuf);
+}
+
+GST_END_TEST;
+
+static void
+check_yuv_normalize (GstVideoFormat format, GstInferenceTensorLayout layout)
+{
+  const gdouble mean[MODEL_CHANNELS] = { 128, 128, 128 };
+  const gdouble std[MODEL_CHANNELS] = { 1 / 128.0, 1 / 128.0, 1 / 128.0 };
+  const gint pixels = 24 * 24;
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstBuffer *buffer;
+  gfloat *tensor;
+  gint i, c;
+
+  gst_video_info_set_format (&info, format, 65, 33);
+  buffer = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  fail_unless (gst_video_frame_map (&frame, &info, buffer, GST_MAP_WRITE));
+  fill_red_yuv (&frame);
+
+  tensor = g_new0 (gfloat, pixels * MODEL_CHANNELS);
+  gst_inference_preprocess_set_layout (layout);
+  fail_unless (gst_inference_resize_normalize (&frame, tensor, 24, 24, mean,
+          std, GST_INFERENCE_RESIZE_METHOD_BILINEAR));
+  gst_inference_preprocess_set_layout (GST_INFERENCE_TENSOR_LAYOUT_NHWC);
+
+  for (i = 0; i < pixels; ++i) {
+    for (c = 0; c < MODEL_CHANNELS; ++c) {
+      const gfloat expected = 0 == c ? 127 / 128.0 : -1;
+      const gfloat value = GST_INFERENCE_TENSOR_LAYOUT_NCHW == layout ?
+          tensor[c * pixels + i] : tensor[i * MODEL_CHANNELS + c];
+
+      fail_unless (ABS (value - expected) < 0.02,
+          "Channel %d is %f, expected %f", c, value, expected);
+    }
+  }
+
+  g_free (tensor);
+  gst_video_frame_unmap (&frame);
+  gst_buffer_unref (buffer);
+}
+
+GST_START_TEST (test_gst_resize_normalize_I420)
+{
+  check_yuv_normalize (GST_VIDEO_FORMAT_I420,
+      GST_INFERENCE_TENSOR_LAYOUT_NHWC);
+  check_yuv_normalize (GST_VIDEO_FORMAT_I420,
+      GST_INFERENCE_TENSOR_LAYOUT_NCHW);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_resize_normalize_NV12)
+{
+  check_yuv_normalize (GST_VIDEO_FORMAT_NV12,
+      GST_INFERENCE_TENSOR_LAYOUT_NHWC);
+  check_yuv_normalize (GST_VIDEO_FORMAT_NV12,
+      GST_INFERENCE_TENSOR_LAYOUT_NCHW);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_resize_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_resize");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_resize_identity);
+  tcase_add_test (tc, test_gst_resize_area_half);
+  tcase_add_test (tc, test_gst_resize_normalize_I420);
+  tcase_add_test (tc, test_gst_resize_normalize_NV12);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_resize);
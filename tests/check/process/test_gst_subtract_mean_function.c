@@ -654,14 +654,9 @@ GST_START_TEST (test_gst_subtract_mean_null_outframe)
 
 GST_END_TEST;
 
-static Suite *
-gst_subtract_mean_suite (void)
+static void
+gst_subtract_mean_add_tests (TCase * tc)
 {
-  Suite *suite = suite_create ("GstInference");
-  TCase *tc = tcase_create ("gst_subtract_mean");
-
-  suite_add_tcase (suite, tc);
-
   tcase_add_test (tc, test_gst_subtract_mean_RGBA);
   tcase_add_test (tc, test_gst_subtract_mean_RGB);
   tcase_add_test (tc, test_gst_subtract_mean_RGBx);
@@ -677,6 +672,23 @@ gst_subtract_mean_suite (void)
   tcase_add_test (tc, test_gst_subtract_mean_odd_height);
   tcase_add_test (tc, test_gst_subtract_mean_null_inframe);
   tcase_add_test (tc, test_gst_subtract_mean_null_outframe);
+}
+
+static Suite *
+gst_subtract_mean_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_subtract_mean");
+  TCase *tc_scalar = tcase_create ("gst_subtract_mean_scalar");
+
+  suite_add_tcase (suite, tc);
+  suite_add_tcase (suite, tc_scalar);
+
+  tcase_add_checked_fixture (tc_scalar, gst_preprocess_use_scalar,
+      gst_preprocess_use_default);
+
+  gst_subtract_mean_add_tests (tc);
+  gst_subtract_mean_add_tests (tc_scalar);
 
   return suite;
 }
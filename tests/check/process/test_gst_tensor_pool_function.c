@@ -0,0 +1,118 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include "gst/r2inference/gstinferencetensorpool.h"
+
+#define TENSOR_SIZE (224 * 224 * 3 * sizeof (gfloat))
+#define TENSOR_ALIGNMENT 64
+
+static void
+check_stats (GstBufferPool * pool, guint allocated, guint64 acquired)
+{
+  GstStructure *stats;
+  guint size, stats_allocated;
+  guint64 stats_acquired;
+
+  stats = gst_inference_tensor_pool_get_stats (GST_INFERENCE_TENSOR_POOL
+      (pool));
+  fail_unless (gst_structure_get_uint (stats, "size", &size));
+  fail_unless (gst_structure_get_uint (stats, "allocated", &stats_allocated));
+  fail_unless (gst_structure_get_uint64 (stats, "acquired", &stats_acquired));
+
+  fail_unless_equals_int (size, TENSOR_SIZE);
+  fail_unless_equals_int (stats_allocated, allocated);
+  fail_unless_equals_uint64 (stats_acquired, acquired);
+
+  gst_structure_free (stats);
+}
+
+GST_START_TEST (test_gst_tensor_pool_alignment)
+{
+  GstBufferPool *pool;
+  GstBuffer *buffer;
+  GstMapInfo map;
+
+  pool = gst_inference_tensor_pool_new (TENSOR_SIZE);
+  fail_unless (pool);
+
+  fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &buffer,
+          NULL), GST_FLOW_OK);
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_WRITE));
+  fail_unless_equals_int (map.size, TENSOR_SIZE);
+  fail_unless_equals_int (GPOINTER_TO_SIZE (map.data) % TENSOR_ALIGNMENT, 0);
+  gst_buffer_unmap (buffer, &map);
+  gst_buffer_unref (buffer);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_tensor_pool_reuse)
+{
+  GstBufferPool *pool;
+  GstBuffer *first, *second;
+  gint i;
+
+  pool = gst_inference_tensor_pool_new (TENSOR_SIZE);
+  fail_unless (pool);
+
+  /* A released buffer is handed out again without a new allocation */
+  for (i = 0; i < 10; ++i) {
+    fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &first,
+            NULL), GST_FLOW_OK);
+    gst_buffer_unref (first);
+  }
+  check_stats (pool, 1, 10);
+
+  /* Buffers held at the same time are different allocations */
+  fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &first,
+          NULL), GST_FLOW_OK);
+  fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &second,
+          NULL), GST_FLOW_OK);
+  fail_unless (first != second);
+  gst_buffer_unref (first);
+  gst_buffer_unref (second);
+  check_stats (pool, 2, 12);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_tensor_pool_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_tensor_pool");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_tensor_pool_alignment);
+  tcase_add_test (tc, test_gst_tensor_pool_reuse);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_tensor_pool);
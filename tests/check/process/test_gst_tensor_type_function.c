@@ -0,0 +1,254 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include <math.h>
+#include "gst/r2inference/gstinferencepreprocess.h"
+
+#define TEST_WIDTH 37
+#define TEST_HEIGHT 5
+#define MODEL_CHANNELS 3
+#define TEST_SCALE (1 / 128.0)
+#define TEST_ZERO_POINT 3
+
+static const GstInferencePreprocessImpl impls[] = {
+  GST_INFERENCE_PREPROCESS_IMPL_SCALAR,
+  GST_INFERENCE_PREPROCESS_IMPL_SSE4_1,
+  GST_INFERENCE_PREPROCESS_IMPL_AVX2,
+  GST_INFERENCE_PREPROCESS_IMPL_NEON
+};
+
+static const GstInferenceTensorLayout layouts[] = {
+  GST_INFERENCE_TENSOR_LAYOUT_NHWC,
+  GST_INFERENCE_TENSOR_LAYOUT_NCHW
+};
+
+static gfloat
+half_to_float (guint16 half)
+{
+  gint exponent = (half >> 10) & 0x1f;
+  gint mantissa = half & 0x3ff;
+  gfloat value;
+
+  if (0 == exponent) {
+    value = ldexpf (mantissa / 1024.0, -14);
+  } else {
+    value = ldexpf (1 + mantissa / 1024.0, exponent - 15);
+  }
+
+  return half & 0x8000 ? -value : value;
+}
+
+static void
+normalize_frame (GstVideoFrame * inframe, gpointer tensor,
+    GstInferenceTensorType type)
+{
+  GstVideoFrame outframe;
+
+  outframe = *inframe;
+  outframe.data[0] = tensor;
+
+  gst_inference_preprocess_set_tensor_type (type, TEST_SCALE,
+      TEST_ZERO_POINT);
+  fail_unless (gst_normalize (inframe, &outframe, 128, 1 / 128.0,
+          MODEL_CHANNELS));
+  gst_inference_preprocess_set_tensor_type (GST_INFERENCE_TENSOR_TYPE_FLOAT,
+      1, 0);
+}
+
+static void
+check_tensor_types (GstInferenceTensorLayout layout)
+{
+  const gint count = TEST_WIDTH * TEST_HEIGHT * MODEL_CHANNELS;
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstBuffer *buffer;
+  gfloat *reference;
+  gpointer tensor;
+  GstMapInfo map;
+  gint i, j, c;
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_BGRx, TEST_WIDTH,
+      TEST_HEIGHT);
+  buffer = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_WRITE));
+  for (i = 0; i < map.size; ++i) {
+    map.data[i] = g_random_int_range (0, 256);
+  }
+  gst_buffer_unmap (buffer, &map);
+  fail_unless (gst_video_frame_map (&frame, &info, buffer, GST_MAP_READ));
+
+  reference = g_new0 (gfloat, count);
+  tensor = g_malloc0 (count * sizeof (gfloat));
+
+  gst_inference_preprocess_set_layout (layout);
+  normalize_frame (&frame, reference, GST_INFERENCE_TENSOR_TYPE_FLOAT);
+
+  normalize_frame (&frame, tensor, GST_INFERENCE_TENSOR_TYPE_FP16);
+  for (i = 0; i < count; ++i) {
+    fail_unless (fabs (half_to_float (((guint16 *) tensor)[i]) -
+            reference[i]) < 0.001);
+  }
+
+  normalize_frame (&frame, tensor, GST_INFERENCE_TENSOR_TYPE_INT8);
+  for (i = 0; i < count; ++i) {
+    gint expected = floor (reference[i] / TEST_SCALE + 0.5) + TEST_ZERO_POINT;
+
+    fail_unless_equals_int (((gint8 *) tensor)[i],
+        CLAMP (expected, G_MININT8, G_MAXINT8));
+  }
+
+  /* Raw pixels skip the normalization */
+  normalize_frame (&frame, tensor, GST_INFERENCE_TENSOR_TYPE_UINT8);
+  for (i = 0; i < TEST_HEIGHT; ++i) {
+    for (j = 0; j < TEST_WIDTH; ++j) {
+      for (c = 0; c < MODEL_CHANNELS; ++c) {
+        const guint8 *in = GST_VIDEO_FRAME_COMP_DATA (&frame, c) +
+            i * GST_VIDEO_FRAME_COMP_STRIDE (&frame, c) +
+            j * GST_VIDEO_FRAME_COMP_PSTRIDE (&frame, c);
+        const gint index = GST_INFERENCE_TENSOR_LAYOUT_NCHW == layout ?
+            (c * TEST_HEIGHT + i) * TEST_WIDTH + j :
+            (i * TEST_WIDTH + j) * MODEL_CHANNELS + c;
+
+        fail_unless_equals_int (((guint8 *) tensor)[index], *in);
+      }
+    }
+  }
+  gst_inference_preprocess_set_layout (GST_INFERENCE_TENSOR_LAYOUT_NHWC);
+
+  g_free (reference);
+  g_free (tensor);
+  gst_video_frame_unmap (&frame);
+  gst_buffer_unref (buffer);
+}
+
+GST_START_TEST (test_gst_tensor_type_half)
+{
+  const gfloat values[] = { 0, 1, -2, 0.5, 65504, 1e6, 5.9604645e-8 };
+  const guint16 expected[] = {
+    0x0000, 0x3c00, 0xc000, 0x3800, 0x7bff, 0x7c00, 0x0001
+  };
+  guint16 tensor[G_N_ELEMENTS (values)];
+  gint i;
+
+  gst_inference_tensor_store (values, G_N_ELEMENTS (values), tensor, 0,
+      GST_INFERENCE_TENSOR_TYPE_FP16, 1, 0);
+
+  for (i = 0; i < G_N_ELEMENTS (values); ++i) {
+    fail_unless_equals_int (tensor[i], expected[i]);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_tensor_type_int8_clamp)
+{
+  const gfloat values[] = { -2, -1, 0, 0.5, 2 };
+  const gint8 expected[] = { -128, -118, 10, 74, 127 };
+  gint8 tensor[G_N_ELEMENTS (values)];
+  gint i;
+
+  gst_inference_tensor_store (values, G_N_ELEMENTS (values), tensor, 0,
+      GST_INFERENCE_TENSOR_TYPE_INT8, 1 / 128.0, 10);
+
+  for (i = 0; i < G_N_ELEMENTS (values); ++i) {
+    fail_unless_equals_int (tensor[i], expected[i]);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_tensor_type_normalize)
+{
+  gint i, l;
+
+  for (i = 0; i < G_N_ELEMENTS (impls); ++i) {
+    if (!gst_inference_preprocess_set_impl (impls[i])) {
+      continue;
+    }
+
+    for (l = 0; l < G_N_ELEMENTS (layouts); ++l) {
+      check_tensor_types (layouts[l]);
+    }
+  }
+
+  fail_unless (gst_inference_preprocess_set_impl
+      (GST_INFERENCE_PREPROCESS_IMPL_AUTO));
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_tensor_info)
+{
+  GstInferenceTensorInfo tensor;
+  GstVideoInfo info, tensor_video;
+  gint width, height, channels;
+
+  /* Padding bytes are not part of the tensor */
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_BGRx, TEST_WIDTH,
+      TEST_HEIGHT);
+  fail_unless (gst_inference_tensor_info_from_video_info (&tensor, &info,
+          GST_INFERENCE_TENSOR_TYPE_FLOAT, GST_INFERENCE_TENSOR_LAYOUT_NHWC));
+  fail_unless_equals_int (tensor.size,
+      TEST_WIDTH * TEST_HEIGHT * MODEL_CHANNELS * sizeof (gfloat));
+  fail_unless_equals_int (tensor.shape[1], TEST_HEIGHT);
+  fail_unless_equals_int (tensor.shape[3], MODEL_CHANNELS);
+  fail_unless_equals_int (tensor.strides[1],
+      TEST_WIDTH * MODEL_CHANNELS * sizeof (gfloat));
+
+  gst_inference_tensor_info_to_video_info (&tensor, &tensor_video);
+  fail_unless_equals_int (GST_VIDEO_INFO_SIZE (&tensor_video), tensor.size);
+  fail_unless_equals_int (GST_VIDEO_INFO_WIDTH (&tensor_video), TEST_WIDTH);
+
+  /* Planar tensors keep the channels before the rows */
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_GRAY8, TEST_WIDTH,
+      TEST_HEIGHT);
+  fail_unless (gst_inference_tensor_info_from_video_info (&tensor, &info,
+          GST_INFERENCE_TENSOR_TYPE_FP16, GST_INFERENCE_TENSOR_LAYOUT_NCHW));
+  fail_unless_equals_int (tensor.size,
+      TEST_WIDTH * TEST_HEIGHT * sizeof (guint16));
+  gst_inference_tensor_info_get_dims (&tensor, &width, &height, &channels);
+  fail_unless_equals_int (width, TEST_WIDTH);
+  fail_unless_equals_int (height, TEST_HEIGHT);
+  fail_unless_equals_int (channels, 1);
+  fail_unless_equals_int (tensor.strides[1],
+      TEST_WIDTH * TEST_HEIGHT * sizeof (guint16));
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_tensor_type_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_tensor_type");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_tensor_type_half);
+  tcase_add_test (tc, test_gst_tensor_type_int8_clamp);
+  tcase_add_test (tc, test_gst_tensor_type_normalize);
+  tcase_add_test (tc, test_gst_tensor_info);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_tensor_type);
@@ -0,0 +1,633 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include "gst/r2inference/gstbasebackend.h"
+#include "gst/r2inference/gstinferencemeta.h"
+#include "gst/r2inference/gstvideoinference.h"
+
+#define TEST_CAPS "video/x-raw, format=(string)RGB, width=(int)4, " \
+  "height=(int)4, framerate=(fraction)30/1"
+#define TEST_FRAME_SIZE (4 * 4 * 3)
+#define TEST_BUFFERS 16
+#define TEST_QUEUE_SIZE 2
+
+/* Microseconds each prediction of the test backend takes */
+static gulong test_predict_delay = 0;
+
+/* A backend that predicts without an R2Inference engine */
+typedef struct _TestBackend TestBackend;
+struct _TestBackend
+{
+  GstBaseBackend parent;
+};
+
+typedef struct _TestBackendClass TestBackendClass;
+struct _TestBackendClass
+{
+  GstBaseBackendClass parent_class;
+};
+
+GType test_backend_get_type (void);
+G_DEFINE_TYPE (TestBackend, test_backend, GST_TYPE_BASE_BACKEND);
+
+static gboolean
+test_backend_start (GstBaseBackend * self, const gchar * model_location,
+    GError ** err)
+{
+  return TRUE;
+}
+
+static gboolean
+test_backend_stop (GstBaseBackend * self, GError ** err)
+{
+  return TRUE;
+}
+
+static gboolean
+test_backend_process_frame (GstBaseBackend * self, GstVideoFrame * frame,
+    GstBuffer ** prediction, GError ** err)
+{
+  gfloat value = 1.0;
+
+  if (test_predict_delay) {
+    g_usleep (test_predict_delay);
+  }
+
+  *prediction = gst_buffer_new_allocate (NULL, sizeof (value), NULL);
+  gst_buffer_fill (*prediction, 0, &value, sizeof (value));
+
+  return TRUE;
+}
+
+static void
+test_backend_class_init (TestBackendClass * klass)
+{
+  GstBaseBackendClass *bclass = GST_BASE_BACKEND_CLASS (klass);
+
+  bclass->start = test_backend_start;
+  bclass->stop = test_backend_stop;
+  bclass->process_frame = test_backend_process_frame;
+}
+
+static void
+test_backend_init (TestBackend * self)
+{
+}
+
+/* An inference element running the test backend */
+typedef struct _TestInference TestInference;
+struct _TestInference
+{
+  GstVideoInference parent;
+};
+
+typedef struct _TestInferenceClass TestInferenceClass;
+struct _TestInferenceClass
+{
+  GstVideoInferenceClass parent_class;
+};
+
+GType test_inference_get_type (void);
+G_DEFINE_TYPE (TestInference, test_inference, GST_TYPE_VIDEO_INFERENCE);
+
+static GstStaticPadTemplate test_sink_model_factory =
+GST_STATIC_PAD_TEMPLATE ("sink_model",
+    GST_PAD_SINK,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS (TEST_CAPS)
+    );
+
+static GstStaticPadTemplate test_src_model_factory =
+GST_STATIC_PAD_TEMPLATE ("src_model",
+    GST_PAD_SRC,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS (TEST_CAPS)
+    );
+
+static gboolean
+test_inference_preprocess (GstVideoInference * self, GstVideoFrame * inframe,
+    GstVideoFrame * outframe)
+{
+  return TRUE;
+}
+
+static gboolean
+test_inference_postprocess (GstVideoInference * self,
+    const gpointer prediction, gsize size, GstMeta * meta_model,
+    GstVideoInfo * info_model, gboolean * valid_prediction,
+    gchar ** labels_list, gint num_labels)
+{
+  *valid_prediction = TRUE;
+
+  return TRUE;
+}
+
+static void
+test_inference_class_init (TestInferenceClass * klass)
+{
+  GstElementClass *eclass = GST_ELEMENT_CLASS (klass);
+  GstVideoInferenceClass *vclass = GST_VIDEO_INFERENCE_CLASS (klass);
+
+  gst_element_class_set_static_metadata (eclass, "Test inference",
+      "Filter/Video", "Predicts with a fake backend",
+      "RidgeRun <support@ridgerun.com>");
+  gst_element_class_add_static_pad_template (eclass,
+      &test_sink_model_factory);
+  gst_element_class_add_static_pad_template (eclass, &test_src_model_factory);
+
+  vclass->preprocess = test_inference_preprocess;
+  vclass->postprocess = test_inference_postprocess;
+  vclass->backend_type = test_backend_get_type ();
+}
+
+static void
+test_inference_init (TestInference * self)
+{
+}
+
+typedef struct _TestHarness TestHarness;
+struct _TestHarness
+{
+  GstElement *element;
+  GstHarness *model;
+  GstHarness *bypass;
+};
+
+static GstElement *
+test_inference_new (void)
+{
+  return GST_ELEMENT (gst_object_ref_sink (g_object_new
+          (test_inference_get_type (), "model-location", "test.model",
+              NULL)));
+}
+
+/* Takes the element, set its properties before */
+static void
+test_harness_setup (TestHarness * h, GstElement * element)
+{
+  h->element = element;
+  h->model = gst_harness_new_with_element (h->element, "sink_model",
+      "src_model");
+  h->bypass = gst_harness_new_with_element (h->element, "sink_bypass",
+      "src_bypass");
+  gst_harness_play (h->bypass);
+
+  gst_harness_set_src_caps_str (h->model, TEST_CAPS);
+  gst_harness_set_src_caps_str (h->bypass, TEST_CAPS);
+}
+
+static void
+test_harness_teardown (TestHarness * h)
+{
+  gst_harness_teardown (h->bypass);
+  gst_harness_teardown (h->model);
+  gst_object_unref (h->element);
+}
+
+static GstBuffer *
+test_buffer_new (GstHarness * h, GstClockTime pts)
+{
+  GstBuffer *buffer = gst_harness_create_buffer (h, TEST_FRAME_SIZE);
+
+  GST_BUFFER_PTS (buffer) = pts;
+  GST_BUFFER_DURATION (buffer) = GST_SECOND / 30;
+
+  return buffer;
+}
+
+static guint
+test_harness_count_buffers (GstHarness * h, guint * with_meta)
+{
+  GstBuffer *buffer;
+  GstClockTime last = 0;
+  guint count = 0;
+
+  *with_meta = 0;
+  while ((buffer = gst_harness_try_pull_buffer (h))) {
+    /* Whatever the branch timing, the order is kept */
+    fail_unless (GST_BUFFER_PTS (buffer) >= last);
+    last = GST_BUFFER_PTS (buffer);
+    if (gst_buffer_get_meta (buffer, gst_inference_meta_api_get_type ())) {
+      (*with_meta)++;
+    }
+    gst_buffer_unref (buffer);
+    count++;
+  }
+
+  return count;
+}
+
+static GstEvent *
+test_harness_pull_eos (GstHarness * h)
+{
+  GstEvent *event;
+
+  while ((event = gst_harness_try_pull_event (h))) {
+    if (GST_EVENT_EOS == GST_EVENT_TYPE (event)) {
+      return event;
+    }
+    gst_event_unref (event);
+  }
+
+  return NULL;
+}
+
+static guint64
+test_harness_get_model_dropped (TestHarness * h)
+{
+  GstStructure *stats;
+  guint64 dropped = 0;
+
+  g_object_get (h->element, "queue-stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "model-dropped", &dropped));
+  gst_structure_free (stats);
+
+  return dropped;
+}
+
+static guint
+test_harness_get_model_queued (TestHarness * h)
+{
+  GstStructure *stats;
+  guint queued = 0;
+
+  g_object_get (h->element, "queue-stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint (stats, "model-queued", &queued));
+  gst_structure_free (stats);
+
+  return queued;
+}
+
+static gpointer
+test_push_model (gpointer user_data)
+{
+  GstHarness *h = (GstHarness *) user_data;
+  guint i;
+
+  for (i = 0; i < TEST_BUFFERS; i++) {
+    gst_harness_push (h, test_buffer_new (h, i * GST_SECOND / 30));
+  }
+
+  return NULL;
+}
+
+GST_START_TEST (test_gst_video_inference_pairing)
+{
+  TestHarness h;
+  GstEvent *eos;
+  guint32 seqnum;
+  guint count, with_meta;
+  guint i;
+
+  test_harness_setup (&h, test_inference_new ());
+
+  for (i = 0; i < TEST_BUFFERS; i++) {
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h.bypass,
+            test_buffer_new (h.bypass, i * GST_SECOND / 30)));
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h.model,
+            test_buffer_new (h.model, i * GST_SECOND / 30)));
+  }
+
+  /* The model EOS waits for the bypass branch and keeps its seqnum */
+  eos = gst_event_new_eos ();
+  seqnum = gst_event_get_seqnum (eos);
+  fail_unless (gst_harness_push_event (h.model, eos));
+  fail_unless (NULL == test_harness_pull_eos (h.model));
+  fail_unless (gst_harness_push_event (h.bypass, gst_event_new_eos ()));
+
+  eos = test_harness_pull_eos (h.model);
+  fail_unless (NULL != eos);
+  fail_unless_equals_int (seqnum, gst_event_get_seqnum (eos));
+  gst_event_unref (eos);
+
+  count = test_harness_count_buffers (h.model, &with_meta);
+  fail_unless_equals_int (TEST_BUFFERS, count);
+  fail_unless_equals_int (TEST_BUFFERS, with_meta);
+  count = test_harness_count_buffers (h.bypass, &with_meta);
+  fail_unless_equals_int (TEST_BUFFERS, count);
+  fail_unless (with_meta > 0);
+
+  test_harness_teardown (&h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_video_inference_wait_for_room)
+{
+  TestHarness h;
+  GThread *thread;
+  guint count, with_meta;
+  guint i;
+
+  GstElement *element = test_inference_new ();
+
+  g_object_set (element, "model-queue-size", TEST_QUEUE_SIZE, NULL);
+  test_harness_setup (&h, element);
+
+  /* The model branch runs ahead and waits for the bypass branch */
+  thread = g_thread_new ("test-model", test_push_model, h.model);
+  for (i = 0; i < TEST_BUFFERS; i++) {
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h.bypass,
+            test_buffer_new (h.bypass, i * GST_SECOND / 30)));
+  }
+  fail_unless (gst_harness_push_event (h.bypass, gst_event_new_eos ()));
+  g_thread_join (thread);
+  fail_unless (gst_harness_push_event (h.model, gst_event_new_eos ()));
+
+  count = test_harness_count_buffers (h.model, &with_meta);
+  fail_unless_equals_int (TEST_BUFFERS, count);
+  count = test_harness_count_buffers (h.bypass, &with_meta);
+  fail_unless_equals_int (TEST_BUFFERS, count);
+  fail_unless_equals_int (0, test_harness_get_model_dropped (&h));
+
+  test_harness_teardown (&h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_video_inference_drop_oldest)
+{
+  TestHarness h;
+  guint count, with_meta;
+  guint i;
+
+  GstElement *element = test_inference_new ();
+
+  g_object_set (element, "model-queue-size", TEST_QUEUE_SIZE, NULL);
+  gst_util_set_object_arg (G_OBJECT (element), "leaky", "oldest");
+  test_harness_setup (&h, element);
+
+  /* Nothing consumes the model queue, the excess is dropped */
+  for (i = 0; i < TEST_BUFFERS; i++) {
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h.model,
+            test_buffer_new (h.model, i * GST_SECOND / 30)));
+  }
+  fail_unless_equals_int (TEST_BUFFERS - TEST_QUEUE_SIZE,
+      test_harness_get_model_dropped (&h));
+
+  fail_unless (gst_harness_push_event (h.bypass, gst_event_new_eos ()));
+  fail_unless (gst_harness_push_event (h.model, gst_event_new_eos ()));
+  count = test_harness_count_buffers (h.model, &with_meta);
+  fail_unless_equals_int (TEST_QUEUE_SIZE, count);
+
+  test_harness_teardown (&h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_video_inference_flush)
+{
+  TestHarness h;
+  GstSegment segment;
+  GThread *thread;
+  guint count, with_meta;
+
+  GstElement *element = test_inference_new ();
+
+  g_object_set (element, "model-queue-size", TEST_QUEUE_SIZE, NULL);
+  test_harness_setup (&h, element);
+
+  /* Blocked on the full model queue until the bypass flush */
+  thread = g_thread_new ("test-model", test_push_model, h.model);
+  fail_unless (gst_harness_push_event (h.bypass,
+          gst_event_new_flush_start ()));
+  g_thread_join (thread);
+  fail_unless (gst_harness_push_event (h.bypass,
+          gst_event_new_flush_stop (TRUE)));
+
+  /* Both queues were emptied */
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_harness_push_event (h.bypass,
+          gst_event_new_segment (&segment)));
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h.bypass,
+          test_buffer_new (h.bypass, 0)));
+  fail_unless (gst_harness_push_event (h.bypass, gst_event_new_eos ()));
+  fail_unless (gst_harness_push_event (h.model, gst_event_new_eos ()));
+
+  count = test_harness_count_buffers (h.model, &with_meta);
+  fail_unless_equals_int (0, count);
+  count = test_harness_count_buffers (h.bypass, &with_meta);
+  fail_unless_equals_int (1, count);
+  fail_unless_equals_int (0, with_meta);
+
+  test_harness_teardown (&h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_video_inference_seek)
+{
+  TestHarness h;
+  GstEvent *seek;
+
+  test_harness_setup (&h, test_inference_new ());
+
+  /* Seeking one branch seeks both */
+  seek = gst_event_new_seek (1.0, GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH,
+      GST_SEEK_TYPE_SET, 0, GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE);
+  fail_unless (gst_harness_push_upstream_event (h.bypass, seek));
+
+  fail_unless_equals_int (1, gst_harness_upstream_events_received (h.model));
+  fail_unless_equals_int (1, gst_harness_upstream_events_received (h.bypass));
+
+  test_harness_teardown (&h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_video_inference_bypass_timeout)
+{
+  TestHarness h;
+  guint count, with_meta;
+
+  GstElement *element = test_inference_new ();
+
+  g_object_set (element, "bypass-timeout", 10, NULL);
+  test_harness_setup (&h, element);
+
+  /* No prediction arrives, the buffers older than the timeout leave */
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h.bypass,
+          test_buffer_new (h.bypass, 0)));
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h.bypass,
+          test_buffer_new (h.bypass, 5 * GST_MSECOND)));
+  fail_unless_equals_int (0, gst_harness_buffers_received (h.bypass));
+
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h.bypass,
+          test_buffer_new (h.bypass, 20 * GST_MSECOND)));
+  count = test_harness_count_buffers (h.bypass, &with_meta);
+  fail_unless_equals_int (2, count);
+  fail_unless_equals_int (0, with_meta);
+
+  test_harness_teardown (&h);
+}
+
+GST_END_TEST;
+
+static guint64
+test_buffer_get_id (GstBuffer * buffer)
+{
+  GstInferenceMeta *meta = (GstInferenceMeta *) gst_buffer_get_meta (buffer,
+      gst_inference_meta_api_get_type ());
+
+  return meta ? meta->prediction->prediction_id : G_MAXUINT64;
+}
+
+GST_START_TEST (test_gst_video_inference_interval)
+{
+  TestHarness h;
+  GstElement *element = test_inference_new ();
+  GstBuffer *buffer;
+  guint64 ids[TEST_BUFFERS];
+  guint64 id;
+  guint paired = 0;
+  guint i;
+
+  g_object_set (element, "inference-interval", 2, NULL);
+  test_harness_setup (&h, element);
+
+  for (i = 0; i < TEST_BUFFERS; i++) {
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h.bypass,
+            test_buffer_new (h.bypass, i * GST_SECOND / 30)));
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h.model,
+            test_buffer_new (h.model, i * GST_SECOND / 30)));
+  }
+  fail_unless (gst_harness_push_event (h.model, gst_event_new_eos ()));
+  fail_unless (gst_harness_push_event (h.bypass, gst_event_new_eos ()));
+
+  /* Reused predictions still get an id of their own */
+  for (i = 0; i < TEST_BUFFERS; i++) {
+    buffer = gst_harness_try_pull_buffer (h.model);
+    fail_unless (NULL != buffer);
+    ids[i] = test_buffer_get_id (buffer);
+    fail_unless (G_MAXUINT64 != ids[i]);
+    fail_unless (0 == i || ids[i] != ids[i - 1]);
+    gst_buffer_unref (buffer);
+  }
+
+  /* Each bypass buffer is paired with its own model buffer */
+  for (i = 0; i < TEST_BUFFERS; i++) {
+    buffer = gst_harness_try_pull_buffer (h.bypass);
+    fail_unless (NULL != buffer);
+    id = test_buffer_get_id (buffer);
+    if (G_MAXUINT64 != id) {
+      fail_unless (ids[i] == id);
+      paired++;
+    }
+    gst_buffer_unref (buffer);
+  }
+  fail_unless (paired >= TEST_BUFFERS - 2);
+
+  test_harness_teardown (&h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_video_inference_async_drop)
+{
+  TestHarness h;
+  GstElement *element = test_inference_new ();
+  GstBuffer *buffer;
+  GstEvent *event;
+  guint64 ids[TEST_BUFFERS];
+  guint64 id;
+  guint predicted = 0, paired = 0;
+  guint i;
+
+  g_object_set (element, "async", TRUE, "async-queue-size", 1, NULL);
+  test_harness_setup (&h, element);
+  test_predict_delay = 50 * 1000;
+
+  /* Faster than the inference, most of them are dropped */
+  for (i = 0; i < TEST_BUFFERS; i++) {
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h.model,
+            test_buffer_new (h.model, i * GST_SECOND / 30)));
+  }
+  /* Every buffer or its gap waits for the bypass branch */
+  while (test_harness_get_model_queued (&h) < TEST_BUFFERS) {
+    g_usleep (1000);
+  }
+
+  for (i = 0; i < TEST_BUFFERS; i++) {
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h.bypass,
+            test_buffer_new (h.bypass, i * GST_SECOND / 30)));
+  }
+  fail_unless (gst_harness_push_event (h.bypass, gst_event_new_eos ()));
+  fail_unless (gst_harness_push_event (h.model, gst_event_new_eos ()));
+  while ((event = gst_harness_pull_event (h.model))
+      && GST_EVENT_EOS != GST_EVENT_TYPE (event)) {
+    gst_event_unref (event);
+  }
+  fail_unless (NULL != event);
+  gst_event_unref (event);
+
+  for (i = 0; i < TEST_BUFFERS; i++) {
+    ids[i] = G_MAXUINT64;
+  }
+  while ((buffer = gst_harness_try_pull_buffer (h.model))) {
+    i = gst_util_uint64_scale_round (GST_BUFFER_PTS (buffer), 30, GST_SECOND);
+    ids[i] = test_buffer_get_id (buffer);
+    gst_buffer_unref (buffer);
+    predicted++;
+  }
+  fail_unless (predicted > 0 && predicted < TEST_BUFFERS);
+
+  /* A dropped model buffer doesn't shift the pairing of the next ones */
+  for (i = 0; i < TEST_BUFFERS; i++) {
+    buffer = gst_harness_try_pull_buffer (h.bypass);
+    fail_unless (NULL != buffer);
+    id = test_buffer_get_id (buffer);
+    if (G_MAXUINT64 != id) {
+      fail_unless (ids[i] == id);
+      paired++;
+    }
+    gst_buffer_unref (buffer);
+  }
+  fail_unless (paired > 0);
+
+  test_predict_delay = 0;
+  test_harness_teardown (&h);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_video_inference_suite (void)
+{
+  Suite *suite = suite_create ("GstVideoInference");
+  TCase *tc = tcase_create ("element");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_video_inference_pairing);
+  tcase_add_test (tc, test_gst_video_inference_wait_for_room);
+  tcase_add_test (tc, test_gst_video_inference_drop_oldest);
+  tcase_add_test (tc, test_gst_video_inference_flush);
+  tcase_add_test (tc, test_gst_video_inference_seek);
+  tcase_add_test (tc, test_gst_video_inference_bypass_timeout);
+  tcase_add_test (tc, test_gst_video_inference_interval);
+  tcase_add_test (tc, test_gst_video_inference_async_drop);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_video_inference);